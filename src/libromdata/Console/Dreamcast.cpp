@@ -806,4 +806,33 @@ int Dreamcast::loadInternalImage(ImageType imageType, const rp_image **pImage)
 	return (*pImage != nullptr ? 0 : -EIO);
 }
 
+/**
+ * Verify the EDC and ECC of every sector in the disc image.
+ * Only disc images with 2352-byte sectors can be verified.
+ * For GDI images, tracks with 2048-byte sectors are skipped.
+ * @param report	[out] Sector verification report.
+ * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+ * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+ */
+int Dreamcast::verifyCdromSectors(CdromEdcEcc::SectorReport &report, unsigned int threads)
+{
+	RP_D(Dreamcast);
+	report.sectorCount = 0;
+	report.badSectors.clear();
+	if (!d->isValid || !d->discReader) {
+		// Disc image isn't valid.
+		return -EIO;
+	}
+
+	switch (d->discType) {
+		case DreamcastPrivate::DISC_ISO_2352:
+			return static_cast<Cdrom2352Reader*>(d->discReader)->verifySectors(report, threads);
+		case DreamcastPrivate::DISC_GDI:
+			return d->gdiReader->verifySectors(report, threads);
+		default:
+			// 2048-byte sectors don't have EDC or ECC.
+			return -ENOTSUP;
+	}
+}
+
 }
@@ -23,6 +23,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_DREAMCAST_HPP__
 
 #include "librpbase/RomData.hpp"
+#include "../utils/CdromEdcEcc.hpp"
 
 namespace LibRomData {
 
@@ -163,6 +164,19 @@ class Dreamcast : public LibRpBase::RomData
 		 */
 		virtual int loadInternalImage(ImageType imageType,
 			const LibRpBase::rp_image **pImage) override final;
+
+	public:
+		/** CD-ROM sector verification **/
+
+		/**
+		 * Verify the EDC and ECC of every sector in the disc image.
+		 * Only disc images with 2352-byte sectors can be verified.
+		 * For GDI images, tracks with 2048-byte sectors are skipped.
+		 * @param report	[out] Sector verification report.
+		 * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+		 */
+		int verifyCdromSectors(CdromEdcEcc::SectorReport &report, unsigned int threads = 0);
 };
 
 }
@@ -43,8 +43,10 @@ using namespace LibRpBase;
 
 // DiscReader
 #include "librpbase/disc/DiscReader.hpp"
+#include "librpbase/disc/SplitDiscReader.hpp"
 #include "disc/WbfsReader.hpp"
 #include "disc/CisoGcnReader.hpp"
+#include "disc/GczReader.hpp"
 #include "disc/WiiPartition.hpp"
 
 // C includes. (C++ namespace)
@@ -101,6 +103,7 @@ class GameCubePrivate : public RomDataPrivate
 			DISC_FORMAT_WBFS = (2 << 8),	// WBFS image. (Wii only)
 			DISC_FORMAT_CISO = (3 << 8),	// CISO image.
 			DISC_FORMAT_WIA  = (4 << 8),	// WIA image. (Header only!)
+			DISC_FORMAT_GCZ  = (5 << 8),	// GCZ image. (Dolphin compressed)
 			DISC_FORMAT_UNKNOWN = (0xFF << 8),
 			DISC_FORMAT_MASK = (0xFF << 8),
 		};
@@ -959,7 +962,12 @@ GameCube::GameCube(IRpFile *file)
 	if (d->discType >= 0) {
 		switch (d->discType & GameCubePrivate::DISC_FORMAT_MASK) {
 			case GameCubePrivate::DISC_FORMAT_RAW:
-				d->discReader = new DiscReader(d->file);
+				if (SplitDiscReader::isSplitFilename(d->file->filename())) {
+					// Split disc image. ("*.part0.iso", "*.part1.iso", ...)
+					d->discReader = new SplitDiscReader(d->file);
+				} else {
+					d->discReader = new DiscReader(d->file);
+				}
 				break;
 			case GameCubePrivate::DISC_FORMAT_TGC: {
 				d->fileType = FTYPE_EMBEDDED_DISC_IMAGE;
@@ -976,6 +984,9 @@ GameCube::GameCube(IRpFile *file)
 			case GameCubePrivate::DISC_FORMAT_CISO:
 				d->discReader = new CisoGcnReader(d->file);
 				break;
+			case GameCubePrivate::DISC_FORMAT_GCZ:
+				d->discReader = new GczReader(d->file);
+				break;
 			case GameCubePrivate::DISC_FORMAT_WIA:
 				// TODO: Implement WiaReader.
 				// For now, only the header will be readable.
@@ -1011,9 +1022,16 @@ GameCube::GameCube(IRpFile *file)
 	}
 
 	// Save the disc header for later.
-	d->discReader->rewind();
-	size = d->discReader->read(&d->discHeader, sizeof(d->discHeader));
-	if (size != sizeof(d->discHeader)) {
+	// bi2.bin (GCN) and RVL_RegionSetting (Wii) are read in
+	// the same batch, since we don't know the system type yet.
+	GCN_Boot_Info bootInfo;	// TODO: Save in GameCubePrivate?
+	IRpFile::ReadRequest reqs[3] = {
+		{0, &d->discHeader, sizeof(d->discHeader), 0},
+		{GCN_Boot_Info_ADDRESS, &bootInfo, sizeof(bootInfo), 0},
+		{RVL_RegionSetting_ADDRESS, &d->regionSetting, sizeof(d->regionSetting), 0},
+	};
+	d->discReader->readv(reqs, ARRAY_SIZE(reqs));
+	if (reqs[0].ret != sizeof(d->discHeader)) {
 		// Error reading the disc header.
 		delete d->discReader;
 		d->discReader = nullptr;
@@ -1030,6 +1048,7 @@ GameCube::GameCube(IRpFile *file)
 		// Examples:
 		// - CISO doesn't store a copy of the disc header
 		//   in range of the data we read.
+		// - GCZ stores the disc header compressed.
 		// - TGC has a 32 KB header before the embedded GCM.
 		if (d->discHeader.magic_wii == cpu_to_be32(WII_MAGIC)) {
 			// Wii disc image.
@@ -1060,9 +1079,7 @@ GameCube::GameCube(IRpFile *file)
 	switch (d->discType & GameCubePrivate::DISC_SYSTEM_MASK) {
 		case GameCubePrivate::DISC_SYSTEM_GCN:
 		case GameCubePrivate::DISC_SYSTEM_TRIFORCE: {	// TODO?
-			GCN_Boot_Info bootInfo;	// TODO: Save in GameCubePrivate?
-			size = d->discReader->seekAndRead(GCN_Boot_Info_ADDRESS, &bootInfo, sizeof(bootInfo));
-			if (size != sizeof(bootInfo)) {
+			if (reqs[1].ret != sizeof(bootInfo)) {
 				// Cannot read bi2.bin.
 				delete d->discReader;
 				d->discReader = nullptr;
@@ -1076,8 +1093,7 @@ GameCube::GameCube(IRpFile *file)
 		}
 
 		case GameCubePrivate::DISC_SYSTEM_WII:
-			size = d->discReader->seekAndRead(RVL_RegionSetting_ADDRESS, &d->regionSetting, sizeof(d->regionSetting));
-			if (size != sizeof(d->regionSetting)) {
+			if (reqs[2].ret != sizeof(d->regionSetting)) {
 				// Cannot read RVL_RegionSetting.
 				delete d->discReader;
 				d->discReader = nullptr;
@@ -1172,6 +1188,13 @@ int GameCube::isRomSupported_static(const DetectInfo *info)
 		return (GameCubePrivate::DISC_SYSTEM_UNKNOWN | GameCubePrivate::DISC_FORMAT_CISO);
 	}
 
+	// Check for GCZ.
+	if (GczReader::isDiscSupported_static(info->header.pData, info->header.size) >= 0) {
+		// GCZ blocks are compressed, so the system format
+		// can't be checked until the disc header is read.
+		return (GameCubePrivate::DISC_SYSTEM_UNKNOWN | GameCubePrivate::DISC_FORMAT_GCZ);
+	}
+
 	// Check for WIA.
 	static const uint8_t wia_magic[4] = {'W','I','A',1};
 	if (!memcmp(info->header.pData, wia_magic, sizeof(wia_magic))) {
@@ -1221,6 +1244,33 @@ int GameCube::isRomSupported(const DetectInfo *info) const
 	return isRomSupported_static(info);
 }
 
+/**
+ * Get the general file type for a class-specific system ID.
+ * This does not require constructing the RomData object.
+ * @param romType Class-specific system ID from isRomSupported_static().
+ * @return General file type.
+ */
+RomData::FileType GameCube::fileType_static(int romType)
+{
+	if (romType < 0)
+		return FTYPE_UNKNOWN;
+
+	switch (romType & GameCubePrivate::DISC_FORMAT_MASK) {
+		case GameCubePrivate::DISC_FORMAT_RAW:
+		case GameCubePrivate::DISC_FORMAT_WBFS:
+		case GameCubePrivate::DISC_FORMAT_CISO:
+		case GameCubePrivate::DISC_FORMAT_GCZ:
+		case GameCubePrivate::DISC_FORMAT_WIA:
+			return FTYPE_DISC_IMAGE;
+		case GameCubePrivate::DISC_FORMAT_TGC:
+			return FTYPE_EMBEDDED_DISC_IMAGE;
+		default:
+			break;
+	}
+
+	return FTYPE_UNKNOWN;
+}
+
 /**
  * Get the name of the system the loaded ROM is designed for.
  * @param type System name type. (See the SystemName enum.)
@@ -1270,6 +1320,7 @@ const char *const *GameCube::supportedFileExtensions_static(void)
 	static const char *const exts[] = {
 		".gcm", ".rvm", ".wbfs",
 		".ciso", ".cso", ".tgc",
+		".gcz",
 
 		// Partially supported. (Header only!)
 		".wia",
@@ -2027,4 +2078,49 @@ int GameCube::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) c
 	return 0;
 }
 
+
+#ifdef ENABLE_DECRYPTION
+/**
+ * Verify the hash trees of all Wii partitions. (Wii only)
+ * @param reports	[out] Hash verification reports, one per partition.
+ * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameCube::verifyWiiPartitionHashes(vector<WiiPartitionHashReport> &reports, unsigned int threads)
+{
+	RP_D(GameCube);
+	reports.clear();
+	if (!d->isValid || !d->discReader) {
+		// Disc image isn't valid.
+		return -EIO;
+	} else if ((d->discType & GameCubePrivate::DISC_SYSTEM_MASK) != GameCubePrivate::DISC_SYSTEM_WII) {
+		// Not a Wii disc.
+		return -ENOTSUP;
+	}
+
+	int ret = d->loadWiiPartitionTables();
+	if (ret != 0) {
+		return ret;
+	}
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(d->wiiVgTbl); i++) {
+		const GameCubePrivate::WiiPartTable &tbl = d->wiiVgTbl[i];
+		for (unsigned int j = 0; j < (unsigned int)tbl.size(); j++) {
+			const GameCubePrivate::WiiPartEntry &entry = tbl[j];
+
+			size_t idx = reports.size();
+			reports.resize(idx+1);
+			WiiPartitionHashReport &report = reports[idx];
+			report.vg = i;
+			report.pt = j;
+			report.type = entry.type;
+			report.start = entry.start;
+			report.error = entry.partition->verifyHashes(report.report, threads);
+		}
+	}
+
+	return 0;
+}
+#endif /* ENABLE_DECRYPTION */
+
 }
@@ -23,6 +23,9 @@
 #define __ROMPROPERTIES_LIBROMDATA_GAMECUBE_HPP__
 
 #include "librpbase/RomData.hpp"
+#ifdef ENABLE_DECRYPTION
+# include "../disc/WiiPartition.hpp"
+#endif /* ENABLE_DECRYPTION */
 
 namespace LibRomData {
 
@@ -74,6 +77,14 @@ class GameCube : public LibRpBase::RomData
 		 */
 		virtual int isRomSupported(const DetectInfo *info) const override final;
 
+		/**
+		 * Get the general file type for a class-specific system ID.
+		 * This does not require constructing the RomData object.
+		 * @param romType Class-specific system ID from isRomSupported_static().
+		 * @return General file type.
+		 */
+		static FileType fileType_static(int romType);
+
 		/**
 		 * Get the name of the system the loaded ROM is designed for.
 		 * @param type System name type. (See the SystemName enum.)
@@ -192,6 +203,29 @@ class GameCube : public LibRpBase::RomData
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		virtual int extURLs(ImageType imageType, std::vector<ExtURL> *pExtURLs, int size = IMAGE_SIZE_DEFAULT) const override final;
+
+#ifdef ENABLE_DECRYPTION
+	public:
+		/** Wii partition hash verification **/
+
+		// Hash verification report for a Wii partition.
+		struct WiiPartitionHashReport {
+			unsigned int vg;	// Volume group number.
+			unsigned int pt;	// Partition number within the volume group.
+			uint32_t type;		// Partition type. (0 == game, 1 == update, 2 == channel)
+			int64_t start;		// Partition starting address, in bytes.
+			int error;		// 0 if verified; negative POSIX error code on error.
+			WiiPartition::HashReport report;
+		};
+
+		/**
+		 * Verify the hash trees of all Wii partitions. (Wii only)
+		 * @param reports	[out] Hash verification reports, one per partition.
+		 * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int verifyWiiPartitionHashes(std::vector<WiiPartitionHashReport> &reports, unsigned int threads = 0);
+#endif /* ENABLE_DECRYPTION */
 };
 
 }
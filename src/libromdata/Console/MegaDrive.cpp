@@ -730,6 +730,31 @@ int MegaDrive::isRomSupported(const DetectInfo *info) const
 	return isRomSupported_static(info);
 }
 
+/**
+ * Get the general file type for a class-specific system ID.
+ * This does not require constructing the RomData object.
+ * @param romType Class-specific system ID from isRomSupported_static().
+ * @return General file type.
+ */
+RomData::FileType MegaDrive::fileType_static(int romType)
+{
+	if (romType < 0)
+		return FTYPE_UNKNOWN;
+
+	switch (romType & MegaDrivePrivate::ROM_FORMAT_MASK) {
+		case MegaDrivePrivate::ROM_FORMAT_CART_BIN:
+		case MegaDrivePrivate::ROM_FORMAT_CART_SMD:
+			return FTYPE_ROM_IMAGE;
+		case MegaDrivePrivate::ROM_FORMAT_DISC_2048:
+		case MegaDrivePrivate::ROM_FORMAT_DISC_2352:
+			return FTYPE_DISC_IMAGE;
+		default:
+			break;
+	}
+
+	return FTYPE_UNKNOWN;
+}
+
 /**
  * Get the name of the system the loaded ROM is designed for.
  * @param type System name type. (See the SystemName enum.)
@@ -460,6 +460,34 @@ int NES::isRomSupported(const DetectInfo *info) const
 	return isRomSupported_static(info);
 }
 
+/**
+ * Get the general file type for a class-specific system ID.
+ * This does not require constructing the RomData object.
+ * @param romType Class-specific system ID from isRomSupported_static().
+ * @return General file type.
+ */
+RomData::FileType NES::fileType_static(int romType)
+{
+	if (romType < 0)
+		return FTYPE_UNKNOWN;
+
+	switch (romType & NESPrivate::ROM_FORMAT_MASK) {
+		case NESPrivate::ROM_FORMAT_OLD_INES:
+		case NESPrivate::ROM_FORMAT_INES:
+		case NESPrivate::ROM_FORMAT_NES2:
+		case NESPrivate::ROM_FORMAT_TNES:
+			return FTYPE_ROM_IMAGE;
+		case NESPrivate::ROM_FORMAT_FDS:
+		case NESPrivate::ROM_FORMAT_FDS_FWNES:
+		case NESPrivate::ROM_FORMAT_FDS_TNES:
+			return FTYPE_DISK_IMAGE;
+		default:
+			break;
+	}
+
+	return FTYPE_UNKNOWN;
+}
+
 /**
  * Get the name of the system the loaded ROM is designed for.
  * @param type System name type. (See the SystemName enum.)
@@ -588,4 +588,33 @@ int SegaSaturn::loadFieldData(void)
 	return (int)d->fields->count();
 }
 
+/**
+ * Verify the EDC and ECC of every sector in the disc image.
+ * Only disc images with 2352-byte sectors can be verified.
+ * @param report	[out] Sector verification report.
+ * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+ * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+ */
+int SegaSaturn::verifyCdromSectors(CdromEdcEcc::SectorReport &report, unsigned int threads)
+{
+	RP_D(SegaSaturn);
+	report.sectorCount = 0;
+	report.badSectors.clear();
+	if (!d->file || !d->file->isOpen()) {
+		// File isn't open.
+		return -EBADF;
+	} else if (!d->isValid) {
+		// Disc image isn't valid.
+		return -EIO;
+	} else if (d->discType != SegaSaturnPrivate::DISC_ISO_2352) {
+		// 2048-byte sectors don't have EDC or ECC.
+		return -ENOTSUP;
+	}
+
+	// NOTE: SegaSaturn only reads the disc header,
+	// so a Cdrom2352Reader is only needed here.
+	Cdrom2352Reader reader(d->file);
+	return reader.verifySectors(report, threads);
+}
+
 }
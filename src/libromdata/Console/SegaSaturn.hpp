@@ -22,6 +22,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_SEGASATURN_HPP__
 
 #include "librpbase/RomData.hpp"
+#include "../utils/CdromEdcEcc.hpp"
 
 namespace LibRomData {
 
@@ -118,6 +119,18 @@ class SegaSaturn : public LibRpBase::RomData
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		virtual int loadFieldData(void) override final;
+
+	public:
+		/** CD-ROM sector verification **/
+
+		/**
+		 * Verify the EDC and ECC of every sector in the disc image.
+		 * Only disc images with 2352-byte sectors can be verified.
+		 * @param report	[out] Sector verification report.
+		 * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+		 */
+		int verifyCdromSectors(CdromEdcEcc::SectorReport &report, unsigned int threads = 0);
 };
 
 }
@@ -617,28 +617,32 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 		return -1;
 	}
 
-	/** Read the ticket. **/
+	// The ticket and TMD are located at fixed addresses,
+	// but the location of the actual data depends on the
+	// signature type, so we need two batches of reads:
+	// - Ticket and TMD signature types.
+	// - Ticket and TMD header.
 
-	// Determine the ticket starting address
-	// and read the signature type.
+	// Determine the ticket and TMD starting addresses.
 	const uint32_t ticket_start = toNext64(le32_to_cpu(mxh.cia_header.header_size)) +
 			toNext64(le32_to_cpu(mxh.cia_header.cert_chain_size));
-	uint32_t addr = ticket_start;
-	uint32_t signature_type;
-	size_t size = file->seekAndRead(addr, &signature_type, sizeof(signature_type));
-	if (size != sizeof(signature_type)) {
+	const uint32_t tmd_start = ticket_start +
+			toNext64(le32_to_cpu(mxh.cia_header.ticket_size));
+
+	/** Read the signature types. **/
+	uint32_t ticket_sigtype, tmd_sigtype;
+	IRpFile::ReadRequest reqs[2] = {
+		{ticket_start, &ticket_sigtype, sizeof(ticket_sigtype), 0},
+		{tmd_start, &tmd_sigtype, sizeof(tmd_sigtype), 0},
+	};
+	file->readv(reqs, 2);
+	if (reqs[0].ret != sizeof(ticket_sigtype)) {
 		// Seek and/or read error.
 		return -2;
 	}
-	signature_type = be32_to_cpu(signature_type);
-
-	// Verify the signature type.
-	if ((signature_type & 0xFFFFFFF8) != 0x00010000) {
-		// Invalid signature type.
-		return -3;
-	}
+	ticket_sigtype = be32_to_cpu(ticket_sigtype);
 
-	// Skip over the signature and padding.
+	// Signature lengths, including padding.
 	static const unsigned int sig_len_tbl[8] = {
 		0x200 + 0x3C,	// N3DS_SIGTYPE_RSA_4096_SHA1
 		0x100 + 0x3C,	// N3DS_SIGTYPE_RSA_2048_SHA1,
@@ -652,7 +656,16 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 		0,		// invalid
 	};
 
-	uint32_t sig_len = sig_len_tbl[signature_type & 0x07];
+	/** Verify the ticket. **/
+
+	// Verify the signature type.
+	if ((ticket_sigtype & 0xFFFFFFF8) != 0x00010000) {
+		// Invalid signature type.
+		return -3;
+	}
+
+	// Skip over the signature and padding.
+	uint32_t sig_len = sig_len_tbl[ticket_sigtype & 0x07];
 	if (sig_len == 0) {
 		// Invalid signature type.
 		return -3;
@@ -664,36 +677,24 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 		// Ticket is too small.
 		return -4;
 	}
+	const uint32_t ticket_addr = ticket_start + sizeof(ticket_sigtype) + sig_len;
 
-	// Read the ticket.
-	addr += sizeof(signature_type) + sig_len;
-	size = file->seekAndRead(addr, &mxh.ticket, sizeof(mxh.ticket));
-	if (size != sizeof(mxh.ticket)) {
-		// Seek and/or read error.
-		return -5;
-	}
-
-	/** Read the TMD. **/
+	/** Verify the TMD. **/
 
-	// Determine the TMD starting address.
-	const uint32_t tmd_start = ticket_start +
-			toNext64(le32_to_cpu(mxh.cia_header.ticket_size));
-	addr = tmd_start;
-	size = file->seekAndRead(addr, &signature_type, sizeof(signature_type));
-	if (size != sizeof(signature_type)) {
+	if (reqs[1].ret != sizeof(tmd_sigtype)) {
 		// Seek and/or read error.
 		return -6;
 	}
-	signature_type = be32_to_cpu(signature_type);
+	tmd_sigtype = be32_to_cpu(tmd_sigtype);
 
 	// Verify the signature type.
-	if ((signature_type & 0xFFFFFFF8) != 0x00010000) {
+	if ((tmd_sigtype & 0xFFFFFFF8) != 0x00010000) {
 		// Invalid signature type.
 		return -7;
 	}
 
 	// Skip over the signature and padding.
-	sig_len = sig_len_tbl[signature_type & 0x07];
+	sig_len = sig_len_tbl[tmd_sigtype & 0x07];
 	if (sig_len == 0) {
 		// Invalid signature type.
 		return -7;
@@ -705,11 +706,21 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 		// TMD is too small.
 		return -8;
 	}
-
-	// Read the TMD.
-	addr += sizeof(signature_type) + sig_len;
-	size = file->seekAndRead(addr, &mxh.tmd_header, sizeof(mxh.tmd_header));
-	if (size != sizeof(mxh.tmd_header)) {
+	uint32_t addr = tmd_start + sizeof(tmd_sigtype) + sig_len;
+
+	/** Read the ticket and TMD header. **/
+	reqs[0].pos = ticket_addr;
+	reqs[0].ptr = &mxh.ticket;
+	reqs[0].size = sizeof(mxh.ticket);
+	reqs[1].pos = addr;
+	reqs[1].ptr = &mxh.tmd_header;
+	reqs[1].size = sizeof(mxh.tmd_header);
+	file->readv(reqs, 2);
+	if (reqs[0].ret != sizeof(mxh.ticket)) {
+		// Seek and/or read error.
+		return -5;
+	}
+	if (reqs[1].ret != sizeof(mxh.tmd_header)) {
 		// Seek and/or read error.
 		return -9;
 	}
@@ -725,7 +736,7 @@ int Nintendo3DSPrivate::loadTicketAndTMD(void)
 	const size_t content_chunks_size = content_count * sizeof(N3DS_Content_Chunk_Record_t);
 
 	addr += sizeof(N3DS_TMD_t);
-	size = file->seekAndRead(addr, content_chunks.get(), content_chunks_size);
+	size_t size = file->seekAndRead(addr, content_chunks.get(), content_chunks_size);
 	if (size != content_chunks_size) {
 		// Seek and/or read error.
 		content_count = 0;
@@ -1494,6 +1505,35 @@ int Nintendo3DS::isRomSupported(const DetectInfo *info) const
 	return isRomSupported_static(info);
 }
 
+/**
+ * Get the general file type for a class-specific system ID.
+ * This does not require constructing the RomData object.
+ * @param romType Class-specific system ID from isRomSupported_static().
+ * @return General file type.
+ */
+RomData::FileType Nintendo3DS::fileType_static(int romType)
+{
+	switch (romType) {
+		case Nintendo3DSPrivate::ROM_TYPE_SMDH:
+			return FTYPE_ICON_FILE;
+		case Nintendo3DSPrivate::ROM_TYPE_3DSX:
+			return FTYPE_HOMEBREW;
+		case Nintendo3DSPrivate::ROM_TYPE_CIA:
+			return FTYPE_APPLICATION_PACKAGE;
+		case Nintendo3DSPrivate::ROM_TYPE_CCI:
+			return FTYPE_ROM_IMAGE;
+		case Nintendo3DSPrivate::ROM_TYPE_eMMC:
+			return FTYPE_EMMC_DUMP;
+		case Nintendo3DSPrivate::ROM_TYPE_NCCH:
+			// TODO: Better type.
+			return FTYPE_TITLE_CONTENTS;
+		default:
+			break;
+	}
+
+	return FTYPE_UNKNOWN;
+}
+
 /**
  * Get the name of the system the loaded ROM is designed for.
  * @param type System name type. (See the SystemName enum.)
@@ -1746,6 +1786,12 @@ int Nintendo3DS::loadFieldData(void)
 	// TODO: Split up into smaller functions?
 	const char *const s_unknown = C_("Nintendo3DS", "Unknown");
 
+	// Requested field groups.
+	// The partition and contents tables require loading every
+	// NCCH, and the ExHeader requires decryption, so skip them
+	// if they weren't requested.
+	const uint32_t fieldGroups = d->fieldGroups;
+
 	// Maximum of 20 fields.
 	// Tested with several CCI, CIA, and NCCH files.
 	d->fields->reserve(20);
@@ -1801,93 +1847,97 @@ int Nintendo3DS::loadFieldData(void)
 			// Add the title ID and product code fields here.
 			// (Include the content type, if available.)
 			haveSeparateSMDHTab = false;
-			d->addTitleIdAndProductCodeFields(true);
+			if (fieldGroups & FG_IDENTITY) {
+				d->addTitleIdAndProductCodeFields(true);
+			}
 		}
 
-		// Get the system language.
-		// TODO: Verify against the game's region code?
-		int lang = NintendoLanguage::getN3DSLanguage();
-
-		// Check that the field is valid.
-		if (d->smdh.header.titles[lang].desc_short[0] == cpu_to_le16(0)) {
-			// Not valid. Check English.
-			if (d->smdh.header.titles[N3DS_LANG_ENGLISH].desc_short[0] != cpu_to_le16(0)) {
-				// English is valid.
-				lang = N3DS_LANG_ENGLISH;
-			} else {
-				// Not valid. Check Japanese.
-				if (d->smdh.header.titles[N3DS_LANG_JAPANESE].desc_short[0] != cpu_to_le16(0)) {
-					// Japanese is valid.
-					lang = N3DS_LANG_JAPANESE;
+		if (fieldGroups & FG_IDENTITY) {
+			// Get the system language.
+			// TODO: Verify against the game's region code?
+			int lang = NintendoLanguage::getN3DSLanguage();
+
+			// Check that the field is valid.
+			if (d->smdh.header.titles[lang].desc_short[0] == cpu_to_le16(0)) {
+				// Not valid. Check English.
+				if (d->smdh.header.titles[N3DS_LANG_ENGLISH].desc_short[0] != cpu_to_le16(0)) {
+					// English is valid.
+					lang = N3DS_LANG_ENGLISH;
 				} else {
-					// Not valid...
-					// TODO: Check other languages?
-					lang = -1;
+					// Not valid. Check Japanese.
+					if (d->smdh.header.titles[N3DS_LANG_JAPANESE].desc_short[0] != cpu_to_le16(0)) {
+						// Japanese is valid.
+						lang = N3DS_LANG_JAPANESE;
+					} else {
+						// Not valid...
+						// TODO: Check other languages?
+						lang = -1;
+					}
 				}
 			}
-		}
 
-		if (lang >= 0 && lang < ARRAY_SIZE(d->smdh.header.titles)) {
-			d->fields->addField_string(C_("Nintendo3DS", "Title"), utf16le_to_utf8(
-				d->smdh.header.titles[1].desc_short, ARRAY_SIZE(d->smdh.header.titles[lang].desc_short)));
-			d->fields->addField_string(C_("Nintendo3DS", "Full Title"), utf16le_to_utf8(
-				d->smdh.header.titles[1].desc_long, ARRAY_SIZE(d->smdh.header.titles[lang].desc_long)));
-			d->fields->addField_string(C_("Nintendo3DS", "Publisher"), utf16le_to_utf8(
-				d->smdh.header.titles[1].publisher, ARRAY_SIZE(d->smdh.header.titles[lang].publisher)));
-		}
-
-		// Region code.
-		// Maps directly to the SMDH field.
-		static const char *const n3ds_region_bitfield_names[] = {
-			NOP_C_("Region", "Japan"),
-			NOP_C_("Region", "USA"),
-			NOP_C_("Region", "Europe"),
-			NOP_C_("Region", "Australia"),
-			NOP_C_("Region", "China"),
-			NOP_C_("Region", "South Korea"),
-			NOP_C_("Region", "Taiwan"),
-		};
-		vector<string> *const v_n3ds_region_bitfield_names = RomFields::strArrayToVector_i18n(
-			"Region", n3ds_region_bitfield_names, ARRAY_SIZE(n3ds_region_bitfield_names));
-		d->fields->addField_bitfield(C_("Nintendo3DS", "Region Code"),
-			v_n3ds_region_bitfield_names, 3, le32_to_cpu(d->smdh.header.settings.region_code));
-
-		// Age rating(s).
-		// Note that not all 16 fields are present on 3DS,
-		// though the fields do match exactly, so no
-		// mapping is necessary.
-		RomFields::age_ratings_t age_ratings;
-		// Valid ratings: 0-1, 3-4, 6-10
-		static const uint16_t valid_ratings = 0x7DB;
-
-		for (int i = (int)age_ratings.size()-1; i >= 0; i--) {
-			if (!(valid_ratings & (1 << i))) {
-				// Rating is not applicable for NintendoDS.
-				age_ratings[i] = 0;
-				continue;
+			if (lang >= 0 && lang < ARRAY_SIZE(d->smdh.header.titles)) {
+				d->fields->addField_string(C_("Nintendo3DS", "Title"), utf16le_to_utf8(
+					d->smdh.header.titles[1].desc_short, ARRAY_SIZE(d->smdh.header.titles[lang].desc_short)));
+				d->fields->addField_string(C_("Nintendo3DS", "Full Title"), utf16le_to_utf8(
+					d->smdh.header.titles[1].desc_long, ARRAY_SIZE(d->smdh.header.titles[lang].desc_long)));
+				d->fields->addField_string(C_("Nintendo3DS", "Publisher"), utf16le_to_utf8(
+					d->smdh.header.titles[1].publisher, ARRAY_SIZE(d->smdh.header.titles[lang].publisher)));
 			}
 
-			// 3DS ratings field:
-			// - 0x1F: Age rating.
-			// - 0x20: No age restriction.
-			// - 0x40: Rating pending.
-			// - 0x80: Rating is valid if set.
-			const uint8_t n3ds_rating = d->smdh.header.settings.ratings[i];
-			if (!(n3ds_rating & 0x80)) {
-				// Rating is unused.
-				age_ratings[i] = 0;
-			} else if (n3ds_rating & 0x40) {
-				// Rating pending.
-				age_ratings[i] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_PENDING;
-			} else if (n3ds_rating & 0x20) {
-				// No age restriction.
-				age_ratings[i] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_NO_RESTRICTION;
-			} else {
-				// Set active | age value.
-				age_ratings[i] = RomFields::AGEBF_ACTIVE | (n3ds_rating & 0x1F);
+			// Region code.
+			// Maps directly to the SMDH field.
+			static const char *const n3ds_region_bitfield_names[] = {
+				NOP_C_("Region", "Japan"),
+				NOP_C_("Region", "USA"),
+				NOP_C_("Region", "Europe"),
+				NOP_C_("Region", "Australia"),
+				NOP_C_("Region", "China"),
+				NOP_C_("Region", "South Korea"),
+				NOP_C_("Region", "Taiwan"),
+			};
+			vector<string> *const v_n3ds_region_bitfield_names = RomFields::strArrayToVector_i18n(
+				"Region", n3ds_region_bitfield_names, ARRAY_SIZE(n3ds_region_bitfield_names));
+			d->fields->addField_bitfield(C_("Nintendo3DS", "Region Code"),
+				v_n3ds_region_bitfield_names, 3, le32_to_cpu(d->smdh.header.settings.region_code));
+
+			// Age rating(s).
+			// Note that not all 16 fields are present on 3DS,
+			// though the fields do match exactly, so no
+			// mapping is necessary.
+			RomFields::age_ratings_t age_ratings;
+			// Valid ratings: 0-1, 3-4, 6-10
+			static const uint16_t valid_ratings = 0x7DB;
+
+			for (int i = (int)age_ratings.size()-1; i >= 0; i--) {
+				if (!(valid_ratings & (1 << i))) {
+					// Rating is not applicable for NintendoDS.
+					age_ratings[i] = 0;
+					continue;
+				}
+
+				// 3DS ratings field:
+				// - 0x1F: Age rating.
+				// - 0x20: No age restriction.
+				// - 0x40: Rating pending.
+				// - 0x80: Rating is valid if set.
+				const uint8_t n3ds_rating = d->smdh.header.settings.ratings[i];
+				if (!(n3ds_rating & 0x80)) {
+					// Rating is unused.
+					age_ratings[i] = 0;
+				} else if (n3ds_rating & 0x40) {
+					// Rating pending.
+					age_ratings[i] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_PENDING;
+				} else if (n3ds_rating & 0x20) {
+					// No age restriction.
+					age_ratings[i] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_NO_RESTRICTION;
+				} else {
+					// Set active | age value.
+					age_ratings[i] = RomFields::AGEBF_ACTIVE | (n3ds_rating & 0x1F);
+				}
 			}
+			d->fields->addField_ageRatings(C_("Nintendo3DS", "Age Rating"), age_ratings);
 		}
-		d->fields->addField_ageRatings(C_("Nintendo3DS", "Age Rating"), age_ratings);
 	} else if (d->srlData) {
 		// DSiWare SRL.
 		const RomFields *srl_fields = d->srlData->fields();
@@ -1900,7 +1950,9 @@ int Nintendo3DS::loadFieldData(void)
 				// Add the title ID and product code fields here.
 				// (Include the content type, if available.)
 				haveSeparateSMDHTab = false;
-				d->addTitleIdAndProductCodeFields(true);
+				if (fieldGroups & FG_IDENTITY) {
+					d->addTitleIdAndProductCodeFields(true);
+				}
 			}
 
 			// Add the DSiWare fields.
@@ -1911,7 +1963,9 @@ int Nintendo3DS::loadFieldData(void)
 		// Add the title ID and product code fields here.
 		// (Include the content type, if available.)
 		haveSeparateSMDHTab = false;
-		d->addTitleIdAndProductCodeFields(true);
+		if (fieldGroups & FG_IDENTITY) {
+			d->addTitleIdAndProductCodeFields(true);
+		}
 	}
 
 	// Is the NCSD header loaded?
@@ -1921,7 +1975,9 @@ int Nintendo3DS::loadFieldData(void)
 			d->fields->addTab("NCSD");
 			// Add the title ID and product code fields here.
 			// (Content type is listed in the NCSD partition table.)
-			d->addTitleIdAndProductCodeFields(false);
+			if (fieldGroups & FG_IDENTITY) {
+				d->addTitleIdAndProductCodeFields(false);
+			}
 		} else {
 			d->fields->setTabName(0, "NCSD");
 		}
@@ -1994,8 +2050,10 @@ int Nintendo3DS::loadFieldData(void)
 			// eMMC (NAND dump)
 
 			// eMMC type.
-			d->fields->addField_string(C_("Nintendo3DS|eMMC", "Type"),
-				(new3ds ? "New3DS / New2DS" : "Old3DS / 2DS"));
+			if (fieldGroups & FG_DETAILS) {
+				d->fields->addField_string(C_("Nintendo3DS|eMMC", "Type"),
+					(new3ds ? "New3DS / New2DS" : "Old3DS / 2DS"));
+			}
 
 			// Partition type names.
 			// TODO: Show TWL NAND partitions?
@@ -2015,7 +2073,7 @@ int Nintendo3DS::loadFieldData(void)
 				"Nintendo3DS|eMMC", emmc_partitions_names, ARRAY_SIZE(emmc_partitions_names));
 		}
 
-		if (d->romType == Nintendo3DSPrivate::ROM_TYPE_CCI) {
+		if (d->romType == Nintendo3DSPrivate::ROM_TYPE_CCI && (fieldGroups & FG_DETAILS)) {
 			// CCI-specific fields.
 			const N3DS_NCSD_Card_Info_Header_t *const cinfo_header = &d->mxh.cinfo_header;
 
@@ -2080,101 +2138,105 @@ int Nintendo3DS::loadFieldData(void)
 			// TODO: Show "title version"?
 		}
 
-		// Partition table.
-		// TODO: Show the ListView on a separate row?
-		auto partitions = new std::vector<std::vector<string> >();
-		partitions->reserve(8);
-
-		// Process the partition table.
-		for (unsigned int i = 0; i < 8; i++) {
-			const uint32_t length = le32_to_cpu(ncsd_header->partitions[i].length);
-			if (length == 0)
-				continue;
-
-			// Make sure the partition exists first.
-			NCCHReader *pNcch = nullptr;
-			int ret = d->loadNCCH(i, &pNcch);
-			if (ret == -ENOENT)
-				continue;
-
-			const int vidx = (int)partitions->size();
-			partitions->resize(vidx+1);
-			auto &data_row = partitions->at(vidx);
-
-			// Partition number.
-			data_row.push_back(rp_sprintf("%u", i));
-
-			// Partition type.
-			// TODO: Use the partition ID to determine the type?
-			const char *type = (pt_types[i] ? pt_types[i] : s_unknown);
-			data_row.push_back(type);
-
-			if (!emmc) {
-				const N3DS_NCCH_Header_NoSig_t *const part_ncch_header =
-					(pNcch && pNcch->isOpen() ? pNcch->ncchHeader() : nullptr);
-				if (part_ncch_header) {
-					// Encryption.
-					NCCHReader::CryptoType cryptoType = {nullptr, false, 0, false};
-					int ret = NCCHReader::cryptoType_static(&cryptoType, part_ncch_header);
-					if (ret != 0 || !cryptoType.encrypted || cryptoType.keyslot >= 0x40) {
-						// Not encrypted, or not using a predefined keyslot.
-						if (cryptoType.name) {
-							data_row.push_back(latin1_to_utf8(cryptoType.name, -1));
+		if (fieldGroups & FG_CONTENTS) {
+			// Partition table.
+			// TODO: Show the ListView on a separate row?
+			auto partitions = new std::vector<std::vector<string> >();
+			partitions->reserve(8);
+
+			// Process the partition table.
+			for (unsigned int i = 0; i < 8; i++) {
+				const uint32_t length = le32_to_cpu(ncsd_header->partitions[i].length);
+				if (length == 0)
+					continue;
+
+				// Make sure the partition exists first.
+				NCCHReader *pNcch = nullptr;
+				int ret = d->loadNCCH(i, &pNcch);
+				if (ret == -ENOENT)
+					continue;
+
+				const int vidx = (int)partitions->size();
+				partitions->resize(vidx+1);
+				auto &data_row = partitions->at(vidx);
+
+				// Partition number.
+				data_row.push_back(rp_sprintf("%u", i));
+
+				// Partition type.
+				// TODO: Use the partition ID to determine the type?
+				const char *type = (pt_types[i] ? pt_types[i] : s_unknown);
+				data_row.push_back(type);
+
+				if (!emmc) {
+					const N3DS_NCCH_Header_NoSig_t *const part_ncch_header =
+						(pNcch && pNcch->isOpen() ? pNcch->ncchHeader() : nullptr);
+					if (part_ncch_header) {
+						// Encryption.
+						NCCHReader::CryptoType cryptoType = {nullptr, false, 0, false};
+						int ret = NCCHReader::cryptoType_static(&cryptoType, part_ncch_header);
+						if (ret != 0 || !cryptoType.encrypted || cryptoType.keyslot >= 0x40) {
+							// Not encrypted, or not using a predefined keyslot.
+							if (cryptoType.name) {
+								data_row.push_back(latin1_to_utf8(cryptoType.name, -1));
+							} else {
+								data_row.push_back(s_unknown);
+							}
 						} else {
-							data_row.push_back(s_unknown);
+							data_row.push_back(rp_sprintf("%s %s (0x%02X)",
+								(cryptoType.name ? cryptoType.name : s_unknown),
+								(cryptoType.seed ? "+Seed" : ""),
+								cryptoType.keyslot));
 						}
-					} else {
-						data_row.push_back(rp_sprintf("%s %s (0x%02X)",
-							(cryptoType.name ? cryptoType.name : s_unknown),
-							(cryptoType.seed ? "+Seed" : ""),
-							cryptoType.keyslot));
-					}
 
-					// Version.
-					// Reference: https://3dbrew.org/wiki/Titles
-					bool isUpdate;
-					uint16_t version;
-					if (i >= 6) {
-						// System Update versions are in the partition ID.
-						// TODO: Update region.
-						isUpdate = true;
-						version = le16_to_cpu(part_ncch_header->sysversion);
-					} else {
-						// Use the NCCH version.
-						// NOTE: This doesn't seem to be accurate...
-						isUpdate = false;
-						version = le16_to_cpu(part_ncch_header->version);
-					}
+						// Version.
+						// Reference: https://3dbrew.org/wiki/Titles
+						bool isUpdate;
+						uint16_t version;
+						if (i >= 6) {
+							// System Update versions are in the partition ID.
+							// TODO: Update region.
+							isUpdate = true;
+							version = le16_to_cpu(part_ncch_header->sysversion);
+						} else {
+							// Use the NCCH version.
+							// NOTE: This doesn't seem to be accurate...
+							isUpdate = false;
+							version = le16_to_cpu(part_ncch_header->version);
+						}
 
-					if (isUpdate && version == 0x8000) {
-						// Early titles have a system update with version 0x8000 (32.0.0).
-						// This is usually 1.1.0, though some might be 1.0.0.
-						data_row.push_back("1.x.x");
+						if (isUpdate && version == 0x8000) {
+							// Early titles have a system update with version 0x8000 (32.0.0).
+							// This is usually 1.1.0, though some might be 1.0.0.
+							data_row.push_back("1.x.x");
+						} else {
+							data_row.push_back(d->n3dsVersionToString(version));
+						}
 					} else {
-						data_row.push_back(d->n3dsVersionToString(version));
+						// Unable to load the NCCH header.
+						data_row.push_back(s_unknown);	// Encryption
+						data_row.push_back(s_unknown);	// Version
 					}
-				} else {
-					// Unable to load the NCCH header.
-					data_row.push_back(s_unknown);	// Encryption
-					data_row.push_back(s_unknown);	// Version
 				}
-			}
 
-			if (keyslots) {
-				// Keyslot.
-				data_row.push_back(rp_sprintf("0x%02X", keyslots[i]));
-			}
+				if (keyslots) {
+					// Keyslot.
+					data_row.push_back(rp_sprintf("0x%02X", keyslots[i]));
+				}
 
-			// Partition size.
-			const int64_t length_bytes = (int64_t)length << d->media_unit_shift;
-			data_row.push_back(d->formatFileSize(length_bytes));
+				// Partition size.
+				const int64_t length_bytes = (int64_t)length << d->media_unit_shift;
+				data_row.push_back(d->formatFileSize(length_bytes));
 
-			delete pNcch;
-		}
+				delete pNcch;
+			}
 
-		// Add the partitions list data.
-		d->fields->addField_listData(C_("Nintendo3DS", "Partitions"),
-			v_partitions_names, partitions);
+			// Add the partitions list data.
+			d->fields->addField_listData(C_("Nintendo3DS", "Partitions"),
+				v_partitions_names, partitions);
+		} else {
+			delete v_partitions_names;
+		}
 	}
 
 	// Is the TMD header loaded?
@@ -2185,7 +2247,9 @@ int Nintendo3DS::loadFieldData(void)
 			d->fields->addTab("CIA");
 			// Add the title ID and product code fields here.
 			// (Content type is listed in the CIA contents table.)
-			d->addTitleIdAndProductCodeFields(false);
+			if (fieldGroups & FG_IDENTITY) {
+				d->addTitleIdAndProductCodeFields(false);
+			}
 		} else {
 			d->fields->setTabName(0, "CIA");
 		}
@@ -2193,184 +2257,189 @@ int Nintendo3DS::loadFieldData(void)
 		// TODO: Add more fields?
 		const N3DS_TMD_Header_t *const tmd_header = &d->mxh.tmd_header;
 
-		// TODO: Required system version?
-
-		// Version.
-		const uint16_t version = be16_to_cpu(tmd_header->title_version);
-		d->fields->addField_string(C_("Nintendo3DS", "Version"), d->n3dsVersionToString(version));
-
-		// Issuer.
-		// NOTE: We're using the Ticket Issuer in the TMD tab.
-		// Retail Ticket will always have a Retail TMD,
-		// but the issuer is technically different.
-		// We're only printing "Ticket Issuer" if we can't
-		// identify the issuer at all.
-		const char *issuer;
-		if (!strncmp(d->mxh.ticket.issuer, N3DS_TICKET_ISSUER_RETAIL, sizeof(d->mxh.ticket.issuer))) {
-			// Retail issuer..
-			issuer = C_("Nintendo3DS", "Retail");
-		} else if (!strncmp(d->mxh.ticket.issuer, N3DS_TICKET_ISSUER_DEBUG, sizeof(d->mxh.ticket.issuer))) {
-			// Debug issuer.
-			issuer = C_("Nintendo3DS", "Debug");
-		} else {
-			// Unknown issuer.
-			issuer = nullptr;
-		}
+		if (fieldGroups & FG_IDENTITY) {
+			// TODO: Required system version?
+
+			// Version.
+			const uint16_t version = be16_to_cpu(tmd_header->title_version);
+			d->fields->addField_string(C_("Nintendo3DS", "Version"), d->n3dsVersionToString(version));
+
+			// Issuer.
+			// NOTE: We're using the Ticket Issuer in the TMD tab.
+			// Retail Ticket will always have a Retail TMD,
+			// but the issuer is technically different.
+			// We're only printing "Ticket Issuer" if we can't
+			// identify the issuer at all.
+			const char *issuer;
+			if (!strncmp(d->mxh.ticket.issuer, N3DS_TICKET_ISSUER_RETAIL, sizeof(d->mxh.ticket.issuer))) {
+				// Retail issuer..
+				issuer = C_("Nintendo3DS", "Retail");
+			} else if (!strncmp(d->mxh.ticket.issuer, N3DS_TICKET_ISSUER_DEBUG, sizeof(d->mxh.ticket.issuer))) {
+				// Debug issuer.
+				issuer = C_("Nintendo3DS", "Debug");
+			} else {
+				// Unknown issuer.
+				issuer = nullptr;
+			}
 
-		if (issuer) {
-			d->fields->addField_string(C_("Nintendo3DS", "Issuer"), issuer);
-		} else {
-			// Print the ticket issuer as-is.
-			d->fields->addField_string(C_("Nintendo3DS", "Ticket Issuer"),
-				latin1_to_utf8(d->mxh.ticket.issuer, sizeof(d->mxh.ticket.issuer)));
-		}
+			if (issuer) {
+				d->fields->addField_string(C_("Nintendo3DS", "Issuer"), issuer);
+			} else {
+				// Print the ticket issuer as-is.
+				d->fields->addField_string(C_("Nintendo3DS", "Ticket Issuer"),
+					latin1_to_utf8(d->mxh.ticket.issuer, sizeof(d->mxh.ticket.issuer)));
+			}
 
-		// Demo use limit.
-		if (d->mxh.ticket.limits[0] == cpu_to_be32(4)) {
-			// Title has use limits.
-			d->fields->addField_string_numeric(C_("Nintendo3DS", "Demo Use Limit"),
-				be32_to_cpu(d->mxh.ticket.limits[1]));
+			// Demo use limit.
+			if (d->mxh.ticket.limits[0] == cpu_to_be32(4)) {
+				// Title has use limits.
+				d->fields->addField_string_numeric(C_("Nintendo3DS", "Demo Use Limit"),
+					be32_to_cpu(d->mxh.ticket.limits[1]));
+			}
 		}
 
-		// Contents table.
-		// TODO: Show the ListView on a separate row?
-		auto contents = new std::vector<std::vector<string> >();
-		contents->reserve(d->content_count);
-
-		// Process the contents.
-		// TODO: Content types?
-		const N3DS_Content_Chunk_Record_t *content_chunk = &d->content_chunks[0];
-		for (unsigned int i = 0; i < d->content_count; i++, content_chunk++) {
-			// Make sure the content exists first.
-			NCCHReader *pNcch = nullptr;
-			int ret = d->loadNCCH(i, &pNcch);
-			if (ret == -ENOENT)
-				continue;
-
-			const int vidx = (int)contents->size();
-			contents->resize(vidx+1);
-			auto &data_row = contents->at(vidx);
-
-			// Content index.
-			data_row.push_back(rp_sprintf("%u", i));
-
-			// TODO: Use content_chunk->index?
-			const N3DS_NCCH_Header_NoSig_t *content_ncch_header = nullptr;
-			const char *noncch_cnt_type = nullptr;
-			if (pNcch) {
-				if (pNcch->isOpen()) {
-					content_ncch_header = pNcch->ncchHeader();
-				} else {
-					// This might be a non-NCCH content that
-					// we still recognize.
-					noncch_cnt_type = pNcch->contentType();
-				}
-			}
-			if (!content_ncch_header) {
-				// Invalid content index, or this content isn't an NCCH.
-				// TODO: Are there CIAs with discontiguous content indexes?
-				// (Themes, DLC...)
-				const char *crypto = nullptr;
-				if (content_chunk->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
-					// CIA encryption.
-					crypto = "CIA";
+		if (fieldGroups & FG_CONTENTS) {
+			// Contents table.
+			// TODO: Show the ListView on a separate row?
+			auto contents = new std::vector<std::vector<string> >();
+			contents->reserve(d->content_count);
+
+			// Process the contents.
+			// TODO: Content types?
+			const N3DS_Content_Chunk_Record_t *content_chunk = &d->content_chunks[0];
+			for (unsigned int i = 0; i < d->content_count; i++, content_chunk++) {
+				// Make sure the content exists first.
+				NCCHReader *pNcch = nullptr;
+				int ret = d->loadNCCH(i, &pNcch);
+				if (ret == -ENOENT)
+					continue;
+
+				const int vidx = (int)contents->size();
+				contents->resize(vidx+1);
+				auto &data_row = contents->at(vidx);
+
+				// Content index.
+				data_row.push_back(rp_sprintf("%u", i));
+
+				// TODO: Use content_chunk->index?
+				const N3DS_NCCH_Header_NoSig_t *content_ncch_header = nullptr;
+				const char *noncch_cnt_type = nullptr;
+				if (pNcch) {
+					if (pNcch->isOpen()) {
+						content_ncch_header = pNcch->ncchHeader();
+					} else {
+						// This might be a non-NCCH content that
+						// we still recognize.
+						noncch_cnt_type = pNcch->contentType();
+					}
 				}
-
-				if (i == 0 && d->srlData) {
-					// This is an SRL.
-					if (!noncch_cnt_type) {
-						noncch_cnt_type = "SRL";
+				if (!content_ncch_header) {
+					// Invalid content index, or this content isn't an NCCH.
+					// TODO: Are there CIAs with discontiguous content indexes?
+					// (Themes, DLC...)
+					const char *crypto = nullptr;
+					if (content_chunk->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED)) {
+						// CIA encryption.
+						crypto = "CIA";
 					}
-					// TODO: Do SRLs have encryption besides CIA encryption?
-					if (!crypto) {
-						crypto = "NoCrypto";
+
+					if (i == 0 && d->srlData) {
+						// This is an SRL.
+						if (!noncch_cnt_type) {
+							noncch_cnt_type = "SRL";
+						}
+						// TODO: Do SRLs have encryption besides CIA encryption?
+						if (!crypto) {
+							crypto = "NoCrypto";
+						}
+					} else {
+						// Something else...
+						if (!noncch_cnt_type) {
+							noncch_cnt_type = s_unknown;
+						}
 					}
-				} else {
-					// Something else...
-					if (!noncch_cnt_type) {
-						noncch_cnt_type = s_unknown;
+					data_row.push_back(noncch_cnt_type);
+
+					// Encryption.
+					data_row.push_back(crypto ? crypto : s_unknown);
+					// Version.
+					data_row.push_back("");
+
+					// Content size.
+					if (i < d->content_count) {
+						data_row.push_back(d->formatFileSize(be64_to_cpu(content_chunk->size)));
+					} else {
+						data_row.push_back("");
 					}
+					delete pNcch;
+					continue;
 				}
-				data_row.push_back(noncch_cnt_type);
 
-				// Encryption.
-				data_row.push_back(crypto ? crypto : s_unknown);
-				// Version.
-				data_row.push_back("");
+				// Content type.
+				const char *content_type = pNcch->contentType();
+				data_row.push_back(content_type ? content_type : s_unknown);
 
-				// Content size.
-				if (i < d->content_count) {
-					data_row.push_back(d->formatFileSize(be64_to_cpu(content_chunk->size)));
-				} else {
-					data_row.push_back("");
+				// Encryption.
+				NCCHReader::CryptoType cryptoType;
+				bool isCIAcrypto = !!(content_chunk->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED));
+				ret = NCCHReader::cryptoType_static(&cryptoType, content_ncch_header);
+				if (ret != 0) {
+					// Unknown encryption.
+					cryptoType.name = nullptr;
+					cryptoType.encrypted = false;
+				}
+				if (!cryptoType.name && isCIAcrypto) {
+					// Prevent "CIA+Unknown".
+					cryptoType.name = "CIA";
+					cryptoType.encrypted = false;
+					isCIAcrypto = false;
 				}
-				delete pNcch;
-				continue;
-			}
-
-			// Content type.
-			const char *content_type = pNcch->contentType();
-			data_row.push_back(content_type ? content_type : s_unknown);
-
-			// Encryption.
-			NCCHReader::CryptoType cryptoType;
-			bool isCIAcrypto = !!(content_chunk->type & cpu_to_be16(N3DS_CONTENT_CHUNK_ENCRYPTED));
-			ret = NCCHReader::cryptoType_static(&cryptoType, content_ncch_header);
-			if (ret != 0) {
-				// Unknown encryption.
-				cryptoType.name = nullptr;
-				cryptoType.encrypted = false;
-			}
-			if (!cryptoType.name && isCIAcrypto) {
-				// Prevent "CIA+Unknown".
-				cryptoType.name = "CIA";
-				cryptoType.encrypted = false;
-				isCIAcrypto = false;
-			}
 
-			if (!cryptoType.encrypted || cryptoType.keyslot >= 0x40) {
-				// Not encrypted, or not using a predefined keyslot.
-				if (cryptoType.name) {
-					data_row.push_back(latin1_to_utf8(cryptoType.name, -1));
+				if (!cryptoType.encrypted || cryptoType.keyslot >= 0x40) {
+					// Not encrypted, or not using a predefined keyslot.
+					if (cryptoType.name) {
+						data_row.push_back(latin1_to_utf8(cryptoType.name, -1));
+					} else {
+						data_row.push_back(s_unknown);
+					}
 				} else {
-					data_row.push_back(s_unknown);
+					// Encrypted.
+					data_row.push_back(rp_sprintf("%s%s%s (0x%02X)",
+						(isCIAcrypto ? "CIA+" : ""),
+						(cryptoType.name ? cryptoType.name : s_unknown),
+						(cryptoType.seed ? "+Seed" : ""),
+						cryptoType.keyslot));
 				}
-			} else {
-				// Encrypted.
-				data_row.push_back(rp_sprintf("%s%s%s (0x%02X)",
-					(isCIAcrypto ? "CIA+" : ""),
-					(cryptoType.name ? cryptoType.name : s_unknown),
-					(cryptoType.seed ? "+Seed" : ""),
-					cryptoType.keyslot));
-			}
 
-			// Version. [FIXME: Might not be right...]
-			const uint16_t version = le16_to_cpu(content_ncch_header->version);
-			data_row.push_back(d->n3dsVersionToString(version));
+				// Version. [FIXME: Might not be right...]
+				const uint16_t version = le16_to_cpu(content_ncch_header->version);
+				data_row.push_back(d->n3dsVersionToString(version));
 
-			// Content size.
-			data_row.push_back(d->formatFileSize(pNcch->partition_size()));
+				// Content size.
+				data_row.push_back(d->formatFileSize(pNcch->partition_size()));
 
-			delete pNcch;
-		}
+				delete pNcch;
+			}
 
-		// Add the contents table.
-		static const char *const contents_names[] = {
-			NOP_C_("Nintendo3DS|CtNames", "#"),
-			NOP_C_("Nintendo3DS|CtNames", "Type"),
-			NOP_C_("Nintendo3DS|CtNames", "Encryption"),
-			NOP_C_("Nintendo3DS|CtNames", "Version"),
-			NOP_C_("Nintendo3DS|CtNames", "Size"),
-		};
-		vector<string> *const v_contents_names = RomFields::strArrayToVector_i18n(
-			"Nintendo3DS|CtNames", contents_names, ARRAY_SIZE(contents_names));
-		d->fields->addField_listData(C_("Nintendo3DS", "Contents"), v_contents_names, contents);
+			// Add the contents table.
+			static const char *const contents_names[] = {
+				NOP_C_("Nintendo3DS|CtNames", "#"),
+				NOP_C_("Nintendo3DS|CtNames", "Type"),
+				NOP_C_("Nintendo3DS|CtNames", "Encryption"),
+				NOP_C_("Nintendo3DS|CtNames", "Version"),
+				NOP_C_("Nintendo3DS|CtNames", "Size"),
+			};
+			vector<string> *const v_contents_names = RomFields::strArrayToVector_i18n(
+				"Nintendo3DS|CtNames", contents_names, ARRAY_SIZE(contents_names));
+			d->fields->addField_listData(C_("Nintendo3DS", "Contents"), v_contents_names, contents);
+		}
 	}
 
 	// Get the NCCH Extended Header.
 	const N3DS_NCCH_ExHeader_t *const ncch_exheader =
-		(ncch && ncch->isOpen() ? ncch->ncchExHeader() : nullptr);
-	if (ncch_exheader) {
+		((fieldGroups & (FG_DETAILS | FG_PERMISSIONS)) && ncch && ncch->isOpen()
+			? ncch->ncchExHeader() : nullptr);
+	if (ncch_exheader && (fieldGroups & FG_DETAILS)) {
 		// Display the NCCH Extended Header.
 		// TODO: Add more fields?
 		d->fields->addTab("ExHeader");
@@ -2463,7 +2532,9 @@ int Nintendo3DS::loadFieldData(void)
 		// TODO: Ideal CPU and affinity mask.
 		// TODO: core_version is probably specified for e.g. AGB.
 		// Indicate that somehow.
+	}
 
+	if (ncch_exheader && (fieldGroups & FG_PERMISSIONS)) {
 		// Permissions. These are technically part of the
 		// ExHeader, but we're using a separate tab because
 		// there's a lot of them.
@@ -81,6 +81,14 @@ class Nintendo3DS : public LibRpBase::RomData
 		 */
 		virtual int isRomSupported(const DetectInfo *info) const override final;
 
+		/**
+		 * Get the general file type for a class-specific system ID.
+		 * This does not require constructing the RomData object.
+		 * @param romType Class-specific system ID from isRomSupported_static().
+		 * @return General file type.
+		 */
+		static FileType fileType_static(int romType);
+
 		/**
 		 * Get the name of the system the loaded ROM is designed for.
 		 * @param type System name type. (See the SystemName enum.)
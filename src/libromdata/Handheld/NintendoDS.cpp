@@ -123,6 +123,13 @@ class NintendoDSPrivate : public RomDataPrivate
 		 */
 		int loadIconTitleData(void);
 
+		/**
+		 * Validate the icon/title data after it's been read.
+		 * @param size Number of bytes read into nds_icon_title.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int validateIconTitleData(size_t size);
+
 		/**
 		 * Load the ROM image's icon.
 		 * @return Icon, or nullptr on error.
@@ -145,15 +152,17 @@ class NintendoDSPrivate : public RomDataPrivate
 		 * SDK puts unknown pseudo-random data here, so DSiWare and
 		 * Wii U VC SRLs will have non-zero data here.
 		 *
+		 * @param blank_area Data from $1000-$3FFF, or nullptr if it couldn't be read.
 		 * @return True if the mask ROM area has non-zero data; false if not.
 		 */
-		bool checkNDSMaskROMArea(void);
+		bool checkNDSMaskROMArea(const uintptr_t *blank_area);
 
 		/**
 		 * Check the NDS Secure Area type.
+		 * @param secure_area First 16 bytes of the Secure Area, or nullptr if it couldn't be read.
 		 * @return Secure area type.
 		 */
-		const char *checkNDSSecureArea(void);
+		const char *checkNDSSecureArea(const uint32_t *secure_area);
 
 		/**
 		 * Convert a Nintendo DS(i) region value to a GameTDB region code.
@@ -214,7 +223,16 @@ int NintendoDSPrivate::loadIconTitleData(void)
 
 	// Read the icon/title data.
 	size_t size = this->file->seekAndRead(icon_offset, &nds_icon_title, sizeof(nds_icon_title));
+	return validateIconTitleData(size);
+}
 
+/**
+ * Validate the icon/title data after it's been read.
+ * @param size Number of bytes read into nds_icon_title.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int NintendoDSPrivate::validateIconTitleData(size_t size)
+{
 	// Make sure we have the correct size based on the version.
 	if (size < sizeof(nds_icon_title.version)) {
 		// Couldn't even load the version number...
@@ -409,22 +427,21 @@ int NintendoDSPrivate::getTitleIndex(void) const
  * SDK puts unknown pseudo-random data here, so DSiWare and
  * Wii U VC SRLs will have non-zero data here.
  *
+ * @param blank_area Data from $1000-$3FFF, or nullptr if it couldn't be read.
  * @return True if the mask ROM area has non-zero data; false if not.
  */
-bool NintendoDSPrivate::checkNDSMaskROMArea(void)
+bool NintendoDSPrivate::checkNDSMaskROMArea(const uintptr_t *blank_area)
 {
 	// Make sure 0x1000-0x3FFF is blank.
 	// NOTE: ndstool checks 0x0200-0x0FFF, but this may
 	// contain extra data for DSi-enhanced ROMs, or even
 	// for regular DS games released after the DSi.
-	uintptr_t blank_area[0x3000/sizeof(uintptr_t)];
-	size_t size = file->seekAndRead(0x1000, blank_area, sizeof(blank_area));
-	if (size != sizeof(blank_area)) {
+	if (!blank_area) {
 		// Seek and/or read error.
 		return false;
 	}
 
-	const uintptr_t *const end = &blank_area[ARRAY_SIZE(blank_area)-1];
+	const uintptr_t *const end = &blank_area[0x3000/sizeof(uintptr_t)-1];
 	for (const uintptr_t *p = blank_area; p < end; p += 2) {
 		if (p[0] != 0 || p[1] != 0) {
 			// Not zero. This isn't a dumped ROM.
@@ -438,17 +455,12 @@ bool NintendoDSPrivate::checkNDSMaskROMArea(void)
 
 /**
  * Check the NDS Secure Area type.
+ * @param secure_area First 16 bytes of the Secure Area, or nullptr if it couldn't be read.
  * @return Secure area type, or nullptr if unknown.
  */
-const char *NintendoDSPrivate::checkNDSSecureArea(void)
+const char *NintendoDSPrivate::checkNDSSecureArea(const uint32_t *secure_area)
 {
-	// Read the start of the Secure Area.
-	// NOTE: We only need to check the first two DWORDs, but
-	// we're reading the first four because CIAReader only
-	// supports multiples of 16 bytes right now.
-	uint32_t secure_area[4];
-	size_t size = file->seekAndRead(0x4000, secure_area, sizeof(secure_area));
-	if (size != sizeof(secure_area)) {
+	if (!secure_area) {
 		// Seek and/or read error.
 		return nullptr;
 	}
@@ -1034,6 +1046,24 @@ int NintendoDS::loadFieldData(void)
 		return -EIO;
 	}
 
+	// Read the icon/title data, the Mask ROM area, and the
+	// start of the Secure Area in a single batch.
+	// NOTE: For the Secure Area, we only need to check the
+	// first two DWORDs, but we're reading the first four
+	// because CIAReader only supports multiples of 16 bytes.
+	uintptr_t blank_area[0x3000/sizeof(uintptr_t)];
+	uint32_t secure_area[4];
+	IRpFile::ReadRequest reqs[3] = {
+		{0x1000, blank_area, sizeof(blank_area), 0},
+		{0x4000, secure_area, sizeof(secure_area), 0},
+		{le32_to_cpu(d->romHeader.icon_offset), &d->nds_icon_title, sizeof(d->nds_icon_title), 0},
+	};
+	const unsigned int reqCount = (d->nds_icon_title_loaded ? 2 : 3);
+	d->file->readv(reqs, reqCount);
+	if (reqCount == 3) {
+		d->validateIconTitleData(reqs[2].ret);
+	}
+
 	// Nintendo DS ROM header.
 	const NDS_RomHeader *const romHeader = &d->romHeader;
 	d->fields->reserve(13);	// Maximum of 13 fields.
@@ -1097,13 +1127,14 @@ int NintendoDS::loadFieldData(void)
 	// Is this a Mask ROM?
 	// TODO: Better way to represent a boolean.
 	d->fields->addField_string(C_("NintendoDS", "Mask ROM"),
-		d->checkNDSMaskROMArea() ? "Yes" : "No");
+		d->checkNDSMaskROMArea(reqs[0].ret == sizeof(blank_area) ? blank_area : nullptr) ? "Yes" : "No");
 
 	// Secure Area.
 	// TODO: Verify the CRC.
-	const char *secure_area = d->checkNDSSecureArea();
-	if (secure_area) {
-		d->fields->addField_string(C_("NintendoDS", "Secure Area"), secure_area);
+	const char *secType = d->checkNDSSecureArea(
+		reqs[1].ret == sizeof(secure_area) ? secure_area : nullptr);
+	if (secType) {
+		d->fields->addField_string(C_("NintendoDS", "Secure Area"), secType);
 	} else {
 		d->fields->addField_string(C_("NintendoDS", "Secure Area"), C_("NintendoDS", "Unknown"));
 	}
@@ -25,15 +25,24 @@
 
 // librpbase
 #include "librpbase/common.h"
+#include "librpbase/byteswap.h"
 #include "librpbase/RomData.hpp"
 #include "librpbase/TextFuncs.hpp"
 #include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/RpMmapFile.hpp"
 #include "librpbase/file/FileSystem.hpp"
 #include "librpbase/file/RelatedFile.hpp"
+#include "librpbase/threads/Atomics.h"
+#include "librpbase/threads/pthread_once.h"
+#include "librpbase/threads/Mutex.hpp"
+#include "librpbase/threads/Thread.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
 using namespace LibRpBase;
 
 // C includes. (C++ namespace)
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 
 // C++ includes.
 #include <string>
@@ -87,6 +96,9 @@ using std::vector;
 // Special case for Dreamcast save files.
 #include "Console/dc_structs.h"
 
+// Magic numbers for the dispatch index.
+#include "Console/gcn_structs.h"
+
 namespace LibRomData {
 
 class RomDataFactoryPrivate
@@ -108,10 +120,21 @@ class RomDataFactoryPrivate
 		typedef std::function<RomData*(IRpFile*)> pFnNewRomData;
 #endif
 
+		typedef RomData::FileType (*pFnFileType)(int romType);
+
 		struct RomDataFns {
 			pFnIsRomSupported isRomSupported;
 			pFnNewRomData newRomData;
 			pFnSupportedFileExtensions supportedFileExtensions;
+
+			// Identification information for identify().
+			// If fileType_static is set, it's used to determine
+			// the file type from the class-specific system ID.
+			pFnFileType fileType_static;
+			const char *className;
+			const char *systemName;
+			RomData::FileType fileType;
+
 			bool hasThumbnail;
 
 			// Extra fields for files whose headers
@@ -122,15 +145,23 @@ class RomDataFactoryPrivate
 
 // MSVC 2010 complains if we don't specify the full namespace
 // for the RomData subclass in the lambda expression.
-#define GetRomDataFns(sys, hasThumbnail) \
+#define GetRomDataFns(sys, hasThumbnail, fileType, systemName) \
 	{sys::isRomSupported_static, \
 	 [](IRpFile *file) -> RomData* { return new ::LibRomData::sys(file); }, \
 	 sys::supportedFileExtensions_static, \
+	 nullptr, #sys, systemName, RomData::fileType, \
 	 hasThumbnail, 0, 0}
-#define GetRomDataFns_addr(sys, hasThumbnail, address, size) \
+#define GetRomDataFns_ftype(sys, hasThumbnail, systemName) \
 	{sys::isRomSupported_static, \
 	 [](IRpFile *file) -> RomData* { return new ::LibRomData::sys(file); }, \
 	 sys::supportedFileExtensions_static, \
+	 sys::fileType_static, #sys, systemName, RomData::FTYPE_UNKNOWN, \
+	 hasThumbnail, 0, 0}
+#define GetRomDataFns_addr(sys, hasThumbnail, fileType, systemName, address, size) \
+	{sys::isRomSupported_static, \
+	 [](IRpFile *file) -> RomData* { return new ::LibRomData::sys(file); }, \
+	 sys::supportedFileExtensions_static, \
+	 nullptr, #sys, systemName, RomData::fileType, \
 	 hasThumbnail, address, size}
 
 		// RomData subclasses that use a header.
@@ -141,64 +172,323 @@ class RomDataFactoryPrivate
 		// RomData subclasses that use a footer.
 		static const RomDataFns romDataFns_footer[];
 
+		/**
+		 * Magic number dispatch index entry.
+		 *
+		 * If a RomData subclass has one or more entries in
+		 * romDataFns_magic[], its isRomSupported() function
+		 * will only be called if at least one of its magic
+		 * numbers or file extensions matches.
+		 *
+		 * RomData subclasses that don't have any entries
+		 * are always checked.
+		 */
+		struct RomDataMagic {
+			pFnIsRomSupported isRomSupported;
+			const char *ext;	// File extension. (If nullptr, use the magic number.)
+			uint32_t address;	// Address of the magic number.
+			uint32_t magic;		// Magic number. (host-endian value of big-endian data)
+			uint32_t mask;		// Mask to apply before comparing.
+		};
+
+#define RomDataMagic_mask(sys, address, magic, mask) \
+	{sys::isRomSupported_static, nullptr, address, magic, mask}
+#define RomDataMagic(sys, address, magic) \
+	RomDataMagic_mask(sys, address, magic, 0xFFFFFFFF)
+#define RomDataMagic_ext(sys, ext) \
+	{sys::isRomSupported_static, ext, 0, 0, 0}
+
+		// Magic numbers and file extensions for the
+		// dispatch index.
+		static const RomDataMagic romDataFns_magic[];
+
+		/**
+		 * Magic number dispatch index.
+		 * Initialized by initMagicIndex().
+		 *
+		 * Each bitfield has one bit per romDataFns_header[] entry.
+		 */
+		struct MagicPoint {
+			uint32_t address;
+			uint32_t mask;
+		};
+		static vector<MagicPoint> magicPoints;
+		static unordered_map<uint64_t, uint64_t> map_magic;
+		static uint64_t magicIndexed;	// romDataFns_header[] entries that are indexed.
+		static pthread_once_t once_magic;
+
+		/**
+		 * Initialize the magic number dispatch index.
+		 * Called by pthread_once().
+		 */
+		static void initMagicIndex(void);
+
+		/**
+		 * Look up the candidate RomData subclasses for a header.
+		 * @param info DetectInfo. (Header must be at address 0.)
+		 * @return Bitfield of romDataFns_header[] entries that should be checked.
+		 */
+		static uint64_t lookupMagic(const RomData::DetectInfo *info);
+
+		// Probe statistics.
+		static volatile int stats_lookups;
+		static volatile int stats_probes;
+		static volatile int stats_probesAvoided;
+
 		/**
 		 * Attempt to open the other file in a Dreamcast .VMI+.VMS pair.
 		 * @param file One opened file in the .VMI+.VMS pair.
 		 * @return DreamcastSave if valid; nullptr if not.
 		 */
 		static RomData *openDreamcastVMSandVMI(IRpFile *file);
+
+		// Size of the header buffer used for detection.
+		// 4,096+256 bytes should be enough to detect most systems.
+		static const unsigned int HEADER_SIZE = 4096+256;
+
+		/**
+		 * Read the header for a RomData subclass whose header
+		 * isn't located at the beginning of the file.
+		 * @param file	[in] ROM file.
+		 * @param fns	[in] RomDataFns.
+		 * @param info	[in,out] DetectInfo. (header.pData must have HEADER_SIZE bytes available)
+		 * @return 0 on success; 1 if this subclass should be skipped; -1 if no more subclasses should be checked.
+		 */
+		static int readHeaderAt(IRpFile *file, const RomDataFns *fns, RomData::DetectInfo *info);
 };
 
 /** RomDataFactoryPrivate **/
 
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_header[] = {
 	// Consoles
-	GetRomDataFns(Dreamcast, true),
-	GetRomDataFns(DreamcastSave, true),
-	GetRomDataFns(GameCube, true),
-	GetRomDataFns(GameCubeSave, true),
-	GetRomDataFns(MegaDrive, false),
-	GetRomDataFns(N64, false),
-	GetRomDataFns(NES, false),
-	GetRomDataFns(SNES, false),
-	GetRomDataFns(SegaSaturn, false),
-	GetRomDataFns(WiiU, true),
+	GetRomDataFns(Dreamcast, true, FTYPE_DISC_IMAGE, "Sega Dreamcast"),
+	GetRomDataFns(DreamcastSave, true, FTYPE_SAVE_FILE, "Sega Dreamcast"),
+	GetRomDataFns_ftype(GameCube, true, "Nintendo GameCube / Wii"),
+	GetRomDataFns(GameCubeSave, true, FTYPE_SAVE_FILE, "Nintendo GameCube"),
+	GetRomDataFns_ftype(MegaDrive, false, "Sega Mega Drive"),
+	GetRomDataFns(N64, false, FTYPE_ROM_IMAGE, "Nintendo 64"),
+	GetRomDataFns_ftype(NES, false, "Nintendo Entertainment System"),
+	GetRomDataFns(SNES, false, FTYPE_ROM_IMAGE, "Super Nintendo Entertainment System"),
+	GetRomDataFns(SegaSaturn, false, FTYPE_DISC_IMAGE, "Sega Saturn"),
+	GetRomDataFns(WiiU, true, FTYPE_DISC_IMAGE, "Nintendo Wii U"),
 
 	// Handhelds
-	GetRomDataFns(DMG, false),
-	GetRomDataFns(GameBoyAdvance, false),
-	GetRomDataFns(Lynx, false),
-	GetRomDataFns(Nintendo3DS, true),
-	GetRomDataFns(Nintendo3DSFirm, false),
-	GetRomDataFns(NintendoDS, true),
+	GetRomDataFns(DMG, false, FTYPE_ROM_IMAGE, "Nintendo Game Boy"),
+	GetRomDataFns(GameBoyAdvance, false, FTYPE_ROM_IMAGE, "Nintendo Game Boy Advance"),
+	GetRomDataFns(Lynx, false, FTYPE_ROM_IMAGE, "Atari Lynx"),
+	GetRomDataFns_ftype(Nintendo3DS, true, "Nintendo 3DS"),
+	GetRomDataFns(Nintendo3DSFirm, false, FTYPE_FIRMWARE_BINARY, "Nintendo 3DS"),
+	GetRomDataFns(NintendoDS, true, FTYPE_ROM_IMAGE, "Nintendo DS"),
 
 	// Textures
-	GetRomDataFns(DirectDrawSurface, true),
-	GetRomDataFns(KhronosKTX, true),
-	GetRomDataFns(SegaPVR, true),
-	GetRomDataFns(ValveVTF, true),
-	GetRomDataFns(ValveVTF3, true),
+	GetRomDataFns(DirectDrawSurface, true, FTYPE_TEXTURE_FILE, "DirectDraw Surface"),
+	GetRomDataFns(KhronosKTX, true, FTYPE_TEXTURE_FILE, "Khronos KTX Texture"),
+	GetRomDataFns(SegaPVR, true, FTYPE_TEXTURE_FILE, "Sega PVR"),
+	GetRomDataFns(ValveVTF, true, FTYPE_TEXTURE_FILE, "Valve VTF Texture"),
+	GetRomDataFns(ValveVTF3, true, FTYPE_TEXTURE_FILE, "Valve VTF3 Texture (PS3)"),
 
 	// Other
-	GetRomDataFns(Amiibo, true),
-	GetRomDataFns(NintendoBadge, true),
+	GetRomDataFns(Amiibo, true, FTYPE_NFC_DUMP, "Nintendo Figurine Platform"),
+	GetRomDataFns(NintendoBadge, true, FTYPE_TEXTURE_FILE, "Nintendo Badge Arcade"),
 
 	// The following formats have 16-bit magic numbers,
 	// so they should go at the end of the address=0 section.
-	GetRomDataFns(EXE, false),	// TODO: Thumbnailing on non-Windows platforms.
-	GetRomDataFns(PlayStationSave, true),
+	// TODO: EXE file type requires parsing the NE/PE headers.
+	GetRomDataFns(EXE, false, FTYPE_EXECUTABLE, "Microsoft Windows"),	// TODO: Thumbnailing on non-Windows platforms.
+	GetRomDataFns(PlayStationSave, true, FTYPE_SAVE_FILE, "Sony PlayStation"),
 
 	// Headers with non-zero addresses.
-	GetRomDataFns_addr(Sega8Bit, false, 0x7FE0, 0x20),
+	GetRomDataFns_addr(Sega8Bit, false, FTYPE_ROM_IMAGE, "Sega Master System", 0x7FE0, 0x20),
 
-	{nullptr, nullptr, nullptr, false, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, RomData::FTYPE_UNKNOWN, false, 0, 0}
 };
 
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_footer[] = {
-	GetRomDataFns(VirtualBoy, false),
-	{nullptr, nullptr, nullptr, false, 0, 0}
+	GetRomDataFns(VirtualBoy, false, FTYPE_ROM_IMAGE, "Nintendo Virtual Boy"),
+	{nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, RomData::FTYPE_UNKNOWN, false, 0, 0}
+};
+
+// NOTE: Magic numbers are read from the header as big-endian,
+// so e.g. "SEGA" is 0x53454741 regardless of the file format's
+// own byte order.
+const RomDataFactoryPrivate::RomDataMagic RomDataFactoryPrivate::romDataFns_magic[] = {
+	// Consoles
+	RomDataMagic_ext(Dreamcast, ".gdi"),
+	RomDataMagic(Dreamcast, 0x0008, 'AKAT'),	// "SEGA SEGAKATANA " (2048)
+	RomDataMagic(Dreamcast, 0x0018, 'AKAT'),	// "SEGA SEGAKATANA " (2352)
+
+	RomDataMagic(GameCube, 0x0018, WII_MAGIC),
+	RomDataMagic(GameCube, 0x001C, GCN_MAGIC),
+	RomDataMagic(GameCube, 0x0000, TGC_MAGIC),
+	RomDataMagic(GameCube, 0x0000, 'WBFS'),
+	RomDataMagic(GameCube, 0x0000, 'CISO'),
+	RomDataMagic(GameCube, 0x0000, 0x01C00BB1),	// GCZ (le32)
+	RomDataMagic(GameCube, 0x0000, 'WIA\x01'),
+	RomDataMagic(GameCube, 0x0000, 0x30300045),	// NDDEMO
+
+	RomDataMagic(MegaDrive, 0x0008, 'SYST'),	// "SEGADISCSYSTEM  " (2048)
+	RomDataMagic(MegaDrive, 0x0018, 'SYST'),	// "SEGADISCSYSTEM  " (2352)
+	RomDataMagic(MegaDrive, 0x0100, 'SEGA'),
+	RomDataMagic(MegaDrive, 0x0101, 'SEGA'),
+	RomDataMagic_mask(MegaDrive, 0x0008, 0xAABB0000, 0xFFFF0000),	// SMD
+
+	RomDataMagic(N64, 0x0000, 0x80371240),	// Z64
+	RomDataMagic(N64, 0x0000, 0x37804012),	// V64
+	RomDataMagic(N64, 0x0000, 0x12408037),	// swap2
+	RomDataMagic(N64, 0x0000, 0x40123780),	// le32
+
+	RomDataMagic_mask(NES, 0x0000, 'NES\x00', 0xFFFFFF00),	// iNES
+	RomDataMagic(NES, 0x0000, 'TNES'),
+	RomDataMagic(NES, 0x0000, 'FDS\x1A'),
+	RomDataMagic(NES, 0x0001, '*NIN'),	// FDS without fwNES header
+
+	RomDataMagic(SegaSaturn, 0x0008, 'ASAT'),	// "SEGA SEGASATURN " (2048)
+	RomDataMagic(SegaSaturn, 0x0018, 'ASAT'),	// "SEGA SEGASATURN " (2352)
+	RomDataMagic(WiiU, 0x0000, 'WUP-'),
+
+	// Handhelds
+	RomDataMagic(DMG, 0x0104, 0xCEED6666),
+	RomDataMagic(Lynx, 0x0000, 'LYNX'),
+	RomDataMagic_ext(Nintendo3DS, ".cia"),
+	RomDataMagic(Nintendo3DS, 0x0000, 'SMDH'),
+	RomDataMagic(Nintendo3DS, 0x0000, '3DSX'),
+	RomDataMagic(Nintendo3DS, 0x0100, 'NCSD'),
+	RomDataMagic(Nintendo3DS, 0x0100, 'NCCH'),
+	RomDataMagic(Nintendo3DSFirm, 0x0000, 'FIRM'),
+	RomDataMagic(NintendoDS, 0x00C0, 0x24FFAE51),	// Nintendo logo
+	RomDataMagic(NintendoDS, 0x00C0, 0xC8604FE2),	// Slot-2 logo
+
+	// Textures
+	RomDataMagic(DirectDrawSurface, 0x0000, 'DDS '),
+	RomDataMagic(KhronosKTX, 0x0000, 0xAB4B5458),	// "\xABKTX"
+	RomDataMagic(SegaPVR, 0x0000, 'GBIX'),
+	RomDataMagic(SegaPVR, 0x0000, 'GCIX'),
+	RomDataMagic(SegaPVR, 0x0000, 'PVRT'),
+	RomDataMagic(SegaPVR, 0x0000, 'GVRT'),
+	RomDataMagic(SegaPVR, 0x0000, 'PVRX'),
+	RomDataMagic(ValveVTF, 0x0000, 'VTF\x00'),
+	RomDataMagic(ValveVTF3, 0x0000, 'VTF3'),
+
+	// Other
+	RomDataMagic(NintendoBadge, 0x0000, 'PRBS'),
+	RomDataMagic(NintendoBadge, 0x0000, 'CABS'),
+	RomDataMagic_mask(EXE, 0x0000, 'MZ\x00\x00', 0xFFFF0000),
+	RomDataMagic_mask(EXE, 0x0000, 'ZM\x00\x00', 0xFFFF0000),
+
+	{nullptr, nullptr, 0, 0, 0}
 };
 
+vector<RomDataFactoryPrivate::MagicPoint> RomDataFactoryPrivate::magicPoints;
+unordered_map<uint64_t, uint64_t> RomDataFactoryPrivate::map_magic;
+uint64_t RomDataFactoryPrivate::magicIndexed = 0;
+pthread_once_t RomDataFactoryPrivate::once_magic = PTHREAD_ONCE_INIT;
+
+volatile int RomDataFactoryPrivate::stats_lookups = 0;
+volatile int RomDataFactoryPrivate::stats_probes = 0;
+volatile int RomDataFactoryPrivate::stats_probesAvoided = 0;
+
+/**
+ * Initialize the magic number dispatch index.
+ * Called by pthread_once().
+ */
+void RomDataFactoryPrivate::initMagicIndex(void)
+{
+	// Each romDataFns_header[] entry gets one bit.
+	assert(ARRAY_SIZE(romDataFns_header)-1 <= 64);
+
+	for (const RomDataMagic *magic = &romDataFns_magic[0];
+	     magic->isRomSupported != nullptr; magic++)
+	{
+		// Find the romDataFns_header[] entry.
+		unsigned int idx = 0;
+		const RomDataFns *fns = &romDataFns_header[0];
+		for (; fns->supportedFileExtensions != nullptr; fns++, idx++) {
+			if (fns->isRomSupported == magic->isRomSupported)
+				break;
+		}
+		assert(fns->supportedFileExtensions != nullptr);
+		if (fns->supportedFileExtensions == nullptr || idx >= 64)
+			continue;
+		// Only headers at address 0 can be indexed.
+		assert(fns->address == 0);
+		if (fns->address != 0)
+			continue;
+		magicIndexed |= (1ULL << idx);
+
+		if (magic->ext) {
+			// File extensions are checked separately.
+			continue;
+		}
+
+		// Add the magic point if it isn't present already.
+		bool found = false;
+		for (auto iter = magicPoints.cbegin(); iter != magicPoints.cend(); ++iter) {
+			if (iter->address == magic->address && iter->mask == magic->mask) {
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			MagicPoint point;
+			point.address = magic->address;
+			point.mask = magic->mask;
+			magicPoints.push_back(point);
+		}
+
+		const uint64_t key = ((uint64_t)magic->address << 32) | (magic->magic & magic->mask);
+		map_magic[key] |= (1ULL << idx);
+	}
+}
+
+/**
+ * Look up the candidate RomData subclasses for a header.
+ * @param info DetectInfo. (Header must be at address 0.)
+ * @return Bitfield of romDataFns_header[] entries that should be checked.
+ */
+uint64_t RomDataFactoryPrivate::lookupMagic(const RomData::DetectInfo *info)
+{
+	assert(info->header.addr == 0);
+	pthread_once(&once_magic, initMagicIndex);
+
+	// Non-indexed subclasses are always checked.
+	uint64_t candidates = ~magicIndexed;
+
+	for (auto iter = magicPoints.cbegin(); iter != magicPoints.cend(); ++iter) {
+		if ((uint64_t)iter->address + sizeof(uint32_t) > info->header.size)
+			continue;
+
+		uint32_t data;
+		memcpy(&data, &info->header.pData[iter->address], sizeof(data));
+		const uint64_t key = ((uint64_t)iter->address << 32) | (be32_to_cpu(data) & iter->mask);
+		auto map_iter = map_magic.find(key);
+		if (map_iter != map_magic.end()) {
+			candidates |= map_iter->second;
+		}
+	}
+
+	if (info->ext != nullptr) {
+		// Check file extensions.
+		// NOTE: This list is short, so a linear search is fine.
+		for (const RomDataMagic *magic = &romDataFns_magic[0];
+		     magic->isRomSupported != nullptr; magic++)
+		{
+			if (!magic->ext || strcasecmp(info->ext, magic->ext) != 0)
+				continue;
+
+			unsigned int idx = 0;
+			const RomDataFns *fns = &romDataFns_header[0];
+			for (; fns->supportedFileExtensions != nullptr; fns++, idx++) {
+				if (fns->isRomSupported == magic->isRomSupported) {
+					candidates |= (1ULL << idx);
+					break;
+				}
+			}
+		}
+	}
+
+	return candidates;
+}
+
 /**
  * Attempt to open the other file in a Dreamcast .VMI+.VMS pair.
  * @param file One opened file in the .VMI+.VMS pair.
@@ -265,6 +555,59 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
 	return dcSave;
 }
 
+/**
+ * Read the header for a RomData subclass whose header
+ * isn't located at the beginning of the file.
+ * @param file	[in] ROM file.
+ * @param fns	[in] RomDataFns.
+ * @param info	[in,out] DetectInfo. (header.pData must have HEADER_SIZE bytes available)
+ * @return 0 on success; 1 if this subclass should be skipped; -1 if no more subclasses should be checked.
+ */
+int RomDataFactoryPrivate::readHeaderAt(IRpFile *file, const RomDataFns *fns, RomData::DetectInfo *info)
+{
+	// Check the file extension to reduce overhead
+	// for file types that don't use this.
+	// TODO: Don't hard-code this.
+	// Use a pointer to supportedFileExtensions_static() instead?
+	if (info->ext == nullptr) {
+		// No file extension...
+		return -1;
+	} else if (strcasecmp(info->ext, ".sms") != 0 &&
+		   strcasecmp(info->ext, ".gg") != 0)
+	{
+		// Not SMS or Game Gear.
+		return -1;
+	}
+
+	// Read the new header data.
+
+	// NOTE: fns->size == 0 is only correct
+	// for headers located at 0, since we
+	// read the whole 4096+256 bytes for these.
+	assert(fns->size != 0);
+	assert(fns->size <= HEADER_SIZE);
+	if (fns->size == 0 || fns->size > HEADER_SIZE)
+		return 1;
+
+	// Make sure the file is big enough to
+	// have this header.
+	if (((int64_t)fns->address + fns->size) > info->szFile)
+		return 1;
+
+	// Read the header data.
+	// NOTE: pData is const in DetectInfo, but it points
+	// to the caller's writable header buffer.
+	info->header.addr = fns->address;
+	int ret = file->seek(info->header.addr);
+	if (ret != 0)
+		return 1;
+	info->header.size = (uint32_t)file->read(const_cast<uint8_t*>(info->header.pData), fns->size);
+	if (info->header.size != fns->size)
+		return 1;
+
+	return 0;
+}
+
 /** RomDataFactory **/
 
 /**
@@ -291,7 +634,7 @@ RomData *RomDataFactory::create(IRpFile *file, bool thumbnail)
 
 	// Read 4,096+256 bytes from the ROM header.
 	// This should be enough to detect most systems.
-	uint8_t header[4096+256];
+	uint8_t header[RomDataFactoryPrivate::HEADER_SIZE];
 	file->rewind();
 	info.header.addr = 0;
 	info.header.pData = header;
@@ -328,72 +671,61 @@ RomData *RomDataFactory::create(IRpFile *file, bool thumbnail)
 		// Not a .VMI+.VMS pair.
 	}
 
+	// Use the magic number dispatch index to determine
+	// which RomData subclasses need to be checked.
+	const uint64_t candidates = RomDataFactoryPrivate::lookupMagic(&info);
+	int probes = 0, probesAvoided = 0;
+
 	// Check RomData subclasses that take a header.
+	RomData *romData = nullptr;
 	const RomDataFactoryPrivate::RomDataFns *fns =
 		&RomDataFactoryPrivate::romDataFns_header[0];
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
+	for (unsigned int idx = 0; fns->supportedFileExtensions != nullptr; fns++, idx++) {
 		if (thumbnail && !fns->hasThumbnail) {
 			// Thumbnail is requested, but this RomData class
 			// doesn't support any images.
 			continue;
 		}
 
+		if (idx < 64 && !(candidates & (1ULL << idx))) {
+			// Magic number doesn't match.
+			probesAvoided++;
+			continue;
+		}
+
 		if (fns->address != info.header.addr ||
 		    fns->size > info.header.size)
 		{
 			// Header address has changed.
-
-			// Check the file extension to reduce overhead
-			// for file types that don't use this.
-			// TODO: Don't hard-code this.
-			// Use a pointer to supportedFileExtensions_static() instead?
-			if (info.ext == nullptr) {
-				// No file extension...
+			int ret = RomDataFactoryPrivate::readHeaderAt(file, fns, &info);
+			if (ret < 0)
 				break;
-			} else if (strcasecmp(info.ext, ".sms") != 0 &&
-				   strcasecmp(info.ext, ".gg") != 0)
-			{
-				// Not SMS or Game Gear.
-				break;
-			}
-
-			// Read the new header data.
-
-			// NOTE: fns->size == 0 is only correct
-			// for headers located at 0, since we
-			// read the whole 4096+256 bytes for these.
-			assert(fns->size != 0);
-			assert(fns->size <= sizeof(header));
-			if (fns->size == 0 || fns->size > sizeof(header))
-				continue;
-
-			// Make sure the file is big enough to
-			// have this header.
-			if (((int64_t)fns->address + fns->size) > info.szFile)
-				continue;
-
-			// Read the header data.
-			info.header.addr = fns->address;
-			int ret = file->seek(info.header.addr);
-			if (ret != 0)
-				continue;
-			info.header.size = (uint32_t)file->read(header, fns->size);
-			if (info.header.size != fns->size)
+			else if (ret > 0)
 				continue;
 		}
 
+		probes++;
 		if (fns->isRomSupported(&info) >= 0) {
-			RomData *const romData = fns->newRomData(file);
+			romData = fns->newRomData(file);
 			if (romData->isValid()) {
 				// RomData subclass obtained.
-				return romData;
+				break;
 			}
 
 			// Not actually supported.
 			romData->unref();
+			romData = nullptr;
 		}
 	}
 
+	// Update the probe statistics.
+	ATOMIC_INC_FETCH(&RomDataFactoryPrivate::stats_lookups);
+	ATOMIC_ADD_FETCH(&RomDataFactoryPrivate::stats_probes, probes);
+	ATOMIC_ADD_FETCH(&RomDataFactoryPrivate::stats_probesAvoided, probesAvoided);
+	if (romData) {
+		return romData;
+	}
+
 	// Check RomData subclasses that take a footer.
 	if (info.szFile > (1LL << 30)) {
 		// No subclasses that expect footers support
@@ -432,8 +764,9 @@ RomData *RomDataFactory::create(IRpFile *file, bool thumbnail)
 			readFooter = true;
 		}
 
+		ATOMIC_INC_FETCH(&RomDataFactoryPrivate::stats_probes);
 		if (fns->isRomSupported(&info) >= 0) {
-			RomData *const romData = fns->newRomData(file);
+			romData = fns->newRomData(file);
 			if (romData->isValid()) {
 				// RomData subclass obtained.
 				return romData;
@@ -448,6 +781,251 @@ RomData *RomDataFactory::create(IRpFile *file, bool thumbnail)
 	return nullptr;
 }
 
+/**
+ * Identify a ROM file without creating a RomData object.
+ *
+ * This only uses isRomSupported_static() and the DetectInfo
+ * header, so it's much cheaper than create() for classes
+ * that do a lot of I/O in their constructors.
+ *
+ * NOTE: Since the RomData subclass isn't constructed,
+ * RomData::isValid() isn't checked. create() may still
+ * fail for files that are identified by this function.
+ *
+ * @param file		[in] ROM file.
+ * @param pRomInfo	[out] RomInfo.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataFactory::identify(IRpFile *file, RomInfo *pRomInfo)
+{
+	assert(file != nullptr);
+	assert(pRomInfo != nullptr);
+	if (!file || !pRomInfo) {
+		return -EINVAL;
+	}
+
+	RomData::DetectInfo info;
+
+	// Get the file size.
+	info.szFile = file->size();
+
+	// Read the ROM header.
+	uint8_t header[RomDataFactoryPrivate::HEADER_SIZE];
+	file->rewind();
+	info.header.addr = 0;
+	info.header.pData = header;
+	info.header.size = (uint32_t)file->read(header, sizeof(header));
+	if (info.header.size == 0) {
+		// Read error.
+		return -EIO;
+	}
+
+	// Get the file extension.
+	info.ext = nullptr;
+	const string filename = file->filename();
+	if (!filename.empty()) {
+		info.ext = FileSystem::file_ext(filename);
+	}
+
+	// Use the magic number dispatch index to determine
+	// which RomData subclasses need to be checked.
+	const uint64_t candidates = RomDataFactoryPrivate::lookupMagic(&info);
+
+	const RomDataFactoryPrivate::RomDataFns *fns =
+		&RomDataFactoryPrivate::romDataFns_header[0];
+	for (unsigned int idx = 0; fns->supportedFileExtensions != nullptr; fns++, idx++) {
+		if (idx < 64 && !(candidates & (1ULL << idx))) {
+			// Magic number doesn't match.
+			continue;
+		}
+
+		if (fns->address != info.header.addr ||
+		    fns->size > info.header.size)
+		{
+			// Header address has changed.
+			int ret = RomDataFactoryPrivate::readHeaderAt(file, fns, &info);
+			if (ret < 0)
+				break;
+			else if (ret > 0)
+				continue;
+		}
+
+		const int romType = fns->isRomSupported(&info);
+		if (romType >= 0) {
+			pRomInfo->className = fns->className;
+			pRomInfo->systemName = fns->systemName;
+			pRomInfo->fileType = (fns->fileType_static
+				? fns->fileType_static(romType)
+				: fns->fileType);
+			pRomInfo->romType = romType;
+			return 0;
+		}
+	}
+
+	// Check RomData subclasses that take a footer.
+	// Currently only supports VirtualBoy.
+	// FIXME: Instead of hard-coded, check supportedFileExtensions.
+	if (info.szFile <= (1LL << 30) &&
+	    info.ext != nullptr && !strcasecmp(info.ext, ".vb"))
+	{
+		static const int footer_size = 1024;
+		if (info.szFile > footer_size) {
+			info.header.addr = (uint32_t)(info.szFile - footer_size);
+			info.header.size = (uint32_t)file->seekAndRead(info.header.addr, header, footer_size);
+			if (info.header.size == 0) {
+				// Seek and/or read error.
+				return -EIO;
+			}
+		}
+
+		fns = &RomDataFactoryPrivate::romDataFns_footer[0];
+		for (; fns->supportedFileExtensions != nullptr; fns++) {
+			const int romType = fns->isRomSupported(&info);
+			if (romType >= 0) {
+				pRomInfo->className = fns->className;
+				pRomInfo->systemName = fns->systemName;
+				pRomInfo->fileType = (fns->fileType_static
+					? fns->fileType_static(romType)
+					: fns->fileType);
+				pRomInfo->romType = romType;
+				return 0;
+			}
+		}
+	}
+
+	// Not supported.
+	return -ENOTSUP;
+}
+
+/**
+ * createBatch() job data.
+ */
+struct CreateBatchJob {
+	const vector<string> *filenames;
+	RomDataFactory::pFnBatchCallback callback;
+	void *userdata;
+	bool thumbnail;
+	int64_t mmapMaxSize;	// Maximum size for RpMmapFile. (0 to disable)
+
+	Mutex callbackMutex;	// Serializes callbacks.
+	volatile int supported;	// Number of supported files.
+};
+
+/**
+ * createBatch() work item function.
+ * @param param CreateBatchJob.
+ * @param idx Filename index.
+ */
+static void createBatch_work(void *param, unsigned int idx)
+{
+	CreateBatchJob *const job = static_cast<CreateBatchJob*>(param);
+	const string &filename = job->filenames->at(idx);
+
+	// If enabled, map small files on local filesystems.
+	// This avoids a read() system call for every header probe.
+	// Large files and files on network shares aren't mapped,
+	// since truncating or disconnecting them while they're
+	// mapped results in SIGBUS instead of a read error.
+	RomData *romData = nullptr;
+	IRpFile *file = nullptr;
+	if (job->mmapMaxSize > 0) {
+		const int64_t fileSize = FileSystem::filesize(filename);
+		if (fileSize > 0 && fileSize <= job->mmapMaxSize &&
+		    FileSystem::is_on_local_fs(filename))
+		{
+			file = new RpMmapFile(filename);
+			if (!file->isOpen()) {
+				delete file;
+				file = nullptr;
+			}
+		}
+	}
+	if (!file) {
+		file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	}
+	if (file->isOpen()) {
+		romData = RomDataFactory::create(file, job->thumbnail);
+		if (romData) {
+			ATOMIC_INC_FETCH(&job->supported);
+		}
+	}
+	delete file;
+
+	{
+		MutexLocker callbackLock(job->callbackMutex);
+		job->callback(idx, filename.c_str(), romData, job->userdata);
+	}
+	if (romData) {
+		romData->unref();
+	}
+}
+
+/**
+ * Create RomData objects for a list of files.
+ *
+ * The files are opened and detected on a bounded pool of
+ * worker threads, and the results are handed back through
+ * the callback as they complete.
+ *
+ * @param filenames	[in] List of filenames.
+ * @param callback	[in] Callback function.
+ * @param userdata	[in] User data for the callback.
+ * @param thumbnail	[in] If true, RomData class must support at least one image type.
+ * @param threads	[in] Number of threads to use. (If 0, use the number of logical processors.)
+ * @param mmapMaxSize	[in] If non-zero, memory-map files on local filesystems up to this size.
+ * @return Number of supported files on success; negative POSIX error code on error.
+ */
+int RomDataFactory::createBatch(const vector<string> &filenames,
+	pFnBatchCallback callback, void *userdata,
+	bool thumbnail, unsigned int threads,
+	int64_t mmapMaxSize)
+{
+	assert(callback != nullptr);
+	if (!callback) {
+		return -EINVAL;
+	} else if (filenames.empty()) {
+		return 0;
+	}
+
+	// Don't start more threads than we have files.
+	const unsigned int nfiles = (unsigned int)filenames.size();
+	if (threads == 0) {
+		threads = Thread::processorCount();
+	}
+	if (threads > nfiles) {
+		threads = nfiles;
+	}
+
+	CreateBatchJob job;
+	job.filenames = &filenames;
+	job.callback = callback;
+	job.userdata = userdata;
+	job.thumbnail = thumbnail;
+	job.mmapMaxSize = mmapMaxSize;
+	job.supported = 0;
+
+	ThreadPool pool(threads);
+	pool.run(nfiles, createBatch_work, &job);
+	return job.supported;
+}
+
+/**
+ * Get the probe statistics for create().
+ * This shows how many isRomSupported() probes
+ * were avoided by the magic number dispatch index.
+ * @param stats ProbeStats struct.
+ */
+void RomDataFactory::getProbeStats(ProbeStats *stats)
+{
+	assert(stats != nullptr);
+	if (!stats)
+		return;
+
+	stats->lookups = (unsigned int)RomDataFactoryPrivate::stats_lookups;
+	stats->probes = (unsigned int)RomDataFactoryPrivate::stats_probes;
+	stats->probesAvoided = (unsigned int)RomDataFactoryPrivate::stats_probesAvoided;
+}
+
 /**
  * Get all supported file extensions.
  * Used for Win32 COM registration.
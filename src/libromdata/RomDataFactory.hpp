@@ -24,12 +24,13 @@
 
 #include "librpbase/config.librpbase.h"
 #include "librpbase/common.h"
+#include "librpbase/RomData.hpp"
 
 // C++ includes.
+#include <string>
 #include <vector>
 
 namespace LibRpBase {
-	class RomData;
 	class IRpFile;
 }
 
@@ -61,6 +62,92 @@ class RomDataFactory
 		 */
 		static LibRpBase::RomData *create(LibRpBase::IRpFile *file, bool thumbnail = false);
 
+		/**
+		 * Lightweight ROM identification.
+		 * Returned by identify().
+		 */
+		struct RomInfo {
+			const char *className;			// Class name. (ASCII)
+			const char *systemName;			// Generic system name for the class.
+			LibRpBase::RomData::FileType fileType;	// General file type.
+			int romType;				// Class-specific system ID from isRomSupported_static().
+		};
+
+		/**
+		 * Identify a ROM file without creating a RomData object.
+		 *
+		 * This only uses isRomSupported_static() and the DetectInfo
+		 * header, so it's much cheaper than create() for classes
+		 * that do a lot of I/O in their constructors.
+		 *
+		 * NOTE: Since the RomData subclass isn't constructed,
+		 * RomData::isValid() isn't checked. create() may still
+		 * fail for files that are identified by this function.
+		 *
+		 * @param file		[in] ROM file.
+		 * @param pRomInfo	[out] RomInfo.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int identify(LibRpBase::IRpFile *file, RomInfo *pRomInfo);
+
+		/**
+		 * Batch scanning callback.
+		 *
+		 * Called once for each file in the batch, in completion order.
+		 * Callbacks are serialized, but they're run on the worker threads,
+		 * so they must not call back into the UI toolkit directly.
+		 *
+		 * romData is unref()'d after the callback returns.
+		 * To keep it, call romData->ref().
+		 *
+		 * @param idx		[in] Index of the file in the filename list.
+		 * @param filename	[in] Filename.
+		 * @param romData	[in] RomData object, or nullptr if the file couldn't be opened or isn't supported.
+		 * @param userdata	[in] User data specified in createBatch().
+		 */
+		typedef void (*pFnBatchCallback)(unsigned int idx, const char *filename,
+			LibRpBase::RomData *romData, void *userdata);
+
+		/**
+		 * Create RomData objects for a list of files.
+		 *
+		 * The files are opened and detected on a bounded pool of
+		 * worker threads, and the results are handed back through
+		 * the callback as they complete.
+		 *
+		 * @param filenames	[in] List of filenames.
+		 * @param callback	[in] Callback function.
+		 * @param userdata	[in] User data for the callback.
+		 * @param thumbnail	[in] If true, RomData class must support at least one image type.
+		 * @param threads	[in] Number of threads to use. (If 0, use the number of logical processors.)
+		 * @param mmapMaxSize	[in] If non-zero, memory-map files on local filesystems up to this size.
+		 *
+		 * NOTE: Memory-mapped files that are truncated or removed during
+		 * the scan cause SIGBUS instead of a read error, so mmapMaxSize
+		 * should only be used for small files. Files on network shares
+		 * are never mapped.
+		 *
+		 * @return Number of supported files on success; negative POSIX error code on error.
+		 */
+		static int createBatch(const std::vector<std::string> &filenames,
+			pFnBatchCallback callback, void *userdata,
+			bool thumbnail = false, unsigned int threads = 0,
+			int64_t mmapMaxSize = 0);
+
+		struct ProbeStats {
+			unsigned int lookups;		// Number of header lookups.
+			unsigned int probes;		// Number of isRomSupported() calls.
+			unsigned int probesAvoided;	// Number of isRomSupported() calls skipped by the magic number index.
+		};
+
+		/**
+		 * Get the probe statistics for create().
+		 * This shows how many isRomSupported() probes
+		 * were avoided by the magic number dispatch index.
+		 * @param stats ProbeStats struct.
+		 */
+		static void getProbeStats(ProbeStats *stats);
+
 		struct ExtInfo {
 			const char *ext;
 			bool hasThumbnail;
@@ -39,6 +39,10 @@ using namespace LibRpBase;
 #include <cstdio>
 #include <cstring>
 
+// C++ includes.
+#include <memory>
+using std::unique_ptr;
+
 namespace LibRomData {
 
 class CIAReaderPrivate
@@ -77,6 +81,50 @@ class CIAReaderPrivate
 		// CIA cipher.
 		uint8_t title_key[16];		// Decrypted title key.
 		LibRpBase::IAesCipher *cipher;	// Cipher.
+
+		// Last ciphertext block that was decrypted.
+		// This is the IV for the next block, so sequential
+		// reads don't need to re-read it from the file.
+		uint8_t lastCipherBlock[16];
+		uint32_t lastCipherBlockEnd;	// Content address after lastCipherBlock. (0 if unused)
+
+		// Decrypted block cache. (LRU)
+		// NCCHReader jumps between the NCCH header, ExHeader,
+		// and ExeFS, so small reads are decrypted in larger
+		// blocks and cached.
+		static const unsigned int BLOCK_SIZE = 64*1024;
+		static const unsigned int BLOCK_CACHE_COUNT = 4;
+		struct BlockCacheEntry {
+			uint32_t block_num;		// Block number. (~0 if unused)
+			uint32_t lastUsed;		// Last-used tick.
+			uint32_t length;		// Amount of valid data.
+			uint8_t buf[BLOCK_SIZE];	// Decrypted block data.
+		};
+		unique_ptr<BlockCacheEntry[]> blockCache;
+		uint32_t blockCacheTick;
+
+		/**
+		 * Read and decrypt data from the CIA content.
+		 *
+		 * NOTE: Offset and size must both be multiples of 16.
+		 *
+		 * @param offset	[in] Starting address, relative to the beginning of the content.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readBlocks(uint32_t offset, uint8_t *ptr, size_t size);
+
+		/**
+		 * Read and decrypt a block using the block cache.
+		 *
+		 * NOTE: The returned entry is only valid until the
+		 * next cache operation.
+		 *
+		 * @param block_num Block number. (address / BLOCK_SIZE)
+		 * @return Cache entry, or nullptr on error.
+		 */
+		const BlockCacheEntry *readBlock(uint32_t block_num);
 #endif /* ENABLE_DECRYPTION */
 };
 
@@ -95,6 +143,8 @@ CIAReaderPrivate::CIAReaderPrivate(CIAReader *q, IRpFile *file,
 	, titleKeyEncIdx(0)
 	, tmd_content_index(tmd_content_index)
 	, cipher(nullptr)
+	, lastCipherBlockEnd(0)
+	, blockCacheTick(0)
 #endif /* ENABLE_DECRYPTION */
 {
 #ifndef ENABLE_DECRYPTION
@@ -210,6 +260,141 @@ CIAReaderPrivate::~CIAReaderPrivate()
 #endif /* ENABLE_DECRYPTION */
 }
 
+#ifdef ENABLE_DECRYPTION
+/**
+ * Read and decrypt data from the CIA content.
+ *
+ * NOTE: Offset and size must both be multiples of 16.
+ *
+ * @param offset	[in] Starting address, relative to the beginning of the content.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CIAReaderPrivate::readBlocks(uint32_t offset, uint8_t *ptr, size_t size)
+{
+	assert(offset % 16 == 0);
+	assert(size % 16 == 0);
+	assert(size > 0);
+
+	// Determine the CIA IV.
+	u128_t cia_iv;
+	int64_t phys_addr = content_offset + offset;
+	if (offset == 0) {
+		// Start of CIA content.
+		// IV is the TMD content index.
+		cia_iv.u8[0] = tmd_content_index >> 8;
+		cia_iv.u8[1] = tmd_content_index & 0xFF;
+		memset(&cia_iv.u8[2], 0, sizeof(cia_iv.u8)-2);
+	} else if (offset == lastCipherBlockEnd) {
+		// IV is the last ciphertext block we decrypted.
+		memcpy(cia_iv.u8, lastCipherBlock, sizeof(cia_iv.u8));
+	} else {
+		// IV is the previous 16 bytes.
+		// Read it along with the data.
+		phys_addr -= 16;
+	}
+
+	// NOTE: pread() doesn't change the file position,
+	// so this doesn't interfere with other users of the file.
+	int ret = 0;
+	if (phys_addr != content_offset + offset) {
+		if (file->pread(phys_addr, cia_iv.u8, sizeof(cia_iv.u8)) != sizeof(cia_iv.u8)) {
+			ret = -1;
+		}
+	}
+	if (ret == 0 && file->pread(content_offset + offset, ptr, size) != size) {
+		// Short read.
+		// Cannot decrypt with a short read.
+		ret = -1;
+	}
+	if (ret != 0) {
+		// Read error.
+		ret = -file->lastError();
+		if (ret == 0) {
+			ret = -EIO;
+		}
+		return ret;
+	}
+
+	// Save the last ciphertext block for the next read.
+	memcpy(lastCipherBlock, &ptr[size - 16], sizeof(lastCipherBlock));
+	lastCipherBlockEnd = offset + (uint32_t)size;
+
+	// Decrypt the data.
+	if (cipher->setIV(cia_iv.u8, sizeof(cia_iv.u8)) != 0 ||
+	    cipher->decrypt(ptr, (unsigned int)size) != size)
+	{
+		// Decryption failed.
+		lastCipherBlockEnd = 0;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/**
+ * Read and decrypt a block using the block cache.
+ *
+ * NOTE: The returned entry is only valid until the
+ * next cache operation.
+ *
+ * @param block_num Block number. (address / BLOCK_SIZE)
+ * @return Cache entry, or nullptr on error.
+ */
+const CIAReaderPrivate::BlockCacheEntry *CIAReaderPrivate::readBlock(uint32_t block_num)
+{
+	if (!blockCache) {
+		// Allocate the block cache.
+		blockCache.reset(new BlockCacheEntry[BLOCK_CACHE_COUNT]);
+		for (unsigned int i = 0; i < BLOCK_CACHE_COUNT; i++) {
+			blockCache[i].block_num = ~0U;
+			blockCache[i].lastUsed = 0;
+			blockCache[i].length = 0;
+		}
+	}
+
+	// Check if the block is already cached.
+	// If it isn't, find the least-recently used entry.
+	BlockCacheEntry *entry = blockCache.get();
+	BlockCacheEntry *lru = entry;
+	for (unsigned int i = BLOCK_CACHE_COUNT; i > 0; i--, entry++) {
+		if (entry->block_num == block_num) {
+			entry->lastUsed = ++blockCacheTick;
+			return entry;
+		}
+		// NOTE: Subtraction handles tick wraparound.
+		if (lru->block_num != ~0U &&
+		    (entry->block_num == ~0U ||
+		     (uint32_t)(blockCacheTick - entry->lastUsed) >
+		     (uint32_t)(blockCacheTick - lru->lastUsed)))
+		{
+			lru = entry;
+		}
+	}
+
+	// Decrypt the block.
+	// The last block may be smaller than BLOCK_SIZE.
+	const uint32_t block_addr = block_num * BLOCK_SIZE;
+	// NOTE: content_length is const, so ALIGN() can't be used here.
+	uint32_t length = ((content_length + 15U) & ~15U) - block_addr;
+	if (length > BLOCK_SIZE) {
+		length = BLOCK_SIZE;
+	}
+	lru->block_num = ~0U;
+	int ret = readBlocks(block_addr, lru->buf, length);
+	if (ret != 0) {
+		q_ptr->m_lastError = -ret;
+		return nullptr;
+	}
+
+	lru->block_num = block_num;
+	lru->lastUsed = ++blockCacheTick;
+	lru->length = length;
+	return lru;
+}
+#endif /* ENABLE_DECRYPTION */
+
 /** CIAReader **/
 
 /**
@@ -298,86 +483,53 @@ size_t CIAReader::read(void *ptr, size_t size)
 			}
 			return 0;
 		}
+		d->pos += (uint32_t)sz_read;
 		return sz_read;
 	}
 
 #ifdef ENABLE_DECRYPTION
-	// TODO: Handle reads that aren't a multiple of 16 bytes.
-	assert(d->pos % 16 == 0);
-	assert(size % 16 == 0);
-	if (d->pos % 16 != 0 || size % 16 != 0) {
-		// Cannot read now.
-		return 0;
-	}
-
-	// Physical address.
-	int64_t phys_addr = d->content_offset + d->pos;
-
-	// Determine the CIA IV.
-	u128_t cia_iv;
-	if (d->pos >= 16) {
-		// Subtract 16 in order to read the IV.
-		phys_addr -= 16;
-	}
-	int ret = d->file->seek(phys_addr);
-	if (ret != 0) {
-		// Seek error.
-		m_lastError = d->file->lastError();
-		if (m_lastError == 0) {
-			m_lastError = EIO;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t sz_total_read = 0;
+	while (size > 0) {
+		if (d->pos % 16 == 0 && size >= CIAReaderPrivate::BLOCK_SIZE) {
+			// Large aligned read. Decrypt the data directly
+			// into the output buffer, bypassing the cache.
+			// If the read is sequential, the IV doesn't
+			// need to be read from the file.
+			const size_t sz_blocks = (size & ~(size_t)15);
+			int ret = d->readBlocks(d->pos, ptr8, sz_blocks);
+			if (ret != 0) {
+				m_lastError = -ret;
+				break;
+			}
+			d->pos += (uint32_t)sz_blocks;
+			ptr8 += sz_blocks;
+			sz_total_read += sz_blocks;
+			size -= sz_blocks;
+			continue;
 		}
-		return 0;
-	}
 
-	if (d->pos < 16) {
-		// Start of CIA content.
-		// IV is the TMD content index.
-		cia_iv.u8[0] = d->tmd_content_index >> 8;
-		cia_iv.u8[1] = d->tmd_content_index & 0xFF;
-		memset(&cia_iv.u8[2], 0, sizeof(cia_iv.u8)-2);
-	} else {
-		// IV is the previous 16 bytes.
-		// TODO: Cache this?
-		size_t sz_read = d->file->read(&cia_iv.u8, sizeof(cia_iv.u8));
-		if (sz_read != sizeof(cia_iv.u8)) {
+		// Small or unaligned read. Use the block cache.
+		const uint32_t block_num = d->pos / CIAReaderPrivate::BLOCK_SIZE;
+		const uint32_t blockOffset = d->pos % CIAReaderPrivate::BLOCK_SIZE;
+		const CIAReaderPrivate::BlockCacheEntry *const entry = d->readBlock(block_num);
+		if (!entry || blockOffset >= entry->length) {
 			// Read error.
-			m_lastError = d->file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
+			break;
 		}
-	}
 
-	// Read the data.
-	size_t sz_read = d->file->read(ptr, size);
-	if (sz_read != size) {
-		// Short read.
-		// Cannot decrypt with a short read.
-		m_lastError = d->file->lastError();
-		if (m_lastError == 0) {
-			m_lastError = EIO;
+		size_t sz_copy = entry->length - blockOffset;
+		if (sz_copy > size) {
+			sz_copy = size;
 		}
-		return 0;
-	}
-
-	// Decrypt the data.
-	ret = d->cipher->setIV(cia_iv.u8, sizeof(cia_iv.u8));
-	if (ret != 0) {
-		// setIV() failed.
-		m_lastError = EIO;
-		return 0;
-	}
-	unsigned int sz_dec = d->cipher->decrypt(
-		static_cast<uint8_t*>(ptr), (unsigned int)size);
-	if (sz_dec != size) {
-		// decrypt() failed.
-		m_lastError = EIO;
-		return 0;
+		memcpy(ptr8, &entry->buf[blockOffset], sz_copy);
+		d->pos += (uint32_t)sz_copy;
+		ptr8 += sz_copy;
+		sz_total_read += sz_copy;
+		size -= sz_copy;
 	}
 
-	// Data read and decrypted successfully.
-	return sz_read;
+	return sz_total_read;
 #else
 	// Cannot decrypt data if decryption is disabled.
 	return 0;
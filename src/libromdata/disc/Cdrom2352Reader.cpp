@@ -32,6 +32,7 @@
 // librpbase
 #include "librpbase/byteswap.h"
 #include "librpbase/file/IRpFile.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
 using namespace LibRpBase;
 
 // C includes.
@@ -42,6 +43,10 @@ using namespace LibRpBase;
 #include <cerrno>
 #include <cstring>
 
+// C++ includes.
+#include <memory>
+using std::unique_ptr;
+
 namespace LibRomData {
 
 class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
@@ -59,6 +64,10 @@ class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
 		// Physical block size.
 		static const unsigned int physBlockSize = 2352;
 
+		// Maximum number of raw sectors to read at once
+		// in readBlocks(). (~294 KB)
+		static const unsigned int maxBulkSectors = 128;
+
 		// Number of 2352-byte blocks.
 		unsigned int blockCount;
 };
@@ -183,9 +192,150 @@ int Cdrom2352Reader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t siz
 	// FIXME: Read the whole block so we can determine if this is Mode1 or Mode2.
 	// Mode1 data starts at byte 16; Mode2 data starts at byte 24.
 	const int64_t phys_pos = ((int64_t)blockIdx * d->physBlockSize) + 16 + pos;
-	size_t sz_read = d->file->seekAndRead(phys_pos, ptr, size);
+	size_t sz_read = d->file->pread(phys_pos, ptr, size);
 	m_lastError = d->file->lastError();
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple consecutive full blocks.
+ * Runs of raw sectors are read with a single pread(),
+ * and the user data is extracted from each sector.
+ * @param firstIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+ * @return Number of bytes read. (Less than count * block_size on error.)
+ */
+size_t Cdrom2352Reader::readBlocks(uint32_t firstIdx, unsigned int count, void *ptr)
+{
+	RP_D(Cdrom2352Reader);
+	assert(firstIdx < d->blockCount);
+	assert(count <= d->blockCount - firstIdx);
+	if (firstIdx >= d->blockCount) {
+		// Out of range.
+		return 0;
+	} else if (count > d->blockCount - firstIdx) {
+		// Read as many blocks as possible.
+		count = d->blockCount - firstIdx;
+	}
+
+	int err = 0;
+	const size_t ret = readUserData(d->file, (int64_t)firstIdx * d->physBlockSize,
+		d->physBlockSize, count, ptr, &err);
+	if (err != 0) {
+		m_lastError = err;
+	}
+	return ret;
+}
+
+/**
+ * Read the user data from a run of consecutive sectors.
+ *
+ * Raw 2352-byte sectors are read in bulk with pread(),
+ * and the 2048-byte user data is extracted from each
+ * sector. 2048-byte sectors are read directly.
+ *
+ * This is used by both Cdrom2352Reader and GdiReader.
+ *
+ * @param file		[in] File. (Must support pread().)
+ * @param phys_pos	[in] Address of the first sector in the file.
+ * @param sectorSize	[in] Physical sector size. (2048 or 2352)
+ * @param count		[in] Number of sectors.
+ * @param ptr		[out] Output data buffer. (Must be at least count * 2048 bytes.)
+ * @param pErr		[out] POSIX error code if a short read occurred.
+ * @return Number of bytes read. (Less than count * 2048 on error.)
+ */
+size_t Cdrom2352Reader::readUserData(IRpFile *file, int64_t phys_pos,
+	unsigned int sectorSize, unsigned int count, void *ptr, int *pErr)
+{
+	assert(sectorSize == 2048 || sectorSize == 2352);
+	static const unsigned int block_size = 2048;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	*pErr = 0;
+
+	if (sectorSize == block_size) {
+		// No sector headers. Read the data directly.
+		const size_t sz = (size_t)count * block_size;
+		ret = file->pread(phys_pos, ptr8, sz);
+		if (ret != sz) {
+			*pErr = file->lastError();
+			if (*pErr == 0) {
+				*pErr = EIO;
+			}
+			// Only return complete sectors.
+			ret -= ret % block_size;
+		}
+		return ret;
+	}
+
+	// Temporary buffer for raw sectors.
+	// NOTE: This may be called from multiple threads,
+	// so the buffer can't be shared.
+	const unsigned int maxBulkSectors = Cdrom2352ReaderPrivate::maxBulkSectors;
+	const unsigned int bufSectors = (count < maxBulkSectors ? count : maxBulkSectors);
+	unique_ptr<uint8_t[]> rawBuf(new uint8_t[(size_t)bufSectors * sectorSize]);
+
+	while (count > 0) {
+		const unsigned int run = (count < bufSectors ? count : bufSectors);
+		const size_t run_sz = (size_t)run * sectorSize;
+		size_t sz_read = file->pread(phys_pos, rawBuf.get(), run_sz);
+
+		// Copy the user data from each sector that was read.
+		// FIXME: Mode2 data starts at byte 24. (See readBlock().)
+		const unsigned int sectorsRead = (unsigned int)(sz_read / sectorSize);
+		const uint8_t *src = rawBuf.get() + 16;
+		for (unsigned int i = sectorsRead; i > 0; i--) {
+			memcpy(ptr8, src, block_size);
+			src += sectorSize;
+			ptr8 += block_size;
+		}
+		ret += (size_t)sectorsRead * block_size;
+
+		if (sz_read != run_sz) {
+			// Error reading the data.
+			*pErr = file->lastError();
+			if (*pErr == 0) {
+				*pErr = EIO;
+			}
+			break;
+		}
+
+		phys_pos += run_sz;
+		count -= run;
+	}
+
+	return ret;
+}
+
+/** EDC/ECC verification **/
+
+/**
+ * Verify the EDC and ECC of every sector in the disc image.
+ *
+ * Sectors are read and checked in parallel. This doesn't
+ * affect normal reads, which don't check the EDC or ECC.
+ *
+ * @param report	[out] Sector verification report.
+ * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+ * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+ */
+int Cdrom2352Reader::verifySectors(CdromEdcEcc::SectorReport &report, unsigned int threads)
+{
+	RP_D(Cdrom2352Reader);
+	report.sectorCount = 0;
+	report.badSectors.clear();
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -EBADF;
+	}
+
+	ThreadPool pool(threads);
+	int ret = CdromEdcEcc::verifySectors(report, &pool, d->file, 0, d->blockCount, 0);
+	if (ret != 0) {
+		m_lastError = -ret;
+	}
+	return ret;
+}
+
 }
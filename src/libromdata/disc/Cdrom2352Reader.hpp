@@ -23,6 +23,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_DISC_CDROM2352READER_HPP__
 
 #include "librpbase/disc/SparseDiscReader.hpp"
+#include "../utils/CdromEdcEcc.hpp"
 
 namespace LibRpBase {
 	class IRpFile;
@@ -83,6 +84,53 @@ class Cdrom2352Reader : public LibRpBase::SparseDiscReader
 		 * @return Number of bytes read, or -1 if the block index is invalid.
 		 */
 		virtual int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size) override final;
+
+		/**
+		 * Read multiple consecutive full blocks.
+		 * Runs of raw sectors are read with a single pread(),
+		 * and the user data is extracted from each sector.
+		 * @param firstIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+		 * @return Number of bytes read. (Less than count * block_size on error.)
+		 */
+		virtual size_t readBlocks(uint32_t firstIdx, unsigned int count, void *ptr) override final;
+
+	public:
+		/**
+		 * Read the user data from a run of consecutive sectors.
+		 *
+		 * Raw 2352-byte sectors are read in bulk with pread(),
+		 * and the 2048-byte user data is extracted from each
+		 * sector. 2048-byte sectors are read directly.
+		 *
+		 * This is used by both Cdrom2352Reader and GdiReader.
+		 *
+		 * @param file		[in] File. (Must support pread().)
+		 * @param phys_pos	[in] Address of the first sector in the file.
+		 * @param sectorSize	[in] Physical sector size. (2048 or 2352)
+		 * @param count		[in] Number of sectors.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * 2048 bytes.)
+		 * @param pErr		[out] POSIX error code if a short read occurred.
+		 * @return Number of bytes read. (Less than count * 2048 on error.)
+		 */
+		static size_t readUserData(LibRpBase::IRpFile *file, int64_t phys_pos,
+			unsigned int sectorSize, unsigned int count, void *ptr, int *pErr);
+
+	public:
+		/** EDC/ECC verification **/
+
+		/**
+		 * Verify the EDC and ECC of every sector in the disc image.
+		 *
+		 * Sectors are read and checked in parallel. This doesn't
+		 * affect normal reads, which don't check the EDC or ECC.
+		 *
+		 * @param report	[out] Sector verification report.
+		 * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+		 */
+		int verifySectors(CdromEdcEcc::SectorReport &report, unsigned int threads = 0);
 };
 
 }
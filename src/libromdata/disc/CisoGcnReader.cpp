@@ -41,6 +41,7 @@ using namespace LibRpBase;
 #include <cstring>
 
 // C++ includes.
+#include <algorithm>
 #include <array>
 using std::array;
 
@@ -277,9 +278,71 @@ int CisoGcnReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size)
 
 	// Go to the block.
 	const int64_t phys_pos = sizeof(d->cisoHeader) + ((int64_t)physBlockIdx * d->block_size) + pos;
-	size_t sz_read = d->file->seekAndRead(phys_pos, ptr, size);
-	m_lastError = d->file->lastError();
+	// NOTE: Using pread() so multiple threads can read blocks at once.
+	size_t sz_read = d->file->pread(phys_pos, ptr, size);
+	if (sz_read != size) {
+		m_lastError = d->file->lastError();
+	}
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple consecutive full blocks.
+ * Physically contiguous blocks are read with a single pread().
+ * @param firstIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+ * @return Number of bytes read. (Less than count * block_size on error.)
+ */
+size_t CisoGcnReader::readBlocks(uint32_t firstIdx, unsigned int count, void *ptr)
+{
+	RP_D(CisoGcnReader);
+	const unsigned int block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	while (count > 0) {
+		// TODO: Check against maxLogicalBlockUsed?
+		if (firstIdx >= d->blockMap.size()) {
+			// Out of range.
+			break;
+		}
+
+		// Find a run of physically contiguous blocks,
+		// or a run of empty blocks.
+		const unsigned int physBlockIdx = d->blockMap[firstIdx];
+		const unsigned int maxRun = std::min<size_t>(count, d->blockMap.size() - firstIdx);
+		unsigned int run = 1;
+		if (physBlockIdx >= 0xFFFF) {
+			// Empty blocks.
+			while (run < maxRun && d->blockMap[firstIdx + run] >= 0xFFFF) {
+				run++;
+			}
+			memset(ptr8, 0, (size_t)run * block_size);
+		} else {
+			while (run < maxRun && d->blockMap[firstIdx + run] == physBlockIdx + run) {
+				run++;
+			}
+
+			// Read the entire run at once.
+			const int64_t phys_pos = sizeof(d->cisoHeader) + ((int64_t)physBlockIdx * block_size);
+			const size_t run_sz = (size_t)run * block_size;
+			size_t sz_read = d->file->pread(phys_pos, ptr8, run_sz);
+			if (sz_read != run_sz) {
+				// Error reading the data.
+				m_lastError = d->file->lastError();
+				return ret + sz_read;
+			}
+		}
+
+		const size_t run_sz = (size_t)run * block_size;
+		firstIdx += run;
+		count -= run;
+		ptr8 += run_sz;
+		ret += run_sz;
+	}
+
+	return ret;
+}
+
 }
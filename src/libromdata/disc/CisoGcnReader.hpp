@@ -83,6 +83,16 @@ class CisoGcnReader : public LibRpBase::SparseDiscReader
 		 * @return Number of bytes read, or -1 if the block index is invalid.
 		 */
 		virtual int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size) override final;
+
+		/**
+		 * Read multiple consecutive full blocks.
+		 * Physically contiguous blocks are read with a single pread().
+		 * @param firstIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+		 * @return Number of bytes read. (Less than count * block_size on error.)
+		 */
+		virtual size_t readBlocks(uint32_t firstIdx, unsigned int count, void *ptr) override final;
 };
 
 }
@@ -36,15 +36,17 @@ using namespace LibRpBase;
 // C++ includes.
 #include <string>
 #include <unordered_map>
+#include <vector>
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
 class GcnFstPrivate
 {
 	public:
-		GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offsetShift);
+		GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offsetShift, bool borrowed);
 		~GcnFstPrivate();
 
 	private:
@@ -54,7 +56,10 @@ class GcnFstPrivate
 		bool hasErrors;
 
 		// FST data.
-		GCN_FST_Entry *fstData;
+		// If the FST data is borrowed from the caller,
+		// fstData_owned is nullptr.
+		const GCN_FST_Entry *fstData;
+		uint8_t *fstData_owned;
 		uint32_t fstData_sz;
 
 		// String table. (Pointer into d->fstData.)
@@ -62,6 +67,8 @@ class GcnFstPrivate
 		uint32_t string_table_sz;
 
 		// String table, converted to Unicode.
+		// ASCII names are used directly from the FST string table,
+		// so this only has names that needed to be converted.
 		// - Key: String offset in the FST string table.
 		// - Value: string.
 		unordered_map<uint32_t, string> u8_string_table;
@@ -72,6 +79,45 @@ class GcnFstPrivate
 		// IFst::Dir* reference counter.
 		int fstDirCount;
 
+		// Path index. Built on first use by find_path().
+		// Paths are hashed using 32-bit FNV-1a after converting
+		// ASCII characters to lowercase.
+		// - pathParent: Parent directory index for each FST entry.
+		// - pathHash: Full path hash for each FST entry.
+		// - pathTable: Open-addressing hash table of FST entry indexes.
+		//              (0 == empty slot; the root directory isn't indexed.)
+		vector<int> pathParent;
+		vector<uint32_t> pathHash;
+		vector<int> pathTable;
+		bool pathIndexLoaded;
+
+		/**
+		 * Update a 32-bit FNV-1a hash with a path component.
+		 * ASCII characters are converted to lowercase.
+		 * @param hash Current hash.
+		 * @param str Path component.
+		 * @param len Length of str.
+		 * @return Updated hash.
+		 */
+		static inline uint32_t fnv1a_lower(uint32_t hash, const char *str, size_t len);
+
+		/**
+		 * Build the path index.
+		 * If the FST is corrupted, hasErrors will be set,
+		 * and the index will only contain the valid entries.
+		 */
+		void loadPathIndex(void);
+
+		/**
+		 * Check if an indexed FST entry matches a path.
+		 * @param idx	[in] FST entry index.
+		 * @param path	[in] Path.
+		 * @param len	[in] Length of path.
+		 * @param exact	[in] If true, compare case-sensitively.
+		 * @return True if the entry matches; false if not.
+		 */
+		bool path_matches(int idx, const char *path, size_t len, bool exact) const;
+
 		/**
 		 * Check if an fst_entry is a directory.
 		 * @return True if this is a directory; false if it's a regular file.
@@ -80,10 +126,11 @@ class GcnFstPrivate
 
 		/**
 		 * Get an FST entry's name.
-		 * @param fst_entry FST entry.
+		 * @param fst_entry	[in] FST entry.
+		 * @param pLen		[out, opt] Name length, in bytes.
 		 * @return Name, or nullptr if an error occurred.
 		 */
-		inline const char *entry_name(const GCN_FST_Entry *fst_entry) const;
+		inline const char *entry_name(const GCN_FST_Entry *fst_entry, uint32_t *pLen = nullptr) const;
 
 		/**
 		 * Get an FST entry.
@@ -93,9 +140,10 @@ class GcnFstPrivate
 		 *
 		 * @param idx		[in] FST entry index.
 		 * @param ppszName	[out, opt] Entry name. (Do not free this!)
+		 * @param pNameLen	[out, opt] Entry name length, in bytes.
 		 * @return FST entry, or nullptr on error.
 		 */
-		const GCN_FST_Entry *entry(int idx, const char **ppszName = nullptr) const;
+		const GCN_FST_Entry *entry(int idx, const char **ppszName = nullptr, uint32_t *pNameLen = nullptr) const;
 
 		/**
 		 * Find a path.
@@ -107,14 +155,16 @@ class GcnFstPrivate
 
 /** GcnFstPrivate **/
 
-GcnFstPrivate::GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offsetShift)
+GcnFstPrivate::GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offsetShift, bool borrowed)
 	: hasErrors(false)
 	, fstData(nullptr)
+	, fstData_owned(nullptr)
 	, fstData_sz(len)
 	, string_table_ptr(nullptr)
 	, string_table_sz(0)
 	, offsetShift(offsetShift)
 	, fstDirCount(0)
+	, pathIndexLoaded(false)
 {
 	if (len < sizeof(GCN_FST_Entry)) {
 		// Invalid FST length.
@@ -141,33 +191,36 @@ GcnFstPrivate::GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offse
 		return;
 	}
 
-	// Copy the FST data.
-	// NOTE: +1 for NULL termination.
-	uint8_t *fst8 = static_cast<uint8_t*>(malloc(fstData_sz + 1));
-	if (!fst8) {
-		// Could not allocate memory for the FST.
-		hasErrors = true;
-		return;
+	const uint8_t *fst8;
+	if (borrowed) {
+		// Use the caller's FST data directly.
+		// NOTE: The string table might not be NULL-terminated.
+		// entry_name() handles this.
+		fst8 = fstData;
+	} else {
+		// Copy the FST data.
+		// NOTE: +1 for NULL termination.
+		fstData_owned = static_cast<uint8_t*>(malloc(fstData_sz + 1));
+		if (!fstData_owned) {
+			// Could not allocate memory for the FST.
+			hasErrors = true;
+			return;
+		}
+		memcpy(fstData_owned, fstData, fstData_sz);
+		fstData_owned[fstData_sz] = 0; // Make sure the string table is NULL-terminated.
+		fst8 = fstData_owned;
 	}
-	memcpy(fst8, fstData, fstData_sz);
-	fst8[fstData_sz] = 0; // Make sure the string table is NULL-terminated.
-	this->fstData = reinterpret_cast<GCN_FST_Entry*>(fst8);
+	this->fstData = reinterpret_cast<const GCN_FST_Entry*>(fst8);
 
 	// Save a pointer to the string table.
-	string_table_ptr = reinterpret_cast<char*>(&fst8[string_table_offset]);
+	string_table_ptr = reinterpret_cast<const char*>(&fst8[string_table_offset]);
 	string_table_sz = fstData_sz - string_table_offset;
-
-#if !defined(_MSC_VER) || _MSC_VER >= 1700
-	// Reserve space in the string table.
-	// NOTE: file_count includes the root directory entry.
-	u8_string_table.reserve(file_count - 1);
-#endif
 }
 
 GcnFstPrivate::~GcnFstPrivate()
 {
 	assert(fstDirCount == 0);
-	free(fstData);
+	free(fstData_owned);
 }
 
 /**
@@ -181,33 +234,57 @@ inline bool GcnFstPrivate::is_dir(const GCN_FST_Entry *fst_entry)
 
 /**
  * Get an FST entry's name.
- * @param fst_entry FST entry.
+ * @param fst_entry	[in] FST entry.
+ * @param pLen		[out, opt] Name length, in bytes.
  * @return Name, or nullptr if an error occurred.
  */
-inline const char *GcnFstPrivate::entry_name(const GCN_FST_Entry *fst_entry) const
+inline const char *GcnFstPrivate::entry_name(const GCN_FST_Entry *fst_entry, uint32_t *pLen) const
 {
-	// FIXME: Is returning c_str from the iterator valid?
-
 	// Get the name entry from the string table.
 	uint32_t offset = be32_to_cpu(fst_entry->file_type_name_offset) & 0xFFFFFF;
 	if (offset >= string_table_sz) {
 		// Out of range.
+		if (pLen) {
+			*pLen = 0;
+		}
 		return nullptr;
 	}
 
+	const char *const str = &string_table_ptr[offset];
+	const uint32_t max_len = string_table_sz - offset;
+	const char *const str_end = static_cast<const char*>(memchr(str, 0, max_len));
+	if (str_end) {
+		// If the name is ASCII, it's already valid UTF-8,
+		// so it can be returned directly from the string table.
+		const char *p = str;
+		for (; p < str_end; p++) {
+			if (*p & 0x80)
+				break;
+		}
+		if (p == str_end) {
+			if (pLen) {
+				*pLen = (uint32_t)(str_end - str);
+			}
+			return str;
+		}
+	}
+
 	// Has this name already been converted to UTF-8?
+	// NOTE: Names that aren't NULL-terminated within the
+	// string table are also converted in order to add
+	// the NULL terminator.
 	unordered_map<uint32_t, string>::const_iterator iter = u8_string_table.find(offset);
-	if (iter != u8_string_table.end()) {
-		// Name has already been converted.
-		return iter->second.c_str();
+	if (iter == u8_string_table.end()) {
+		// Name has not been converted.
+		// Do the conversion now.
+		const int len = (str_end ? (int)(str_end - str) : (int)max_len);
+		string u8str = cp1252_sjis_to_utf8(str, len);
+		iter = const_cast<GcnFstPrivate*>(this)->u8_string_table.insert(std::make_pair(offset, u8str)).first;
 	}
 
-	// Name has not been converted.
-	// Do the conversion now.
-	const char *str = &string_table_ptr[offset];
-	int len = (int)strlen(str);	// TODO: Bounds checking.
-	string u8str = cp1252_sjis_to_utf8(str, len);
-	iter = const_cast<GcnFstPrivate*>(this)->u8_string_table.insert(std::make_pair(offset, u8str)).first;
+	if (pLen) {
+		*pLen = (uint32_t)iter->second.size();
+	}
 	return iter->second.c_str();
 }
 
@@ -219,9 +296,10 @@ inline const char *GcnFstPrivate::entry_name(const GCN_FST_Entry *fst_entry) con
  *
  * @param idx		[in] FST entry index.
  * @param ppszName	[out, opt] Entry name. (Do not free this!)
+ * @param pNameLen	[out, opt] Entry name length, in bytes.
  * @return FST entry, or nullptr on error.
  */
-const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
+const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName, uint32_t *pNameLen) const
 {
 	if (!fstData || idx < 0) {
 		// No FST, or idx is invalid.
@@ -238,9 +316,12 @@ const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
 		if (idx == 0) {
 			// Root directory has no name.
 			*ppszName = nullptr;
+			if (pNameLen) {
+				*pNameLen = 0;
+			}
 		} else {
 			// Get the entry's name.
-			*ppszName = entry_name(&fstData[idx]);
+			*ppszName = entry_name(&fstData[idx], pNameLen);
 		}
 	}
 
@@ -248,145 +329,260 @@ const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
 }
 
 /**
- * Find a path.
- * @param path Path. (Absolute paths only!)
- * @return fst_entry if found, or nullptr if not.
+ * Update a 32-bit FNV-1a hash with a path component.
+ * ASCII characters are converted to lowercase.
+ * @param hash Current hash.
+ * @param str Path component.
+ * @param len Length of str.
+ * @return Updated hash.
  */
-const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
+inline uint32_t GcnFstPrivate::fnv1a_lower(uint32_t hash, const char *str, size_t len)
 {
-	// TODO: Combine multiple slashes together.
-
-	if (!path) {
-		// Invalid path.
-		return nullptr;
-	} else if (!path[0] || (path[0] == '/' && !path[1])) {
-		// Empty path or "/".
-		// Return the root directory.
-		return this->entry(0, nullptr);
-	}
-
-	// Store the path as a temporary string.
-	string s_path;
-	if (path[0] != 0 && path[0] != '/') {
-		// Prepend a slash.
-		// (Relative paths aren't supported.)
-		s_path = '/';
-	}
-	s_path.append(path);
-
-	if (s_path.empty()) {
-		// Invalid path.
-		return nullptr;
+	// Each path component is preceded by a slash.
+	hash = (hash ^ '/') * 0x01000193U;
+	for (; len > 0; len--, str++) {
+		uint8_t chr = (uint8_t)*str;
+		if (chr >= 'A' && chr <= 'Z') {
+			chr += ('a' - 'A');
+		}
+		hash = (hash ^ chr) * 0x01000193U;
 	}
+	return hash;
+}
 
-	// If there's a trailing slash, remove it.
-	if (s_path[s_path.size()-1] == '/') {
-		s_path.resize(s_path.size()-1);
+/**
+ * Build the path index.
+ * If the FST is corrupted, hasErrors will be set,
+ * and the index will only contain the valid entries.
+ */
+void GcnFstPrivate::loadPathIndex(void)
+{
+	pathIndexLoaded = true;
+	if (!fstData) {
+		// No FST.
+		return;
 	}
 
-	// Get the root directory.
-	const GCN_FST_Entry *fst_entry = this->entry(0, nullptr);
-	if (!fst_entry) {
-		// Can't find the root directory.
-		return nullptr;
+	// NOTE: file_count includes the root directory entry,
+	// and it was validated by the constructor.
+	const int file_count = (int)be32_to_cpu(fstData[0].root_dir.file_count);
+	pathParent.resize(file_count);
+	pathHash.resize(file_count);
+	pathParent[0] = 0;
+	pathHash[0] = 0x811C9DC5U;
+
+	// Hash table size: Power of two, at least twice the number of entries.
+	unsigned int table_size = 64;
+	while (table_size < (unsigned int)file_count * 2) {
+		table_size <<= 1;
 	}
+	pathTable.assign(table_size, 0);
+	const unsigned int table_mask = table_size - 1;
+
+	// Directory stack.
+	// - first: Index *after* the last entry in the directory.
+	// - second: Directory index.
+	vector<std::pair<int, int> > dirStack;
+	dirStack.push_back(std::make_pair(file_count, 0));
+
+	for (int idx = 1; idx < file_count; idx++) {
+		// Leave any directories that end before this entry.
+		while (idx >= dirStack.back().first) {
+			dirStack.pop_back();
+		}
 
-	// Should not have "" or "/" here.
-	assert(!s_path.empty());
-	assert(s_path != "/");
-
-	// Skip the initial slash.
-	int idx = 1;	// Ignore the root directory.
-	// NOTE: This is the index *after* the last file.
-	int last_fst_idx = be32_to_cpu(fst_entry->root_dir.file_count);
-	size_t slash_pos = 0;
-	do {
-		size_t next_slash_pos = s_path.find('/', slash_pos + 1);
-		string path_component;
-		bool are_more_slashes = true;
-		if (next_slash_pos == string::npos) {
-			// No more slashes.
-			are_more_slashes = false;
-			path_component = s_path.substr(slash_pos + 1);
-		} else {
-			// Found another slash.
-			int sz = (int)(next_slash_pos - slash_pos - 1);
-			if (sz <= 0) {
-				// Empty path component.
-				slash_pos = next_slash_pos;
-				continue;
-			}
-			path_component = s_path.substr(slash_pos + 1, (size_t)sz);
+		const char *pName;
+		uint32_t name_len;
+		const GCN_FST_Entry *fst_entry = entry(idx, &pName, &name_len);
+		if (!fst_entry || !pName || name_len == 0) {
+			// Empty or invalid name.
+			hasErrors = true;
+			return;
 		}
 
-		if (path_component.empty()) {
-			// Empty path component.
-			slash_pos = next_slash_pos;
-			continue;
+		const int parent = dirStack.back().second;
+		const uint32_t hash = fnv1a_lower(pathHash[parent], pName, name_len);
+		pathParent[idx] = parent;
+		pathHash[idx] = hash;
+
+		// Add the entry to the hash table.
+		// NOTE: Entries are added in FST order, so if multiple
+		// entries have the same path, the first one is found first.
+		unsigned int slot = hash & table_mask;
+		while (pathTable[slot] != 0) {
+			slot = (slot + 1) & table_mask;
 		}
+		pathTable[slot] = idx;
 
-		// Search this directory for a matching path component.
-		bool found = false;
-		for (; idx < last_fst_idx; idx++) {
-			const char *pName;
-			fst_entry = this->entry(idx, &pName);
-			if (!fst_entry) {
-				// Invalid path.
-				return nullptr;
+		if (is_dir(fst_entry)) {
+			// NOTE: next_offset is the index *after* the
+			// last entry in the subdirectory.
+			const int next_idx = (int)be32_to_cpu(fst_entry->dir.next_offset);
+			if (next_idx <= idx || next_idx > dirStack.back().first) {
+				// Invalid subdirectory.
+				hasErrors = true;
+				return;
 			}
+			dirStack.push_back(std::make_pair(next_idx, idx));
+		}
+	}
+}
 
-			// TODO: Is GCN/Wii case-sensitive?
-			if (pName && !strcmp(path_component.c_str(), pName)) {
-				// Found a match.
-				found = true;
-				break;
-			}
+/**
+ * Check if an indexed FST entry matches a path.
+ * @param idx	[in] FST entry index.
+ * @param path	[in] Path.
+ * @param len	[in] Length of path.
+ * @param exact	[in] If true, compare case-sensitively.
+ * @return True if the entry matches; false if not.
+ */
+bool GcnFstPrivate::path_matches(int idx, const char *path, size_t len, bool exact) const
+{
+	// Compare path components from the end of the path,
+	// walking up the parent directories.
+	const char *end = path + len;
+	while (idx != 0) {
+		// Skip trailing slashes.
+		while (end > path && end[-1] == '/') {
+			end--;
+		}
+		if (end == path) {
+			// Path has fewer components than the entry.
+			return false;
+		}
 
-			// If this is a directory, skip it.
-			if (is_dir(fst_entry)) {
-				// NOTE: next_offset is the index *after* the
-				// last entry in the subdirectory, so we have to
-				// subtract 1 for proper enumeration.
-				idx = be32_to_cpu(fst_entry->dir.next_offset) - 1;
-			}
+		const char *start = end;
+		while (start > path && start[-1] != '/') {
+			start--;
 		}
 
-		if (!found) {
-			// No match.
-			return nullptr;
+		const char *pName;
+		uint32_t name_len;
+		if (!entry(idx, &pName, &name_len) || !pName ||
+		    name_len != (uint32_t)(end - start))
+		{
+			return false;
 		}
 
-		if (is_dir(fst_entry)) {
-			// Directory. Save the last_fst_idx.
-			last_fst_idx = be32_to_cpu(fst_entry->dir.next_offset);
-			idx++;
+		if (exact) {
+			if (memcmp(pName, start, name_len) != 0)
+				return false;
 		} else {
-			// File: Make sure there's no more slashes.
-			if (are_more_slashes) {
-				// More slashes. Not a match.
-				return nullptr;
+			for (uint32_t i = 0; i < name_len; i++) {
+				uint8_t a = (uint8_t)pName[i];
+				uint8_t b = (uint8_t)start[i];
+				if (a >= 'A' && a <= 'Z') a += ('a' - 'A');
+				if (b >= 'A' && b <= 'Z') b += ('a' - 'A');
+				if (a != b)
+					return false;
 			}
 		}
 
-		// Next slash.
-		slash_pos = next_slash_pos;
-	} while (slash_pos != string::npos);
+		end = start;
+		idx = pathParent[idx];
+	}
+
+	// The rest of the path must be slashes.
+	while (end > path && end[-1] == '/') {
+		end--;
+	}
+	return (end == path);
+}
+
+/**
+ * Find a path.
+ * @param path Path. (Absolute paths only!)
+ * @return fst_entry if found, or nullptr if not.
+ */
+const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
+{
+	if (!path) {
+		// Invalid path.
+		return nullptr;
+	}
+
+	// Hash the path.
+	// NOTE: Multiple slashes are combined together,
+	// and leading and trailing slashes are ignored.
+	uint32_t hash = 0x811C9DC5U;
+	const char *p = path;
+	bool is_root = true;
+	while (*p != 0) {
+		if (*p == '/') {
+			p++;
+			continue;
+		}
+		const char *start = p;
+		while (*p != 0 && *p != '/') {
+			p++;
+		}
+		hash = fnv1a_lower(hash, start, (size_t)(p - start));
+		is_root = false;
+	}
+	if (is_root) {
+		// Empty path or "/".
+		// Return the root directory.
+		return this->entry(0, nullptr);
+	}
+
+	if (!pathIndexLoaded) {
+		// Build the path index.
+		const_cast<GcnFstPrivate*>(this)->loadPathIndex();
+	}
+	if (pathTable.empty()) {
+		// No index.
+		return nullptr;
+	}
+
+	// TODO: Is GCN/Wii case-sensitive?
+	// An exact match is preferred. Otherwise, the first
+	// case-insensitive match in FST order is returned.
+	const size_t len = (size_t)(p - path);
+	const unsigned int table_mask = (unsigned int)pathTable.size() - 1;
+	int ci_idx = -1;
+	for (unsigned int slot = hash & table_mask; pathTable[slot] != 0;
+	     slot = (slot + 1) & table_mask)
+	{
+		const int idx = pathTable[slot];
+		if (pathHash[idx] != hash)
+			continue;
 
-	// Found the directory entry.
-	return fst_entry;
+		if (path_matches(idx, path, len, true)) {
+			// Exact match.
+			return this->entry(idx, nullptr);
+		} else if ((ci_idx < 0 || idx < ci_idx) && path_matches(idx, path, len, false)) {
+			// Case-insensitive match.
+			ci_idx = idx;
+		}
+	}
+
+	return (ci_idx >= 0 ? this->entry(ci_idx, nullptr) : nullptr);
 }
 
 /** GcnFst **/
 
 /**
  * Parse a GameCube FST.
+ * The FST data is copied.
  * @param fstData FST data.
  * @param len Length of fstData, in bytes.
  * @param offsetShift File offset shift. (0 = GCN, 2 = Wii)
  */
 GcnFst::GcnFst(const uint8_t *fstData, uint32_t len, uint8_t offsetShift)
 	: super()
-	, d(new GcnFstPrivate(fstData, len, offsetShift))
+	, d(new GcnFstPrivate(fstData, len, offsetShift, false))
+{ }
+
+/**
+ * Parse a GameCube FST.
+ * @param fstData FST data.
+ * @param len Length of fstData, in bytes.
+ * @param offsetShift File offset shift. (0 = GCN, 2 = Wii)
+ * @param borrowed If true, don't copy the FST data.
+ */
+GcnFst::GcnFst(const uint8_t *fstData, uint32_t len, uint8_t offsetShift, bool borrowed)
+	: super()
+	, d(new GcnFstPrivate(fstData, len, offsetShift, borrowed))
 { }
 
 GcnFst::~GcnFst()
@@ -451,7 +647,7 @@ IFst::Dir *GcnFst::opendir(const char *path)
 	// readdir() will automatically seek to the next entry.
 	dirp->entry.idx = dirp->dir_idx;
 	dirp->entry.type = DT_DIR;
-	dirp->entry.name = d->entry_name(fst_entry);
+	dirp->entry.name = d->entry_name(fst_entry, &dirp->entry.name_len);
 	// offset and size are not valid for directories.
 	dirp->entry.offset = 0;
 	dirp->entry.size = 0;
@@ -513,12 +709,14 @@ IFst::DirEnt *GcnFst::readdir(IFst::Dir *dirp)
 	}
 
 	const char *pName;
-	fst_entry = d->entry(idx, &pName);
+	uint32_t name_len;
+	fst_entry = d->entry(idx, &pName, &name_len);
 	dirp->entry.idx = idx;
 	if (!fst_entry) {
 		// No more entries.
 		dirp->entry.type = 0;
 		dirp->entry.name = nullptr;
+		dirp->entry.name_len = 0;
 		return nullptr;
 	} else if (!pName || pName[0] == 0) {
 		// Empty or NULL name. This is invalid.
@@ -526,6 +724,7 @@ IFst::DirEnt *GcnFst::readdir(IFst::Dir *dirp)
 		d->hasErrors = true;
 		dirp->entry.type = 0;
 		dirp->entry.name = nullptr;
+		dirp->entry.name_len = 0;
 		return nullptr;
 	}
 
@@ -533,6 +732,7 @@ IFst::DirEnt *GcnFst::readdir(IFst::Dir *dirp)
 	const bool is_fst_dir = d->is_dir(fst_entry);
 	dirp->entry.type = is_fst_dir ? DT_DIR : DT_REG;
 	dirp->entry.name = pName;
+	dirp->entry.name_len = name_len;
 	if (is_fst_dir) {
 		// offset and size are not valid for directories.
 		dirp->entry.offset = 0;
@@ -593,7 +793,7 @@ int GcnFst::find_file(const char *filename, DirEnt *dirent)
 	// Copy the relevant information to dirent.
 	const bool is_fst_dir = d->is_dir(fst_entry);
 	dirent->type = is_fst_dir ? DT_DIR : DT_REG;
-	dirent->name = d->entry_name(fst_entry);
+	dirent->name = d->entry_name(fst_entry, &dirent->name_len);
 	if (is_fst_dir) {
 		// offset and size are not valid for directories.
 		dirent->offset = 0;
@@ -33,11 +33,27 @@ class GcnFst : public LibRpBase::IFst
 	public:
 		/**
 		 * Parse a GameCube FST.
+		 * The FST data is copied.
 		 * @param fstData FST data.
 		 * @param len Length of fstData, in bytes.
 		 * @param offsetShift File offset shift. (0 = GCN, 2 = Wii)
 		 */
 		GcnFst(const uint8_t *fstData, uint32_t len, uint8_t offsetShift);
+
+		/**
+		 * Parse a GameCube FST.
+		 *
+		 * If borrowed is true, the FST data is used directly instead of
+		 * being copied, and it *must* remain valid while this GcnFst is
+		 * open. Filenames returned by readdir() and find_file() will point
+		 * into the FST string table wherever possible.
+		 *
+		 * @param fstData FST data.
+		 * @param len Length of fstData, in bytes.
+		 * @param offsetShift File offset shift. (0 = GCN, 2 = Wii)
+		 * @param borrowed If true, don't copy the FST data.
+		 */
+		GcnFst(const uint8_t *fstData, uint32_t len, uint8_t offsetShift, bool borrowed);
 		virtual ~GcnFst();
 
 	private:
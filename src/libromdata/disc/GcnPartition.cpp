@@ -106,6 +106,35 @@ size_t GcnPartition::read(void *ptr, size_t size)
 	return d->discReader->read(ptr, size);
 }
 
+/**
+ * Read data from the specified position in the partition.
+ * This does not use the partition position, so it's
+ * thread-safe as long as the underlying IDiscReader's
+ * pread() is thread-safe.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GcnPartition::pread(int64_t pos, void *ptr, size_t size)
+{
+	RP_D(GcnPartition);
+	assert(d->discReader != nullptr);
+	assert(d->discReader->isOpen());
+	if (!d->discReader || !d->discReader->isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Partitions are stored as-is.
+	// TODO: data_size checks?
+	size_t ret = d->discReader->pread(d->data_offset + pos, ptr, size);
+	if (ret != size) {
+		m_lastError = d->discReader->lastError();
+	}
+	return ret;
+}
+
 /**
  * Set the partition position.
  * @param pos Partition position.
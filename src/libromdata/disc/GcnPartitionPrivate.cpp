@@ -50,6 +50,7 @@ GcnPartitionPrivate::GcnPartitionPrivate(GcnPartition *q, IDiscReader *discReade
 	, data_size(-1)
 	, bootLoaded(false)
 	, fst(nullptr)
+	, fstData(nullptr)
 {
 	// Clear the various structs.
 	memset(&bootBlock, 0, sizeof(bootBlock));
@@ -69,6 +70,7 @@ GcnPartitionPrivate::GcnPartitionPrivate(GcnPartition *q, IDiscReader *discReade
 GcnPartitionPrivate::~GcnPartitionPrivate()
 {
 	delete fst;
+	free(fstData);
 }
 
 /**
@@ -175,7 +177,6 @@ int GcnPartitionPrivate::loadFst(void)
 	}
 
 	// Read the FST.
-	// TODO: Eliminate the extra copy?
 	uint32_t fstData_len = bootBlock.fst_size << offsetShift;
 	uint8_t *fstData = static_cast<uint8_t*>(malloc(fstData_len));
 	if (!fstData) {
@@ -192,8 +193,9 @@ int GcnPartitionPrivate::loadFst(void)
 	}
 
 	// Create the GcnFst.
-	fst = new GcnFst(fstData, fstData_len, offsetShift);
-	free(fstData);	// TODO: Eliminate the extra copy?
+	// The FST data is borrowed by GcnFst instead of being copied.
+	fst = new GcnFst(fstData, fstData_len, offsetShift, true);
+	this->fstData = fstData;
 	return 0;
 }
 
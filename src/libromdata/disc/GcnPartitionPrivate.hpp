@@ -78,7 +78,10 @@ class GcnPartitionPrivate
 		int loadBootBlockAndInfo(void);
 
 		// Filesystem table.
+		// NOTE: fst borrows fstData, so fstData must be
+		// freed after fst is deleted.
 		GcnFst *fst;
+		uint8_t *fstData;
 
 		/**
 		 * Load the FST.
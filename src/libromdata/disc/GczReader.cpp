@@ -0,0 +1,539 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * GczReader.cpp: GameCube/Wii GCZ disc image reader.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// References:
+// - https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/DiscIO/CompressedBlob.cpp
+// - https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/DiscIO/CompressedBlob.h
+
+#include "GczReader.hpp"
+#include "librpbase/disc/SparseDiscReader_p.hpp"
+#include "gcz.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/file/IRpFile.hpp"
+#include "librpbase/threads/Mutex.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
+using namespace LibRpBase;
+
+// zlib for uncompress()
+#include <zlib.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData {
+
+class GczReaderPrivate : public SparseDiscReaderPrivate {
+	public:
+		GczReaderPrivate(GczReader *q, IRpFile *file);
+		virtual ~GczReaderPrivate();
+
+	private:
+		typedef SparseDiscReaderPrivate super;
+		RP_DISABLE_COPY(GczReaderPrivate)
+
+	public:
+		// GCZ header. (byteswapped to host-endian)
+		GczHeader gczHeader;
+
+		// Block pointers. (host-endian)
+		// Relative to dataOffset. If GCZ_BLOCK_UNCOMPRESSED
+		// is set, the block is stored uncompressed.
+		vector<uint64_t> blockPointers;
+
+		// Starting address of the block data.
+		int64_t dataOffset;
+
+		/**
+		 * Get the physical location of a block.
+		 * @param blockIdx	[in] Block index.
+		 * @param pPhysPos	[out] Physical address.
+		 * @param pPhysSize	[out] Physical size.
+		 * @param pCompressed	[out] True if the block is compressed.
+		 * @return True on success; false if the block index or block pointer is invalid.
+		 */
+		bool getBlockLocation(uint32_t blockIdx, int64_t *pPhysPos,
+			uint32_t *pPhysSize, bool *pCompressed) const;
+
+		/**
+		 * Read and decompress a full block.
+		 * This function is thread-safe.
+		 * @param blockIdx	[in] Block index.
+		 * @param out		[out] Output buffer. (Must be at least block_size bytes.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressBlock(uint32_t blockIdx, uint8_t *out) const;
+
+	public:
+		/** Decompressed block cache. **/
+
+		// Used for partial block reads. SparseDiscReader splits
+		// blocks larger than its cache line size, so without this,
+		// each line would decompress the entire block again.
+		static const unsigned int BLOCK_CACHE_COUNT = 4;
+		struct BlockCacheEntry {
+			uint32_t blockIdx;	// Block index. (~0U if empty)
+			uint32_t lastUsed;	// LRU tick.
+			unique_ptr<uint8_t[]> buf;	// Decompressed block data.
+		};
+		BlockCacheEntry blockCache[BLOCK_CACHE_COUNT];
+		uint32_t blockCacheTick;
+		Mutex blockCacheMutex;
+
+		/**
+		 * Get a decompressed block from the block cache.
+		 * blockCacheMutex must be locked by the caller.
+		 * @param blockIdx Block index.
+		 * @return Block cache entry, or nullptr on error.
+		 */
+		const BlockCacheEntry *getCachedBlock(uint32_t blockIdx);
+
+	public:
+		/** Parallel decompression. **/
+
+		// Thread pool for readBlocks().
+		// Created on first use.
+		ThreadPool *threadPool;
+		Mutex threadPoolMutex;
+
+		// readBlocks() work item parameters.
+		struct DecompressJob {
+			const GczReaderPrivate *d;
+			uint32_t firstIdx;
+			uint8_t *ptr;
+			int *results;		// One per block.
+		};
+
+		/**
+		 * Decompress a single block for readBlocks().
+		 * @param param DecompressJob.
+		 * @param idx Block index, relative to firstIdx.
+		 */
+		static void decompressBlockProc(void *param, unsigned int idx);
+};
+
+/** GczReaderPrivate **/
+
+GczReaderPrivate::GczReaderPrivate(GczReader *q, IRpFile *file)
+	: super(q, file)
+	, dataOffset(0)
+	, blockCacheTick(0)
+	, threadPool(nullptr)
+{
+	// Clear the GCZ header struct.
+	memset(&gczHeader, 0, sizeof(gczHeader));
+	for (unsigned int i = 0; i < BLOCK_CACHE_COUNT; i++) {
+		blockCache[i].blockIdx = ~0U;
+		blockCache[i].lastUsed = 0;
+	}
+
+	if (!this->file) {
+		// File could not be dup()'d.
+		return;
+	}
+
+	// Read the GCZ header.
+	this->file->rewind();
+	size_t sz = this->file->read(&gczHeader, sizeof(gczHeader));
+	if (sz != sizeof(gczHeader) ||
+	    GczReader::isDiscSupported_static(reinterpret_cast<const uint8_t*>(&gczHeader), sizeof(gczHeader)) < 0)
+	{
+		// Error reading the GCZ header,
+		// or the GCZ header is invalid.
+		delete this->file;
+		this->file = nullptr;
+		q->m_lastError = EIO;
+		return;
+	}
+
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+	// Byteswap the header.
+	gczHeader.magic			= le32_to_cpu(gczHeader.magic);
+	gczHeader.sub_type		= le32_to_cpu(gczHeader.sub_type);
+	gczHeader.compressed_data_size	= le64_to_cpu(gczHeader.compressed_data_size);
+	gczHeader.data_size		= le64_to_cpu(gczHeader.data_size);
+	gczHeader.block_size		= le32_to_cpu(gczHeader.block_size);
+	gczHeader.num_blocks		= le32_to_cpu(gczHeader.num_blocks);
+#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+
+	// The blocks must cover the entire disc,
+	// and the block tables must fit in the file.
+	const uint32_t num_blocks = gczHeader.num_blocks;
+	dataOffset = (int64_t)sizeof(gczHeader) +
+		((int64_t)num_blocks * (sizeof(uint64_t) + sizeof(uint32_t)));
+	if (gczHeader.data_size > (uint64_t)num_blocks * gczHeader.block_size ||
+	    dataOffset > this->file->size())
+	{
+		// Invalid GCZ header.
+		delete this->file;
+		this->file = nullptr;
+		q->m_lastError = EIO;
+		return;
+	}
+
+	// Read the block pointers.
+	// NOTE: The Adler-32 hashes aren't needed for reading.
+	blockPointers.resize(num_blocks);
+	const size_t ptrs_sz = num_blocks * sizeof(uint64_t);
+	sz = this->file->read(blockPointers.data(), ptrs_sz);
+	if (sz != ptrs_sz) {
+		// Error reading the block pointers.
+		blockPointers.clear();
+		delete this->file;
+		this->file = nullptr;
+		q->m_lastError = EIO;
+		return;
+	}
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+	for (auto iter = blockPointers.begin(); iter != blockPointers.end(); ++iter) {
+		*iter = le64_to_cpu(*iter);
+	}
+#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+
+	block_size = gczHeader.block_size;
+	disc_size = (int64_t)gczHeader.data_size;
+
+	// Reset the disc position.
+	pos = 0;
+}
+
+GczReaderPrivate::~GczReaderPrivate()
+{
+	delete threadPool;
+}
+
+/**
+ * Get the physical location of a block.
+ * @param blockIdx	[in] Block index.
+ * @param pPhysPos	[out] Physical address.
+ * @param pPhysSize	[out] Physical size.
+ * @param pCompressed	[out] True if the block is compressed.
+ * @return True on success; false if the block index or block pointer is invalid.
+ */
+bool GczReaderPrivate::getBlockLocation(uint32_t blockIdx, int64_t *pPhysPos,
+	uint32_t *pPhysSize, bool *pCompressed) const
+{
+	if (blockIdx >= blockPointers.size()) {
+		// Out of range.
+		return false;
+	}
+
+	// The physical size is the distance to the next block.
+	// The last block ends at the end of the data area.
+	const uint64_t blockPtr = blockPointers[blockIdx];
+	const uint64_t start = blockPtr & ~GCZ_BLOCK_UNCOMPRESSED;
+	const uint64_t end = (blockIdx + 1 < blockPointers.size()
+		? (blockPointers[blockIdx + 1] & ~GCZ_BLOCK_UNCOMPRESSED)
+		: gczHeader.compressed_data_size);
+	if (end < start || end - start > compressBound(block_size)) {
+		// Invalid block pointer.
+		return false;
+	}
+
+	*pPhysPos = dataOffset + (int64_t)start;
+	*pPhysSize = (uint32_t)(end - start);
+	*pCompressed = !(blockPtr & GCZ_BLOCK_UNCOMPRESSED);
+	return true;
+}
+
+/**
+ * Read and decompress a full block.
+ * This function is thread-safe.
+ * @param blockIdx	[in] Block index.
+ * @param out		[out] Output buffer. (Must be at least block_size bytes.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GczReaderPrivate::decompressBlock(uint32_t blockIdx, uint8_t *out) const
+{
+	int64_t physPos;
+	uint32_t physSize;
+	bool compressed;
+	if (!getBlockLocation(blockIdx, &physPos, &physSize, &compressed)) {
+		// Invalid block.
+		return -EIO;
+	}
+
+	// NOTE: Using pread() so multiple threads can read blocks at once.
+	size_t out_sz;
+	if (!compressed) {
+		// Uncompressed block.
+		if (physSize > block_size) {
+			// Block is too big.
+			return -EIO;
+		}
+		if (file->pread(physPos, out, physSize) != physSize) {
+			// Error reading the block.
+			return -EIO;
+		}
+		out_sz = physSize;
+	} else {
+		// Compressed block.
+		unique_ptr<uint8_t[]> cbuf(new uint8_t[physSize]);
+		if (file->pread(physPos, cbuf.get(), physSize) != physSize) {
+			// Error reading the block.
+			return -EIO;
+		}
+
+		uLongf destLen = block_size;
+		int ret = uncompress(out, &destLen, cbuf.get(), physSize);
+		if (ret != Z_OK) {
+			// Decompression error.
+			return -EIO;
+		}
+		out_sz = destLen;
+	}
+
+	// Only the last block can be shorter than the block size.
+	if (out_sz < block_size) {
+		if (blockIdx + 1 < blockPointers.size()) {
+			// Short block in the middle of the disc.
+			return -EIO;
+		}
+		memset(&out[out_sz], 0, block_size - out_sz);
+	}
+	return 0;
+}
+
+/**
+ * Get a decompressed block from the block cache.
+ * blockCacheMutex must be locked by the caller.
+ * @param blockIdx Block index.
+ * @return Block cache entry, or nullptr on error.
+ */
+const GczReaderPrivate::BlockCacheEntry *GczReaderPrivate::getCachedBlock(uint32_t blockIdx)
+{
+	// Check if the block is already cached.
+	BlockCacheEntry *lru = &blockCache[0];
+	for (unsigned int i = 0; i < BLOCK_CACHE_COUNT; i++) {
+		BlockCacheEntry *const entry = &blockCache[i];
+		if (entry->blockIdx == blockIdx) {
+			// Cache hit.
+			entry->lastUsed = ++blockCacheTick;
+			return entry;
+		}
+		if (entry->blockIdx == ~0U ||
+		    (lru->blockIdx != ~0U &&
+		     (uint32_t)(blockCacheTick - entry->lastUsed) >
+		     (uint32_t)(blockCacheTick - lru->lastUsed)))
+		{
+			// Empty entry, or older than the current LRU entry.
+			lru = entry;
+		}
+	}
+
+	// Cache miss. Decompress the block into the LRU entry.
+	if (!lru->buf) {
+		lru->buf.reset(new uint8_t[block_size]);
+	}
+	lru->blockIdx = ~0U;
+	if (decompressBlock(blockIdx, lru->buf.get()) != 0) {
+		// Error decompressing the block.
+		return nullptr;
+	}
+	lru->blockIdx = blockIdx;
+	lru->lastUsed = ++blockCacheTick;
+	return lru;
+}
+
+/**
+ * Decompress a single block for readBlocks().
+ * @param param DecompressJob.
+ * @param idx Block index, relative to firstIdx.
+ */
+void GczReaderPrivate::decompressBlockProc(void *param, unsigned int idx)
+{
+	const DecompressJob *const job = static_cast<const DecompressJob*>(param);
+	const unsigned int block_size = job->d->block_size;
+	job->results[idx] = job->d->decompressBlock(job->firstIdx + idx,
+		job->ptr + ((size_t)idx * block_size));
+}
+
+/** GczReader **/
+
+GczReader::GczReader(IRpFile *file)
+	: super(new GczReaderPrivate(this, file))
+{ }
+
+/**
+ * Is a disc image supported by this class?
+ * @param pHeader Disc image header.
+ * @param szHeader Size of header.
+ * @return Class-specific disc format ID (>= 0) if supported; -1 if not.
+ */
+int GczReader::isDiscSupported_static(const uint8_t *pHeader, size_t szHeader)
+{
+	if (szHeader < sizeof(GczHeader)) {
+		// Not enough data to check.
+		return -1;
+	}
+
+	// Check the GCZ magic.
+	const GczHeader *const gczHeader = reinterpret_cast<const GczHeader*>(pHeader);
+	if (gczHeader->magic != cpu_to_le32(GCZ_MAGIC)) {
+		// Invalid magic.
+		return -1;
+	}
+
+	// Check the block size and block count.
+	const unsigned int block_size = le32_to_cpu(gczHeader->block_size);
+	if (block_size < GCZ_BLOCK_SIZE_MIN || block_size > GCZ_BLOCK_SIZE_MAX ||
+	    gczHeader->num_blocks == 0)
+	{
+		// Block size is out of range, or there are no blocks.
+		return -1;
+	}
+
+	// This is a valid GCZ image.
+	return 0;
+}
+
+/**
+ * Is a disc image supported by this object?
+ * @param pHeader Disc image header.
+ * @param szHeader Size of header.
+ * @return Class-specific system ID (>= 0) if supported; -1 if not.
+ */
+int GczReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
+{
+	return isDiscSupported_static(pHeader, szHeader);
+}
+
+/** SparseDiscReader functions. **/
+
+/**
+ * Read the specified block.
+ *
+ * This can read either a full block or a partial block.
+ * For a full block, set pos = 0 and size = block_size.
+ *
+ * @param blockIdx	[in] Block index.
+ * @param ptr		[out] Output data buffer.
+ * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+ * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+ * @return Number of bytes read, or -1 if the block index is invalid.
+ */
+int GczReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size)
+{
+	// Read 'size' bytes of block 'blockIdx', starting at 'pos'.
+	// NOTE: This can only be called by SparseDiscReader,
+	// so the main assertions are already checked there.
+	RP_D(GczReader);
+	assert(pos >= 0 && pos < (int)d->block_size);
+	assert(size <= d->block_size);
+	// TODO: Make sure overflow doesn't occur.
+	assert((int64_t)(pos + size) <= (int64_t)d->block_size);
+	if (pos < 0 || pos >= (int)d->block_size || size > d->block_size ||
+	    (int64_t)(pos + size) > (int64_t)d->block_size)
+	{
+		// pos+size is out of range.
+		return -1;
+	}
+
+	// TODO: "unlikely" hint.
+	if (size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	if (pos == 0 && size == d->block_size) {
+		// Full block. Decompress it directly into the output buffer.
+		int ret = d->decompressBlock(blockIdx, static_cast<uint8_t*>(ptr));
+		if (ret != 0) {
+			m_lastError = -ret;
+			return -1;
+		}
+		return (int)size;
+	}
+
+	// Partial block. Use the decompressed block cache.
+	MutexLocker lock(d->blockCacheMutex);
+	const GczReaderPrivate::BlockCacheEntry *const entry = d->getCachedBlock(blockIdx);
+	if (!entry) {
+		// Error decompressing the block.
+		m_lastError = EIO;
+		return -1;
+	}
+	memcpy(ptr, &entry->buf[pos], size);
+	return (int)size;
+}
+
+/**
+ * Read multiple consecutive full blocks.
+ * Blocks are decompressed in parallel using a thread pool.
+ * @param firstIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+ * @return Number of bytes read. (Less than count * block_size on error.)
+ */
+size_t GczReader::readBlocks(uint32_t firstIdx, unsigned int count, void *ptr)
+{
+	RP_D(GczReader);
+	if (count == 0) {
+		// Nothing to read.
+		return 0;
+	} else if (count == 1) {
+		// Single block. No need to use the thread pool.
+		int ret = readBlock(firstIdx, ptr, 0, d->block_size);
+		return (ret > 0 ? (size_t)ret : 0);
+	}
+
+	// Create the thread pool if it hasn't been created yet.
+	ThreadPool *pool;
+	{
+		MutexLocker lock(d->threadPoolMutex);
+		if (!d->threadPool) {
+			d->threadPool = new ThreadPool();
+		}
+		pool = d->threadPool;
+	}
+
+	// Decompress the blocks.
+	// NOTE: ThreadPool::run() serializes concurrent calls.
+	unique_ptr<int[]> results(new int[count]);
+	GczReaderPrivate::DecompressJob job;
+	job.d = d;
+	job.firstIdx = firstIdx;
+	job.ptr = static_cast<uint8_t*>(ptr);
+	job.results = results.get();
+	pool->run(count, GczReaderPrivate::decompressBlockProc, &job);
+
+	// Return the number of blocks that were
+	// decompressed before the first error.
+	unsigned int i;
+	for (i = 0; i < count; i++) {
+		if (results[i] != 0) {
+			m_lastError = -results[i];
+			break;
+		}
+	}
+	return (size_t)i * d->block_size;
+}
+
+}
@@ -22,6 +22,7 @@
 #include "librpbase/disc/SparseDiscReader_p.hpp"
 
 #include "../cdrom_structs.h"
+#include "Cdrom2352Reader.hpp"
 #include "IsoPartition.hpp"
 
 // librpbase
@@ -29,6 +30,8 @@
 #include "librpbase/TextFuncs.hpp"
 #include "librpbase/file/IRpFile.hpp"
 #include "librpbase/file/RelatedFile.hpp"
+#include "librpbase/threads/Mutex.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
 using namespace LibRpBase;
 
 // C includes.
@@ -46,9 +49,11 @@ using namespace LibRpBase;
 #endif
 
 // C++ includes.
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
@@ -83,8 +88,8 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 			// TODO: Mode1/Mode2 designation?
 			// TODO: Data vs. audio?
 			string filename;		// Relative to the .gdi file. Cleared on error.
-			IRpFile *file;
 		};
+		// Sorted by blockStart.
 		vector<BlockRange> blockRanges;
 
 		// Track to blockRanges mappings.
@@ -92,6 +97,26 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 		// Value = pointer to BlockRange in blockRanges.
 		vector<BlockRange*> trackMappings;
 
+		/** Track file pool. **/
+
+		// Track files are opened when they're first read.
+		// At most TRACK_POOL_SIZE track files are kept open;
+		// the least recently used file is closed if another
+		// track has to be opened. Files are reference-counted,
+		// so a file that's closed while it's being read is
+		// deleted once the read is finished.
+		static const unsigned int TRACK_POOL_SIZE = 4;
+		struct TrackFile {
+			uint8_t trackNumber;	// Track number. (0 if unused)
+			uint32_t lastUsed;	// LRU tick.
+			shared_ptr<IRpFile> file;
+		};
+		TrackFile trackPool[TRACK_POOL_SIZE];
+		uint32_t trackPoolTick;
+
+		// Locks trackPool[] and the block ranges' blockEnd values.
+		Mutex trackPoolMutex;
+
 		/**
 		 * Close all opened files.
 		 */
@@ -107,10 +132,29 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 
 		/**
 		 * Open a track.
-		 * @param trackNumber Track number. (starts with 1)
+		 * trackPoolMutex must be locked by the caller.
+		 * @param trackNumber	[in] Track number. (starts with 1)
+		 * @param pFile		[out,opt] Track file.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int openTrack(int trackNumber);
+		int openTrack_locked(int trackNumber, shared_ptr<IRpFile> *pFile = nullptr);
+
+		/**
+		 * Open a track.
+		 * @param trackNumber	[in] Track number. (starts with 1)
+		 * @param pFile		[out,opt] Track file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int openTrack(int trackNumber, shared_ptr<IRpFile> *pFile = nullptr);
+
+		/**
+		 * Find the block range containing a block.
+		 * The track is opened if necessary.
+		 * @param blockIdx	[in] Block index.
+		 * @param file		[out] Track file.
+		 * @return Block range, or nullptr if the block isn't in any data track.
+		 */
+		const BlockRange *findBlockRange(uint32_t blockIdx, shared_ptr<IRpFile> &file);
 };
 
 /** GdiReaderPrivate **/
@@ -118,7 +162,13 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 GdiReaderPrivate::GdiReaderPrivate(GdiReader *q, IRpFile *file)
 	: super(q, file)
 	, blockCount(0)
+	, trackPoolTick(0)
 {
+	for (unsigned int i = 0; i < TRACK_POOL_SIZE; i++) {
+		trackPool[i].trackNumber = 0;
+		trackPool[i].lastUsed = 0;
+	}
+
 	if (!this->file) {
 		// File could not be dup()'d.
 		return;
@@ -163,6 +213,7 @@ GdiReaderPrivate::GdiReaderPrivate(GdiReader *q, IRpFile *file)
 	}
 
 	// Open track 03 (primary data track) and the last data track.
+	// Other tracks are opened when they're first read.
 	if (trackMappings.size() >= 3) {
 		ret = openTrack(3);
 		if (ret != 0) {
@@ -222,8 +273,9 @@ GdiReaderPrivate::~GdiReaderPrivate()
  */
 void GdiReaderPrivate::close(void)
 {
-	for (auto iter = blockRanges.begin(); iter != blockRanges.end(); ++iter) {
-		delete iter->file;
+	for (unsigned int i = 0; i < TRACK_POOL_SIZE; i++) {
+		trackPool[i].trackNumber = 0;
+		trackPool[i].file.reset();
 	}
 	blockRanges.clear();
 	trackMappings.clear();
@@ -334,23 +386,34 @@ int GdiReaderPrivate::parseGdiFile(char *gdibuf)
 		// FIXME: UTF-8 or Latin-1?
 		filename[sizeof(filename)-1] = 0;
 		blockRange.filename = latin1_to_utf8(filename, -1);
-		blockRange.file = nullptr;
 
 		// Save the track mapping.
+		// NOTE: This is updated after sorting.
 		trackMappings[trackNumber-1] = &blockRange;
 	}
 
+	// Sort the block ranges by LBA so findBlockRange()
+	// can use a binary search, then update the track mappings.
+	std::sort(blockRanges.begin(), blockRanges.end(),
+		[](const BlockRange &a, const BlockRange &b) {
+			return (a.blockStart < b.blockStart);
+		});
+	for (auto iter = blockRanges.begin(); iter != blockRanges.end(); ++iter) {
+		trackMappings[iter->trackNumber-1] = &(*iter);
+	}
+
 	// Done parsing the GDI.
-	// TODO: Sort by LBA?
 	return 0;
 }
 
 /**
  * Open a track.
- * @param trackNumber Track number. (starts with 1)
+ * trackPoolMutex must be locked by the caller.
+ * @param trackNumber	[in] Track number. (starts with 1)
+ * @param pFile		[out,opt] Track file.
  * @return 0 on success; negative POSIX error code on error.
  */
-int GdiReaderPrivate::openTrack(int trackNumber)
+int GdiReaderPrivate::openTrack_locked(int trackNumber, shared_ptr<IRpFile> *pFile)
 {
 	assert(trackNumber > 0);
 	assert(trackNumber <= 99);
@@ -372,9 +435,26 @@ int GdiReaderPrivate::openTrack(int trackNumber)
 		return -ENOENT;
 	}
 
-	if (blockRange->file) {
-		// File is already open.
-		return 0;
+	// Check if the file is already open.
+	TrackFile *lru = &trackPool[0];
+	for (unsigned int i = 0; i < TRACK_POOL_SIZE; i++) {
+		TrackFile *const entry = &trackPool[i];
+		if (entry->trackNumber == trackNumber) {
+			// File is already open.
+			entry->lastUsed = ++trackPoolTick;
+			if (pFile) {
+				*pFile = entry->file;
+			}
+			return 0;
+		}
+		if (entry->trackNumber == 0 ||
+		    (lru->trackNumber != 0 &&
+		     (uint32_t)(trackPoolTick - entry->lastUsed) >
+		     (uint32_t)(trackPoolTick - lru->lastUsed)))
+		{
+			// Unused entry, or older than the current LRU entry.
+			lru = entry;
+		}
 	}
 
 	// Separate the file extension.
@@ -413,11 +493,69 @@ int GdiReaderPrivate::openTrack(int trackNumber)
 	}
 
 	// File opened.
+	// Replace the least recently used file in the pool.
 	blockRange->blockEnd = blockRange->blockStart + (unsigned int)(fileSize / blockRange->sectorSize) - 1;
-	blockRange->file = file;
+	lru->trackNumber = (uint8_t)trackNumber;
+	lru->lastUsed = ++trackPoolTick;
+	lru->file.reset(file);
+	if (pFile) {
+		*pFile = lru->file;
+	}
 	return 0;
 }
 
+/**
+ * Open a track.
+ * @param trackNumber	[in] Track number. (starts with 1)
+ * @param pFile		[out,opt] Track file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GdiReaderPrivate::openTrack(int trackNumber, shared_ptr<IRpFile> *pFile)
+{
+	MutexLocker lock(trackPoolMutex);
+	return openTrack_locked(trackNumber, pFile);
+}
+
+/**
+ * Find the block range containing a block.
+ * The track is opened if necessary.
+ * @param blockIdx	[in] Block index.
+ * @param file		[out] Track file.
+ * @return Block range, or nullptr if the block isn't in any data track.
+ */
+const GdiReaderPrivate::BlockRange *GdiReaderPrivate::findBlockRange(uint32_t blockIdx, shared_ptr<IRpFile> &file)
+{
+	// Find the last block range that starts at or before blockIdx.
+	// Data tracks don't overlap, so it's the only one that can
+	// contain the block.
+	auto iter = std::upper_bound(blockRanges.begin(), blockRanges.end(), blockIdx,
+		[](uint32_t blockIdx, const BlockRange &blockRange) {
+			return (blockIdx < blockRange.blockStart);
+		});
+	if (iter == blockRanges.begin()) {
+		// Block is before the first data track.
+		return nullptr;
+	}
+	--iter;
+
+	// Get the track file.
+	// This also determines blockEnd if the track
+	// hasn't been opened yet.
+	MutexLocker lock(trackPoolMutex);
+	if (openTrack_locked(iter->trackNumber, &file) != 0) {
+		// Unable to open the track.
+		return nullptr;
+	}
+
+	// Check the end block.
+	if (blockIdx > iter->blockEnd) {
+		// Block is in a gap after this track.
+		file.reset();
+		return nullptr;
+	}
+	return &(*iter);
+}
+
 /** GdiReader **/
 
 GdiReader::GdiReader(IRpFile *file)
@@ -514,55 +652,87 @@ int GdiReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size)
 	}
 
 	// Find the block.
-	// TODO: Cache this lookup somewhere or something.
-	const GdiReaderPrivate::BlockRange *blockRange = nullptr;
-	for (auto iter = d->blockRanges.cbegin(); iter != d->blockRanges.cend(); ++iter) {
-		// NOTE: Using volatile because it can change in d->openTrack().
-		const volatile GdiReaderPrivate::BlockRange *const vbr = &(*iter);
-		if (blockIdx < vbr->blockStart) {
-			// Not in this track.
-			continue;
-		}
-
-		// Is the track loaded?
-		if (vbr->blockEnd == 0) {
-			// Track isn't loaded. Load it.
-			int ret = d->openTrack(vbr->trackNumber);
-			if (ret != 0) {
-				// Unable to load the track.
-				// Skip for now.
-				continue;
-			}
-		}
-
-		// Check the end block.
-		if (vbr->blockEnd != 0 && blockIdx <= vbr->blockEnd) {
-			// Found the track.
-			blockRange = (const GdiReaderPrivate::BlockRange*)vbr;
-			break;
-		}
-	}
-
+	shared_ptr<IRpFile> file;
+	const GdiReaderPrivate::BlockRange *const blockRange = d->findBlockRange(blockIdx, file);
 	if (!blockRange) {
 		// Not found in any block range.
 		return 0;
 	}
 
-	assert(blockRange->file != nullptr);
-	if (!blockRange->file) {
-		// File *still* isn't open...
-		return 0;
-	}
-
 	// Go to the block.
 	// FIXME: Read the whole block so we can determine if this is Mode1 or Mode2.
 	// Mode1 data starts at byte 16; Mode2 data starts at byte 24.
-	const int64_t phys_pos = ((int64_t)(blockIdx - blockRange->blockStart) * blockRange->sectorSize) + 16 + pos;
-	size_t sz_read = blockRange->file->seekAndRead(phys_pos, ptr, size);
-	m_lastError = blockRange->file->lastError();
+	// 2048-byte sectors don't have a header.
+	// NOTE: Using pread() so multiple threads can read blocks at once.
+	const int dataOffset = (blockRange->sectorSize == 2352 ? 16 : 0);
+	const int64_t phys_pos = ((int64_t)(blockIdx - blockRange->blockStart) * blockRange->sectorSize) + dataOffset + pos;
+	size_t sz_read = file->pread(phys_pos, ptr, size);
+	if (sz_read != size) {
+		m_lastError = file->lastError();
+	}
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple consecutive full blocks.
+ * Runs are split at track boundaries, and each run
+ * is read with Cdrom2352Reader::readUserData().
+ * @param firstIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+ * @return Number of bytes read. (Less than count * block_size on error.)
+ */
+size_t GdiReader::readBlocks(uint32_t firstIdx, unsigned int count, void *ptr)
+{
+	RP_D(GdiReader);
+	assert(firstIdx < d->blockCount);
+	assert(count <= d->blockCount - firstIdx);
+	if (firstIdx >= d->blockCount) {
+		// Out of range.
+		return 0;
+	} else if (count > d->blockCount - firstIdx) {
+		// Read as many blocks as possible.
+		count = d->blockCount - firstIdx;
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (count > 0) {
+		// Find the track containing the next block.
+		// NOTE: Keep a reference to the track file, since the
+		// pool might close it while it's being read.
+		shared_ptr<IRpFile> file;
+		const GdiReaderPrivate::BlockRange *const blockRange = d->findBlockRange(firstIdx, file);
+		if (!blockRange) {
+			// Not found in any block range.
+			break;
+		}
+
+		// Don't read past the end of the track.
+		unsigned int run = blockRange->blockEnd - firstIdx + 1;
+		if (run > count) {
+			run = count;
+		}
+
+		const int64_t phys_pos = (int64_t)(firstIdx - blockRange->blockStart) * blockRange->sectorSize;
+		int err = 0;
+		const size_t sz_read = Cdrom2352Reader::readUserData(file.get(), phys_pos,
+			blockRange->sectorSize, run, ptr8, &err);
+		ret += sz_read;
+		if (err != 0) {
+			// Error reading the data.
+			m_lastError = err;
+			break;
+		}
+
+		ptr8 += sz_read;
+		firstIdx += run;
+		count -= run;
+	}
+
+	return ret;
+}
+
 /** GDI-specific functions. **/
 // TODO: "CdromReader" class?
 
@@ -613,4 +783,59 @@ IsoPartition *GdiReader::openIsoPartition(int trackNumber)
 	return new IsoPartition(this, lba * 2048, lba);
 }
 
+/**
+ * Verify the EDC and ECC of every sector in the data tracks.
+ *
+ * Sectors are read and checked in parallel. Tracks with
+ * 2048-byte sectors don't have EDC or ECC, so they're
+ * skipped. This doesn't affect normal reads, which don't
+ * check the EDC or ECC.
+ *
+ * @param report	[out] Sector verification report.
+ * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+ * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+ */
+int GdiReader::verifySectors(CdromEdcEcc::SectorReport &report, unsigned int threads)
+{
+	RP_D(GdiReader);
+	report.sectorCount = 0;
+	report.badSectors.clear();
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -EBADF;
+	}
+
+	// The thread pool is shared by all tracks.
+	ThreadPool pool(threads);
+
+	for (int trackNumber = 1; trackNumber <= (int)d->trackMappings.size(); trackNumber++) {
+		const GdiReaderPrivate::BlockRange *const blockRange = d->trackMappings[trackNumber-1];
+		if (!blockRange || blockRange->sectorSize != 2352) {
+			// Audio track, or no EDC/ECC.
+			continue;
+		}
+
+		// Make sure the track is open.
+		// NOTE: Keep a reference to the track file, since the
+		// pool might close it while the track is being verified.
+		shared_ptr<IRpFile> file;
+		int ret = d->openTrack(trackNumber, &file);
+		if (ret != 0) {
+			// Unable to open the track.
+			m_lastError = -ret;
+			return ret;
+		}
+
+		ret = CdromEdcEcc::verifySectors(report, &pool, file.get(), 0,
+			blockRange->blockEnd - blockRange->blockStart + 1,
+			blockRange->blockStart);
+		if (ret != 0) {
+			m_lastError = -ret;
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
 }
@@ -22,6 +22,7 @@
 #define __ROMPROPERTIES_LIBROMDATA_DISC_GDIREADER_HPP__
 
 #include "librpbase/disc/SparseDiscReader.hpp"
+#include "../utils/CdromEdcEcc.hpp"
 
 namespace LibRpBase {
 	class IRpFile;
@@ -85,6 +86,17 @@ class GdiReader : public LibRpBase::SparseDiscReader
 		 */
 		virtual int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size) override final;
 
+		/**
+		 * Read multiple consecutive full blocks.
+		 * Runs are split at track boundaries, and each run
+		 * is read with Cdrom2352Reader::readUserData().
+		 * @param firstIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+		 * @return Number of bytes read. (Less than count * block_size on error.)
+		 */
+		virtual size_t readBlocks(uint32_t firstIdx, unsigned int count, void *ptr) override final;
+
 	public:
 		/** GDI-specific functions. **/
 
@@ -107,6 +119,20 @@ class GdiReader : public LibRpBase::SparseDiscReader
 		 * @return IsoPartition, or nullptr on error.
 		 */
 		IsoPartition *openIsoPartition(int trackNumber);
+
+		/**
+		 * Verify the EDC and ECC of every sector in the data tracks.
+		 *
+		 * Sectors are read and checked in parallel. Tracks with
+		 * 2048-byte sectors don't have EDC or ECC, so they're
+		 * skipped. This doesn't affect normal reads, which don't
+		 * check the EDC or ECC.
+		 *
+		 * @param report	[out] Sector verification report.
+		 * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+		 */
+		int verifySectors(CdromEdcEcc::SectorReport &report, unsigned int threads = 0);
 };
 
 }
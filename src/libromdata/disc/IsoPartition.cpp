@@ -36,7 +36,9 @@ using namespace LibRpBase;
 
 // C++ includes.
 #include <string>
+#include <unordered_map>
 using std::string;
+using std::unordered_map;
 
 // Uninitialized vector class.
 // Reference: http://andreoffringa.org/?q=uvector
@@ -75,11 +77,34 @@ class IsoPartitionPrivate
 		// is a byte array, not an ISO_DirEntry array.
 		ao::uvector<uint8_t> rootDir_data;
 
+		// Root directory index. Built on first use by findRootDirEntry().
+		// - Key: Filename, lowercased. (ASCII only)
+		// - Value: Directory entry offset in rootDir_data.
+		// Filenames with a ";1" suffix are indexed both
+		// with and without the suffix.
+		unordered_map<string, size_t> rootDir_index;
+		bool rootDir_indexLoaded;
+
 		/**
 		 * Load the root directory.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		int loadRootDirectory(void);
+
+		/**
+		 * Lowercase a filename for the root directory index.
+		 * Only ASCII characters are converted.
+		 * @param filename [in,out] Filename.
+		 */
+		static inline void filename_to_lower(string &filename);
+
+		/**
+		 * Find a file in the root directory.
+		 * NOTE: Filenames are case-insensitive.
+		 * @param filename Filename. (cp1252)
+		 * @return Directory entry, or nullptr if not found.
+		 */
+		const ISO_DirEntry *findRootDirEntry(const string &filename);
 };
 
 /** IsoPartitionPrivate **/
@@ -91,6 +116,7 @@ IsoPartitionPrivate::IsoPartitionPrivate(IsoPartition *q, IDiscReader *discReade
 	, partition_offset(partition_offset)
 	, partition_size(0)
 	, iso_start_offset(iso_start_offset)
+	, rootDir_indexLoaded(false)
 {
 	// Clear the PVD struct.
 	memset(&pvd, 0, sizeof(pvd));
@@ -199,6 +225,77 @@ int IsoPartitionPrivate::loadRootDirectory(void)
 	return 0;
 }
 
+/**
+ * Lowercase a filename for the root directory index.
+ * Only ASCII characters are converted.
+ * @param filename [in,out] Filename.
+ */
+inline void IsoPartitionPrivate::filename_to_lower(string &filename)
+{
+	for (auto iter = filename.begin(); iter != filename.end(); ++iter) {
+		if (*iter >= 'A' && *iter <= 'Z') {
+			*iter += ('a' - 'A');
+		}
+	}
+}
+
+/**
+ * Find a file in the root directory.
+ * NOTE: Filenames are case-insensitive.
+ * @param filename Filename. (cp1252)
+ * @return Directory entry, or nullptr if not found.
+ */
+const ISO_DirEntry *IsoPartitionPrivate::findRootDirEntry(const string &filename)
+{
+	if (!rootDir_indexLoaded) {
+		// Build the root directory index.
+		// NOTE: If a filename appears more than once,
+		// the first entry is used.
+		rootDir_indexLoaded = true;
+		const uint8_t *const p_start = rootDir_data.data();
+		const uint8_t *const p_end = p_start + rootDir_data.size();
+		const uint8_t *p = p_start;
+		while (p < p_end) {
+			const ISO_DirEntry *dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
+			if (dirEntry->entry_length < sizeof(*dirEntry)) {
+				// End of directory.
+				break;
+			}
+
+			const char *entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
+			if (entry_filename + dirEntry->filename_length > reinterpret_cast<const char*>(p_end)) {
+				// Filename is out of bounds.
+				break;
+			}
+
+			string key(entry_filename, dirEntry->filename_length);
+			filename_to_lower(key);
+			const size_t offset = (size_t)(p - p_start);
+			rootDir_index.insert(std::make_pair(key, offset));
+
+			// 1990s and early 2000s CD-ROM games usually have
+			// ";1" filenames, so index them without the suffix, too.
+			if (key.size() > 2 && key[key.size()-2] == ';' && key[key.size()-1] == '1') {
+				key.resize(key.size()-2);
+				rootDir_index.insert(std::make_pair(key, offset));
+			}
+
+			// Next entry.
+			p += dirEntry->entry_length;
+		}
+	}
+
+	string key(filename);
+	filename_to_lower(key);
+
+	unordered_map<string, size_t>::const_iterator iter = rootDir_index.find(key);
+	if (iter == rootDir_index.end()) {
+		// Not found.
+		return nullptr;
+	}
+	return reinterpret_cast<const ISO_DirEntry*>(rootDir_data.data() + iter->second);
+}
+
 /** IsoPartition **/
 
 /**
@@ -254,6 +351,35 @@ size_t IsoPartition::read(void *ptr, size_t size)
 	return d->discReader->read(ptr, size);
 }
 
+/**
+ * Read data from the specified position in the partition.
+ * This does not use the partition position, so it's
+ * thread-safe as long as the underlying IDiscReader's
+ * pread() is thread-safe.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IsoPartition::pread(int64_t pos, void *ptr, size_t size)
+{
+	RP_D(IsoPartition);
+	assert(d->discReader != nullptr);
+	assert(d->discReader->isOpen());
+	if (!d->discReader || !d->discReader->isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Partitions are stored as-is.
+	// TODO: data_size checks?
+	size_t ret = d->discReader->pread(d->partition_offset + pos, ptr, size);
+	if (ret != size) {
+		m_lastError = d->discReader->lastError();
+	}
+	return ret;
+}
+
 /**
  * Set the partition position.
  * @param pos Partition position.
@@ -452,54 +578,7 @@ IRpFile *IsoPartition::open(const char *filename)
 	}
 
 	// Find the file in the root directory.
-	// NOTE: Filenames are case-insensitive.
-	// NOTE: File might have a ";1" suffix.
-	const unsigned int filename_len = (unsigned int)s_filename.size();
-	const ISO_DirEntry *dirEntry_found = nullptr;
-	const uint8_t *p = d->rootDir_data.data();
-	const uint8_t *const p_end = p + d->rootDir_data.size();
-	while (p < p_end) {
-		const ISO_DirEntry *dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
-		if (dirEntry->entry_length < sizeof(*dirEntry)) {
-			// End of directory.
-			break;
-		}
-
-		const char *entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
-		if (entry_filename + dirEntry->filename_length > reinterpret_cast<const char*>(p_end)) {
-			// Filename is out of bounds.
-			break;
-		}
-
-		// Check the filename.
-		// 1990s and early 2000s CD-ROM games usually have
-		// ";1" filenames, so check for that first.
-		if (dirEntry->filename_length == filename_len + 2) {
-			// +2 length match.
-			// This might have ";1".
-			if (!strncasecmp(entry_filename, s_filename.c_str(), filename_len)) {
-				// Check for ";1".
-				if (entry_filename[filename_len]   == ';' &&
-				    entry_filename[filename_len+1] == '1')
-				{
-					// Found it!
-					dirEntry_found = dirEntry;
-					break;
-				}
-			}
-		} else if (dirEntry->filename_length == filename_len) {
-			// Exact length match.
-			if (!strncasecmp(entry_filename, s_filename.c_str(), filename_len)) {
-				// Found it!
-				dirEntry_found = dirEntry;
-				break;
-			}
-		}
-
-		// Next entry.
-		p += dirEntry->entry_length;
-	}
-
+	const ISO_DirEntry *const dirEntry_found = d->findRootDirEntry(s_filename);
 	if (!dirEntry_found) {
 		// Not found.
 		return nullptr;
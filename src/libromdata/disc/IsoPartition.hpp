@@ -74,6 +74,18 @@ class IsoPartition : public LibRpBase::IPartition
 		 */
 		virtual size_t read(void *ptr, size_t size) override;
 
+		/**
+		 * Read data from the specified position in the partition.
+		 * This does not use the partition position, so it's
+		 * thread-safe as long as the underlying IDiscReader's
+		 * pread() is thread-safe.
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
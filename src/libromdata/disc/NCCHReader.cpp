@@ -60,6 +60,10 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q, IRpFile *file,
 #ifdef ENABLE_DECRYPTION
 	, tid_be(0)
 	, cipher(nullptr)
+	, cipherKeyIdx(-1)
+	, cipherSection(N3DS_NCCH_SECTION_PLAIN)
+	, cipherCtrOffset(0)
+	, lastEncSection(-1)
 	, titleKeyEncIdx(0)
 	, tmd_content_index(0)
 #endif /* ENABLE_DECRYPTION */
@@ -88,6 +92,10 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q, IDiscReader *discReader,
 #ifdef ENABLE_DECRYPTION
 	, tid_be(0)
 	, cipher(nullptr)
+	, cipherKeyIdx(-1)
+	, cipherSection(N3DS_NCCH_SECTION_PLAIN)
+	, cipherCtrOffset(0)
+	, lastEncSection(-1)
 	, titleKeyEncIdx(0)
 	, tmd_content_index(0)
 #endif /* ENABLE_DECRYPTION */
@@ -211,6 +219,9 @@ void NCCHReaderPrivate::init(void)
 			ctr.init_ctr(tid_be, N3DS_NCCH_SECTION_EXEFS, 0);
 			cipher->setIV(ctr.u8, sizeof(ctr.u8));
 			cipher->decrypt(reinterpret_cast<uint8_t*>(&exefs_header), sizeof(exefs_header));
+			cipherKeyIdx = 0;
+			cipherSection = N3DS_NCCH_SECTION_EXEFS;
+			cipherCtrOffset = sizeof(exefs_header);
 		}
 
 		// Initialize encrypted section handling.
@@ -316,12 +327,24 @@ NCCHReaderPrivate::~NCCHReaderPrivate()
  */
 int NCCHReaderPrivate::findEncSection(uint32_t address) const
 {
+	// Check the last section first, since most
+	// reads are sequential within a section.
+	if (lastEncSection >= 0 && lastEncSection < (int)encSections.size()) {
+		const auto &section = encSections[lastEncSection];
+		if (address >= section.address &&
+		    address < section.address + section.length)
+		{
+			return lastEncSection;
+		}
+	}
+
 	for (int i = 0; i < (int)encSections.size(); i++) {
 		const auto &section = encSections.at(i);
 		if (address >= section.address &&
 		    address < section.address + section.length)
 		{
 			// Found the section.
+			lastEncSection = i;
 			return i;
 		}
 	}
@@ -377,6 +400,105 @@ size_t NCCHReaderPrivate::readFromROM(uint32_t offset, void *ptr, size_t size)
 	return sz_read;
 }
 
+/**
+ * Read and decrypt data from the underlying ROM image.
+ * NCCH decryption is handled here; CIA decryption is
+ * handled by readFromROM().
+ *
+ * NOTE: Offset and size must both be multiples of 16.
+ *
+ * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of bytes read, or 0 on error.
+ */
+size_t NCCHReaderPrivate::readBlocks(uint32_t offset, uint8_t *ptr, size_t size)
+{
+	assert(offset % 16 == 0);
+	assert(size % 16 == 0);
+
+	if (ncch_header.hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] & N3DS_NCCH_BIT_MASK_NoCrypto) {
+		// No NCCH encryption.
+		// NOTE: readFromROM() sets q->m_lastError, so we
+		// don't need to check if a short read occurred.
+		return readFromROM(offset, ptr, size);
+	}
+
+#ifdef ENABLE_DECRYPTION
+	size_t sz_total_read = 0;
+	while (size > 0) {
+		// Determine what section we're in.
+		const int sectIdx = findEncSection(offset);
+		if (sectIdx < 0) {
+			// Not in a defined section.
+			// TODO: Handle this?
+			assert(!"Reading in an undefined section.");
+			break;
+		}
+		const EncSection *const section = &encSections[sectIdx];
+
+		// Don't read past the end of this section.
+		// NOTE: If the section length isn't a multiple of 16,
+		// the last block is decrypted using this section.
+		size_t sz_to_read = ALIGN(16, section->address + section->length) - offset;
+		if (sz_to_read > size) {
+			sz_to_read = size;
+		}
+
+		// Read from the ROM image.
+		// This automatically removes the outer CIA
+		// title key encryption if it's present.
+		size_t ret_sz = readFromROM(offset, ptr, sz_to_read);
+		// Only decrypt whole blocks.
+		ret_sz &= ~(size_t)15;
+
+		if (section->section > N3DS_NCCH_SECTION_PLAIN && ret_sz > 0) {
+			// Set the required key if it's changed.
+			if (cipherKeyIdx != section->keyIdx) {
+				cipher->setKey(ncch_keys[section->keyIdx].u8, sizeof(ncch_keys[section->keyIdx].u8));
+				cipherKeyIdx = section->keyIdx;
+				// Reset the counter, too.
+				cipherSection = N3DS_NCCH_SECTION_PLAIN;
+			}
+
+			// Initialize the counter based on section and offset.
+			// If this read continues from the previous one,
+			// the cipher's counter is already correct.
+			const uint32_t ctr_offset = offset - section->ctr_base;
+			if (cipherSection != section->section || cipherCtrOffset != ctr_offset) {
+				u128_t ctr;
+				ctr.init_ctr(tid_be, section->section, ctr_offset);
+				cipher->setIV(ctr.u8, sizeof(ctr.u8));
+				cipherSection = section->section;
+			}
+
+			// Decrypt the data.
+			if (cipher->decrypt(ptr, (unsigned int)ret_sz) != ret_sz) {
+				// Decryption failed.
+				cipherSection = N3DS_NCCH_SECTION_PLAIN;
+				q_ptr->m_lastError = EIO;
+				break;
+			}
+			cipherCtrOffset = ctr_offset + (uint32_t)ret_sz;
+		}
+
+		offset += (uint32_t)ret_sz;
+		ptr += ret_sz;
+		sz_total_read += ret_sz;
+		size -= ret_sz;
+		if (ret_sz != sz_to_read) {
+			// Short read.
+			break;
+		}
+	}
+
+	return sz_total_read;
+#else /* !ENABLE_DECRYPTION */
+	// Decryption is not enabled.
+	return 0;
+#endif /* ENABLE_DECRYPTION */
+}
+
 /**
  * Load the NCCH Extended Header.
  * @return 0 on success; non-zero on error.
@@ -406,7 +528,7 @@ int NCCHReaderPrivate::loadExHeader(void)
 	// start of the NCCH.
 
 	// Check the ExHeader length.
-	uint32_t exheader_length = le32_to_cpu(ncch_header.hdr.exheader_size);
+	const uint32_t exheader_length = le32_to_cpu(ncch_header.hdr.exheader_size);
 	if (exheader_length < N3DS_NCCH_EXHEADER_MIN_SIZE ||
 	    exheader_length > sizeof(ncch_exheader))
 	{
@@ -415,9 +537,6 @@ int NCCHReaderPrivate::loadExHeader(void)
 		return -3;
 	}
 
-	// Round up exheader_length to the nearest 16 bytes for decryption purposes.
-	exheader_length = ALIGN(16, exheader_length);
-
 	// Load the ExHeader.
 	// ExHeader is stored immediately after the main header.
 	int64_t prev_pos = q->tell();
@@ -559,87 +678,62 @@ size_t NCCHReader::read(void *ptr, size_t size)
 		size = (size_t)(d->ncch_length - d->pos);
 	}
 
-	if (d->ncch_header.hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] & N3DS_NCCH_BIT_MASK_NoCrypto) {
-		// No NCCH encryption.
-		// NOTE: readFromROM() sets q->m_lastError, so we
-		// don't need to check if a short read occurred.
-		return d->readFromROM(d->pos, ptr, size);
-	}
-
-#ifdef ENABLE_DECRYPTION
-	// TODO: Handle reads that aren't a multiple of 16 bytes.
-	assert(d->pos % 16 == 0);
-	assert(size % 16 == 0);
-	if (d->pos % 16 != 0 || size % 16 != 0) {
-		// Cannot read now.
-		return 0;
-	}
-
+	// NCCH encryption uses 16-byte blocks, and CIA encryption
+	// requires 16-byte alignment, so partial blocks at the
+	// start and end of the read are read into a temporary
+	// buffer and copied.
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t sz_total_read = 0;
-	while (size > 0) {
-		// Determine what section we're in.
-		int sectIdx = d->findEncSection(d->pos);
-		const NCCHReaderPrivate::EncSection *section = (
-			sectIdx >= 0 ? &d->encSections.at(sectIdx) : nullptr);
+	uint8_t block[16];
 
-		size_t sz_to_read = 0;
-		if (!section) {
-			// Not in a defined section.
-			// TODO: Handle this?
-			assert(!"Reading in an undefined section.");
-			return sz_total_read;
-		} else {
-			// We're in an encrypted section.
-			uint32_t section_offset = (uint32_t)(d->pos - section->address);
-			if (section_offset + size <= section->length) {
-				// Remainder of reading is in this section.
-				sz_to_read = size;
-			} else {
-				// We're reading past the end of this section.
-				sz_to_read = section->length - section_offset;
-			}
+	// Partial block at the start of the read.
+	const unsigned int blockOffset = (d->pos % 16);
+	if (blockOffset != 0) {
+		size_t sz_read = d->readBlocks(d->pos - blockOffset, block, sizeof(block));
+		if (sz_read != sizeof(block)) {
+			// Short read.
+			return 0;
 		}
 
-		// Read from the ROM image.
-		// This automatically removes the outer CIA
-		// title key encryption if it's present.
-		size_t ret_sz = d->readFromROM(d->pos, ptr8, sz_to_read);
-
-		if (section && section->section > N3DS_NCCH_SECTION_PLAIN) {
-			// Set the required key.
-			// TODO: Don't set the key if it hasn't changed.
-			d->cipher->setKey(d->ncch_keys[section->keyIdx].u8, sizeof(d->ncch_keys[section->keyIdx].u8));
-
-			// Initialize the counter based on section and offset.
-			u128_t ctr;
-			ctr.init_ctr(d->tid_be, section->section, d->pos - section->ctr_base);
-			d->cipher->setIV(ctr.u8, sizeof(ctr.u8));
-
-			// Decrypt the data.
-			// FIXME: Round up to 16 if a short read occurred?
-			ret_sz = d->cipher->decrypt(static_cast<uint8_t*>(ptr), (unsigned int)ret_sz);
+		size_t sz_copy = sizeof(block) - blockOffset;
+		if (sz_copy > size) {
+			sz_copy = size;
 		}
+		memcpy(ptr8, &block[blockOffset], sz_copy);
+		d->pos += (uint32_t)sz_copy;
+		ptr8 += sz_copy;
+		sz_total_read += sz_copy;
+		size -= sz_copy;
+	}
 
-		d->pos += (uint32_t)ret_sz;
-		ptr8 += ret_sz;
-		sz_total_read += ret_sz;
-		size -= ret_sz;
-		if (d->pos > d->ncch_length) {
-			d->pos = d->ncch_length;
-			break;
+	// Whole blocks.
+	const size_t sz_blocks = (size & ~(size_t)15);
+	if (sz_blocks > 0) {
+		size_t sz_read = d->readBlocks(d->pos, ptr8, sz_blocks);
+		d->pos += (uint32_t)sz_read;
+		ptr8 += sz_read;
+		sz_total_read += sz_read;
+		size -= sz_read;
+		if (sz_read != sz_blocks) {
+			// Short read.
+			return sz_total_read;
 		}
-		if (ret_sz != sz_to_read) {
+	}
+
+	// Partial block at the end of the read.
+	if (size > 0) {
+		size_t sz_read = d->readBlocks(d->pos, block, sizeof(block));
+		if (sz_read != sizeof(block)) {
 			// Short read.
-			break;
+			return sz_total_read;
 		}
+
+		memcpy(ptr8, block, size);
+		d->pos += (uint32_t)size;
+		sz_total_read += size;
 	}
 
 	return sz_total_read;
-#else /* !ENABLE_DECRYPTION */
-	// Decryption is not enabled.
-	return 0;
-#endif /* ENABLE_DECRYPTION */
 }
 
 /**
@@ -128,6 +128,20 @@ class NCCHReaderPrivate
 		 */
 		size_t readFromROM(uint32_t offset, void *ptr, size_t size);
 
+		/**
+		 * Read and decrypt data from the underlying ROM image.
+		 * NCCH decryption is handled here; CIA decryption is
+		 * handled by readFromROM().
+		 *
+		 * NOTE: Offset and size must both be multiples of 16.
+		 *
+		 * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of bytes read, or 0 on error.
+		 */
+		size_t readBlocks(uint32_t offset, uint8_t *ptr, size_t size);
+
 		/**
 		 * Load the NCCH Extended Header.
 		 * @return 0 on success; non-zero on error.
@@ -145,6 +159,14 @@ class NCCHReaderPrivate
 		// NCCH cipher.
 		LibRpBase::IAesCipher *cipher;
 
+		// Current NCCH cipher state.
+		// Sequential reads within a section continue with
+		// the cipher's existing key and counter instead of
+		// reinitializing them for every read.
+		int cipherKeyIdx;		// ncch_keys[] index, or -1 if no key is set.
+		uint8_t cipherSection;		// N3DS_NCCH_Sections for the counter. (PLAIN == invalid)
+		uint32_t cipherCtrOffset;	// Counter offset, relative to the section's ctr_base.
+
 		// Encrypted section addresses.
 		struct EncSection {
 			uint32_t address;	// Relative to ncch_offset.
@@ -179,6 +201,9 @@ class NCCHReaderPrivate
 		 */
 		int findEncSection(uint32_t address) const;
 
+		// Last section found by findEncSection().
+		mutable int lastEncSection;
+
 		// KeyY index for title key encryption. (CIA only)
 		uint8_t titleKeyEncIdx;
 		// TMD content index.
@@ -211,33 +211,48 @@ int PEResourceReaderPrivate::loadResDir(uint32_t addr, rsrc_dir_t &dir)
 {
 	RP_Q(PEResourceReader);
 
-	IMAGE_RESOURCE_DIRECTORY root;
-	size_t size = file->seekAndRead(rsrc_addr + addr, &root, sizeof(root));
-	if (size != sizeof(root)) {
-		// Seek and/or read error.
-		q->m_lastError = file->lastError();
-		return q->m_lastError;
+	// If the file is memory-backed, the directory is parsed
+	// in place. Otherwise, it's read into a local buffer.
+	const int64_t dir_addr = (int64_t)rsrc_addr + addr;
+	IMAGE_RESOURCE_DIRECTORY root_buf;
+	const IMAGE_RESOURCE_DIRECTORY *root = static_cast<const IMAGE_RESOURCE_DIRECTORY*>(
+		file->map(dir_addr, sizeof(root_buf)));
+	if (!root) {
+		size_t size = file->seekAndRead(dir_addr, &root_buf, sizeof(root_buf));
+		if (size != sizeof(root_buf)) {
+			// Seek and/or read error.
+			q->m_lastError = file->lastError();
+			return q->m_lastError;
+		}
+		root = &root_buf;
 	}
 
 	// Total number of entries.
-	unsigned int entryCount = le16_to_cpu(root.NumberOfNamedEntries) + le16_to_cpu(root.NumberOfIdEntries);
+	unsigned int entryCount = le16_to_cpu(root->NumberOfNamedEntries) + le16_to_cpu(root->NumberOfIdEntries);
 	assert(entryCount <= 64);
 	if (entryCount > 64) {
 		// Sanity check; constrain to 64 entries.
 		entryCount = 64;
 	}
+	const int64_t entries_addr = dir_addr + sizeof(IMAGE_RESOURCE_DIRECTORY);
 	uint32_t szToRead = (uint32_t)(entryCount * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY));
-	unique_ptr<IMAGE_RESOURCE_DIRECTORY_ENTRY[]> irdEntries(new IMAGE_RESOURCE_DIRECTORY_ENTRY[entryCount]);
-	size = file->read(irdEntries.get(), szToRead);
-	if (size != szToRead) {
-		// Read error.
-		q->m_lastError = file->lastError();
-		return q->m_lastError;
+	unique_ptr<IMAGE_RESOURCE_DIRECTORY_ENTRY[]> irdEntries_buf;
+	const IMAGE_RESOURCE_DIRECTORY_ENTRY *irdEntries =
+		static_cast<const IMAGE_RESOURCE_DIRECTORY_ENTRY*>(file->map(entries_addr, szToRead));
+	if (!irdEntries) {
+		irdEntries_buf.reset(new IMAGE_RESOURCE_DIRECTORY_ENTRY[entryCount]);
+		size_t size = file->seekAndRead(entries_addr, irdEntries_buf.get(), szToRead);
+		if (size != szToRead) {
+			// Read error.
+			q->m_lastError = file->lastError();
+			return q->m_lastError;
+		}
+		irdEntries = irdEntries_buf.get();
 	}
 
 	// Read each directory header.
 	dir.resize(entryCount);
-	const IMAGE_RESOURCE_DIRECTORY_ENTRY *irdEntry = irdEntries.get();
+	const IMAGE_RESOURCE_DIRECTORY_ENTRY *irdEntry = irdEntries;
 	unsigned int entriesRead = 0;
 	for (unsigned int i = 0; i < entryCount; i++, irdEntry++) {
 		// Skipping any root directory entry that isn't an ID.
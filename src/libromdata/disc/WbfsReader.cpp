@@ -22,10 +22,15 @@
 #include "WbfsReader.hpp"
 #include "librpbase/disc/SparseDiscReader_p.hpp"
 #include "libwbfs.h"
+#include "Console/gcn_structs.h"
 
 // librpbase
 #include "librpbase/byteswap.h"
+#include "librpbase/TextFuncs.hpp"
 #include "librpbase/file/IRpFile.hpp"
+#include "librpbase/disc/PartitionFile.hpp"
+#include "librpbase/disc/SplitDiscReader.hpp"
+#include "librpbase/threads/Mutex.hpp"
 using namespace LibRpBase;
 
 // C includes.
@@ -36,11 +41,20 @@ using namespace LibRpBase;
 #include <cerrno>
 #include <cstring>
 
+// C++ includes.
+#include <algorithm>
+#include <memory>
+#include <vector>
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+
 namespace LibRomData {
 
 class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 	public:
-		WbfsReaderPrivate(WbfsReader *q, IRpFile *file);
+		WbfsReaderPrivate(WbfsReader *q, IRpFile *file, unsigned int index);
+		WbfsReaderPrivate(WbfsReader *q, const WbfsReaderPrivate *other, unsigned int index);
 		virtual ~WbfsReaderPrivate();
 
 	private:
@@ -48,11 +62,35 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 		RP_DISABLE_COPY(WbfsReaderPrivate)
 
 	public:
-		// WBFS structs.
-		wbfs_t *m_wbfs;			// WBFS image.
-		wbfs_disc_t *m_wbfs_disc;	// Current disc.
+		/**
+		 * Parsed WBFS header and disc list.
+		 * Shared by all WbfsReaders opened from the same WBFS image.
+		 */
+		struct WbfsImage {
+			explicit WbfsImage(wbfs_t *p)
+				: p(p), discsLoaded(false) { }
+			~WbfsImage() { freeWbfsHeader(p); }
+
+			wbfs_t *p;		// WBFS header.
 
-		const be16_t *wlba_table;	// Pointer to m_wbfs_disc->disc->header->wlba_table.
+			// Split WBFS image. ("*.wbfs", "*.wbf1", ...)
+			// If set, the WbfsReaders read the image
+			// through PartitionFiles using this reader.
+			unique_ptr<SplitDiscReader> splitReader;
+
+			// Disc list. Loaded by loadDiscs().
+			Mutex discsMutex;
+			bool discsLoaded;
+			vector<WbfsReader::DiscInfo> discs;
+
+			private:
+				RP_DISABLE_COPY(WbfsImage)
+		};
+		shared_ptr<WbfsImage> m_image;
+
+		// Current disc.
+		unsigned int discIdx;		// Disc index.
+		vector<uint16_t> blockMap;	// WBFS block map. (host-endian)
 
 		/** WBFS functions. **/
 
@@ -68,34 +106,47 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 		/**
 		 * Free an allocated WBFS header.
 		 * This frees all associated structs.
-		 * All opened discs *must* be closed.
 		 * @param p wbfs_t struct.
 		 */
-		void freeWbfsHeader(wbfs_t *p);
+		static void freeWbfsHeader(wbfs_t *p);
 
 		/**
-		 * Open a disc from the WBFS image.
-		 * @param p wbfs_t struct.
-		 * @param index Disc index.
-		 * @return Allocated wbfs_disc_t on success; nullptr on error.
+		 * Parse a WBFS disc information block.
+		 * @param p	[in] wbfs_t struct.
+		 * @param info	[in] Disc information block. (p->disc_info_sz bytes)
+		 * @param slot	[in] Disc table slot.
+		 * @param disc	[out] Disc information.
 		 */
-		wbfs_disc_t *openWbfsDisc(wbfs_t *p, uint32_t index);
+		static void parseDiscInfo(const wbfs_t *p, const wbfs_disc_info_t *info,
+			unsigned int slot, WbfsReader::DiscInfo &disc);
 
 		/**
-		 * Close a WBFS disc.
-		 * This frees all associated structs.
-		 * @param disc wbfs_disc_t.
+		 * Load the disc list into m_image.
+		 * All disc information blocks are read with a single readv().
+		 * m_image->discsMutex must be locked by the caller.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadDiscs(void) const;
+
+		/**
+		 * Open a disc from the WBFS image.
+		 * If the disc list has been loaded, the block map
+		 * is copied from there; otherwise, only this disc's
+		 * information block is read.
+		 * @param index Disc index.
+		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		void closeWbfsDisc(wbfs_disc_t *disc);
+		int openWbfsDisc(unsigned int index);
 
 		/**
-		 * Get the non-sparse size of an open WBFS disc, in bytes.
-		 * This scans the block table to find the first block
-		 * from the end of wlba_table[] that has been allocated.
-		 * @param disc wbfs_disc_t struct.
+		 * Get the non-sparse size of a WBFS disc, in bytes.
+		 * This scans the block map to find the first block
+		 * from the end of the block map that has been allocated.
+		 * @param p wbfs_t struct.
+		 * @param blockMap WBFS block map. (host-endian)
 		 * @return Non-sparse size, in bytes.
 		 */
-		int64_t getWbfsDiscSize(const wbfs_disc_t *disc) const;
+		static int64_t getWbfsDiscSize(const wbfs_t *p, const vector<uint16_t> &blockMap);
 };
 
 /** WbfsReaderPrivate **/
@@ -103,56 +154,86 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 // WBFS magic number.
 const uint8_t WbfsReaderPrivate::WBFS_MAGIC[4] = {'W','B','F','S'};
 
-WbfsReaderPrivate::WbfsReaderPrivate(WbfsReader *q, IRpFile *file)
+WbfsReaderPrivate::WbfsReaderPrivate(WbfsReader *q, IRpFile *file, unsigned int index)
 	: super(q, file)
-	, m_wbfs(nullptr)
-	, m_wbfs_disc(nullptr)
-	, wlba_table(nullptr)
+	, discIdx(index)
 {
 	if (!this->file) {
 		// File could not be dup()'d.
 		return;
 	}
 
+	// Check for a split WBFS image.
+	unique_ptr<SplitDiscReader> splitReader;
+	if (SplitDiscReader::isSplitFilename(this->file->filename())) {
+		splitReader.reset(new SplitDiscReader(this->file));
+		if (splitReader->partCount() > 1) {
+			// Read the image through the SplitDiscReader.
+			IRpFile *const partFile = new PartitionFile(splitReader.get(), 0, splitReader->size());
+			delete this->file;
+			this->file = partFile;
+		} else {
+			// Only one part.
+			splitReader.reset();
+		}
+	}
+
 	// Read the WBFS header.
-	m_wbfs = readWbfsHeader();
-	if (!m_wbfs) {
+	wbfs_t *const p = readWbfsHeader();
+	if (!p) {
 		// Error reading the WBFS header.
 		delete this->file;
 		this->file = nullptr;
 		q->m_lastError = EIO;
 		return;
 	}
+	m_image.reset(new WbfsImage(p));
+	m_image->splitReader = std::move(splitReader);
 
-	// Open the first disc.
-	m_wbfs_disc = openWbfsDisc(m_wbfs, 0);
-	if (!m_wbfs_disc) {
+	// Open the disc.
+	if (openWbfsDisc(index) != 0) {
 		// Error opening the WBFS disc.
-		freeWbfsHeader(m_wbfs);
-		m_wbfs = nullptr;
 		delete this->file;
 		this->file = nullptr;
+		m_image.reset();
 		q->m_lastError = EIO;
 		return;
 	}
+}
 
-	// Save important values for later.
-	wlba_table = m_wbfs_disc->header->wlba_table;
-	block_size = m_wbfs->wbfs_sec_sz;
-	pos = 0;	// Reset the read position.
+WbfsReaderPrivate::WbfsReaderPrivate(WbfsReader *q, const WbfsReaderPrivate *other, unsigned int index)
+	: super(q, other->file)
+	, m_image(other->m_image)
+	, discIdx(index)
+{
+	if (!this->file || !m_image) {
+		// File could not be dup()'d,
+		// or the other WbfsReader isn't open.
+		delete this->file;
+		this->file = nullptr;
+		m_image.reset();
+		q->m_lastError = EBADF;
+		return;
+	}
 
-	// Get the size of the WBFS disc.
-	disc_size = getWbfsDiscSize(m_wbfs_disc);
+	// Open the disc.
+	if (openWbfsDisc(index) != 0) {
+		// Error opening the WBFS disc.
+		delete this->file;
+		this->file = nullptr;
+		m_image.reset();
+		q->m_lastError = EIO;
+		return;
+	}
 }
 
 WbfsReaderPrivate::~WbfsReaderPrivate()
 {
-	if (m_wbfs_disc) {
-		closeWbfsDisc(m_wbfs_disc);
-	}
-	if (m_wbfs) {
-		freeWbfsHeader(m_wbfs);
-	}
+	// If this is a split WBFS image, the file is a PartitionFile
+	// that reads from m_image->splitReader, so it must be deleted
+	// before the last reference to m_image is released.
+	delete this->file;
+	this->file = nullptr;
 }
 
 // from libwbfs.c
@@ -280,120 +361,201 @@ wbfs_t *WbfsReaderPrivate::readWbfsHeader(void)
 /**
  * Free an allocated WBFS header.
  * This frees all associated structs.
- * All opened discs *must* be closed.
  * @param p wbfs_t struct.
  */
 void WbfsReaderPrivate::freeWbfsHeader(wbfs_t *p)
 {
 	assert(p != nullptr);
 	assert(p->head != nullptr);
-	assert(p->n_disc_open == 0);
 
 	// Free everything.
 	free(p->head);
 	free(p);
 }
 
+/**
+ * Parse a WBFS disc information block.
+ * @param p	[in] wbfs_t struct.
+ * @param info	[in] Disc information block. (p->disc_info_sz bytes)
+ * @param slot	[in] Disc table slot.
+ * @param disc	[out] Disc information.
+ */
+void WbfsReaderPrivate::parseDiscInfo(const wbfs_t *p, const wbfs_disc_info_t *info,
+	unsigned int slot, WbfsReader::DiscInfo &disc)
+{
+	// The disc header copy is the first 256 bytes of the disc.
+	const GCN_DiscHeader *const discHeader =
+		reinterpret_cast<const GCN_DiscHeader*>(info->disc_header_copy);
+	disc.slot = slot;
+	memcpy(disc.id6, discHeader->id6, sizeof(discHeader->id6));
+	disc.id6[6] = 0;
+	disc.title = cp1252_sjis_to_utf8(discHeader->game_title, sizeof(discHeader->game_title));
+
+	// Byteswap the block map.
+	const unsigned int n_blocks = p->n_wbfs_sec_per_disc;
+	disc.blockMap.resize(n_blocks);
+	for (unsigned int i = 0; i < n_blocks; i++) {
+		disc.blockMap[i] = be16_to_cpu(info->wlba_table[i]);
+	}
+	disc.size = getWbfsDiscSize(p, disc.blockMap);
+}
+
+/**
+ * Load the disc list into m_image.
+ * All disc information blocks are read with a single readv().
+ * m_image->discsMutex must be locked by the caller.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WbfsReaderPrivate::loadDiscs(void) const
+{
+	WbfsImage *const image = m_image.get();
+	if (image->discsLoaded) {
+		// Already loaded.
+		return 0;
+	}
+
+	// Find all used disc table slots.
+	const wbfs_t *const p = image->p;
+	vector<unsigned int> slots;
+	slots.reserve(p->max_disc);
+	for (unsigned int i = 0; i < p->max_disc; i++) {
+		if (p->head->disc_table[i]) {
+			slots.push_back(i);
+		}
+	}
+
+	// Read all of the disc information blocks at once.
+	const unsigned int count = (unsigned int)slots.size();
+	const unsigned int disc_info_sz = p->disc_info_sz;
+	unique_ptr<uint8_t[]> buf(new uint8_t[(size_t)count * disc_info_sz]);
+	vector<IRpFile::ReadRequest> reqs(count);
+	for (unsigned int i = 0; i < count; i++) {
+		IRpFile::ReadRequest &req = reqs[i];
+		req.pos = (int64_t)p->hd_sec_sz + ((int64_t)slots[i] * disc_info_sz);
+		req.ptr = &buf[(size_t)i * disc_info_sz];
+		req.size = disc_info_sz;
+		req.ret = 0;
+	}
+	if (count > 0) {
+		file->readv(reqs.data(), count);
+	}
+
+	// Parse the disc information blocks.
+	// Disc indexes must match the disc table, so stop
+	// at the first disc that couldn't be read.
+	image->discs.clear();
+	image->discs.reserve(count);
+	for (unsigned int i = 0; i < count; i++) {
+		if (reqs[i].ret != disc_info_sz)
+			break;
+		image->discs.resize(i + 1);
+		parseDiscInfo(p, reinterpret_cast<const wbfs_disc_info_t*>(reqs[i].ptr),
+			slots[i], image->discs[i]);
+	}
+
+	image->discsLoaded = true;
+	return (image->discs.size() == count ? 0 : -EIO);
+}
+
 /**
  * Open a disc from the WBFS image.
- * @param p wbfs_t struct.
+ * If the disc list has been loaded, the block map
+ * is copied from there; otherwise, only this disc's
+ * information block is read.
  * @param index Disc index.
- * @return Allocated wbfs_disc_t on success; non-zero on error.
+ * @return 0 on success; negative POSIX error code on error.
  */
-wbfs_disc_t *WbfsReaderPrivate::openWbfsDisc(wbfs_t *p, uint32_t index)
+int WbfsReaderPrivate::openWbfsDisc(unsigned int index)
 {
+	WbfsImage *const image = m_image.get();
+	const wbfs_t *const p = image->p;
+	{
+		MutexLocker lock(image->discsMutex);
+		if (image->discsLoaded) {
+			// Use the disc list.
+			if (index >= image->discs.size()) {
+				// Disc not found.
+				return -ENOENT;
+			}
+			blockMap = image->discs[index].blockMap;
+			block_size = p->wbfs_sec_sz;
+			disc_size = image->discs[index].size;
+			pos = 0;	// Reset the read position.
+			return 0;
+		}
+	}
+
 	// Based on libwbfs.c's wbfs_open_disc()
 	// and wbfs_get_disc_info().
 	const wbfs_head_t *const head = p->head;
 	uint32_t count = 0;
 	for (uint32_t i = 0; i < p->max_disc; i++) {
-		if (head->disc_table[i]) {
-			if (count++ == index) {
-				// Found the disc table index.
-				wbfs_disc_t *disc = (wbfs_disc_t*)malloc(sizeof(wbfs_disc_t));
-				if (!disc) {
-					// ENOMEM
-					return nullptr;
-				}
-				disc->p = p;
-				disc->i = i;
-
-				// Read the disc header.
-				disc->header = (wbfs_disc_info_t*)malloc(p->disc_info_sz);
-				if (!disc->header) {
-					// ENOMEM
-					free(disc);
-					return nullptr;
-				}
-				size_t size = file->seekAndRead((p->hd_sec_sz + (i*p->disc_info_sz)),
-								disc->header, p->disc_info_sz);
-				if (size != p->disc_info_sz) {
-					// Error reading the disc information.
-					free(disc->header);
-					free(disc);
-					return nullptr;
-				}
-
-				// TODO: Byteswap wlba_table[] here?
-				// Removes unnecessary byteswaps when reading,
-				// but may not be necessary if we're not reading
-				// the entire disc.
-
-				// Disc information read successfully.
-				p->n_disc_open++;
-				return disc;
-			}
+		if (!head->disc_table[i])
+			continue;
+		if (count++ != index)
+			continue;
+
+		// Found the disc table index.
+		// Read the disc header.
+		unique_ptr<uint8_t[]> info(new uint8_t[p->disc_info_sz]);
+		size_t size = file->pread((p->hd_sec_sz + (i*p->disc_info_sz)),
+					  info.get(), p->disc_info_sz);
+		if (size != p->disc_info_sz) {
+			// Error reading the disc information.
+			return -EIO;
 		}
+
+		WbfsReader::DiscInfo disc;
+		parseDiscInfo(p, reinterpret_cast<const wbfs_disc_info_t*>(info.get()), i, disc);
+		blockMap.swap(disc.blockMap);
+		block_size = p->wbfs_sec_sz;
+		disc_size = disc.size;
+		pos = 0;	// Reset the read position.
+		return 0;
 	}
 
 	// Disc not found.
-	return nullptr;
+	return -ENOENT;
 }
 
 /**
- * Close a WBFS disc.
- * This frees all associated structs.
- * @param disc wbfs_disc_t.
- */
-void WbfsReaderPrivate::closeWbfsDisc(wbfs_disc_t *disc)
-{
-	assert(disc != nullptr);
-	assert(disc->p != nullptr);
-	assert(disc->p->n_disc_open > 0);
-	assert(disc->header != nullptr);
-
-	// Free the disc.
-	disc->p->n_disc_open--;
-	free(disc->header);
-	free(disc);
-}
-
-/**
- * Get the non-sparse size of an open WBFS disc, in bytes.
- * This scans the block table to find the first block
- * from the end of wlba_table[] that has been allocated.
- * @param disc wbfs_disc_t struct.
+ * Get the non-sparse size of a WBFS disc, in bytes.
+ * This scans the block map to find the first block
+ * from the end of the block map that has been allocated.
+ * @param p wbfs_t struct.
+ * @param blockMap WBFS block map. (host-endian)
  * @return Non-sparse size, in bytes.
  */
-int64_t WbfsReaderPrivate::getWbfsDiscSize(const wbfs_disc_t *disc) const
+int64_t WbfsReaderPrivate::getWbfsDiscSize(const wbfs_t *p, const vector<uint16_t> &blockMap)
 {
 	// Find the last block that's used on the disc.
 	// NOTE: This is in WBFS blocks, not Wii blocks.
-	int lastBlock = disc->p->n_wbfs_sec_per_disc - 1;
+	int lastBlock = (int)blockMap.size() - 1;
 	for (; lastBlock >= 0; lastBlock--) {
-		if (wlba_table[lastBlock] != cpu_to_be16(0))
+		if (blockMap[lastBlock] != 0)
 			break;
 	}
 
 	// lastBlock+1 * WBFS block size == filesize.
-	const wbfs_t *p = disc->p;
 	return (int64_t)(lastBlock + 1) * (int64_t)(p->wbfs_sec_sz);
 }
 
 /** WbfsReader **/
 
-WbfsReader::WbfsReader(IRpFile *file)
-	: super(new WbfsReaderPrivate(this, file))
+WbfsReader::WbfsReader(IRpFile *file, unsigned int index)
+	: super(new WbfsReaderPrivate(this, file, index))
+{ }
+
+/**
+ * Construct a WbfsReader for another disc in
+ * the same WBFS image as an existing WbfsReader.
+ * The WBFS header is shared with the existing WbfsReader.
+ * @param other Existing WbfsReader.
+ * @param index Disc index.
+ */
+WbfsReader::WbfsReader(const WbfsReader *other, unsigned int index)
+	: super(new WbfsReaderPrivate(this,
+		static_cast<const WbfsReaderPrivate*>(other->d_ptr), index))
 { }
 
 /**
@@ -436,6 +598,66 @@ int WbfsReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
 	return isDiscSupported_static(pHeader, szHeader);
 }
 
+/** WBFS disc table. **/
+
+/**
+ * Get information about all discs in the WBFS image.
+ *
+ * The disc table is read in a single pass the first
+ * time this function is called. The list is shared
+ * by all WbfsReaders opened from this one.
+ *
+ * @return Disc list. (Empty on error.)
+ */
+const vector<WbfsReader::DiscInfo> &WbfsReader::discs(void) const
+{
+	RP_D(const WbfsReader);
+	if (!d->m_image) {
+		// WBFS image isn't open.
+		static const vector<DiscInfo> empty;
+		return empty;
+	}
+
+	// NOTE: The list is never modified once it's
+	// loaded, so it can be returned by reference.
+	MutexLocker lock(d->m_image->discsMutex);
+	d->loadDiscs();
+	return d->m_image->discs;
+}
+
+/**
+ * Get the index of the disc opened by this WbfsReader.
+ * @return Disc index.
+ */
+unsigned int WbfsReader::discIndex(void) const
+{
+	RP_D(const WbfsReader);
+	return d->discIdx;
+}
+
+/**
+ * Open another disc from the same WBFS image.
+ * The WBFS header isn't re-read.
+ * @param index Disc index. (See discs().)
+ * @return New WbfsReader, or nullptr on error. (Caller must delete it.)
+ */
+WbfsReader *WbfsReader::openDisc(unsigned int index) const
+{
+	RP_D(const WbfsReader);
+	if (!d->m_image) {
+		// WBFS image isn't open.
+		return nullptr;
+	}
+
+	WbfsReader *const reader = new WbfsReader(this, index);
+	if (!reader->isOpen()) {
+		// Error opening the disc.
+		delete reader;
+		return nullptr;
+	}
+	return reader;
+}
+
 /** SparseDiscReader functions. **/
 
 /**
@@ -472,13 +694,13 @@ int WbfsReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size)
 	}
 
 	// Get the physical block number first.
-	assert(blockIdx < d->m_wbfs_disc->p->n_wbfs_sec_per_disc);
-	if (blockIdx >= d->m_wbfs_disc->p->n_wbfs_sec_per_disc) {
+	assert(blockIdx < d->blockMap.size());
+	if (blockIdx >= d->blockMap.size()) {
 		// Out of range.
 		return -1;
 	}
 
-	const unsigned int physBlockIdx = be16_to_cpu(d->wlba_table[blockIdx]);
+	const unsigned int physBlockIdx = d->blockMap[blockIdx];
 	if (physBlockIdx == 0) {
 		// Empty block.
 		memset(ptr, 0, size);
@@ -487,9 +709,71 @@ int WbfsReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size)
 
 	// Go to the block.
 	const int64_t phys_pos = ((int64_t)physBlockIdx * d->block_size) + pos;
-	size_t sz_read = d->file->seekAndRead(phys_pos, ptr, size);
-	m_lastError = d->file->lastError();
+	// NOTE: Using pread() so multiple threads can read blocks at once.
+	size_t sz_read = d->file->pread(phys_pos, ptr, size);
+	if (sz_read != size) {
+		m_lastError = d->file->lastError();
+	}
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple consecutive full blocks.
+ * Physically contiguous blocks are read with a single pread().
+ * @param firstIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+ * @return Number of bytes read. (Less than count * block_size on error.)
+ */
+size_t WbfsReader::readBlocks(uint32_t firstIdx, unsigned int count, void *ptr)
+{
+	RP_D(WbfsReader);
+	const unsigned int block_size = d->block_size;
+	const unsigned int n_blocks = (unsigned int)d->blockMap.size();
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	while (count > 0) {
+		if (firstIdx >= n_blocks) {
+			// Out of range.
+			break;
+		}
+
+		// Find a run of physically contiguous blocks,
+		// or a run of empty blocks.
+		const unsigned int physBlockIdx = d->blockMap[firstIdx];
+		const unsigned int maxRun = std::min(count, n_blocks - firstIdx);
+		unsigned int run = 1;
+		if (physBlockIdx == 0) {
+			// Empty blocks.
+			while (run < maxRun && d->blockMap[firstIdx + run] == 0) {
+				run++;
+			}
+			memset(ptr8, 0, (size_t)run * block_size);
+		} else {
+			while (run < maxRun && d->blockMap[firstIdx + run] == physBlockIdx + run) {
+				run++;
+			}
+
+			// Read the entire run at once.
+			const int64_t phys_pos = (int64_t)physBlockIdx * block_size;
+			const size_t run_sz = (size_t)run * block_size;
+			size_t sz_read = d->file->pread(phys_pos, ptr8, run_sz);
+			if (sz_read != run_sz) {
+				// Error reading the data.
+				m_lastError = d->file->lastError();
+				return ret + sz_read;
+			}
+		}
+
+		const size_t run_sz = (size_t)run * block_size;
+		firstIdx += run;
+		count -= run;
+		ptr8 += run_sz;
+		ret += run_sz;
+	}
+
+	return ret;
+}
+
 }
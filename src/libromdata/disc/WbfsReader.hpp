@@ -24,6 +24,10 @@
 
 #include "librpbase/disc/SparseDiscReader.hpp"
 
+// C++ includes.
+#include <string>
+#include <vector>
+
 namespace LibRpBase {
 	class IRpFile;
 }
@@ -39,8 +43,19 @@ class WbfsReader : public LibRpBase::SparseDiscReader
 		 * The file is dup()'d, so the original file can be
 		 * closed afterwards.
 		 * @param file File to read from.
+		 * @param index Disc index. (See discs().)
+		 */
+		explicit WbfsReader(LibRpBase::IRpFile *file, unsigned int index = 0);
+
+	private:
+		/**
+		 * Construct a WbfsReader for another disc in
+		 * the same WBFS image as an existing WbfsReader.
+		 * The WBFS header is shared with the existing WbfsReader.
+		 * @param other Existing WbfsReader.
+		 * @param index Disc index.
 		 */
-		explicit WbfsReader(LibRpBase::IRpFile *file);
+		WbfsReader(const WbfsReader *other, unsigned int index);
 
 	private:
 		typedef SparseDiscReader super;
@@ -48,6 +63,43 @@ class WbfsReader : public LibRpBase::SparseDiscReader
 	private:
 		friend class WbfsReaderPrivate;
 
+	public:
+		/** WBFS disc table. **/
+
+		// Disc information.
+		struct DiscInfo {
+			unsigned int slot;	// Disc table slot.
+			char id6[7];		// Game ID. (NULL-terminated)
+			std::string title;	// Game title. (UTF-8)
+			int64_t size;		// Non-sparse disc size, in bytes.
+			std::vector<uint16_t> blockMap;	// WBFS block map. (host-endian; 0 == empty block)
+		};
+
+		/**
+		 * Get information about all discs in the WBFS image.
+		 *
+		 * The disc table is read in a single pass the first
+		 * time this function is called. The list is shared
+		 * by all WbfsReaders opened from this one.
+		 *
+		 * @return Disc list. (Empty on error.)
+		 */
+		const std::vector<DiscInfo> &discs(void) const;
+
+		/**
+		 * Get the index of the disc opened by this WbfsReader.
+		 * @return Disc index.
+		 */
+		unsigned int discIndex(void) const;
+
+		/**
+		 * Open another disc from the same WBFS image.
+		 * The WBFS header isn't re-read.
+		 * @param index Disc index. (See discs().)
+		 * @return New WbfsReader, or nullptr on error. (Caller must delete it.)
+		 */
+		WbfsReader *openDisc(unsigned int index) const;
+
 	public:
 		/** Disc image detection functions. **/
 
@@ -83,6 +135,16 @@ class WbfsReader : public LibRpBase::SparseDiscReader
 		 * @return Number of bytes read, or -1 if the block index is invalid.
 		 */
 		virtual int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size) override final;
+
+		/**
+		 * Read multiple consecutive full blocks.
+		 * Physically contiguous blocks are read with a single pread().
+		 * @param firstIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+		 * @return Number of bytes read. (Less than count * block_size on error.)
+		 */
+		virtual size_t readBlocks(uint32_t firstIdx, unsigned int count, void *ptr) override final;
 };
 
 }
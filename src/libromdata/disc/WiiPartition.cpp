@@ -31,17 +31,26 @@
 #ifdef ENABLE_DECRYPTION
 #include "librpbase/crypto/IAesCipher.hpp"
 #include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/Sha1.hpp"
+#include "librpbase/threads/Atomics.h"
+#include "librpbase/threads/Mutex.hpp"
+#include "librpbase/threads/Semaphore.hpp"
+#include "librpbase/threads/Thread.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
 #endif /* ENABLE_DECRYPTION */
 using namespace LibRpBase;
 
 // C includes. (C++ namespace)
 #include <cassert>
 #include <cerrno>
+#include <cstddef>
 #include <cstring>
 
 // C++ includes.
 #include <memory>
+#include <vector>
 using std::unique_ptr;
+using std::vector;
 
 #include "GcnPartitionPrivate.hpp"
 
@@ -51,6 +60,18 @@ namespace LibRomData {
 #define SECTOR_SIZE_DECRYPTED 0x7C00
 #define SECTOR_SIZE_DECRYPTED_OFFSET 0x400
 
+// Hash tree.
+// Each sector has 31 H0 hashes (one per 0x400-byte data block),
+// and copies of the H1 and H2 tables for its subgroup and group.
+// The H3 table has one hash per group.
+#define SECTOR_H0_OFFSET	0x000
+#define SECTOR_H0_COUNT		31
+#define SECTOR_H1_OFFSET	0x280
+#define SECTOR_H2_OFFSET	0x340
+#define SECTOR_HX_COUNT		8
+#define SECTORS_PER_GROUP	64	// 8 subgroups of 8 sectors
+#define H3_TABLE_SIZE		0x18000
+
 class WiiPartitionPrivate : public GcnPartitionPrivate
 {
 	public:
@@ -95,20 +116,111 @@ class WiiPartitionPrivate : public GcnPartitionPrivate
 		// Decrypted read position. (0x7C00 bytes out of 0x8000)
 		int64_t pos_7C00;
 
-		// Decrypted sector cache.
+		// Decrypted sector cache. (LRU)
 		// NOTE: Actual data starts at 0x400.
 		// Hashes and the sector IV are stored first.
-		uint32_t sector_num;				// Sector number.
-		uint8_t sector_buf[SECTOR_SIZE_ENCRYPTED];	// Decrypted sector data.
+		static const unsigned int SECTOR_CACHE_COUNT = 16;
+		struct SectorCacheEntry {
+			uint32_t sector_num;			// Sector number. (~0 if unused)
+			uint32_t lastUsed;			// Last-used tick.
+			uint8_t buf[SECTOR_SIZE_ENCRYPTED];	// Decrypted sector data.
+		};
+		unique_ptr<SectorCacheEntry[]> sectorCache;
+		uint32_t sectorCacheTick;
+
+		// Batch buffer for multi-sector reads.
+		// Allocated on demand.
+		static const unsigned int SECTOR_BATCH_MAX = 16;
+		unique_ptr<uint8_t[]> batchBuf;
+
+		// Protects the decrypted sector cache and
+		// decryption initialization for pread().
+		mutable Mutex sectorMutex;
+
+		/**
+		 * Read and decrypt multiple contiguous sectors.
+		 * The encrypted sectors are read with a single I/O request,
+		 * then decrypted in place.
+		 *
+		 * @param sector_num	[in] First sector number. (address / 0x7C00)
+		 * @param count		[in] Number of sectors. (must be <= SECTOR_BATCH_MAX)
+		 * @param buf		[out] Output buffer. (count * SECTOR_SIZE_ENCRYPTED bytes)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readSectors(uint32_t sector_num, unsigned int count, uint8_t *buf);
+
+		/**
+		 * Make sure the specified sectors are in the sector cache.
+		 * Runs of contiguous missing sectors are read in batches.
+		 *
+		 * @param sector_num	[in] First sector number. (address / 0x7C00)
+		 * @param count		[in] Number of sectors. (must be <= SECTOR_CACHE_COUNT)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int cacheSectors(uint32_t sector_num, unsigned int count);
 
 		/**
-		 * Read and decrypt a sector.
-		 * The decrypted sector is stored in sector_buf.
+		 * Read and decrypt a sector using the sector cache.
+		 *
+		 * NOTE: The returned pointer is only valid until the
+		 * next cache operation. sectorMutex must be held.
 		 *
 		 * @param sector_num Sector number. (address / 0x7C00)
+		 * @return Pointer to the decrypted sector, or nullptr on error.
+		 */
+		const uint8_t *readSector(uint32_t sector_num);
+
+		/**
+		 * Decrypt the data areas of multiple sectors in place.
+		 * The hash areas are left encrypted.
+		 * @param cipher	[in] AES cipher. (title key, CBC mode)
+		 * @param buf		[in/out] Sector buffer.
+		 * @param count		[in] Number of sectors.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int readSector(uint32_t sector_num);
+		static int decryptSectors(IAesCipher *cipher, uint8_t *buf, unsigned int count);
+
+		// Hash verification.
+		// NOTE: Protected by sectorMutex.
+		bool hashVerify;			// Verify hashes while reading?
+		unique_ptr<uint8_t[]> h3Table;		// H3 table.
+		bool h3TableOK;				// Does the H3 table match the TMD?
+		vector<WiiPartition::BadSector> readBadSectors;	// Bad sectors found while reading.
+
+		/**
+		 * Load the H3 table.
+		 * The H3 table is checked against the TMD.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadH3Table(void);
+
+		/**
+		 * Verify a sector against the hash tree.
+		 * The H3 table must be loaded.
+		 *
+		 * @param cipher	[in] AES cipher. (title key, CBC mode)
+		 * @param sector	[in] Sector with the data area decrypted.
+		 * @param sector_num	[in] Sector number.
+		 * @param pH0Mask	[out] Data blocks that don't match H0.
+		 * @return Error bits (WiiPartition::HashErrorBits), or 0 if the sector is valid.
+		 */
+		uint32_t verifySector(IAesCipher *cipher, const uint8_t *sector,
+			uint32_t sector_num, uint32_t *pH0Mask) const;
+
+	private:
+		/**
+		 * Find a sector in the sector cache.
+		 * The sector's last-used tick is updated if it's found.
+		 * @param sector_num Sector number.
+		 * @return Cache entry, or nullptr if not found.
+		 */
+		SectorCacheEntry *findCachedSector(uint32_t sector_num);
+
+		/**
+		 * Get the least-recently used sector cache entry.
+		 * @return Cache entry.
+		 */
+		SectorCacheEntry *getLRUCacheEntry(void);
 
 	public:
 		// Verification key names.
@@ -174,7 +286,9 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q, IDiscReader *discReade
 	, m_encKey(WiiPartition::ENCKEY_UNKNOWN)
 	, aes_title(nullptr)
 	, pos_7C00(-1)
-	, sector_num(~0)
+	, sectorCacheTick(0)
+	, hashVerify(false)
+	, h3TableOK(false)
 #else /* !ENABLE_DECRYPTION */
 	, verifyResult(KeyManager::VERIFY_NO_SUPPORT)
 	, m_encKey(WiiPartition::ENCKEY_UNKNOWN)
@@ -374,7 +488,8 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 
 	// Read sector 0, which contains a disc header.
 	// NOTE: readSector() doesn't check verifyResult.
-	if (readSector(0) != 0) {
+	const uint8_t *const sector0 = readSector(0);
+	if (!sector0) {
 		// Error reading sector 0.
 		delete aes_title;
 		aes_title = nullptr;
@@ -385,7 +500,7 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 	// Verify that this is a Wii partition.
 	// If it isn't, the key is probably wrong.
 	const GCN_DiscHeader *discHeader =
-		reinterpret_cast<const GCN_DiscHeader*>(&sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET]);
+		reinterpret_cast<const GCN_DiscHeader*>(&sector0[SECTOR_SIZE_DECRYPTED_OFFSET]);
 	if (discHeader->magic_wii != cpu_to_be32(WII_MAGIC)) {
 		// Invalid disc header.
 		verifyResult = KeyManager::VERIFY_WRONG_KEY;
@@ -407,56 +522,343 @@ WiiPartitionPrivate::~WiiPartitionPrivate()
 
 #ifdef ENABLE_DECRYPTION
 /**
- * Read and decrypt a sector.
- * The decrypted sector is stored in sector_buf.
+ * Read and decrypt multiple contiguous sectors.
+ * The encrypted sectors are read with a single I/O request,
+ * then decrypted in place.
  *
- * @param sector_num Sector number. (address / 0x7C00)
+ * @param sector_num	[in] First sector number. (address / 0x7C00)
+ * @param count		[in] Number of sectors. (must be <= SECTOR_BATCH_MAX)
+ * @param buf		[out] Output buffer. (count * SECTOR_SIZE_ENCRYPTED bytes)
  * @return 0 on success; negative POSIX error code on error.
  */
-int WiiPartitionPrivate::readSector(uint32_t sector_num)
+int WiiPartitionPrivate::readSectors(uint32_t sector_num, unsigned int count, uint8_t *buf)
 {
-	if (this->sector_num == sector_num) {
-		// Sector is already in memory.
-		return 0;
-	}
+	assert(count > 0);
+	assert(count <= SECTOR_BATCH_MAX);
 
 	// NOTE: This function doesn't check verifyResult,
 	// since it's called by initDecryption() before
 	// verifyResult is set.
 
-	// Read the first encrypted sector of the partition.
+	// Read all of the encrypted sectors at once.
 	int64_t sector_addr = partition_offset + data_offset;
 	sector_addr += ((int64_t)sector_num * SECTOR_SIZE_ENCRYPTED);
+	const size_t read_sz = (size_t)count * SECTOR_SIZE_ENCRYPTED;
 
 	RP_Q(WiiPartition);
-	int ret = discReader->seek(sector_addr);
-	if (ret != 0) {
-		q->m_lastError = discReader->lastError();
-		return ret;
+	size_t sz = discReader->pread(sector_addr, buf, read_sz);
+	if (sz != read_sz) {
+		q->m_lastError = EIO;
+		return -EIO;
 	}
 
-	size_t sz = discReader->read(sector_buf, sizeof(sector_buf));
-	if (sz != SECTOR_SIZE_ENCRYPTED) {
-		// sector_buf may be invalid.
-		this->sector_num = ~0;
+	// Decrypt the sectors.
+	if (decryptSectors(aes_title, buf, count) != 0) {
 		q->m_lastError = EIO;
-		return -1;
+		return -EIO;
 	}
 
-	// Decrypt the sector.
-	if (aes_title->decrypt(&sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED,
-	    &sector_buf[0x3D0], 16) != SECTOR_SIZE_DECRYPTED)
+	if (hashVerify && h3Table) {
+		// Verify the sectors against the hash tree.
+		bool isOK = true;
+		for (unsigned int i = 0; i < count; i++, buf += SECTOR_SIZE_ENCRYPTED) {
+			WiiPartition::BadSector bad;
+			bad.sector = sector_num + i;
+			bad.errors = verifySector(aes_title, buf, bad.sector, &bad.h0_mask);
+			if (bad.errors == 0)
+				continue;
+
+			// Hash error. Only record each sector once.
+			isOK = false;
+			bool found = false;
+			for (auto iter = readBadSectors.cbegin(); iter != readBadSectors.cend(); ++iter) {
+				if (iter->sector == bad.sector) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				readBadSectors.push_back(bad);
+			}
+		}
+
+		if (!isOK) {
+			q->m_lastError = EIO;
+			return -EIO;
+		}
+	}
+
+	// Sectors read and decrypted.
+	return 0;
+}
+
+/**
+ * Decrypt the data areas of multiple sectors in place.
+ * The hash areas are left encrypted.
+ * @param cipher	[in] AES cipher. (title key, CBC mode)
+ * @param buf		[in/out] Sector buffer.
+ * @param count		[in] Number of sectors.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiPartitionPrivate::decryptSectors(IAesCipher *cipher, uint8_t *buf, unsigned int count)
+{
+	// Each sector has its own IV, stored in its hash area.
+	for (; count > 0; count--, buf += SECTOR_SIZE_ENCRYPTED) {
+		if (cipher->decrypt(&buf[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED,
+		    &buf[0x3D0], 16) != SECTOR_SIZE_DECRYPTED)
+		{
+			return -EIO;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Load the H3 table.
+ * The H3 table is checked against the TMD.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiPartitionPrivate::loadH3Table(void)
+{
+	if (h3Table) {
+		// H3 table is already loaded.
+		return 0;
+	}
+
+	const int64_t h3_addr = partition_offset +
+		((int64_t)be32_to_cpu(partitionHeader.h3_table_offset) << 2);
+	unique_ptr<uint8_t[]> h3(new uint8_t[H3_TABLE_SIZE]);
+	size_t size = discReader->pread(h3_addr, h3.get(), H3_TABLE_SIZE);
+	if (size != H3_TABLE_SIZE) {
+		// Error reading the H3 table.
+		return -EIO;
+	}
+
+	// The first TMD content record has the SHA-1 of the H3 table.
+	// TMD layout: RSA-2048 signature (0x140 bytes), header,
+	// then content records (0x24 bytes each) at 0x1E4.
+	// Each content record has its SHA-1 at 0x10.
+	// NOTE: Only TMDs stored in the partition header are checked.
+	static const unsigned int TMD_CONTENT_SHA1_OFFSET = 0x1E4 + 0x10;
+	const int64_t tmd_offset = ((int64_t)be32_to_cpu(partitionHeader.tmd_offset) << 2) -
+		(int64_t)offsetof(RVL_PartitionHeader, tmd);
+	h3TableOK = false;
+	if (tmd_offset >= 0 && be32_to_cpu(partitionHeader.tmd_size) >= TMD_CONTENT_SHA1_OFFSET + 20 &&
+	    tmd_offset + TMD_CONTENT_SHA1_OFFSET + 20 <= (int64_t)sizeof(partitionHeader.tmd))
 	{
-		// sector_buf may be invalid.
-		this->sector_num = ~0;
-		q->m_lastError = EIO;
-		return -1;
+		uint8_t digest[Sha1::DIGEST_SIZE];
+		Sha1::hash(h3.get(), H3_TABLE_SIZE, digest);
+		h3TableOK = !memcmp(digest,
+			&partitionHeader.tmd[tmd_offset + TMD_CONTENT_SHA1_OFFSET], sizeof(digest));
+	}
+
+	h3Table = std::move(h3);
+	return 0;
+}
+
+/**
+ * Verify a sector against the hash tree.
+ * The H3 table must be loaded.
+ *
+ * @param cipher	[in] AES cipher. (title key, CBC mode)
+ * @param sector	[in] Sector with the data area decrypted.
+ * @param sector_num	[in] Sector number.
+ * @param pH0Mask	[out] Data blocks that don't match H0.
+ * @return Error bits (WiiPartition::HashErrorBits), or 0 if the sector is valid.
+ */
+uint32_t WiiPartitionPrivate::verifySector(IAesCipher *cipher, const uint8_t *sector,
+	uint32_t sector_num, uint32_t *pH0Mask) const
+{
+	assert(h3Table != nullptr);
+	*pH0Mask = 0;
+
+	// Decrypt the hash area. (IV is all zeroes.)
+	// NOTE: The data IV is taken from the encrypted hash area,
+	// so the sector buffer itself is left as-is.
+	static const uint8_t zero_iv[16] = {0};
+	uint8_t hashes[SECTOR_SIZE_DECRYPTED_OFFSET];
+	memcpy(hashes, sector, sizeof(hashes));
+	if (cipher->decrypt(hashes, sizeof(hashes), zero_iv, sizeof(zero_iv)) != sizeof(hashes)) {
+		return WiiPartition::HASHERR_READ;
+	}
+
+	uint32_t errors = 0;
+	uint8_t digest[Sha1::DIGEST_SIZE];
+
+	// H0: One hash per 0x400-byte data block.
+	const uint8_t *data = &sector[SECTOR_SIZE_DECRYPTED_OFFSET];
+	for (unsigned int i = 0; i < SECTOR_H0_COUNT; i++, data += 0x400) {
+		Sha1::hash(data, 0x400, digest);
+		if (memcmp(digest, &hashes[SECTOR_H0_OFFSET + (i * Sha1::DIGEST_SIZE)], sizeof(digest)) != 0) {
+			*pH0Mask |= (1U << i);
+		}
+	}
+	if (*pH0Mask != 0) {
+		errors |= WiiPartition::HASHERR_H0;
+	}
+
+	// H1: Hash of this sector's H0 table.
+	Sha1::hash(&hashes[SECTOR_H0_OFFSET], SECTOR_H0_COUNT * Sha1::DIGEST_SIZE, digest);
+	if (memcmp(digest, &hashes[SECTOR_H1_OFFSET + ((sector_num % 8) * Sha1::DIGEST_SIZE)], sizeof(digest)) != 0) {
+		errors |= WiiPartition::HASHERR_H1;
+	}
+
+	// H2: Hash of this subgroup's H1 table.
+	Sha1::hash(&hashes[SECTOR_H1_OFFSET], SECTOR_HX_COUNT * Sha1::DIGEST_SIZE, digest);
+	if (memcmp(digest, &hashes[SECTOR_H2_OFFSET + (((sector_num / 8) % 8) * Sha1::DIGEST_SIZE)], sizeof(digest)) != 0) {
+		errors |= WiiPartition::HASHERR_H2;
+	}
+
+	// H3: Hash of this group's H2 table.
+	const unsigned int group = sector_num / SECTORS_PER_GROUP;
+	Sha1::hash(&hashes[SECTOR_H2_OFFSET], SECTOR_HX_COUNT * Sha1::DIGEST_SIZE, digest);
+	if ((group + 1) * Sha1::DIGEST_SIZE > H3_TABLE_SIZE ||
+	    memcmp(digest, &h3Table[group * Sha1::DIGEST_SIZE], sizeof(digest)) != 0)
+	{
+		errors |= WiiPartition::HASHERR_H3;
+	}
+
+	return errors;
+}
+
+/**
+ * Find a sector in the sector cache.
+ * The sector's last-used tick is updated if it's found.
+ * @param sector_num Sector number.
+ * @return Cache entry, or nullptr if not found.
+ */
+WiiPartitionPrivate::SectorCacheEntry *WiiPartitionPrivate::findCachedSector(uint32_t sector_num)
+{
+	SectorCacheEntry *entry = sectorCache.get();
+	for (unsigned int i = SECTOR_CACHE_COUNT; i > 0; i--, entry++) {
+		if (entry->sector_num == sector_num) {
+			entry->lastUsed = ++sectorCacheTick;
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Get the least-recently used sector cache entry.
+ * @return Cache entry.
+ */
+WiiPartitionPrivate::SectorCacheEntry *WiiPartitionPrivate::getLRUCacheEntry(void)
+{
+	SectorCacheEntry *entry = sectorCache.get();
+	SectorCacheEntry *lru = entry;
+	for (unsigned int i = SECTOR_CACHE_COUNT; i > 0; i--, entry++) {
+		if (entry->sector_num == ~0U) {
+			// Unused entry.
+			return entry;
+		}
+		// NOTE: Subtraction handles tick wraparound.
+		if ((uint32_t)(sectorCacheTick - entry->lastUsed) >
+		    (uint32_t)(sectorCacheTick - lru->lastUsed))
+		{
+			lru = entry;
+		}
+	}
+	return lru;
+}
+
+/**
+ * Make sure the specified sectors are in the sector cache.
+ * Runs of contiguous missing sectors are read in batches.
+ *
+ * @param sector_num	[in] First sector number. (address / 0x7C00)
+ * @param count		[in] Number of sectors. (must be <= SECTOR_CACHE_COUNT)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiPartitionPrivate::cacheSectors(uint32_t sector_num, unsigned int count)
+{
+	assert(count > 0);
+	assert(count <= SECTOR_CACHE_COUNT);
+	static_assert(SECTOR_CACHE_COUNT <= SECTOR_BATCH_MAX,
+		"SECTOR_CACHE_COUNT must be <= SECTOR_BATCH_MAX.");
+
+	if (!sectorCache) {
+		// Allocate the sector cache.
+		sectorCache.reset(new SectorCacheEntry[SECTOR_CACHE_COUNT]);
+		for (unsigned int i = 0; i < SECTOR_CACHE_COUNT; i++) {
+			sectorCache[i].sector_num = ~0U;
+			sectorCache[i].lastUsed = 0;
+		}
+	}
+
+	// Mark sectors that are already cached as recently used
+	// so they won't be evicted while loading the others.
+	// Bit i is set if sector_num+i is missing.
+	uint32_t missing = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		if (!findCachedSector(sector_num + i)) {
+			missing |= (1U << i);
+		}
+	}
+	if (missing == 0) {
+		// All sectors are cached.
+		return 0;
+	}
+
+	if (!batchBuf) {
+		batchBuf.reset(new uint8_t[SECTOR_BATCH_MAX * SECTOR_SIZE_ENCRYPTED]);
+	}
+
+	// Read runs of missing sectors.
+	unsigned int i = 0;
+	while (i < count) {
+		if (!(missing & (1U << i))) {
+			i++;
+			continue;
+		}
+
+		// Find the end of this run.
+		unsigned int runEnd = i + 1;
+		while (runEnd < count && (missing & (1U << runEnd))) {
+			runEnd++;
+		}
+		const unsigned int runCount = runEnd - i;
+
+		int ret = readSectors(sector_num + i, runCount, batchBuf.get());
+		if (ret != 0) {
+			return ret;
+		}
+
+		// Add the sectors to the cache.
+		const uint8_t *src = batchBuf.get();
+		for (unsigned int j = i; j < runEnd; j++, src += SECTOR_SIZE_ENCRYPTED) {
+			SectorCacheEntry *const entry = getLRUCacheEntry();
+			memcpy(entry->buf, src, SECTOR_SIZE_ENCRYPTED);
+			entry->sector_num = sector_num + j;
+			entry->lastUsed = ++sectorCacheTick;
+		}
+
+		i = runEnd;
 	}
 
-	// Sector read and decrypted.
-	this->sector_num = sector_num;
 	return 0;
 }
+
+/**
+ * Read and decrypt a sector using the sector cache.
+ *
+ * NOTE: The returned pointer is only valid until the
+ * next cache operation. sectorMutex must be held.
+ *
+ * @param sector_num Sector number. (address / 0x7C00)
+ * @return Pointer to the decrypted sector, or nullptr on error.
+ */
+const uint8_t *WiiPartitionPrivate::readSector(uint32_t sector_num)
+{
+	if (cacheSectors(sector_num, 1) != 0) {
+		// Error reading the sector.
+		return nullptr;
+	}
+
+	SectorCacheEntry *const entry = findCachedSector(sector_num);
+	assert(entry != nullptr);
+	return (entry ? entry->buf : nullptr);
+}
 #endif /* ENABLE_DECRYPTION */
 
 /** WiiPartition **/
@@ -496,6 +898,46 @@ size_t WiiPartition::read(void *ptr, size_t size)
 	}
 
 #ifdef ENABLE_DECRYPTION
+	size_t ret = this->pread(d->pos_7C00, ptr, size);
+	if (ret <= size) {
+		// NOTE: pread() returns -EIO if decryption
+		// couldn't be initialized.
+		d->pos_7C00 += ret;
+	}
+	return ret;
+#else /* !ENABLE_DECRYPTION */
+	// Decryption is not enabled.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EIO;
+	return 0;
+#endif /* ENABLE_DECRYPTION */
+}
+
+/**
+ * Read data from the specified position in the partition.
+ * This does not use the partition position, so it's
+ * thread-safe as long as the underlying IDiscReader's
+ * pread() is thread-safe.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t WiiPartition::pread(int64_t pos, void *ptr, size_t size)
+{
+	RP_D(WiiPartition);
+	assert(d->discReader != nullptr);
+	assert(d->discReader->isOpen());
+	if (!d->discReader || !d->discReader->isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+#ifdef ENABLE_DECRYPTION
+	// The decrypted sector cache is shared.
+	MutexLocker sectorLock(d->sectorMutex);
+
 	// Make sure decryption is initialized.
 	switch (d->verifyResult) {
 		case KeyManager::VERIFY_UNKNOWN:
@@ -523,68 +965,82 @@ size_t WiiPartition::read(void *ptr, size_t size)
 	size_t ret = 0;
 
 	// Are we already at the end of the file?
-	if (d->pos_7C00 >= d->data_size)
+	if (pos < 0 || pos >= d->data_size || size == 0)
 		return 0;
 
-	// Make sure d->pos_7C00 + size <= d->data_size.
+	// Make sure pos + size <= d->data_size.
 	// If it isn't, we'll do a short read.
-	if (d->pos_7C00 + (int64_t)size >= d->data_size) {
-		size = (size_t)(d->data_size - d->pos_7C00);
+	if (pos + (int64_t)size >= d->data_size) {
+		size = (size_t)(d->data_size - pos);
 	}
 
-	// Check if we're not starting on a block boundary.
-	const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_DECRYPTED;
-	if (blockStartOffset != 0) {
-		// Not a block boundary.
-		// Read the end of the block.
-		uint32_t read_sz = SECTOR_SIZE_DECRYPTED - blockStartOffset;
-		if (size < (size_t)read_sz) {
-			read_sz = (uint32_t)size;
-		}
-
-		// Read and decrypt the sector.
-		uint32_t blockStart = (uint32_t)(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-		d->readSector(blockStart);
-
-		// Copy data from the sector.
-		memcpy(ptr8, &d->sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET + blockStartOffset], read_sz);
-
-		// Starting block read.
-		size -= read_sz;
-		ptr8 += read_sz;
-		ret += read_sz;
-		d->pos_7C00 += read_sz;
+	// Sector range for this read.
+	uint32_t sector_num = (uint32_t)(pos / SECTOR_SIZE_DECRYPTED);
+	const uint32_t sector_last = (uint32_t)((pos + size - 1) / SECTOR_SIZE_DECRYPTED);
+	const unsigned int sector_count = sector_last - sector_num + 1;
+	const bool useCache = (sector_count <= WiiPartitionPrivate::SECTOR_CACHE_COUNT);
+	if (useCache) {
+		// Small read. Load all of the sectors into the cache
+		// first so contiguous missing sectors are read in a batch.
+		// NOTE: If an I/O error occurs, the per-sector loop
+		// below will stop at the first bad sector.
+		d->cacheSectors(sector_num, sector_count);
 	}
 
-	// Read entire blocks.
-	for (; size >= SECTOR_SIZE_DECRYPTED;
-	    size -= SECTOR_SIZE_DECRYPTED, ptr8 += SECTOR_SIZE_DECRYPTED,
-	    ret += SECTOR_SIZE_DECRYPTED, d->pos_7C00 += SECTOR_SIZE_DECRYPTED)
-	{
-		assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
+	uint32_t sectorOffset = pos % SECTOR_SIZE_DECRYPTED;
+	while (size > 0) {
+		if (!useCache && sectorOffset == 0 && size >= SECTOR_SIZE_DECRYPTED) {
+			// Large read: Decrypt entire sectors in batches,
+			// bypassing the sector cache.
+			unsigned int count = (unsigned int)(size / SECTOR_SIZE_DECRYPTED);
+			if (count > WiiPartitionPrivate::SECTOR_BATCH_MAX) {
+				count = WiiPartitionPrivate::SECTOR_BATCH_MAX;
+			}
 
-		// Read and decrypt the sector.
-		uint32_t blockStart = (uint32_t)(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-		d->readSector(blockStart);
+			if (!d->batchBuf) {
+				d->batchBuf.reset(new uint8_t[WiiPartitionPrivate::SECTOR_BATCH_MAX * SECTOR_SIZE_ENCRYPTED]);
+			}
+			if (d->readSectors(sector_num, count, d->batchBuf.get()) != 0) {
+				// I/O error.
+				break;
+			}
 
-		// Copy data from the sector.
-		memcpy(ptr8, &d->sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED);
-	}
+			// Copy the data from the sectors.
+			const uint8_t *src = d->batchBuf.get() + SECTOR_SIZE_DECRYPTED_OFFSET;
+			for (unsigned int i = count; i > 0; i--) {
+				memcpy(ptr8, src, SECTOR_SIZE_DECRYPTED);
+				ptr8 += SECTOR_SIZE_DECRYPTED;
+				src += SECTOR_SIZE_ENCRYPTED;
+			}
 
-	// Check if we still have data left. (not a full block)
-	if (size > 0) {
-		// Not a full block.
+			const size_t read_sz = (size_t)count * SECTOR_SIZE_DECRYPTED;
+			size -= read_sz;
+			ret += read_sz;
+			sector_num += count;
+			continue;
+		}
+
+		// Partial sector, or a small read.
+		size_t read_sz = SECTOR_SIZE_DECRYPTED - sectorOffset;
+		if (size < read_sz) {
+			read_sz = size;
+		}
 
 		// Read and decrypt the sector.
-		assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
-		uint32_t blockEnd = (uint32_t)(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-		d->readSector(blockEnd);
+		const uint8_t *const sector_buf = d->readSector(sector_num);
+		if (!sector_buf) {
+			// I/O error.
+			break;
+		}
 
 		// Copy data from the sector.
-		memcpy(ptr8, &d->sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], size);
+		memcpy(ptr8, &sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET + sectorOffset], read_sz);
 
-		ret += size;
-		d->pos_7C00 += size;
+		size -= read_sz;
+		ptr8 += read_sz;
+		ret += read_sz;
+		sector_num++;
+		sectorOffset = 0;
 	}
 
 	// Finished reading the data.
@@ -717,6 +1173,467 @@ const uint8_t *WiiPartition::encryptionVerifyData_static(int keyIdx)
 		return nullptr;
 	return WiiPartitionPrivate::EncryptionKeyVerifyData[keyIdx];
 }
+
+/** Hash verification **/
+
+/**
+ * Enable or disable hash verification while reading.
+ *
+ * If enabled, each sector is checked against the H0-H3
+ * hash tree when it's read. Sectors that fail verification
+ * can't be read, and they're added to the bad sector list.
+ *
+ * @param enable True to enable; false to disable.
+ */
+void WiiPartition::setHashVerification(bool enable)
+{
+	RP_D(WiiPartition);
+	MutexLocker sectorLock(d->sectorMutex);
+	if (d->hashVerify == enable)
+		return;
+
+	if (enable) {
+		// The H3 table is needed for verification.
+		int ret = d->loadH3Table();
+		if (ret != 0) {
+			m_lastError = -ret;
+			return;
+		}
+
+		// Sectors that are already cached weren't verified.
+		if (d->sectorCache) {
+			for (unsigned int i = 0; i < WiiPartitionPrivate::SECTOR_CACHE_COUNT; i++) {
+				d->sectorCache[i].sector_num = ~0U;
+			}
+		}
+	}
+	d->hashVerify = enable;
+}
+
+/**
+ * Is hash verification while reading enabled?
+ * @return True if enabled; false if not.
+ */
+bool WiiPartition::hashVerification(void) const
+{
+	RP_D(const WiiPartition);
+	return d->hashVerify;
+}
+
+/**
+ * Get the sectors that failed hash verification while reading.
+ * @return Bad sectors, in the order they were found.
+ */
+vector<WiiPartition::BadSector> WiiPartition::badSectors(void) const
+{
+	RP_D(const WiiPartition);
+	MutexLocker sectorLock(d->sectorMutex);
+	return d->readBadSectors;
+}
+
+/**
+ * processGroups() sector group slot.
+ *
+ * Slots are filled by the reader thread in group order,
+ * decrypted by the worker threads, and released by the
+ * sink once the group has been passed to the callback.
+ */
+struct ProcessGroupsSlot {
+	unique_ptr<uint8_t[]> buf;	// One sector group.
+	uint32_t group;			// Sector group number.
+	unsigned int sectorCount;	// Number of sectors in this group.
+	unsigned int readable;		// Number of sectors that were read successfully.
+	bool done;			// Decrypted and waiting for the sink.
+	vector<WiiPartition::BadSector> badSectors;
+};
+
+/**
+ * processGroups() job data.
+ */
+struct ProcessGroupsJob {
+	explicit ProcessGroupsJob(unsigned int slotCount)
+		: slotCount(slotCount)
+		, slots(new ProcessGroupsSlot[slotCount])
+		, freeSlots(slotCount)
+		, loadedSlots(0, slotCount)
+		, nextTake(0)
+		, nextGroup(0)
+		, abort(0)
+		, cbRet(0)
+	{ }
+
+	const WiiPartitionPrivate *d;
+	int64_t data_addr;		// Address of the first encrypted sector.
+	uint32_t sectorCount;		// Total number of sectors.
+	unsigned int groupCount;	// Total number of sector groups.
+	unsigned int flags;		// WiiPartition::ProcessFlags
+	WiiPartition::GroupCallback callback;
+	void *userdata;
+
+	// Sector group slots.
+	// Group g always uses slot (g % slotCount).
+	const unsigned int slotCount;
+	unique_ptr<ProcessGroupsSlot[]> slots;
+	Semaphore freeSlots;		// Slots that the reader can fill.
+	Semaphore loadedSlots;		// Slots that are waiting for a worker.
+	int nextTake;			// Next group for a worker to take. (atomic)
+
+	// Unused ciphers.
+	// run() never has more items in flight than threads,
+	// so there's always a cipher available.
+	Mutex cipherMutex;
+	vector<IAesCipher*> freeCiphers;
+
+	// Ordered sink.
+	Mutex sinkMutex;
+	unsigned int nextGroup;		// Next group to pass to the callback.
+
+	// Set if the callback stopped processing. (atomic)
+	int abort;
+	int cbRet;
+
+	/**
+	 * Has the callback stopped processing?
+	 * @return True if processing should stop.
+	 */
+	inline bool isAborted(void)
+	{
+		return (ATOMIC_OR_FETCH(&abort, 0) != 0);
+	}
+
+	/**
+	 * Stop processing.
+	 */
+	inline void setAborted(void)
+	{
+		ATOMIC_EXCHANGE(&abort, 1);
+	}
+};
+
+/**
+ * Read a sector group into its slot.
+ * @param job ProcessGroupsJob.
+ * @param g Sector group number.
+ */
+static void processGroups_readGroup(ProcessGroupsJob *job, unsigned int g)
+{
+	// Wait for the sink to release this group's slot.
+	job->freeSlots.obtain();
+	ProcessGroupsSlot *const slot = &job->slots[g % job->slotCount];
+
+	const uint32_t first = g * SECTORS_PER_GROUP;
+	unsigned int count = job->sectorCount - first;
+	if (count > SECTORS_PER_GROUP) {
+		count = SECTORS_PER_GROUP;
+	}
+	slot->group = g;
+	slot->sectorCount = count;
+	slot->readable = 0;
+
+	if (!job->isAborted()) {
+		const size_t size = job->d->discReader->pread(
+			job->data_addr + ((int64_t)first * SECTOR_SIZE_ENCRYPTED),
+			slot->buf.get(), (size_t)count * SECTOR_SIZE_ENCRYPTED);
+		if (size <= (size_t)count * SECTOR_SIZE_ENCRYPTED) {
+			slot->readable = (unsigned int)(size / SECTOR_SIZE_ENCRYPTED);
+		}
+	}
+
+	// Hand the group off to a worker.
+	job->loadedSlots.release();
+}
+
+/**
+ * processGroups() reader thread function.
+ * Reads sector groups sequentially into the slots.
+ * @param param ProcessGroupsJob.
+ */
+static void processGroups_reader(void *param)
+{
+	ProcessGroupsJob *const job = static_cast<ProcessGroupsJob*>(param);
+	for (unsigned int g = 0; g < job->groupCount; g++) {
+		processGroups_readGroup(job, g);
+	}
+}
+
+/**
+ * processGroups() work item function.
+ * Decrypts (and optionally verifies) the next sector group,
+ * then passes all completed groups to the callback in order.
+ * @param param ProcessGroupsJob.
+ * @param idx Work item index. (unused)
+ */
+static void processGroups_work(void *param, unsigned int idx)
+{
+	RP_UNUSED(idx);
+	ProcessGroupsJob *const job = static_cast<ProcessGroupsJob*>(param);
+
+	// Wait for the reader, then take the next loaded group.
+	// NOTE: Work items may start out of order relative to
+	// the reader, so the group is taken here instead of
+	// being derived from the work item index.
+	job->loadedSlots.obtain();
+	const unsigned int group = (unsigned int)(ATOMIC_INC_FETCH(&job->nextTake) - 1);
+	ProcessGroupsSlot *const slot = &job->slots[group % job->slotCount];
+	assert(slot->group == group);
+
+	if (!job->isAborted()) {
+		IAesCipher *cipher;
+		{
+			MutexLocker cipherLock(job->cipherMutex);
+			assert(!job->freeCiphers.empty());
+			cipher = job->freeCiphers.back();
+			job->freeCiphers.pop_back();
+		}
+
+		uint8_t *const buf = slot->buf.get();
+		if (WiiPartitionPrivate::decryptSectors(cipher, buf, slot->readable) != 0) {
+			// Decryption error.
+			slot->readable = 0;
+		}
+
+		// Check for bad sectors.
+		const bool verify = !!(job->flags & WiiPartition::PROCESS_VERIFY);
+		const uint8_t *sector = buf;
+		for (unsigned int i = 0; i < slot->sectorCount; i++, sector += SECTOR_SIZE_ENCRYPTED) {
+			WiiPartition::BadSector entry;
+			entry.sector = (group * SECTORS_PER_GROUP) + i;
+			entry.h0_mask = 0;
+			if (i >= slot->readable) {
+				entry.errors = WiiPartition::HASHERR_READ;
+			} else if (verify) {
+				entry.errors = job->d->verifySector(cipher, sector, entry.sector, &entry.h0_mask);
+			} else {
+				continue;
+			}
+			if (entry.errors != 0) {
+				slot->badSectors.push_back(entry);
+			}
+		}
+
+		{
+			MutexLocker cipherLock(job->cipherMutex);
+			job->freeCiphers.push_back(cipher);
+		}
+
+		// Remove the hash areas so the user data is contiguous.
+		for (unsigned int i = 0; i < slot->readable; i++) {
+			memmove(&buf[i * SECTOR_SIZE_DECRYPTED],
+				&buf[(i * SECTOR_SIZE_ENCRYPTED) + SECTOR_SIZE_DECRYPTED_OFFSET],
+				SECTOR_SIZE_DECRYPTED);
+		}
+		if (slot->readable < slot->sectorCount) {
+			// Unreadable sectors are returned as zeroes.
+			memset(&buf[slot->readable * SECTOR_SIZE_DECRYPTED], 0,
+				(slot->sectorCount - slot->readable) * SECTOR_SIZE_DECRYPTED);
+		}
+	}
+
+	// Ordered sink: whichever thread completes the next group
+	// in sequence passes it and any consecutive completed groups
+	// to the callback.
+	MutexLocker sinkLock(job->sinkMutex);
+	slot->done = true;
+	while (job->nextGroup < job->groupCount) {
+		ProcessGroupsSlot *const next = &job->slots[job->nextGroup % job->slotCount];
+		if (!next->done)
+			break;
+
+		if (!job->isAborted()) {
+			WiiPartition::GroupInfo info;
+			info.group = next->group;
+			info.sector = next->group * SECTORS_PER_GROUP;
+			info.sectorCount = next->sectorCount;
+			info.data = next->buf.get();
+			info.badSectors = (next->badSectors.empty() ? nullptr : next->badSectors.data());
+			info.badSectorCount = (unsigned int)next->badSectors.size();
+			int ret = job->callback(&info, job->userdata);
+			if (ret != 0) {
+				// Stop processing.
+				job->cbRet = ret;
+				job->setAborted();
+			}
+		}
+
+		next->done = false;
+		next->badSectors.clear();
+		job->nextGroup++;
+		job->freeSlots.release();
+	}
+}
+
+/**
+ * Decrypt the entire partition using a parallel pipeline.
+ *
+ * One thread reads sector groups sequentially, a pool of worker
+ * threads decrypts them with one AES cipher instance per thread,
+ * and the decrypted groups are passed to the callback in order.
+ *
+ * @param callback	[in] Callback function.
+ * @param userdata	[in] User data for the callback.
+ * @param flags		[in,opt] Processing flags. (See ProcessFlags.)
+ * @param threads	[in,opt] Number of worker threads. (If 0, use the number of logical processors.)
+ * @return 0 on success; negative POSIX error code on error; or the callback's return value if it stopped processing.
+ */
+int WiiPartition::processGroups(GroupCallback callback, void *userdata, unsigned int flags, unsigned int threads)
+{
+	RP_D(WiiPartition);
+	assert(d->discReader != nullptr);
+	assert(d->discReader->isOpen());
+	assert(callback != nullptr);
+	if (!d->discReader || !d->discReader->isOpen()) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	} else if (!callback) {
+		m_lastError = EINVAL;
+		return -m_lastError;
+	}
+
+	{
+		MutexLocker sectorLock(d->sectorMutex);
+
+		// Make sure decryption is initialized.
+		if (d->verifyResult == KeyManager::VERIFY_UNKNOWN) {
+			d->initDecryption();
+		}
+		if (d->verifyResult != KeyManager::VERIFY_OK) {
+			// Decryption could not be initialized.
+			m_lastError = EIO;
+			return -m_lastError;
+		}
+
+		if (flags & PROCESS_VERIFY) {
+			// Load the H3 table.
+			int ret = d->loadH3Table();
+			if (ret != 0) {
+				m_lastError = -ret;
+				return ret;
+			}
+		}
+	}
+
+	const uint32_t sectorCount = (uint32_t)(d->data_size / SECTOR_SIZE_ENCRYPTED);
+	const unsigned int groupCount = (sectorCount + SECTORS_PER_GROUP - 1) / SECTORS_PER_GROUP;
+	if (groupCount == 0) {
+		// Nothing to process.
+		return 0;
+	}
+
+	// Don't start more threads than we have sector groups.
+	if (threads == 0) {
+		threads = Thread::processorCount();
+	}
+	if (threads > groupCount) {
+		threads = groupCount;
+	}
+	ThreadPool pool(threads);
+
+	// Two extra slots let the reader stay ahead of the workers.
+	unsigned int slotCount = pool.threadCount() + 2;
+	if (slotCount > groupCount) {
+		slotCount = groupCount;
+	}
+	ProcessGroupsJob job(slotCount);
+	for (unsigned int i = 0; i < slotCount; i++) {
+		ProcessGroupsSlot *const slot = &job.slots[i];
+		slot->buf.reset(new uint8_t[SECTORS_PER_GROUP * SECTOR_SIZE_ENCRYPTED]);
+		slot->group = ~0U;
+		slot->sectorCount = 0;
+		slot->readable = 0;
+		slot->done = false;
+	}
+
+	// Create a cipher for each thread.
+	// NOTE: IAesCipher objects aren't thread-safe.
+	vector<unique_ptr<IAesCipher> > ciphers(pool.threadCount());
+	for (auto iter = ciphers.begin(); iter != ciphers.end(); ++iter) {
+		iter->reset(AesCipherFactory::create());
+		IAesCipher *const cipher = iter->get();
+		if (!cipher || !cipher->isInit() ||
+		    cipher->setKey(d->title_key, sizeof(d->title_key)) != 0 ||
+		    cipher->setChainingMode(IAesCipher::CM_CBC) != 0)
+		{
+			// Error initializing the cipher.
+			m_lastError = EIO;
+			return -m_lastError;
+		}
+		job.freeCiphers.push_back(cipher);
+	}
+
+	job.d = d;
+	job.data_addr = d->partition_offset + d->data_offset;
+	job.sectorCount = sectorCount;
+	job.groupCount = groupCount;
+	job.flags = flags;
+	job.callback = callback;
+	job.userdata = userdata;
+
+	// Start the reader, then decrypt the groups.
+	// NOTE: The reader only waits for groups that have been
+	// passed to the callback, so this can't deadlock.
+	{
+		Thread reader(processGroups_reader, &job);
+		if (reader.isRunning()) {
+			pool.run(groupCount, processGroups_work, &job);
+			reader.join();
+		} else {
+			// Unable to start the reader thread.
+			// Read and decrypt the groups on this thread.
+			// Each group is passed to the callback before the
+			// next one is read, so a slot is always available.
+			for (unsigned int g = 0; g < groupCount; g++) {
+				processGroups_readGroup(&job, g);
+				processGroups_work(&job, g);
+			}
+		}
+	}
+
+	return job.cbRet;
+}
+
+/**
+ * verifyHashes() group callback.
+ * @param info Sector group information.
+ * @param userdata vector<BadSector>
+ * @return 0
+ */
+static int verifyHashes_callback(const WiiPartition::GroupInfo *info, void *userdata)
+{
+	// Groups are processed in order, so the list is sorted.
+	vector<WiiPartition::BadSector> *const badSectors =
+		static_cast<vector<WiiPartition::BadSector>*>(userdata);
+	badSectors->insert(badSectors->end(),
+		info->badSectors, info->badSectors + info->badSectorCount);
+	return 0;
+}
+
+/**
+ * Verify the hashes of the entire partition.
+ *
+ * This uses the processGroups() pipeline, so sector groups
+ * are decrypted and verified in parallel.
+ *
+ * @param report	[out] Hash verification report.
+ * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+ * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+ */
+int WiiPartition::verifyHashes(HashReport &report, unsigned int threads)
+{
+	RP_D(const WiiPartition);
+	report.sectorCount = 0;
+	report.h3TableOK = false;
+	report.badSectors.clear();
+
+	int ret = processGroups(verifyHashes_callback, &report.badSectors, PROCESS_VERIFY, threads);
+	if (ret != 0) {
+		report.badSectors.clear();
+		return ret;
+	}
+
+	report.sectorCount = (uint32_t)(d->data_size / SECTOR_SIZE_ENCRYPTED);
+	report.h3TableOK = d->h3TableOK;
+	return 0;
+}
 #endif /* ENABLE_DECRYPTION */
 
 }
@@ -28,6 +28,9 @@
 // librpbase
 #include "librpbase/crypto/KeyManager.hpp"
 
+// C++ includes.
+#include <vector>
+
 namespace LibRomData {
 
 class WiiPartitionPrivate;
@@ -66,6 +69,18 @@ class WiiPartition : public GcnPartition
 		 */
 		virtual size_t read(void *ptr, size_t size) override final;
 
+		/**
+		 * Read data from the specified position in the partition.
+		 * This does not use the partition position, so it's
+		 * thread-safe as long as the underlying IDiscReader's
+		 * pread() is thread-safe.
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override final;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
@@ -140,6 +155,115 @@ class WiiPartition : public GcnPartition
 		 * @return Verification data. (16 bytes)
 		 */
 		static const uint8_t *encryptionVerifyData_static(int keyIdx);
+
+	public:
+		/** Hash verification **/
+
+		// Hash verification error bits.
+		enum HashErrorBits {
+			HASHERR_H0	= (1U << 0),	// Data block doesn't match H0.
+			HASHERR_H1	= (1U << 1),	// H0 table doesn't match H1.
+			HASHERR_H2	= (1U << 2),	// H1 table doesn't match H2.
+			HASHERR_H3	= (1U << 3),	// H2 table doesn't match H3.
+			HASHERR_READ	= (1U << 4),	// Sector could not be read.
+		};
+
+		// Sector that failed hash verification.
+		struct BadSector {
+			uint32_t sector;	// Sector number. (Group is sector / 64.)
+			uint32_t errors;	// Error bits. (See HashErrorBits.)
+			uint32_t h0_mask;	// Data blocks that don't match H0. (bit 0 == block 0)
+		};
+
+		// Hash verification report.
+		struct HashReport {
+			uint32_t sectorCount;	// Number of sectors checked.
+			bool h3TableOK;		// True if the H3 table matches the TMD.
+			std::vector<BadSector> badSectors;	// Sorted by sector number.
+		};
+
+		/**
+		 * Enable or disable hash verification while reading.
+		 *
+		 * If enabled, each sector is checked against the H0-H3
+		 * hash tree when it's read. Sectors that fail verification
+		 * can't be read, and they're added to the bad sector list.
+		 *
+		 * @param enable True to enable; false to disable.
+		 */
+		void setHashVerification(bool enable);
+
+		/**
+		 * Is hash verification while reading enabled?
+		 * @return True if enabled; false if not.
+		 */
+		bool hashVerification(void) const;
+
+		/**
+		 * Get the sectors that failed hash verification while reading.
+		 * @return Bad sectors, in the order they were found.
+		 */
+		std::vector<BadSector> badSectors(void) const;
+
+		/** Whole-partition processing **/
+
+		// Decrypted sector group.
+		struct GroupInfo {
+			uint32_t group;			// Sector group number.
+			uint32_t sector;		// First sector number.
+			unsigned int sectorCount;	// Number of sectors. (64, except for the last group)
+			const uint8_t *data;		// Decrypted user data. (sectorCount * 0x7C00 bytes)
+			const BadSector *badSectors;	// Bad sectors in this group, or nullptr if none.
+			unsigned int badSectorCount;	// Number of bad sectors.
+		};
+
+		/**
+		 * processGroups() callback.
+		 * GroupInfo is only valid until the callback returns.
+		 * @param info Decrypted sector group.
+		 * @param userdata User data.
+		 * @return 0 to continue; non-zero to stop processing.
+		 */
+		typedef int (*GroupCallback)(const GroupInfo *info, void *userdata);
+
+		// processGroups() flags.
+		enum ProcessFlags {
+			// Verify sectors against the H0-H3 hash tree.
+			// If not set, only read errors are reported.
+			PROCESS_VERIFY	= (1U << 0),
+		};
+
+		/**
+		 * Decrypt the entire partition using a parallel pipeline.
+		 *
+		 * One thread reads sector groups sequentially, a pool of worker
+		 * threads decrypts them with one AES cipher instance per thread,
+		 * and the decrypted groups are passed to the callback in order.
+		 * The callback is never called by more than one thread at a time.
+		 *
+		 * Unreadable sectors are returned as zeroes and reported
+		 * as bad sectors with HASHERR_READ.
+		 *
+		 * @param callback	[in] Callback function.
+		 * @param userdata	[in] User data for the callback.
+		 * @param flags		[in,opt] Processing flags. (See ProcessFlags.)
+		 * @param threads	[in,opt] Number of worker threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success; negative POSIX error code on error; or the callback's return value if it stopped processing.
+		 */
+		int processGroups(GroupCallback callback, void *userdata,
+			unsigned int flags = 0, unsigned int threads = 0);
+
+		/**
+		 * Verify the hashes of the entire partition.
+		 *
+		 * This uses the processGroups() pipeline, so sector groups
+		 * are decrypted and verified in parallel.
+		 *
+		 * @param report	[out] Hash verification report.
+		 * @param threads	[in,opt] Number of threads. (If 0, use the number of logical processors.)
+		 * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+		 */
+		int verifyHashes(HashReport &report, unsigned int threads = 0);
 #endif /* ENABLE_DECRYPTION */
 };
 
@@ -0,0 +1,79 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * gcz.h: GameCube/Wii GCZ (Dolphin compressed) structs.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// References:
+// - https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/DiscIO/CompressedBlob.cpp
+// - https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/DiscIO/CompressedBlob.h
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_DISC_GCZ_H__
+#define __ROMPROPERTIES_LIBROMDATA_DISC_GCZ_H__
+
+#include "librpbase/common.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#pragma pack(1)
+
+// GCZ magic. (LE32)
+#define GCZ_MAGIC 0xB10BC001
+
+// GCZ sub types.
+#define GCZ_SUBTYPE_GCN 0
+#define GCZ_SUBTYPE_WII 1
+
+// Block size limits.
+// Dolphin uses 16 KB or 32 KB blocks by default.
+#define GCZ_BLOCK_SIZE_MIN (512)
+#define GCZ_BLOCK_SIZE_MAX (16*1024*1024)
+
+// If this bit is set in a block pointer,
+// the block is stored uncompressed.
+#define GCZ_BLOCK_UNCOMPRESSED (1ULL << 63)
+
+/**
+ * GCZ header.
+ * All fields are little-endian.
+ *
+ * The header is followed by:
+ * - uint64_t block_pointers[num_blocks]: Offsets relative to the start of the data area.
+ * - uint32_t hashes[num_blocks]: Adler-32 of each block's stored data.
+ * - Block data.
+ */
+typedef struct PACKED _GczHeader {
+	uint32_t magic;			// [0x000] GCZ_MAGIC
+	uint32_t sub_type;		// [0x004] GCZ_SUBTYPE_*
+	uint64_t compressed_data_size;	// [0x008] Size of the block data area.
+	uint64_t data_size;		// [0x010] Uncompressed disc size.
+	uint32_t block_size;		// [0x018] Uncompressed block size.
+	uint32_t num_blocks;		// [0x01C] Number of blocks.
+} GczHeader;
+ASSERT_STRUCT(GczHeader, 32);
+
+#pragma pack()
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_DISC_GCZ_H__ */
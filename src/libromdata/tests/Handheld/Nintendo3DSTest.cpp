@@ -0,0 +1,191 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * Nintendo3DSTest.cpp: Nintendo3DS field group test.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Nintendo3DS
+#include "libromdata/Handheld/Nintendo3DS.hpp"
+#include "libromdata/Handheld/n3ds_structs.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+using LibRpBase::RomData;
+using LibRpBase::RomFields;
+using LibRpBase::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+// CCI image layout, in media units. (512 bytes)
+// Partition 0 is a NoCrypto NCCH with no ExHeader or ExeFS.
+static const uint32_t NCCH_OFFSET = 0x20;
+static const uint32_t NCCH_SIZE = 0x20;
+static const size_t CCI_SIZE = (size_t)(NCCH_OFFSET + NCCH_SIZE) << 9;
+
+class Nintendo3DSTest : public ::testing::Test
+{
+	protected:
+		Nintendo3DSTest()
+			: m_romData(nullptr)
+		{ }
+
+		void SetUp(void) override final;
+		void TearDown(void) override final;
+
+		/**
+		 * Find a field by name.
+		 * @param fields RomFields.
+		 * @param name Field name.
+		 * @return Field, or nullptr if not found.
+		 */
+		static const RomFields::Field *findField(const RomFields *fields, const char *name);
+
+	protected:
+		vector<uint8_t> m_cci;		// CCI image.
+		unique_ptr<RpMemFile> m_file;
+		Nintendo3DS *m_romData;
+};
+
+void Nintendo3DSTest::SetUp(void)
+{
+	// Minimal CCI image with a single NoCrypto partition.
+	// The card info header is all zeroes, so the media type
+	// is "Inner Device". This is an FG_DETAILS field.
+	m_cci.assign(CCI_SIZE, 0);
+	N3DS_NCSD_Header_NoSig_t *const ncsd_header =
+		reinterpret_cast<N3DS_NCSD_Header_NoSig_t*>(&m_cci[N3DS_NCSD_NOSIG_HEADER_ADDRESS]);
+	memcpy(ncsd_header->magic, N3DS_NCSD_HEADER_MAGIC, sizeof(ncsd_header->magic));
+	ncsd_header->image_size = cpu_to_le32(NCCH_OFFSET + NCCH_SIZE);
+	ncsd_header->media_id.lo = cpu_to_le32(0x00012300);
+	ncsd_header->media_id.hi = cpu_to_le32(0x00040000);
+	ncsd_header->partitions[0].offset = cpu_to_le32(NCCH_OFFSET);
+	ncsd_header->partitions[0].length = cpu_to_le32(NCCH_SIZE);
+
+	N3DS_NCCH_Header_t *const ncch_header =
+		reinterpret_cast<N3DS_NCCH_Header_t*>(&m_cci[(size_t)NCCH_OFFSET << 9]);
+	memcpy(ncch_header->hdr.magic, N3DS_NCCH_HEADER_MAGIC, sizeof(ncch_header->hdr.magic));
+	ncch_header->hdr.content_size = cpu_to_le32(NCCH_SIZE);
+	ncch_header->hdr.program_id = ncsd_header->media_id;
+	memcpy(ncch_header->hdr.product_code, "CTR-P-TEST", 10);
+	ncch_header->hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] = N3DS_NCCH_BIT_MASK_NoCrypto;
+
+	m_file.reset(new RpMemFile(m_cci.data(), m_cci.size()));
+	m_romData = new Nintendo3DS(m_file.get());
+	ASSERT_TRUE(m_romData->isValid());
+}
+
+void Nintendo3DSTest::TearDown(void)
+{
+	if (m_romData) {
+		m_romData->unref();
+		m_romData = nullptr;
+	}
+}
+
+/**
+ * Find a field by name.
+ * @param fields RomFields.
+ * @param name Field name.
+ * @return Field, or nullptr if not found.
+ */
+const RomFields::Field *Nintendo3DSTest::findField(const RomFields *fields, const char *name)
+{
+	const int count = fields->count();
+	for (int i = 0; i < count; i++) {
+		const RomFields::Field *const field = fields->field(i);
+		if (field && field->name == name) {
+			return field;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Requesting more field groups after fields() has loaded
+ * the field data clears the fields so they're reloaded.
+ * Requesting fewer field groups doesn't.
+ */
+TEST_F(Nintendo3DSTest, setFieldGroups)
+{
+	EXPECT_EQ((uint32_t)RomData::FG_ALL, m_romData->fieldGroups());
+
+	// Identity fields only.
+	m_romData->setFieldGroups(RomData::FG_IDENTITY);
+	EXPECT_EQ((uint32_t)RomData::FG_IDENTITY, m_romData->fieldGroups());
+	const RomFields *fields = m_romData->fields();
+	ASSERT_TRUE(fields != nullptr);
+	ASSERT_TRUE(fields->isDataLoaded());
+	EXPECT_TRUE(findField(fields, "Media ID") != nullptr);
+	EXPECT_TRUE(findField(fields, "Media Type") == nullptr);
+	const int identityCount = fields->count();
+
+	// All fields. The identity-only fields are cleared.
+	m_romData->setFieldGroups(RomData::FG_ALL);
+	EXPECT_EQ((uint32_t)RomData::FG_ALL, m_romData->fieldGroups());
+	EXPECT_FALSE(fields->isDataLoaded());
+	EXPECT_EQ(0, fields->count());
+
+	// ...and reloaded by the next fields() call.
+	fields = m_romData->fields();
+	ASSERT_TRUE(fields != nullptr);
+	ASSERT_TRUE(fields->isDataLoaded());
+	EXPECT_TRUE(findField(fields, "Media ID") != nullptr);
+	const RomFields::Field *const mediaType = findField(fields, "Media Type");
+	ASSERT_TRUE(mediaType != nullptr);
+	ASSERT_EQ(RomFields::RFT_STRING, mediaType->type);
+	ASSERT_TRUE(mediaType->data.str != nullptr);
+	EXPECT_EQ("Inner Device", *mediaType->data.str);
+	const int allCount = fields->count();
+	EXPECT_GT(allCount, identityCount);
+
+	// A subset of the loaded field groups doesn't
+	// clear the fields.
+	m_romData->setFieldGroups(RomData::FG_IDENTITY);
+	EXPECT_TRUE(fields->isDataLoaded());
+	EXPECT_EQ(allCount, m_romData->fields()->count());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: Nintendo3DS tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -51,6 +51,27 @@ using std::vector;
 
 namespace LibRomData {
 
+/**
+ * Get the number of UTF-16 code units in a UTF-8 string.
+ * @param str	[in] UTF-8 string.
+ * @param len	[in] Length of str, in bytes.
+ * @return Number of UTF-16 code units.
+ */
+static int utf8_to_utf16_length(const char *str, size_t len)
+{
+	int count = 0;
+	for (; len > 0; len--, str++) {
+		const uint8_t chr = (uint8_t)*str;
+		if ((chr & 0xC0) == 0x80) {
+			// Continuation byte.
+			continue;
+		}
+		// 4-byte sequences need a surrogate pair.
+		count += ((chr & 0xF8) == 0xF0) ? 2 : 1;
+	}
+	return count;
+}
+
 /**
  * Print an FST to an ostream.
  * @param fst		[in]FST to print.
@@ -146,14 +167,17 @@ static int fstPrint(IFst *fst, ostream &os, const string &path,
 			fc.files++;
 
 			// Save the filename.
-			string name = dirent->name;
+			// NOTE: The filename points into the FST, so it
+			// remains valid after the next readdir() call.
+			const char *const name = dirent->name;
+			const size_t name_len = dirent->name_len;
 
 			// Tree + name length.
 			// - Tree is 4 characters per level.
 			// - Attrs should start at column 40.
 			// TODO: Handle full-width and non-BMP Unicode characters correctly.
 			const int tree_name_length = ((level+1)*4) + 1 +
-					(int)rp_string_to_utf16(name).size();
+					utf8_to_utf16_length(name, name_len);
 			int attr_spaces;
 			if (tree_name_length < 40) {
 				// Pad it to 40 columns.
@@ -180,7 +204,8 @@ static int fstPrint(IFst *fst, ostream &os, const string &path,
 			os << "\xE2\x94\x80\xE2\x94\x80 ";
 
 			// Print the filename and attributes.
-			os << name << setw(attr_spaces) << ' ' << setw(0) << attrs << '\n';
+			os.write(name, name_len);
+			os << setw(attr_spaces) << ' ' << setw(0) << attrs << '\n';
 		}
 	}
 
@@ -27,6 +27,7 @@
 #include "mz_compat.h"
 
 // librpbase
+#include "librpbase/byteswap.h"
 #include "librpbase/TextFuncs.hpp"
 #include "librpbase/TextFuncs_utf8.hpp"
 #include "librpbase/file/FileSystem.hpp"
@@ -34,6 +35,7 @@ using namespace LibRpBase;
 
 // libromdata
 #include "disc/GcnFst.hpp"
+#include "Console/gcn_structs.h"
 using LibRomData::GcnFst;
 
 // libwin32common
@@ -50,12 +52,16 @@ using LibRomData::GcnFst;
 // C++ includes.
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 using std::istringstream;
 using std::ostream;
 using std::string;
 using std::stringstream;
+using std::unordered_map;
 using std::unordered_set;
+using std::vector;
 
 // Uninitialized vector class.
 // Reference: http://andreoffringa.org/?q=uvector
@@ -136,6 +142,24 @@ class GcnFstTest : public ::testing::TestWithParam<GcnFstTest_mode>
 		 */
 		void checkNoDuplicateFilenames(const char *subdir);
 
+		// Directory entry for find_file() tests.
+		struct FileEntry {
+			string path;
+			uint8_t type;
+			int64_t offset;
+			int64_t size;
+		};
+
+		/**
+		 * Recursively get all directory entries in a subdirectory.
+		 * @param entries	[out] Directory entries.
+		 * @param subdir	[in] Subdirectory path.
+		 */
+		void getAllEntries(vector<FileEntry> &entries, const string &subdir);
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
 		/**
 		 * Print a uint32_t using en_US formatting.
 		 * This is needed in order to work around issues
@@ -146,6 +170,13 @@ class GcnFstTest : public ::testing::TestWithParam<GcnFstTest_mode>
 		 */
 		static void print_uint32_en_US(ostream &os, uint32_t val);
 
+		/**
+		 * Convert ASCII letters in a path to uppercase.
+		 * @param path Path.
+		 * @return Uppercase path.
+		 */
+		static string toUpperAscii(const string &path);
+
 	public:
 		/** Test case parameters. **/
 
@@ -383,6 +414,45 @@ void GcnFstTest::checkNoDuplicateFilenames(const char *subdir)
 	m_fst->closedir(dirp);
 }
 
+/**
+ * Recursively get all directory entries in a subdirectory.
+ * @param entries	[out] Directory entries.
+ * @param subdir	[in] Subdirectory path.
+ */
+void GcnFstTest::getAllEntries(vector<FileEntry> &entries, const string &subdir)
+{
+	IFst::Dir *dirp = m_fst->opendir(subdir.c_str());
+	ASSERT_TRUE(dirp != nullptr) <<
+		"Failed to open directory '" << subdir << "'.";
+
+	vector<string> subdirs;
+	IFst::DirEnt *dirent = m_fst->readdir(dirp);
+	while (dirent != nullptr) {
+		FileEntry entry;
+		entry.path = subdir;
+		if (entry.path.empty() || entry.path[entry.path.size()-1] != '/') {
+			entry.path += '/';
+		}
+		entry.path += dirent->name;
+		entry.type = dirent->type;
+		entry.offset = dirent->offset;
+		entry.size = dirent->size;
+		if (dirent->type == DT_DIR) {
+			subdirs.push_back(entry.path);
+		}
+		entries.push_back(entry);
+
+		// Next entry.
+		dirent = m_fst->readdir(dirp);
+	}
+	m_fst->closedir(dirp);
+
+	// Check subdirectories.
+	for (auto iter = subdirs.cbegin(); iter != subdirs.cend(); ++iter) {
+		ASSERT_NO_FATAL_FAILURE(getAllEntries(entries, *iter));
+	}
+}
+
 /**
  * Print a uint32_t using en_US formatting.
  * This is needed in order to work around issues
@@ -415,6 +485,22 @@ void GcnFstTest::print_uint32_en_US(ostream &os, uint32_t val)
 	}
 }
 
+/**
+ * Convert ASCII letters in a path to uppercase.
+ * @param path Path.
+ * @return Uppercase path.
+ */
+string GcnFstTest::toUpperAscii(const string &path)
+{
+	string upper = path;
+	for (auto chr = upper.begin(); chr != upper.end(); ++chr) {
+		if (*chr >= 'a' && *chr <= 'z') {
+			*chr -= ('a' - 'A');
+		}
+	}
+	return upper;
+}
+
 /**
  * Make sure there aren't any duplicate filenames in all subdirectories.
  */
@@ -506,6 +592,278 @@ TEST_P(GcnFstTest, FstPrint)
 	EXPECT_FALSE(m_fst->hasErrors());
 }
 
+/**
+ * Look up every file and directory with find_file().
+ */
+TEST_P(GcnFstTest, FindFile)
+{
+	vector<FileEntry> entries;
+	ASSERT_NO_FATAL_FAILURE(getAllEntries(entries, "/"));
+	ASSERT_FALSE(entries.empty());
+
+	for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+		IFst::DirEnt dirent;
+		ASSERT_EQ(0, m_fst->find_file(iter->path.c_str(), &dirent)) <<
+			"find_file() failed for '" << iter->path << "'.";
+		EXPECT_EQ(iter->type, dirent.type) << "Path: '" << iter->path << "'";
+		EXPECT_EQ(iter->offset, dirent.offset) << "Path: '" << iter->path << "'";
+		EXPECT_EQ(iter->size, dirent.size) << "Path: '" << iter->path << "'";
+		ASSERT_TRUE(dirent.name != nullptr) << "Path: '" << iter->path << "'";
+		EXPECT_EQ(strlen(dirent.name), dirent.name_len) << "Path: '" << iter->path << "'";
+
+		// Relative paths and extra slashes are accepted.
+		string path = iter->path.substr(1);
+		if (iter->type == DT_DIR) {
+			path += "//";
+		}
+		ASSERT_EQ(0, m_fst->find_file(path.c_str(), &dirent)) <<
+			"find_file() failed for '" << path << "'.";
+		EXPECT_EQ(iter->offset, dirent.offset) << "Path: '" << path << "'";
+
+		// Files can't have subdirectories.
+		if (iter->type != DT_DIR) {
+			path = iter->path + "/x";
+			EXPECT_EQ(-ENOENT, m_fst->find_file(path.c_str(), &dirent)) <<
+				"Path: '" << path << "'";
+		}
+	}
+
+	// Uppercased paths resolve to the first entry, in FST order,
+	// whose path matches case-insensitively. getAllEntries() lists
+	// each directory in FST order, so the first entry it returns
+	// for an uppercased path is that entry.
+	unordered_map<string, size_t> firstEntry;
+	for (size_t i = 0; i < entries.size(); i++) {
+		firstEntry.insert(std::make_pair(toUpperAscii(entries[i].path), i));
+	}
+	for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+		const string path = toUpperAscii(iter->path);
+		const FileEntry &expected = entries[firstEntry[path]];
+
+		IFst::DirEnt dirent;
+		ASSERT_EQ(0, m_fst->find_file(path.c_str(), &dirent)) <<
+			"find_file() failed for '" << path << "'.";
+		EXPECT_EQ(expected.type, dirent.type) << "Path: '" << path << "'";
+		EXPECT_EQ(expected.offset, dirent.offset) << "Path: '" << path << "'";
+		EXPECT_EQ(expected.size, dirent.size) << "Path: '" << path << "'";
+	}
+
+	IFst::DirEnt dirent;
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/this/file/does/not/exist", &dirent));
+	EXPECT_FALSE(m_fst->hasErrors());
+}
+
+/**
+ * Make sure a GcnFst that borrows the FST data
+ * is identical to a GcnFst that copies it.
+ */
+TEST_P(GcnFstTest, Borrowed)
+{
+	// Parameterized test.
+	const GcnFstTest_mode &mode = GetParam();
+
+	GcnFst *fst_borrowed = new GcnFst(m_fst_buf.data(), (uint32_t)m_fst_buf.size(), mode.offsetShift, true);
+	ASSERT_TRUE(fst_borrowed->isOpen());
+
+	stringstream fst_text_copied, fst_text_borrowed;
+	fstPrint(m_fst, fst_text_copied);
+	fstPrint(fst_borrowed, fst_text_borrowed);
+	EXPECT_EQ(fst_text_copied.str(), fst_text_borrowed.str());
+	EXPECT_EQ(m_fst->hasErrors(), fst_borrowed->hasErrors());
+	delete fst_borrowed;
+}
+
+/**
+ * Make sure a GcnFst that borrows FST data without a
+ * NULL terminator after the last name reads that name
+ * correctly. entry_name() must not read past the buffer.
+ */
+TEST_P(GcnFstTest, BorrowedUnterminated)
+{
+	// Parameterized test.
+	const GcnFstTest_mode &mode = GetParam();
+
+	// Find the last name in the string table.
+	ASSERT_GE(m_fst_buf.size(), sizeof(GCN_FST_Entry));
+	const GCN_FST_Entry *const fst_entries = reinterpret_cast<const GCN_FST_Entry*>(m_fst_buf.data());
+	const uint32_t file_count = be32_to_cpu(fst_entries[0].root_dir.file_count);
+	const size_t string_table_offset = (size_t)file_count * sizeof(GCN_FST_Entry);
+	ASSERT_LT(string_table_offset, m_fst_buf.size());
+
+	uint32_t last_name_offset = 0;
+	for (uint32_t i = 1; i < file_count; i++) {
+		const uint32_t name_offset = be32_to_cpu(fst_entries[i].file_type_name_offset) & 0xFFFFFF;
+		if (name_offset > last_name_offset) {
+			last_name_offset = name_offset;
+		}
+	}
+	const size_t last_name_pos = string_table_offset + last_name_offset;
+	ASSERT_LT(last_name_pos, m_fst_buf.size());
+	const char *const last_name_raw = reinterpret_cast<const char*>(&m_fst_buf[last_name_pos]);
+	const size_t last_name_raw_len = strnlen(last_name_raw, m_fst_buf.size() - last_name_pos);
+	ASSERT_GT(last_name_raw_len, 0U);
+	ASSERT_LT(last_name_pos + last_name_raw_len, m_fst_buf.size()) <<
+		"The last name in the test FST isn't NULL-terminated.";
+	const string last_name = cp1252_sjis_to_utf8(last_name_raw, (int)last_name_raw_len);
+
+	// Copy the FST data up to, but not including, the final NULL
+	// terminator, so reading past the end is detectable.
+	const vector<uint8_t> trimmed(m_fst_buf.begin(), m_fst_buf.begin() + last_name_pos + last_name_raw_len);
+	GcnFst *fst_borrowed = new GcnFst(trimmed.data(), (uint32_t)trimmed.size(), mode.offsetShift, true);
+	ASSERT_TRUE(fst_borrowed->isOpen());
+
+	stringstream fst_text_copied, fst_text_borrowed;
+	fstPrint(m_fst, fst_text_copied);
+	fstPrint(fst_borrowed, fst_text_borrowed);
+	EXPECT_EQ(fst_text_copied.str(), fst_text_borrowed.str());
+
+	// Check every name, including the last one.
+	vector<FileEntry> entries;
+	ASSERT_NO_FATAL_FAILURE(getAllEntries(entries, "/"));
+	bool found_last_name = false;
+	for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+		IFst::DirEnt dirent;
+		ASSERT_EQ(0, fst_borrowed->find_file(iter->path.c_str(), &dirent)) <<
+			"find_file() failed for '" << iter->path << "'.";
+		ASSERT_TRUE(dirent.name != nullptr) << "Path: '" << iter->path << "'";
+		EXPECT_EQ(strlen(dirent.name), dirent.name_len) << "Path: '" << iter->path << "'";
+
+		const string basename = iter->path.substr(iter->path.rfind('/') + 1);
+		EXPECT_EQ(basename, dirent.name) << "Path: '" << iter->path << "'";
+		if (basename == last_name) {
+			EXPECT_EQ(last_name.size(), dirent.name_len) << "Path: '" << iter->path << "'";
+			found_last_name = true;
+		}
+	}
+	EXPECT_TRUE(found_last_name) << "Last name: '" << last_name << "'";
+
+	EXPECT_EQ(m_fst->hasErrors(), fst_borrowed->hasErrors());
+	delete fst_borrowed;
+}
+
+/**
+ * Benchmark find_file() with every path in the FST,
+ * in both the original case and uppercase.
+ */
+TEST_P(GcnFstTest, FindFile_benchmark)
+{
+	vector<FileEntry> entries;
+	ASSERT_NO_FATAL_FAILURE(getAllEntries(entries, "/"));
+
+	vector<string> paths;
+	paths.reserve(entries.size() * 2);
+	for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+		paths.push_back(iter->path);
+		paths.push_back(toUpperAscii(iter->path));
+	}
+
+	IFst::DirEnt dirent;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		for (auto iter = paths.cbegin(); iter != paths.cend(); ++iter) {
+			m_fst->find_file(iter->c_str(), &dirent);
+		}
+		// Common probes that usually aren't present.
+		m_fst->find_file("/opening.bnr", &dirent);
+		m_fst->find_file("/0GDTEX.PVR", &dirent);
+	}
+}
+
+/**
+ * Handmade FST entry.
+ */
+struct HandmadeFstEntry {
+	bool isDir;
+	const char *name;
+	uint32_t a;	// Directory: parent index. File: offset.
+	uint32_t b;	// Directory: next index. File: size.
+};
+
+// Handmade FST with names that only differ in case.
+static const HandmadeFstEntry handmadeFst[] = {
+	{false, "Opening.bnr", 0x1000, 0x100},
+	{false, "opening.bnr", 0x2000, 0x200},
+	{true,  "Files", 0, 6},
+	{false, "Data.bin", 0x3000, 0x300},
+	{false, "data.bin", 0x4000, 0x400},
+};
+static const unsigned int HANDMADE_FST_COUNT =
+	(unsigned int)(sizeof(handmadeFst) / sizeof(handmadeFst[0]));
+
+/**
+ * Build an FST from handmade entries.
+ * The root directory is added automatically.
+ * @param entries	[in] Entries.
+ * @param count		[in] Number of entries.
+ * @return FST data.
+ */
+static vector<uint8_t> buildFst(const HandmadeFstEntry *entries, unsigned int count)
+{
+	vector<uint8_t> fst((count + 1) * sizeof(GCN_FST_Entry));
+	GCN_FST_Entry *const fst_entries = reinterpret_cast<GCN_FST_Entry*>(fst.data());
+	fst_entries[0].file_type_name_offset = cpu_to_be32(0x01000000);
+	fst_entries[0].root_dir.unused = 0;
+	fst_entries[0].root_dir.file_count = cpu_to_be32(count + 1);
+
+	vector<uint8_t> strtab;
+	for (unsigned int i = 0; i < count; i++) {
+		GCN_FST_Entry *const entry = &fst_entries[i + 1];
+		entry->file_type_name_offset = cpu_to_be32(
+			(entries[i].isDir ? 0x01000000 : 0) | (uint32_t)strtab.size());
+		entry->file.offset = cpu_to_be32(entries[i].a);
+		entry->file.size = cpu_to_be32(entries[i].b);
+		strtab.insert(strtab.end(), entries[i].name, entries[i].name + strlen(entries[i].name) + 1);
+	}
+
+	fst.insert(fst.end(), strtab.begin(), strtab.end());
+	return fst;
+}
+
+/**
+ * find_file() prefers an exact match. Otherwise,
+ * it returns the first case-insensitive match in FST order.
+ */
+TEST(GcnFstHandmadeTest, CaseOnlyDifferences)
+{
+	const vector<uint8_t> fst_buf = buildFst(handmadeFst, HANDMADE_FST_COUNT);
+	GcnFst fst(fst_buf.data(), (uint32_t)fst_buf.size(), 0);
+	ASSERT_TRUE(fst.isOpen());
+	EXPECT_FALSE(fst.hasErrors());
+
+	static const struct {
+		const char *path;
+		const char *name;
+		uint32_t offset;
+	} lookups[] = {
+		// Exact matches.
+		{"/Opening.bnr", "Opening.bnr", 0x1000},
+		{"/opening.bnr", "opening.bnr", 0x2000},
+		{"/Files/Data.bin", "Data.bin", 0x3000},
+		{"/Files/data.bin", "data.bin", 0x4000},
+
+		// Case-insensitive matches.
+		{"/OPENING.BNR", "Opening.bnr", 0x1000},
+		{"/oPeNiNg.BnR", "Opening.bnr", 0x1000},
+		{"/files/DATA.BIN", "Data.bin", 0x3000},
+
+		// The whole path has to match exactly, so an exact
+		// filename in a mismatched directory isn't preferred.
+		{"/FILES/data.bin", "Data.bin", 0x3000},
+	};
+
+	for (unsigned int i = 0; i < (unsigned int)(sizeof(lookups) / sizeof(lookups[0])); i++) {
+		IFst::DirEnt dirent;
+		ASSERT_EQ(0, fst.find_file(lookups[i].path, &dirent)) <<
+			"find_file() failed for '" << lookups[i].path << "'.";
+		EXPECT_EQ(DT_REG, dirent.type) << "Path: '" << lookups[i].path << "'";
+		EXPECT_EQ((int64_t)lookups[i].offset, dirent.offset) << "Path: '" << lookups[i].path << "'";
+		ASSERT_TRUE(dirent.name != nullptr) << "Path: '" << lookups[i].path << "'";
+		EXPECT_STREQ(lookups[i].name, dirent.name) << "Path: '" << lookups[i].path << "'";
+	}
+
+	IFst::DirEnt dirent;
+	EXPECT_EQ(-ENOENT, fst.find_file("/Files/opening.bnr", &dirent));
+}
+
 /** Test case parameters. **/
 
 /**
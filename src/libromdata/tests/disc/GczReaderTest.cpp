@@ -0,0 +1,365 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * GczReaderTest.cpp: GczReader test.                                      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// GczReader
+#include "libromdata/disc/GczReader.hpp"
+#include "libromdata/disc/gcz.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/file/RpMemFile.hpp"
+using LibRpBase::RpMemFile;
+
+// zlib
+#include <zlib.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+// GCZ block size.
+static const unsigned int BLOCK_SIZE = 4096;
+
+// Number of blocks.
+static const unsigned int BLOCK_COUNT = 5;
+
+/**
+ * GczReader with access to the block read functions.
+ */
+class TestGczReader : public GczReader
+{
+	public:
+		explicit TestGczReader(LibRpBase::IRpFile *file)
+			: GczReader(file) { }
+
+	public:
+		using GczReader::readBlock;
+		using GczReader::readBlocks;
+};
+
+class GczReaderTest : public ::testing::Test
+{
+	protected:
+		GczReaderTest()
+			: m_lastBlockSize(0)
+		{ }
+
+		void SetUp(void) override final;
+
+	public:
+		// How each block is stored.
+		enum BlockType {
+			BT_COMPRESSED,
+			BT_STORED,
+		};
+
+	protected:
+		/**
+		 * Build a GCZ image from m_data.
+		 *
+		 * The last block has m_lastBlockSize bytes. Any other block
+		 * can be made short with shortBlock/shortSize to test
+		 * error handling.
+		 *
+		 * @param types Block types. (BLOCK_COUNT entries)
+		 * @param shortBlock Block index to truncate, or -1 for none.
+		 * @param shortSize Size of the truncated block.
+		 */
+		void buildGcz(const BlockType *types, int shortBlock = -1, unsigned int shortSize = 0);
+
+		/**
+		 * Get the offset of a block's stored data in m_gcz.
+		 * @param blockIdx Block index.
+		 * @return Offset in m_gcz.
+		 */
+		size_t blockOffset(unsigned int blockIdx) const;
+
+	protected:
+		vector<uint8_t> m_data;		// Uncompressed disc data, zero-padded to a full block.
+		unsigned int m_lastBlockSize;	// Size of the last block.
+		vector<uint8_t> m_gcz;		// GCZ image.
+		unique_ptr<RpMemFile> m_file;
+};
+
+void GczReaderTest::SetUp(void)
+{
+	// The last block is short.
+	m_lastBlockSize = 1000;
+	m_data.assign(BLOCK_COUNT * BLOCK_SIZE, 0);
+	const size_t data_size = (BLOCK_COUNT - 1) * BLOCK_SIZE + m_lastBlockSize;
+
+	// Mix compressible runs with less compressible data.
+	uint32_t seed = 0x9E3779B9;
+	for (size_t i = 0; i < data_size; i++) {
+		if ((i / 256) & 1) {
+			m_data[i] = (uint8_t)(i / 256);
+		} else {
+			seed = seed * 1103515245 + 12345;
+			m_data[i] = (uint8_t)(seed >> 16);
+		}
+	}
+}
+
+/**
+ * Build a GCZ image from m_data.
+ *
+ * The last block has m_lastBlockSize bytes. Any other block
+ * can be made short with shortBlock/shortSize to test
+ * error handling.
+ *
+ * @param types Block types. (BLOCK_COUNT entries)
+ * @param shortBlock Block index to truncate, or -1 for none.
+ * @param shortSize Size of the truncated block.
+ */
+void GczReaderTest::buildGcz(const BlockType *types, int shortBlock, unsigned int shortSize)
+{
+	vector<uint64_t> blockPointers(BLOCK_COUNT);
+	vector<uint32_t> hashes(BLOCK_COUNT);
+	vector<uint8_t> blockData;
+
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		const uint8_t *const src = &m_data[i * BLOCK_SIZE];
+		unsigned int srcSize = (i == BLOCK_COUNT - 1 ? m_lastBlockSize : BLOCK_SIZE);
+		if ((int)i == shortBlock) {
+			srcSize = shortSize;
+		}
+
+		uint64_t ptr = blockData.size();
+		const size_t pos = blockData.size();
+		if (types[i] == BT_STORED) {
+			blockData.insert(blockData.end(), src, src + srcSize);
+			ptr |= GCZ_BLOCK_UNCOMPRESSED;
+		} else {
+			uLongf destLen = compressBound(srcSize);
+			blockData.resize(pos + destLen);
+			ASSERT_EQ(Z_OK, compress(&blockData[pos], &destLen, src, srcSize));
+			blockData.resize(pos + destLen);
+		}
+		blockPointers[i] = cpu_to_le64(ptr);
+		hashes[i] = cpu_to_le32((uint32_t)adler32(1, &blockData[pos], (uInt)(blockData.size() - pos)));
+	}
+
+	GczHeader header;
+	header.magic = cpu_to_le32(GCZ_MAGIC);
+	header.sub_type = cpu_to_le32(GCZ_SUBTYPE_GCN);
+	header.compressed_data_size = cpu_to_le64(blockData.size());
+	header.data_size = cpu_to_le64((BLOCK_COUNT - 1) * BLOCK_SIZE + m_lastBlockSize);
+	header.block_size = cpu_to_le32(BLOCK_SIZE);
+	header.num_blocks = cpu_to_le32(BLOCK_COUNT);
+
+	const uint8_t *const pHeader = reinterpret_cast<const uint8_t*>(&header);
+	const uint8_t *const pPointers = reinterpret_cast<const uint8_t*>(blockPointers.data());
+	const uint8_t *const pHashes = reinterpret_cast<const uint8_t*>(hashes.data());
+	m_gcz.clear();
+	m_gcz.insert(m_gcz.end(), pHeader, pHeader + sizeof(header));
+	m_gcz.insert(m_gcz.end(), pPointers, pPointers + (BLOCK_COUNT * sizeof(uint64_t)));
+	m_gcz.insert(m_gcz.end(), pHashes, pHashes + (BLOCK_COUNT * sizeof(uint32_t)));
+	m_gcz.insert(m_gcz.end(), blockData.begin(), blockData.end());
+
+	m_file.reset(new RpMemFile(m_gcz.data(), m_gcz.size()));
+}
+
+/**
+ * Get the offset of a block's stored data in m_gcz.
+ * @param blockIdx Block index.
+ * @return Offset in m_gcz.
+ */
+size_t GczReaderTest::blockOffset(unsigned int blockIdx) const
+{
+	const size_t dataOffset = sizeof(GczHeader) + (BLOCK_COUNT * (sizeof(uint64_t) + sizeof(uint32_t)));
+	uint64_t ptr;
+	memcpy(&ptr, &m_gcz[sizeof(GczHeader) + (blockIdx * sizeof(uint64_t))], sizeof(ptr));
+	return dataOffset + (size_t)(le64_to_cpu(ptr) & ~GCZ_BLOCK_UNCOMPRESSED);
+}
+
+/**
+ * Full block reads with readBlock().
+ * The short final block is zero-filled.
+ */
+TEST_F(GczReaderTest, readBlock)
+{
+	static const BlockType types[BLOCK_COUNT] = {BT_COMPRESSED, BT_STORED, BT_COMPRESSED, BT_STORED, BT_COMPRESSED};
+	ASSERT_NO_FATAL_FAILURE(buildGcz(types));
+
+	TestGczReader reader(m_file.get());
+	ASSERT_TRUE(reader.isOpen());
+	EXPECT_EQ((int64_t)((BLOCK_COUNT - 1) * BLOCK_SIZE + m_lastBlockSize), reader.size());
+
+	vector<uint8_t> buf(BLOCK_SIZE);
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		memset(buf.data(), 0xCC, buf.size());
+		ASSERT_EQ((int)BLOCK_SIZE, reader.readBlock(i, buf.data(), 0, BLOCK_SIZE)) << "block " << i;
+		EXPECT_EQ(0, memcmp(buf.data(), &m_data[i * BLOCK_SIZE], BLOCK_SIZE)) << "block " << i;
+	}
+
+	// Out of range.
+	EXPECT_EQ(-1, reader.readBlock(BLOCK_COUNT, buf.data(), 0, BLOCK_SIZE));
+}
+
+/**
+ * A stored (uncompressed) final block can also be short.
+ */
+TEST_F(GczReaderTest, shortStoredFinalBlock)
+{
+	static const BlockType types[BLOCK_COUNT] = {BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED, BT_STORED};
+	ASSERT_NO_FATAL_FAILURE(buildGcz(types));
+
+	TestGczReader reader(m_file.get());
+	ASSERT_TRUE(reader.isOpen());
+
+	vector<uint8_t> buf(BLOCK_SIZE, 0xCC);
+	ASSERT_EQ((int)BLOCK_SIZE, reader.readBlock(BLOCK_COUNT - 1, buf.data(), 0, BLOCK_SIZE));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[(BLOCK_COUNT - 1) * BLOCK_SIZE], BLOCK_SIZE));
+}
+
+/**
+ * Short blocks other than the final block are errors.
+ */
+TEST_F(GczReaderTest, shortMiddleBlock)
+{
+	static const BlockType types[2][BLOCK_COUNT] = {
+		{BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED},
+		{BT_STORED,     BT_STORED,     BT_STORED,     BT_STORED,     BT_STORED},
+	};
+
+	for (unsigned int t = 0; t < 2; t++) {
+		ASSERT_NO_FATAL_FAILURE(buildGcz(types[t], 2, 3000));
+		TestGczReader reader(m_file.get());
+		ASSERT_TRUE(reader.isOpen());
+
+		vector<uint8_t> buf(BLOCK_COUNT * BLOCK_SIZE);
+		EXPECT_EQ((int)BLOCK_SIZE, reader.readBlock(1, buf.data(), 0, BLOCK_SIZE)) << "types " << t;
+		EXPECT_EQ(-1, reader.readBlock(2, buf.data(), 0, BLOCK_SIZE)) << "types " << t;
+		EXPECT_EQ(EIO, reader.lastError()) << "types " << t;
+		EXPECT_EQ(-1, reader.readBlock(2, buf.data(), 100, 200)) << "types " << t;
+
+		// readBlocks() stops at the short block.
+		EXPECT_EQ(2U * BLOCK_SIZE, reader.readBlocks(0, BLOCK_COUNT, buf.data())) << "types " << t;
+		EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), 2 * BLOCK_SIZE)) << "types " << t;
+	}
+}
+
+/**
+ * Parallel decompression with readBlocks(),
+ * and sequential reads through SparseDiscReader.
+ */
+TEST_F(GczReaderTest, readBlocks)
+{
+	static const BlockType types[BLOCK_COUNT] = {BT_STORED, BT_COMPRESSED, BT_COMPRESSED, BT_STORED, BT_COMPRESSED};
+	ASSERT_NO_FATAL_FAILURE(buildGcz(types));
+
+	TestGczReader reader(m_file.get());
+	ASSERT_TRUE(reader.isOpen());
+
+	vector<uint8_t> buf(BLOCK_COUNT * BLOCK_SIZE, 0xCC);
+	ASSERT_EQ(BLOCK_COUNT * BLOCK_SIZE, reader.readBlocks(0, BLOCK_COUNT, buf.data()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), buf.size()));
+
+	// Subset of the blocks.
+	memset(buf.data(), 0xCC, buf.size());
+	ASSERT_EQ(3U * BLOCK_SIZE, reader.readBlocks(1, 3, buf.data()));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[BLOCK_SIZE], 3 * BLOCK_SIZE));
+	EXPECT_EQ(0xCC, buf[3 * BLOCK_SIZE]);
+
+	// The whole disc through the public interface.
+	// The read size is clamped to the disc size.
+	const size_t data_size = (BLOCK_COUNT - 1) * BLOCK_SIZE + m_lastBlockSize;
+	memset(buf.data(), 0xCC, buf.size());
+	ASSERT_EQ(0, reader.seek(0));
+	ASSERT_EQ(data_size, reader.read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), data_size));
+
+	// Unaligned read across blocks.
+	memset(buf.data(), 0xCC, buf.size());
+	ASSERT_EQ(0, reader.seek(BLOCK_SIZE - 100));
+	ASSERT_EQ(2U * BLOCK_SIZE, reader.read(buf.data(), 2 * BLOCK_SIZE));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[BLOCK_SIZE - 100], 2 * BLOCK_SIZE));
+}
+
+/**
+ * Partial block reads use the decompressed block cache.
+ */
+TEST_F(GczReaderTest, partialBlockCache)
+{
+	static const BlockType types[BLOCK_COUNT] = {BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED, BT_COMPRESSED};
+	ASSERT_NO_FATAL_FAILURE(buildGcz(types));
+
+	TestGczReader reader(m_file.get());
+	ASSERT_TRUE(reader.isOpen());
+
+	// Read part of block 1. This caches the block.
+	uint8_t buf[BLOCK_SIZE];
+	ASSERT_EQ(100, reader.readBlock(1, buf, 500, 100));
+	EXPECT_EQ(0, memcmp(buf, &m_data[BLOCK_SIZE + 500], 100));
+
+	// Corrupt block 1's compressed data.
+	// NOTE: RpMemFile doesn't copy the buffer.
+	m_gcz[blockOffset(1) + 10] ^= 0xFF;
+
+	// More partial reads are handled by the cache...
+	ASSERT_EQ(200, reader.readBlock(1, buf, 0, 200));
+	EXPECT_EQ(0, memcmp(buf, &m_data[BLOCK_SIZE], 200));
+	ASSERT_EQ(96, reader.readBlock(1, buf, BLOCK_SIZE - 96, 96));
+	EXPECT_EQ(0, memcmp(buf, &m_data[BLOCK_SIZE * 2 - 96], 96));
+
+	// ...but full block reads decompress the block directly.
+	EXPECT_EQ(-1, reader.readBlock(1, buf, 0, BLOCK_SIZE));
+
+	// Fill the cache with other blocks to evict block 1.
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		if (i == 1)
+			continue;
+		ASSERT_EQ(10, reader.readBlock(i, buf, 20, 10)) << "block " << i;
+		EXPECT_EQ(0, memcmp(buf, &m_data[i * BLOCK_SIZE + 20], 10)) << "block " << i;
+	}
+	EXPECT_EQ(-1, reader.readBlock(1, buf, 500, 100));
+
+	// Partial reads of the short final block include the zero padding.
+	ASSERT_EQ(100, reader.readBlock(BLOCK_COUNT - 1, buf, m_lastBlockSize - 50, 100));
+	EXPECT_EQ(0, memcmp(buf, &m_data[(BLOCK_COUNT - 1) * BLOCK_SIZE + m_lastBlockSize - 50], 100));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: GczReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,510 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * GdiReaderTest.cpp: GdiReader test.                                      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// GdiReader
+#include "libromdata/disc/GdiReader.hpp"
+
+// librpbase
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/FileSystem.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
+using LibRpBase::IRpFile;
+using LibRpBase::RpFile;
+using LibRpBase::ThreadPool;
+using namespace LibRpBase::FileSystem;
+
+// C includes.
+#ifndef _WIN32
+#include <unistd.h>
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+// Logical block size.
+static const unsigned int BLOCK_SIZE = 2048;
+
+/**
+ * Test track.
+ */
+struct TestTrack {
+	uint8_t trackNumber;
+	uint8_t type;		// 0 == audio, 4 == data
+	uint16_t sectorSize;	// 2048 or 2352
+	unsigned int lba;	// Starting LBA.
+	unsigned int sectors;	// Number of sectors.
+	const char *filename;
+};
+
+// Test tracks.
+// - LBAs 0-9 are before the first data track. (Track 01 is audio.)
+// - LBAs 50-59 are a gap between tracks 03 and 04.
+// - There are more data tracks than GdiReader's track pool,
+//   so track files are closed and reopened.
+static const TestTrack testTracks[] = {
+	{1, 0, 2352,  0, 10, "track01.raw"},
+	{2, 4, 2352, 10, 20, "track02.bin"},
+	{3, 4, 2048, 30, 20, "track03.iso"},
+	{4, 4, 2352, 60,  8, "track04.bin"},
+	{5, 4, 2048, 68,  8, "track05.iso"},
+	{6, 4, 2352, 76,  8, "track06.bin"},
+	{7, 4, 2048, 84,  8, "track07.iso"},
+};
+static const unsigned int TRACK_COUNT = (unsigned int)(sizeof(testTracks) / sizeof(testTracks[0]));
+
+// Total number of logical blocks. (Ends with the last data track.)
+static const unsigned int BLOCK_COUNT = 92;
+
+/**
+ * GdiReader with access to the block read functions.
+ */
+class TestGdiReader : public GdiReader
+{
+	public:
+		explicit TestGdiReader(IRpFile *file)
+			: GdiReader(file) { }
+
+	public:
+		using GdiReader::readBlock;
+		using GdiReader::readBlocks;
+};
+
+class GdiReaderTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) override final;
+		void TearDown(void) override final;
+
+	public:
+		/**
+		 * Get a byte of a logical block's user data.
+		 * @param lba LBA.
+		 * @param i Byte offset within the block.
+		 * @return Byte.
+		 */
+		static inline uint8_t userByte(unsigned int lba, unsigned int i)
+		{
+			return (uint8_t)((lba * 31) + (i * 7) + (i >> 8));
+		}
+
+		/**
+		 * Is an LBA in a data track?
+		 * @param lba LBA.
+		 * @return True if it's in a data track; false if not.
+		 */
+		static bool isDataBlock(unsigned int lba);
+
+		/**
+		 * Check a block of user data.
+		 * @param lba LBA.
+		 * @param buf Data buffer.
+		 * @param pos Starting position within the block.
+		 * @param size Amount of data to check.
+		 * @return True if the data matches; false if it doesn't.
+		 */
+		static bool checkBlock(unsigned int lba, const uint8_t *buf, unsigned int pos = 0, unsigned int size = BLOCK_SIZE);
+
+	protected:
+		/**
+		 * Write a file in the temporary directory.
+		 * @param name Filename, relative to the temporary directory.
+		 * @param data File data.
+		 */
+		void writeFile(const char *name, const vector<uint8_t> &data);
+
+		/**
+		 * Write a track file.
+		 * @param track Test track.
+		 */
+		void writeTrack(const TestTrack &track);
+
+	protected:
+		string m_dir;			// Temporary directory, with a trailing separator.
+		vector<string> m_files;		// Files to delete in TearDown().
+		unique_ptr<TestGdiReader> m_reader;
+};
+
+void GdiReaderTest::SetUp(void)
+{
+	// NOTE: The cache directory is set up by gtest_main().
+	const string &cache_dir = getCacheDirectory();
+	ASSERT_FALSE(cache_dir.empty());
+	m_dir = cache_dir + DIR_SEP_CHR + "GdiReaderTest" + DIR_SEP_CHR;
+	ASSERT_EQ(0, rmkdir(m_dir));
+
+	// Write the GDI file and the tracks.
+	string gdi;
+	char line[128];
+	snprintf(line, sizeof(line), "%u\n", TRACK_COUNT);
+	gdi += line;
+	for (unsigned int i = 0; i < TRACK_COUNT; i++) {
+		const TestTrack &track = testTracks[i];
+		snprintf(line, sizeof(line), "%u %u %u %u %s 0\n",
+			track.trackNumber, track.lba, track.type, track.sectorSize, track.filename);
+		gdi += line;
+		writeTrack(track);
+	}
+	writeFile("disc.gdi", vector<uint8_t>(gdi.begin(), gdi.end()));
+
+	RpFile file(m_dir + "disc.gdi", RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file.isOpen());
+	m_reader.reset(new TestGdiReader(&file));
+	ASSERT_TRUE(m_reader->isOpen());
+}
+
+void GdiReaderTest::TearDown(void)
+{
+	m_reader.reset();
+	for (auto iter = m_files.cbegin(); iter != m_files.cend(); ++iter) {
+		delete_file(*iter);
+	}
+#ifndef _WIN32
+	rmdir(m_dir.c_str());
+#endif /* !_WIN32 */
+}
+
+/**
+ * Is an LBA in a data track?
+ * @param lba LBA.
+ * @return True if it's in a data track; false if not.
+ */
+bool GdiReaderTest::isDataBlock(unsigned int lba)
+{
+	for (unsigned int i = 0; i < TRACK_COUNT; i++) {
+		const TestTrack &track = testTracks[i];
+		if (track.type == 4 && lba >= track.lba && lba < track.lba + track.sectors)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Check a block of user data.
+ * @param lba LBA.
+ * @param buf Data buffer.
+ * @param pos Starting position within the block.
+ * @param size Amount of data to check.
+ * @return True if the data matches; false if it doesn't.
+ */
+bool GdiReaderTest::checkBlock(unsigned int lba, const uint8_t *buf, unsigned int pos, unsigned int size)
+{
+	for (unsigned int i = 0; i < size; i++) {
+		if (buf[i] != userByte(lba, pos + i))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Write a file in the temporary directory.
+ * @param name Filename, relative to the temporary directory.
+ * @param data File data.
+ */
+void GdiReaderTest::writeFile(const char *name, const vector<uint8_t> &data)
+{
+	const string filename = m_dir + name;
+	m_files.push_back(filename);
+	RpFile file(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file.isOpen()) << filename;
+	ASSERT_EQ(data.size(), file.write(data.data(), data.size())) << filename;
+}
+
+/**
+ * Write a track file.
+ * @param track Test track.
+ */
+void GdiReaderTest::writeTrack(const TestTrack &track)
+{
+	vector<uint8_t> data((size_t)track.sectors * track.sectorSize);
+	uint8_t *p = data.data();
+	for (unsigned int s = 0; s < track.sectors; s++, p += track.sectorSize) {
+		const unsigned int lba = track.lba + s;
+		uint8_t *user = p;
+		if (track.sectorSize == 2352) {
+			// Mode 1 sector: sync, header, user data, EDC/ECC.
+			static const uint8_t sync[12] =
+				{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
+			memcpy(p, sync, sizeof(sync));
+			const unsigned int msf = lba + 150;
+			p[12] = (uint8_t)((((msf / 75 / 60) / 10) << 4) | ((msf / 75 / 60) % 10));
+			p[13] = (uint8_t)((((msf / 75 % 60) / 10) << 4) | ((msf / 75 % 60) % 10));
+			p[14] = (uint8_t)((((msf % 75) / 10) << 4) | ((msf % 75) % 10));
+			p[15] = 1;
+			memset(p + 16 + BLOCK_SIZE, 0xA5, 2352 - 16 - BLOCK_SIZE);
+			user = p + 16;
+		}
+		for (unsigned int i = 0; i < BLOCK_SIZE; i++) {
+			user[i] = userByte(lba, i);
+		}
+	}
+	writeFile(track.filename, data);
+}
+
+/**
+ * Disc size and track information.
+ */
+TEST_F(GdiReaderTest, open)
+{
+	EXPECT_EQ((int64_t)BLOCK_COUNT * BLOCK_SIZE, m_reader->size());
+	EXPECT_EQ((int)TRACK_COUNT, m_reader->trackCount());
+	for (unsigned int i = 0; i < TRACK_COUNT; i++) {
+		const TestTrack &track = testTracks[i];
+		if (track.type != 4)
+			continue;
+		EXPECT_EQ((int)track.lba, m_reader->startingLBA(track.trackNumber)) << "track " << (int)track.trackNumber;
+	}
+}
+
+/**
+ * readBlock() for every block on the disc, including
+ * blocks before the first data track and in gaps.
+ */
+TEST_F(GdiReaderTest, readBlock)
+{
+	uint8_t buf[BLOCK_SIZE];
+	for (unsigned int lba = 0; lba < BLOCK_COUNT; lba++) {
+		if (!isDataBlock(lba)) {
+			// Not in a data track.
+			EXPECT_EQ(0, m_reader->readBlock(lba, buf, 0, BLOCK_SIZE)) << "LBA " << lba;
+			continue;
+		}
+
+		ASSERT_EQ((int)BLOCK_SIZE, m_reader->readBlock(lba, buf, 0, BLOCK_SIZE)) << "LBA " << lba;
+		EXPECT_TRUE(checkBlock(lba, buf)) << "LBA " << lba;
+
+		// Partial block.
+		ASSERT_EQ(100, m_reader->readBlock(lba, buf, 1000, 100)) << "LBA " << lba;
+		EXPECT_TRUE(checkBlock(lba, buf, 1000, 100)) << "LBA " << lba;
+	}
+}
+
+/**
+ * Reads that start before the first data track
+ * or in a gap stop at that block.
+ */
+TEST_F(GdiReaderTest, blocksOutsideTracks)
+{
+	vector<uint8_t> buf(16 * BLOCK_SIZE);
+
+	// Before the first data track.
+	EXPECT_EQ(0U, m_reader->readBlocks(0, 4, buf.data()));
+	EXPECT_EQ(0U, m_reader->pread(5 * BLOCK_SIZE, buf.data(), BLOCK_SIZE));
+
+	// In the gap between tracks 03 and 04.
+	EXPECT_EQ(0U, m_reader->readBlocks(50, 10, buf.data()));
+	EXPECT_EQ(0U, m_reader->pread(55 * BLOCK_SIZE + 100, buf.data(), 100));
+
+	// Reads that run into the gap stop at the end of track 03.
+	ASSERT_EQ(5U * BLOCK_SIZE, m_reader->readBlocks(45, 10, buf.data()));
+	for (unsigned int i = 0; i < 5; i++) {
+		EXPECT_TRUE(checkBlock(45 + i, &buf[i * BLOCK_SIZE])) << "LBA " << (45 + i);
+	}
+
+	// Blocks after the gap can still be read.
+	ASSERT_EQ(BLOCK_SIZE, m_reader->readBlocks(60, 1, buf.data()));
+	EXPECT_TRUE(checkBlock(60, buf.data()));
+}
+
+/**
+ * Track files are closed and reopened when more data tracks
+ * are read than the track pool can hold.
+ */
+TEST_F(GdiReaderTest, trackPoolEviction)
+{
+	// Disable the block cache so every read goes to the track files.
+	m_reader->setCacheSize(0);
+
+	// Read one block from each data track, several times,
+	// in an order that evicts each track before it's reused.
+	static const unsigned int lbas[] = {10, 60, 68, 76, 84, 30, 29, 67, 75, 83, 91, 49};
+	uint8_t buf[BLOCK_SIZE];
+	for (unsigned int pass = 0; pass < 3; pass++) {
+		for (unsigned int i = 0; i < sizeof(lbas)/sizeof(lbas[0]); i++) {
+			const unsigned int lba = lbas[i];
+			ASSERT_EQ(BLOCK_SIZE, m_reader->pread((int64_t)lba * BLOCK_SIZE, buf, BLOCK_SIZE))
+				<< "pass " << pass << ", LBA " << lba;
+			EXPECT_TRUE(checkBlock(lba, buf)) << "pass " << pass << ", LBA " << lba;
+		}
+	}
+}
+
+/**
+ * readBlocks() must return the same data as readBlock()
+ * across boundaries between 2352-byte and 2048-byte tracks.
+ */
+TEST_F(GdiReaderTest, readBlocksAcrossSectorSizes)
+{
+	// Track 02 (2352) -> track 03 (2048), and
+	// tracks 04 through 07, which alternate.
+	static const struct {
+		unsigned int firstIdx;
+		unsigned int count;
+	} runs[] = {
+		{20, 20},
+		{29, 2},
+		{60, 32},
+		{66, 5},
+	};
+
+	for (unsigned int r = 0; r < sizeof(runs)/sizeof(runs[0]); r++) {
+		const unsigned int firstIdx = runs[r].firstIdx;
+		const unsigned int count = runs[r].count;
+		vector<uint8_t> bulk((size_t)count * BLOCK_SIZE);
+		ASSERT_EQ(bulk.size(), m_reader->readBlocks(firstIdx, count, bulk.data()))
+			<< "run " << r;
+
+		uint8_t buf[BLOCK_SIZE];
+		for (unsigned int i = 0; i < count; i++) {
+			const unsigned int lba = firstIdx + i;
+			ASSERT_EQ((int)BLOCK_SIZE, m_reader->readBlock(lba, buf, 0, BLOCK_SIZE)) << "LBA " << lba;
+			EXPECT_EQ(0, memcmp(buf, &bulk[i * BLOCK_SIZE], BLOCK_SIZE)) << "LBA " << lba;
+			EXPECT_TRUE(checkBlock(lba, buf)) << "LBA " << lba;
+		}
+	}
+}
+
+/**
+ * pread() across a boundary between a 2352-byte and a 2048-byte
+ * track, with the block cache enabled and disabled.
+ * Large reads use readBlocks(); small reads use readBlock().
+ */
+TEST_F(GdiReaderTest, preadAcrossSectorSizes)
+{
+	static const size_t cacheSizes[] = {
+		GdiReader::DEFAULT_CACHE_SIZE, 0
+	};
+
+	for (unsigned int c = 0; c < sizeof(cacheSizes)/sizeof(cacheSizes[0]); c++) {
+		m_reader->setCacheSize(cacheSizes[c]);
+
+		// Large read: LBAs 20-39, plus partial blocks at both ends.
+		const int64_t pos = (int64_t)20 * BLOCK_SIZE - 300;
+		vector<uint8_t> large(20 * BLOCK_SIZE + 600);
+		ASSERT_EQ(large.size(), m_reader->pread(pos, large.data(), large.size()))
+			<< "cache size " << cacheSizes[c];
+		EXPECT_TRUE(checkBlock(19, large.data(), BLOCK_SIZE - 300, 300));
+		for (unsigned int i = 0; i < 20; i++) {
+			EXPECT_TRUE(checkBlock(20 + i, &large[300 + i * BLOCK_SIZE]))
+				<< "cache size " << cacheSizes[c] << ", LBA " << (20 + i);
+		}
+		EXPECT_TRUE(checkBlock(40, &large[300 + 20 * BLOCK_SIZE], 0, 300));
+
+		// Small reads that straddle the boundary between LBAs 29 and 30.
+		for (unsigned int offset = 0; offset < 2 * BLOCK_SIZE; offset += 700) {
+			const int64_t small_pos = (int64_t)29 * BLOCK_SIZE - 500 + offset;
+			uint8_t small[1500];
+			ASSERT_EQ(sizeof(small), m_reader->pread(small_pos, small, sizeof(small)))
+				<< "cache size " << cacheSizes[c] << ", offset " << offset;
+			EXPECT_EQ(0, memcmp(small, &large[(size_t)(small_pos - pos)], sizeof(small)))
+				<< "cache size " << cacheSizes[c] << ", offset " << offset;
+		}
+	}
+}
+
+/**
+ * Concurrent reads of different tracks. Track files are
+ * evicted from the pool while other threads are reading them.
+ */
+struct ConcurrentReadParams {
+	GdiReader *reader;
+	vector<int> results;	// 1 if the read was correct; 0 if not.
+};
+
+static void concurrentReadFunc(void *param, unsigned int idx)
+{
+	ConcurrentReadParams *const params = static_cast<ConcurrentReadParams*>(param);
+
+	// Pick a data track based on the work item index.
+	static const unsigned int dataTracks[] = {1, 2, 3, 4, 5, 6};
+	const TestTrack &track = testTracks[dataTracks[idx % 6]];
+
+	// Read the entire track.
+	vector<uint8_t> buf((size_t)track.sectors * BLOCK_SIZE);
+	size_t sz = params->reader->pread((int64_t)track.lba * BLOCK_SIZE, buf.data(), buf.size());
+	bool ok = (sz == buf.size());
+	for (unsigned int s = 0; ok && s < track.sectors; s++) {
+		ok = GdiReaderTest::checkBlock(track.lba + s, &buf[s * BLOCK_SIZE]);
+	}
+	params->results[idx] = (ok ? 1 : 0);
+}
+
+TEST_F(GdiReaderTest, concurrentReads)
+{
+	m_reader->setCacheSize(0);
+
+	ConcurrentReadParams params;
+	params.reader = m_reader.get();
+	params.results.assign(240, -1);
+
+	ThreadPool pool(8);
+	pool.run((unsigned int)params.results.size(), concurrentReadFunc, &params);
+	for (size_t i = 0; i < params.results.size(); i++) {
+		EXPECT_EQ(1, params.results[i]) << "work item " << i;
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: GdiReader tests.\n\n");
+	fflush(nullptr);
+
+#ifndef _WIN32
+	// Use a temporary cache directory for the disc image.
+	char tmpdir[] = "/tmp/GdiReaderTest.XXXXXX";
+	if (!mkdtemp(tmpdir)) {
+		fprintf(stderr, "*** ERROR: mkdtemp() failed.\n");
+		return EXIT_FAILURE;
+	}
+	setenv("XDG_CACHE_HOME", tmpdir, 1);
+#endif /* !_WIN32 */
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	int ret = RUN_ALL_TESTS();
+
+#ifndef _WIN32
+	// Remove the temporary cache directory.
+	// NOTE: The test fixture removes all files it creates.
+	rmdir((string(tmpdir) + "/rom-properties").c_str());
+	rmdir(tmpdir);
+#endif /* !_WIN32 */
+	return ret;
+}
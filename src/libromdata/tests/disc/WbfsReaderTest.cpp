@@ -0,0 +1,293 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WbfsReaderTest.cpp: WbfsReader test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// WbfsReader
+#include "libromdata/disc/WbfsReader.hpp"
+#include "libromdata/disc/libwbfs.h"
+#include "libromdata/Console/gcn_structs.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/file/RpMemFile.hpp"
+using LibRpBase::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+// HDD sector size. (512 bytes)
+static const unsigned int HD_SEC_SZ_S = 9;
+static const unsigned int HD_SEC_SZ = (1U << HD_SEC_SZ_S);
+
+// WBFS sector size. (2 MiB)
+static const unsigned int WBFS_SEC_SZ_S = 21;
+static const unsigned int WBFS_SEC_SZ = (1U << WBFS_SEC_SZ_S);
+
+// Number of WBFS sectors per disc, and the disc information block size.
+// Calculated the same way as WbfsReaderPrivate::readWbfsHeader().
+static const unsigned int N_WBFS_SEC_PER_DISC = (143432*2) >> (WBFS_SEC_SZ_S - 15);
+static const unsigned int DISC_INFO_SZ =
+	((sizeof(wbfs_disc_info_t) + N_WBFS_SEC_PER_DISC*2) + HD_SEC_SZ - 1) & ~(HD_SEC_SZ - 1);
+
+// Number of physical WBFS sectors in the image.
+// Sector 0 contains the WBFS header and disc table.
+static const unsigned int N_PHYS_SEC = 4;
+
+/**
+ * Test disc.
+ */
+struct TestDisc {
+	unsigned int slot;	// Disc table slot.
+	const char *id6;	// Game ID.
+	const char *title;	// Game title.
+	unsigned int blockCount;
+	uint16_t blockMap[3];	// Physical WBFS sectors. (0 == empty)
+};
+
+// Test discs. Slots 1, 3, and 4 are empty.
+static const TestDisc testDiscs[] = {
+	{0, "RTST01", "WBFS Test Disc One", 2, {1, 2, 0}},
+	{2, "RTST02", "WBFS Test Disc Two", 3, {3, 0, 1}},
+	{5, "RTST03", "WBFS Test Disc Three", 1, {2, 0, 0}},
+};
+static const unsigned int DISC_COUNT = (unsigned int)(sizeof(testDiscs) / sizeof(testDiscs[0]));
+
+class WbfsReaderTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) override final;
+
+		/**
+		 * Get the expected contents of a test disc.
+		 * @param disc Test disc.
+		 * @return Disc contents.
+		 */
+		vector<uint8_t> expectedData(const TestDisc &disc) const;
+
+		/**
+		 * Read an entire disc from a WbfsReader.
+		 * @param reader WbfsReader.
+		 * @return Disc contents.
+		 */
+		static vector<uint8_t> readDisc(WbfsReader *reader);
+
+	protected:
+		vector<uint8_t> m_wbfs;		// WBFS image.
+		unique_ptr<RpMemFile> m_file;
+};
+
+void WbfsReaderTest::SetUp(void)
+{
+	m_wbfs.assign((size_t)N_PHYS_SEC * WBFS_SEC_SZ, 0);
+
+	// WBFS header.
+	wbfs_head_t *const head = reinterpret_cast<wbfs_head_t*>(m_wbfs.data());
+	memcpy(&head->magic, "WBFS", 4);
+	head->n_hd_sec = cpu_to_be32((N_PHYS_SEC * WBFS_SEC_SZ) >> HD_SEC_SZ_S);
+	head->hd_sec_sz_s = HD_SEC_SZ_S;
+	head->wbfs_sec_sz_s = WBFS_SEC_SZ_S;
+
+	// Disc table and disc information blocks.
+	for (unsigned int i = 0; i < DISC_COUNT; i++) {
+		const TestDisc &disc = testDiscs[i];
+		head->disc_table[disc.slot] = 1;
+
+		uint8_t *const info = &m_wbfs[HD_SEC_SZ + (disc.slot * DISC_INFO_SZ)];
+		GCN_DiscHeader *const discHeader = reinterpret_cast<GCN_DiscHeader*>(info);
+		memcpy(discHeader->id6, disc.id6, sizeof(discHeader->id6));
+		strncpy(discHeader->game_title, disc.title, sizeof(discHeader->game_title));
+
+		uint16_t *const wlba_table = reinterpret_cast<uint16_t*>(info + sizeof(wbfs_disc_info_t));
+		for (unsigned int j = 0; j < disc.blockCount; j++) {
+			wlba_table[j] = cpu_to_be16(disc.blockMap[j]);
+		}
+	}
+
+	// Fill the data sectors with a pattern that identifies
+	// the sector and the offset within the sector.
+	for (unsigned int sec = 1; sec < N_PHYS_SEC; sec++) {
+		uint8_t *const p = &m_wbfs[(size_t)sec * WBFS_SEC_SZ];
+		for (unsigned int i = 0; i < WBFS_SEC_SZ; i++) {
+			p[i] = (uint8_t)((sec * 0x51) ^ (i >> 8) ^ (i * 7));
+		}
+	}
+
+	m_file.reset(new RpMemFile(m_wbfs.data(), m_wbfs.size()));
+}
+
+/**
+ * Get the expected contents of a test disc.
+ * @param disc Test disc.
+ * @return Disc contents.
+ */
+vector<uint8_t> WbfsReaderTest::expectedData(const TestDisc &disc) const
+{
+	vector<uint8_t> data((size_t)disc.blockCount * WBFS_SEC_SZ, 0);
+	for (unsigned int i = 0; i < disc.blockCount; i++) {
+		if (disc.blockMap[i] == 0)
+			continue;
+		memcpy(&data[(size_t)i * WBFS_SEC_SZ],
+		       &m_wbfs[(size_t)disc.blockMap[i] * WBFS_SEC_SZ], WBFS_SEC_SZ);
+	}
+	return data;
+}
+
+/**
+ * Read an entire disc from a WbfsReader.
+ * @param reader WbfsReader.
+ * @return Disc contents.
+ */
+vector<uint8_t> WbfsReaderTest::readDisc(WbfsReader *reader)
+{
+	vector<uint8_t> data((size_t)reader->size());
+	reader->rewind();
+	data.resize(reader->read(data.data(), data.size()));
+	return data;
+}
+
+/**
+ * Check the disc list.
+ * Empty disc table slots must be skipped.
+ */
+TEST_F(WbfsReaderTest, discs)
+{
+	WbfsReader reader(m_file.get());
+	ASSERT_TRUE(reader.isOpen());
+	EXPECT_EQ(0U, reader.discIndex());
+
+	const vector<WbfsReader::DiscInfo> &discs = reader.discs();
+	ASSERT_EQ(DISC_COUNT, discs.size());
+	for (unsigned int i = 0; i < DISC_COUNT; i++) {
+		const TestDisc &disc = testDiscs[i];
+		EXPECT_EQ(disc.slot, discs[i].slot) << "disc " << i;
+		EXPECT_STREQ(disc.id6, discs[i].id6) << "disc " << i;
+		EXPECT_EQ(disc.title, discs[i].title) << "disc " << i;
+		EXPECT_EQ((int64_t)disc.blockCount * WBFS_SEC_SZ, discs[i].size) << "disc " << i;
+
+		ASSERT_EQ(N_WBFS_SEC_PER_DISC, discs[i].blockMap.size()) << "disc " << i;
+		for (unsigned int j = 0; j < N_WBFS_SEC_PER_DISC; j++) {
+			const uint16_t expected = (j < disc.blockCount ? disc.blockMap[j] : 0);
+			EXPECT_EQ(expected, discs[i].blockMap[j]) << "disc " << i << ", block " << j;
+		}
+	}
+
+	// The disc list is shared by WbfsReaders opened from this one.
+	unique_ptr<WbfsReader> other(reader.openDisc(1));
+	ASSERT_TRUE(other != nullptr);
+	EXPECT_EQ(&discs, &other->discs());
+}
+
+/**
+ * WbfsReader(file, i) opens the i-th used disc table slot.
+ */
+TEST_F(WbfsReaderTest, openByIndex)
+{
+	for (unsigned int i = 0; i < DISC_COUNT; i++) {
+		WbfsReader reader(m_file.get(), i);
+		ASSERT_TRUE(reader.isOpen()) << "disc " << i;
+		EXPECT_EQ(i, reader.discIndex());
+		EXPECT_EQ((int64_t)testDiscs[i].blockCount * WBFS_SEC_SZ, reader.size()) << "disc " << i;
+		EXPECT_TRUE(readDisc(&reader) == expectedData(testDiscs[i])) << "disc " << i;
+	}
+
+	// Out of range.
+	WbfsReader reader(m_file.get(), DISC_COUNT);
+	EXPECT_FALSE(reader.isOpen());
+}
+
+/**
+ * openDisc(i) must read the same data as WbfsReader(file, i),
+ * both before and after the disc list has been loaded.
+ */
+TEST_F(WbfsReaderTest, openDisc)
+{
+	WbfsReader reader(m_file.get(), 2);
+	ASSERT_TRUE(reader.isOpen());
+
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			// Load the disc list. openDisc() will use
+			// its block maps from now on.
+			ASSERT_EQ(DISC_COUNT, reader.discs().size());
+		}
+
+		for (unsigned int i = 0; i < DISC_COUNT; i++) {
+			WbfsReader direct(m_file.get(), i);
+			ASSERT_TRUE(direct.isOpen()) << "pass " << pass << ", disc " << i;
+
+			unique_ptr<WbfsReader> opened(reader.openDisc(i));
+			ASSERT_TRUE(opened != nullptr) << "pass " << pass << ", disc " << i;
+			EXPECT_EQ(i, opened->discIndex());
+			EXPECT_EQ(direct.size(), opened->size()) << "pass " << pass << ", disc " << i;
+			EXPECT_TRUE(readDisc(opened.get()) == readDisc(&direct)) << "pass " << pass << ", disc " << i;
+		}
+
+		// Out of range.
+		unique_ptr<WbfsReader> opened(reader.openDisc(DISC_COUNT));
+		EXPECT_TRUE(opened == nullptr) << "pass " << pass;
+	}
+
+	// The original reader still reads its own disc.
+	EXPECT_EQ(2U, reader.discIndex());
+	EXPECT_TRUE(readDisc(&reader) == expectedData(testDiscs[2]));
+}
+
+/**
+ * Readers opened with openDisc() keep working
+ * after the original WbfsReader is deleted.
+ */
+TEST_F(WbfsReaderTest, openDiscOutlivesParent)
+{
+	WbfsReader *const reader = new WbfsReader(m_file.get());
+	ASSERT_TRUE(reader->isOpen());
+	unique_ptr<WbfsReader> opened(reader->openDisc(1));
+	delete reader;
+
+	ASSERT_TRUE(opened != nullptr);
+	EXPECT_EQ(DISC_COUNT, opened->discs().size());
+	EXPECT_TRUE(readDisc(opened.get()) == expectedData(testDiscs[1]));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WbfsReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,505 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * CdromEdcEccTest.cpp: CD-ROM EDC/ECC test.                               *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// CdromEdcEcc
+#include "libromdata/utils/CdromEdcEcc.hpp"
+#include "libromdata/cdrom_structs.h"
+
+// librpbase
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
+using LibRpBase::RpMemFile;
+using LibRpBase::ThreadPool;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class CdromEdcEccTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) override final;
+
+	public:
+		/**
+		 * Bit-at-a-time EDC reference implementation.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @return EDC.
+		 */
+		static uint32_t edc_ref(const uint8_t *data, size_t size);
+
+		/**
+		 * Reference ECC generator for one set of P or Q vectors.
+		 * This is the straightforward algorithm from ECMA-130.
+		 * @param src		Source data. (sector + 0x00C)
+		 * @param major_count	Number of vectors.
+		 * @param minor_count	Number of bytes per vector.
+		 * @param major_mult	Major step.
+		 * @param minor_inc	Minor step.
+		 * @param dest		Parity bytes. (major_count * 2)
+		 */
+		static void ecc_ref_block(const uint8_t *src,
+			unsigned int major_count, unsigned int minor_count,
+			unsigned int major_mult, unsigned int minor_inc,
+			uint8_t *dest);
+
+		/**
+		 * Generate P and Q parity for a sector.
+		 * @param sector Sector. (Header must be zeroed for Mode 2.)
+		 */
+		static void ecc_ref(CDROM_2352_Sector_t *sector);
+
+		/**
+		 * Initialize a sector's sync pattern, address, and mode.
+		 * @param sector Sector.
+		 * @param lba LBA.
+		 * @param mode Mode.
+		 */
+		static void initHeader(CDROM_2352_Sector_t *sector, unsigned int lba, uint8_t mode);
+
+		/**
+		 * Create a valid Mode 1 sector.
+		 * @param sector Sector.
+		 * @param lba LBA. (Also used to seed the user data.)
+		 */
+		static void makeMode1(CDROM_2352_Sector_t *sector, unsigned int lba);
+
+		/**
+		 * Create a valid Mode 2 Form 1 sector.
+		 * @param sector Sector.
+		 * @param lba LBA. (Also used to seed the user data.)
+		 */
+		static void makeMode2Form1(CDROM_2352_Sector_t *sector, unsigned int lba);
+
+		/**
+		 * Create a valid Mode 2 Form 2 sector.
+		 * @param sector Sector.
+		 * @param lba LBA. (Also used to seed the user data.)
+		 * @param withEdc If true, calculate the EDC; otherwise, leave it as 0.
+		 */
+		static void makeMode2Form2(CDROM_2352_Sector_t *sector, unsigned int lba, bool withEdc = true);
+
+	private:
+		// GF(2^8) tables for the reference ECC generator.
+		static uint8_t ecc_f_lut[256];
+		static uint8_t ecc_b_lut[256];
+};
+
+uint8_t CdromEdcEccTest::ecc_f_lut[256];
+uint8_t CdromEdcEccTest::ecc_b_lut[256];
+
+void CdromEdcEccTest::SetUp(void)
+{
+	for (unsigned int i = 0; i < 256; i++) {
+		const unsigned int j = (i << 1) ^ ((i & 0x80) ? 0x11D : 0);
+		ecc_f_lut[i] = (uint8_t)j;
+		ecc_b_lut[i ^ j] = (uint8_t)i;
+	}
+}
+
+/**
+ * Bit-at-a-time EDC reference implementation.
+ * @param data Data.
+ * @param size Size of data.
+ * @return EDC.
+ */
+uint32_t CdromEdcEccTest::edc_ref(const uint8_t *data, size_t size)
+{
+	uint32_t edc = 0;
+	for (; size > 0; size--, data++) {
+		edc ^= *data;
+		for (unsigned int k = 8; k > 0; k--) {
+			edc = (edc >> 1) ^ ((edc & 1) ? 0xD8018001 : 0);
+		}
+	}
+	return edc;
+}
+
+/**
+ * Reference ECC generator for one set of P or Q vectors.
+ * This is the straightforward algorithm from ECMA-130.
+ * @param src		Source data. (sector + 0x00C)
+ * @param major_count	Number of vectors.
+ * @param minor_count	Number of bytes per vector.
+ * @param major_mult	Major step.
+ * @param minor_inc	Minor step.
+ * @param dest		Parity bytes. (major_count * 2)
+ */
+void CdromEdcEccTest::ecc_ref_block(const uint8_t *src,
+	unsigned int major_count, unsigned int minor_count,
+	unsigned int major_mult, unsigned int minor_inc,
+	uint8_t *dest)
+{
+	const unsigned int size = major_count * minor_count;
+	for (unsigned int major = 0; major < major_count; major++) {
+		unsigned int index = (major >> 1) * major_mult + (major & 1);
+		uint8_t ecc_a = 0, ecc_b = 0;
+		for (unsigned int minor = 0; minor < minor_count; minor++) {
+			const uint8_t temp = src[index];
+			index += minor_inc;
+			if (index >= size) {
+				index -= size;
+			}
+			ecc_a ^= temp;
+			ecc_b ^= temp;
+			ecc_a = ecc_f_lut[ecc_a];
+		}
+		ecc_a = ecc_b_lut[ecc_f_lut[ecc_a] ^ ecc_b];
+		dest[major] = ecc_a;
+		dest[major + major_count] = ecc_a ^ ecc_b;
+	}
+}
+
+/**
+ * Generate P and Q parity for a sector.
+ * @param sector Sector. (Header must be zeroed for Mode 2.)
+ */
+void CdromEdcEccTest::ecc_ref(CDROM_2352_Sector_t *sector)
+{
+	uint8_t *const sector8 = reinterpret_cast<uint8_t*>(sector);
+	ecc_ref_block(&sector8[0x00C], 86, 24,  2, 86, &sector8[0x81C]);
+	ecc_ref_block(&sector8[0x00C], 52, 43, 86, 88, &sector8[0x8C8]);
+}
+
+/**
+ * Initialize a sector's sync pattern, address, and mode.
+ * @param sector Sector.
+ * @param lba LBA.
+ * @param mode Mode.
+ */
+void CdromEdcEccTest::initHeader(CDROM_2352_Sector_t *sector, unsigned int lba, uint8_t mode)
+{
+	static const uint8_t sync[12] =
+		{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
+	memset(sector, 0, sizeof(*sector));
+	memcpy(sector->sync, sync, sizeof(sync));
+
+	// Address is stored as BCD MSF.
+	lba += 150;
+	const unsigned int frame = lba % 75;
+	const unsigned int sec = (lba / 75) % 60;
+	const unsigned int min = lba / (75 * 60);
+	sector->msf.min = (uint8_t)(((min / 10) << 4) | (min % 10));
+	sector->msf.sec = (uint8_t)(((sec / 10) << 4) | (sec % 10));
+	sector->msf.frame = (uint8_t)(((frame / 10) << 4) | (frame % 10));
+	sector->mode = mode;
+}
+
+/**
+ * Store a 32-bit little-endian value.
+ * @param p Destination.
+ * @param val Value.
+ */
+static inline void put_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+	p[2] = (uint8_t)(val >> 16);
+	p[3] = (uint8_t)(val >> 24);
+}
+
+/**
+ * Create a valid Mode 1 sector.
+ * @param sector Sector.
+ * @param lba LBA. (Also used to seed the user data.)
+ */
+void CdromEdcEccTest::makeMode1(CDROM_2352_Sector_t *sector, unsigned int lba)
+{
+	initHeader(sector, lba, 1);
+	for (unsigned int i = 0; i < sizeof(sector->m1.data); i++) {
+		sector->m1.data[i] = (uint8_t)(i * 7 + lba);
+	}
+	put_le32(sector->m1.edc, edc_ref(reinterpret_cast<const uint8_t*>(sector), 0x810));
+	ecc_ref(sector);
+}
+
+/**
+ * Create a valid Mode 2 Form 1 sector.
+ * @param sector Sector.
+ * @param lba LBA. (Also used to seed the user data.)
+ */
+void CdromEdcEccTest::makeMode2Form1(CDROM_2352_Sector_t *sector, unsigned int lba)
+{
+	initHeader(sector, lba, 2);
+	static const uint8_t sub[8] = {0x00,0x00,0x08,0x00, 0x00,0x00,0x08,0x00};
+	memcpy(sector->m2xa_f1.sub, sub, sizeof(sub));
+	for (unsigned int i = 0; i < sizeof(sector->m2xa_f1.data); i++) {
+		sector->m2xa_f1.data[i] = (uint8_t)(i * 13 + lba);
+	}
+	const uint8_t *const sector8 = reinterpret_cast<const uint8_t*>(sector);
+	put_le32(sector->m2xa_f1.edc, edc_ref(&sector8[0x010], 0x808));
+
+	// ECC is calculated with the header set to 0.
+	CDROM_2352_Sector_t tmp;
+	memcpy(&tmp, sector, sizeof(tmp));
+	memset(&tmp.msf, 0, sizeof(tmp.msf));
+	tmp.mode = 0;
+	ecc_ref(&tmp);
+	memcpy(sector->m2xa_f1.ecc, tmp.m2xa_f1.ecc, sizeof(sector->m2xa_f1.ecc));
+}
+
+/**
+ * Create a valid Mode 2 Form 2 sector.
+ * @param sector Sector.
+ * @param lba LBA. (Also used to seed the user data.)
+ * @param withEdc If true, calculate the EDC; otherwise, leave it as 0.
+ */
+void CdromEdcEccTest::makeMode2Form2(CDROM_2352_Sector_t *sector, unsigned int lba, bool withEdc)
+{
+	initHeader(sector, lba, 2);
+	static const uint8_t sub[8] = {0x00,0x00,0x20,0x00, 0x00,0x00,0x20,0x00};
+	memcpy(sector->m2xa_f2.sub, sub, sizeof(sub));
+	for (unsigned int i = 0; i < sizeof(sector->m2xa_f2.data); i++) {
+		sector->m2xa_f2.data[i] = (uint8_t)(i * 29 + lba);
+	}
+	if (withEdc) {
+		const uint8_t *const sector8 = reinterpret_cast<const uint8_t*>(sector);
+		put_le32(sector->m2xa_f2.spare, edc_ref(&sector8[0x010], 0x91C));
+	}
+}
+
+/**
+ * EDC check value for "123456789".
+ * (CRC-32/CD-ROM-EDC in the CRC RevEng catalogue.)
+ */
+TEST_F(CdromEdcEccTest, edcCheckValue)
+{
+	static const char check[] = "123456789";
+	EXPECT_EQ(0x6EC2EDC4U, edc_ref(reinterpret_cast<const uint8_t*>(check), 9));
+	EXPECT_EQ(0x6EC2EDC4U, CdromEdcEcc::edc(reinterpret_cast<const uint8_t*>(check), 9));
+}
+
+/**
+ * Compare edc() to the reference implementation for
+ * various lengths and alignments, in one or two calls.
+ */
+TEST_F(CdromEdcEccTest, edcMatchesReference)
+{
+	uint8_t buf[2352 + 8];
+	for (unsigned int i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 151 + 3);
+	}
+
+	static const size_t lengths[] = {0, 1, 2, 3, 4, 5, 7, 8, 63, 0x808, 0x810, 0x91C, 2352};
+	for (unsigned int align = 0; align < 8; align++) {
+		for (unsigned int i = 0; i < sizeof(lengths)/sizeof(lengths[0]); i++) {
+			const size_t len = lengths[i];
+			const uint32_t expected = edc_ref(&buf[align], len);
+			EXPECT_EQ(expected, CdromEdcEcc::edc(&buf[align], len))
+				<< "align == " << align << ", len == " << len;
+
+			// Split into two calls.
+			const size_t split = len / 3;
+			const uint32_t edc1 = CdromEdcEcc::edc(&buf[align], split);
+			EXPECT_EQ(expected, CdromEdcEcc::edc(&buf[align + split], len - split, edc1))
+				<< "align == " << align << ", len == " << len << ", split == " << split;
+		}
+	}
+}
+
+/**
+ * Valid Mode 1 sector.
+ */
+TEST_F(CdromEdcEccTest, mode1Valid)
+{
+	CDROM_2352_Sector_t sector;
+	makeMode1(&sector, 16);
+	EXPECT_EQ(0U, CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * Valid Mode 2 Form 1 sector.
+ */
+TEST_F(CdromEdcEccTest, mode2Form1Valid)
+{
+	CDROM_2352_Sector_t sector;
+	makeMode2Form1(&sector, 16);
+	EXPECT_EQ(0U, CdromEdcEcc::checkSector(&sector));
+
+	// The Mode 2 header isn't covered by the EDC or ECC.
+	sector.msf.frame ^= 0x01;
+	EXPECT_EQ(0U, CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * Valid Mode 2 Form 2 sectors, with and without EDC.
+ */
+TEST_F(CdromEdcEccTest, mode2Form2Valid)
+{
+	CDROM_2352_Sector_t sector;
+	makeMode2Form2(&sector, 16, true);
+	EXPECT_EQ(0U, CdromEdcEcc::checkSector(&sector));
+
+	makeMode2Form2(&sector, 17, false);
+	EXPECT_EQ(0U, CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * Flipped bytes in a Mode 1 sector.
+ */
+TEST_F(CdromEdcEccTest, mode1FlippedByte)
+{
+	CDROM_2352_Sector_t sector;
+
+	// User data: covered by EDC, P, and Q.
+	makeMode1(&sector, 16);
+	sector.m1.data[1000] ^= 0x40;
+	EXPECT_EQ((unsigned int)(CdromEdcEcc::SECTERR_EDC | CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		CdromEdcEcc::checkSector(&sector));
+
+	// Header: covered by EDC, P, and Q.
+	makeMode1(&sector, 16);
+	sector.msf.frame ^= 0x01;
+	EXPECT_EQ((unsigned int)(CdromEdcEcc::SECTERR_EDC | CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		CdromEdcEcc::checkSector(&sector));
+
+	// EDC: covered by P and Q, and no longer matches.
+	makeMode1(&sector, 16);
+	sector.m1.edc[2] ^= 0x01;
+	EXPECT_EQ((unsigned int)(CdromEdcEcc::SECTERR_EDC | CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		CdromEdcEcc::checkSector(&sector));
+
+	// P parity byte: only covered by Q.
+	makeMode1(&sector, 16);
+	reinterpret_cast<uint8_t*>(&sector)[0x81C + 5] ^= 0x80;
+	EXPECT_EQ((unsigned int)(CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		CdromEdcEcc::checkSector(&sector));
+
+	// Q parity byte: not covered by anything else.
+	makeMode1(&sector, 16);
+	reinterpret_cast<uint8_t*>(&sector)[0x8C8 + 100] ^= 0x01;
+	EXPECT_EQ((unsigned int)CdromEdcEcc::SECTERR_ECC_Q, CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * Flipped byte in a Mode 2 Form 1 sector.
+ */
+TEST_F(CdromEdcEccTest, mode2Form1FlippedByte)
+{
+	CDROM_2352_Sector_t sector;
+	makeMode2Form1(&sector, 16);
+	sector.m2xa_f1.data[0] ^= 0x01;
+	EXPECT_EQ((unsigned int)(CdromEdcEcc::SECTERR_EDC | CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * Flipped byte in a Mode 2 Form 2 sector.
+ */
+TEST_F(CdromEdcEccTest, mode2Form2FlippedByte)
+{
+	CDROM_2352_Sector_t sector;
+	makeMode2Form2(&sector, 16, true);
+	sector.m2xa_f2.data[2323] ^= 0x01;
+	EXPECT_EQ((unsigned int)CdromEdcEcc::SECTERR_EDC, CdromEdcEcc::checkSector(&sector));
+
+	// Without an EDC, corruption can't be detected.
+	makeMode2Form2(&sector, 16, false);
+	sector.m2xa_f2.data[2323] ^= 0x01;
+	EXPECT_EQ(0U, CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * Invalid sync pattern and mode.
+ */
+TEST_F(CdromEdcEccTest, invalidHeader)
+{
+	CDROM_2352_Sector_t sector;
+	makeMode1(&sector, 16);
+	sector.sync[5] = 0x00;
+	EXPECT_EQ((unsigned int)CdromEdcEcc::SECTERR_SYNC, CdromEdcEcc::checkSector(&sector));
+
+	makeMode1(&sector, 16);
+	sector.mode = 3;
+	EXPECT_EQ((unsigned int)CdromEdcEcc::SECTERR_MODE, CdromEdcEcc::checkSector(&sector));
+}
+
+/**
+ * verifySectors() with bad sectors in multiple chunks
+ * and a truncated image.
+ */
+TEST_F(CdromEdcEccTest, verifySectors)
+{
+	// 600 sectors, with the last one truncated.
+	static const unsigned int SECTOR_COUNT = 600;
+	static const unsigned int LBA_START = 1000;
+	vector<CDROM_2352_Sector_t> sectors(SECTOR_COUNT);
+	for (unsigned int i = 0; i < SECTOR_COUNT; i++) {
+		switch (i % 3) {
+			case 0:
+				makeMode1(&sectors[i], LBA_START + i);
+				break;
+			case 1:
+				makeMode2Form1(&sectors[i], LBA_START + i);
+				break;
+			default:
+				makeMode2Form2(&sectors[i], LBA_START + i);
+				break;
+		}
+	}
+	sectors[3].m1.data[10] ^= 0x01;		// Mode 1
+	sectors[301].m2xa_f1.data[20] ^= 0x02;	// Mode 2 Form 1
+	sectors[302].m2xa_f2.data[30] ^= 0x04;	// Mode 2 Form 2
+
+	RpMemFile file(sectors.data(), (SECTOR_COUNT * sizeof(CDROM_2352_Sector_t)) - 100);
+	ThreadPool pool(4);
+	CdromEdcEcc::SectorReport report;
+	report.sectorCount = 0;
+	ASSERT_EQ(0, CdromEdcEcc::verifySectors(report, &pool, &file, 0, SECTOR_COUNT, LBA_START));
+
+	EXPECT_EQ(SECTOR_COUNT, report.sectorCount);
+	ASSERT_EQ(4U, report.badSectors.size());
+	EXPECT_EQ(LBA_START + 3, report.badSectors[0].lba);
+	EXPECT_EQ((uint32_t)(CdromEdcEcc::SECTERR_EDC | CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		report.badSectors[0].errors);
+	EXPECT_EQ(LBA_START + 301, report.badSectors[1].lba);
+	EXPECT_EQ((uint32_t)(CdromEdcEcc::SECTERR_EDC | CdromEdcEcc::SECTERR_ECC_P | CdromEdcEcc::SECTERR_ECC_Q),
+		report.badSectors[1].errors);
+	EXPECT_EQ(LBA_START + 302, report.badSectors[2].lba);
+	EXPECT_EQ((uint32_t)CdromEdcEcc::SECTERR_EDC, report.badSectors[2].errors);
+	EXPECT_EQ(LBA_START + SECTOR_COUNT - 1, report.badSectors[3].lba);
+	EXPECT_EQ((uint32_t)CdromEdcEcc::SECTERR_READ, report.badSectors[3].errors);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: CdromEdcEcc tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
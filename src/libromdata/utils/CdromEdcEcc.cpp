@@ -0,0 +1,437 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CdromEdcEcc.cpp: CD-ROM sector EDC/ECC verification.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+/**
+ * References:
+ * - https://github.com/qeedquan/ecm/blob/master/format.txt
+ * - ECMA-130, sections 14.3 (EDC) and 14.5 (ECC)
+ */
+
+#include "CdromEdcEcc.hpp"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/file/IRpFile.hpp"
+#include "librpbase/threads/ThreadPool.hpp"
+using LibRpBase::IRpFile;
+using LibRpBase::ThreadPool;
+
+// One-time initialization.
+#include "librpbase/threads/pthread_once.h"
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData {
+
+/**
+ * EDC lookup tables. (slicing-by-4)
+ * edc_lut[0] is the standard byte-at-a-time table.
+ * edc_lut[n] advances the CRC by n additional zero bytes.
+ */
+static uint32_t edc_lut[4][256];
+
+/**
+ * ECC lookup tables.
+ * ecc_f_lut[x] = x * 2 in GF(2^8), using the polynomial 0x11D.
+ * ecc_b_lut[x ^ (x * 2)] = x
+ */
+static uint8_t ecc_f_lut[256];
+static uint8_t ecc_b_lut[256];
+
+/**
+ * Q parity source indexes.
+ * q_idx[minor][major] is the offset of the minor'th byte
+ * of Q vector 'major', relative to the sector header.
+ */
+static uint16_t q_idx[43][52];
+
+// pthread_once() control variable.
+static pthread_once_t once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Initialize the EDC and ECC lookup tables.
+ *
+ * This function MUST be called using pthread_once().
+ */
+static void initTables_int(void)
+{
+	for (unsigned int i = 0; i < 256; i++) {
+		// ECC: Multiply by 2 in GF(2^8).
+		const unsigned int j = (i << 1) ^ ((i & 0x80) ? 0x11D : 0);
+		ecc_f_lut[i] = (uint8_t)j;
+		ecc_b_lut[i ^ j] = (uint8_t)i;
+
+		// EDC: Reversed polynomial 0x8001801B.
+		uint32_t edc = i;
+		for (unsigned int k = 8; k > 0; k--) {
+			edc = (edc >> 1) ^ ((edc & 1) ? 0xD8018001 : 0);
+		}
+		edc_lut[0][i] = edc;
+	}
+
+	// Q parity source indexes.
+	for (unsigned int major = 0; major < 52; major++) {
+		unsigned int index = (major >> 1) * 86 + (major & 1);
+		for (unsigned int minor = 0; minor < 43; minor++) {
+			q_idx[minor][major] = (uint16_t)index;
+			index += 88;
+			if (index >= 52*43) {
+				index -= 52*43;
+			}
+		}
+	}
+
+	// Slicing-by-4 tables.
+	for (unsigned int i = 0; i < 256; i++) {
+		uint32_t edc = edc_lut[0][i];
+		for (unsigned int n = 1; n < 4; n++) {
+			edc = (edc >> 8) ^ edc_lut[0][edc & 0xFF];
+			edc_lut[n][i] = edc;
+		}
+	}
+}
+
+/**
+ * Initialize the EDC and ECC lookup tables.
+ */
+static FORCEINLINE void initTables(void)
+{
+	pthread_once(&once_control, initTables_int);
+}
+
+/**
+ * Calculate a CD-ROM EDC.
+ * This is a CRC-32 using the polynomial 0x8001801B.
+ * @param data Data.
+ * @param size Size of data.
+ * @param edc Previous EDC value. (0 for the first block)
+ * @return EDC.
+ */
+uint32_t CdromEdcEcc::edc(const uint8_t *data, size_t size, uint32_t edc)
+{
+	initTables();
+
+	// Process four bytes at a time.
+	for (; size >= 4; size -= 4, data += 4) {
+		edc ^= ((uint32_t)data[0]) |
+		       ((uint32_t)data[1] << 8) |
+		       ((uint32_t)data[2] << 16) |
+		       ((uint32_t)data[3] << 24);
+		edc = edc_lut[3][edc & 0xFF] ^
+		      edc_lut[2][(edc >> 8) & 0xFF] ^
+		      edc_lut[1][(edc >> 16) & 0xFF] ^
+		      edc_lut[0][edc >> 24];
+	}
+
+	// Remaining bytes.
+	for (; size > 0; size--, data++) {
+		edc = (edc >> 8) ^ edc_lut[0][(edc ^ *data) & 0xFF];
+	}
+
+	return edc;
+}
+
+/**
+ * Multiply eight GF(2^8) elements by 2.
+ * Each byte is a separate element, using the polynomial 0x11D.
+ * @param x Eight elements.
+ * @return Eight elements, multiplied by 2.
+ */
+static FORCEINLINE uint64_t gf_mul2_x8(uint64_t x)
+{
+	const uint64_t hi = (x & 0x8080808080808080ULL);
+	return ((x & 0x7F7F7F7F7F7F7F7FULL) << 1) ^ ((hi >> 7) * 0x1D);
+}
+
+/**
+ * Compare the final ECC accumulators with the stored parity bytes.
+ * @param ecc_a		[in] ECC accumulators. (A)
+ * @param ecc_b		[in] ECC accumulators. (B)
+ * @param major_count	[in] Number of vectors.
+ * @param ecc		[in] Stored parity bytes.
+ * @return True if the parity bytes match; false if not.
+ */
+static bool compareEcc(const uint8_t *ecc_a, const uint8_t *ecc_b,
+	unsigned int major_count, const uint8_t *ecc)
+{
+	for (unsigned int major = 0; major < major_count; major++) {
+		const uint8_t a = ecc_b_lut[ecc_f_lut[ecc_a[major]] ^ ecc_b[major]];
+		if (ecc[major] != a || ecc[major + major_count] != (a ^ ecc_b[major])) {
+			// Parity mismatch.
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Check a sector's ECC P and Q parity.
+ *
+ * Each P and Q vector is a (minor_count + 2)-byte Reed-Solomon
+ * codeword. The vectors are processed eight at a time, with
+ * one GF(2^8) element per byte of a uint64_t.
+ *
+ * @param sector 2352-byte sector. (Header must be zeroed for Mode 2.)
+ * @return 0 if the parity is valid; otherwise, SECTERR_ECC_P and/or SECTERR_ECC_Q.
+ */
+static unsigned int checkEcc(const CDROM_2352_Sector_t *sector)
+{
+	const uint8_t *const src = reinterpret_cast<const uint8_t*>(sector) + 0x00C;
+	unsigned int errors = 0;
+
+	// Accumulators. (A and B for each vector)
+	// Sized for 88 vectors so P can be processed
+	// in eleven 64-bit words.
+	uint64_t acc_a[11], acc_b[11];
+
+	// P parity: 86 vectors of 24 bytes. (0x00C-0x81B)
+	// Byte 'minor' of vector 'major' is at major + (minor * 86),
+	// so each minor step is a contiguous 86-byte row.
+	// NOTE: The last row reads two bytes past the P source data.
+	// They're in unused lanes, so they don't affect the result.
+	memset(acc_a, 0, sizeof(acc_a));
+	memset(acc_b, 0, sizeof(acc_b));
+	for (unsigned int minor = 0; minor < 24; minor++) {
+		const uint8_t *const row = &src[minor * 86];
+		for (unsigned int i = 0; i < 11; i++) {
+			uint64_t t;
+			memcpy(&t, &row[i * 8], sizeof(t));
+			acc_a[i] = gf_mul2_x8(acc_a[i] ^ t);
+			acc_b[i] ^= t;
+		}
+	}
+	if (!compareEcc(reinterpret_cast<const uint8_t*>(acc_a),
+	                reinterpret_cast<const uint8_t*>(acc_b), 86, &src[0x810]))
+	{
+		errors |= CdromEdcEcc::SECTERR_ECC_P;
+	}
+
+	// Q parity: 52 vectors of 43 bytes. (0x00C-0x8C7)
+	// Q vectors are diagonals, so the bytes are gathered
+	// using the precomputed indexes.
+	uint8_t tmp[56];
+	memset(acc_a, 0, sizeof(acc_a));
+	memset(acc_b, 0, sizeof(acc_b));
+	memset(tmp, 0, sizeof(tmp));
+	for (unsigned int minor = 0; minor < 43; minor++) {
+		const uint16_t *const idx = q_idx[minor];
+		for (unsigned int major = 0; major < 52; major++) {
+			tmp[major] = src[idx[major]];
+		}
+		for (unsigned int i = 0; i < 7; i++) {
+			uint64_t t;
+			memcpy(&t, &tmp[i * 8], sizeof(t));
+			acc_a[i] = gf_mul2_x8(acc_a[i] ^ t);
+			acc_b[i] ^= t;
+		}
+	}
+	if (!compareEcc(reinterpret_cast<const uint8_t*>(acc_a),
+	                reinterpret_cast<const uint8_t*>(acc_b), 52, &src[0x8BC]))
+	{
+		errors |= CdromEdcEcc::SECTERR_ECC_Q;
+	}
+
+	return errors;
+}
+
+/**
+ * Check a 2352-byte sector's EDC and ECC.
+ *
+ * Mode 0 and Mode 2 Form 2 sectors don't have ECC,
+ * so only the EDC is checked for Form 2. (If it's 0,
+ * the EDC wasn't calculated, so it isn't checked.)
+ *
+ * @param sector 2352-byte sector.
+ * @return 0 if the sector is valid; otherwise, SectorErrorBits.
+ */
+unsigned int CdromEdcEcc::checkSector(const CDROM_2352_Sector_t *sector)
+{
+	initTables();
+
+	static const uint8_t sync[12] =
+		{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
+	if (memcmp(sector->sync, sync, sizeof(sync)) != 0) {
+		// Invalid sync pattern.
+		// The rest of the sector can't be trusted.
+		return SECTERR_SYNC;
+	}
+
+	const uint8_t *const sector8 = reinterpret_cast<const uint8_t*>(sector);
+	unsigned int errors = 0;
+	switch (sector->mode) {
+		case 0:
+			// Mode 0: No EDC or ECC.
+			break;
+
+		case 1: {
+			// Mode 1: EDC covers the sync, header, and data.
+			const uint32_t edc_calc = edc(sector8, 0x810);
+			if (edc_calc != le32_to_cpu(*reinterpret_cast<const uint32_t*>(sector->m1.edc))) {
+				errors |= SECTERR_EDC;
+			}
+			errors |= checkEcc(sector);
+			break;
+		}
+
+		case 2: {
+			// Mode 2 (XA): EDC covers the subheader and data.
+			if (!(sector->m2xa_f1.sub[2] & 0x20)) {
+				// Form 1.
+				const uint32_t edc_calc = edc(&sector8[0x010], 0x808);
+				if (edc_calc != le32_to_cpu(*reinterpret_cast<const uint32_t*>(sector->m2xa_f1.edc))) {
+					errors |= SECTERR_EDC;
+				}
+
+				// ECC is calculated with the header set to 0.
+				CDROM_2352_Sector_t tmp;
+				memcpy(&tmp, sector, sizeof(tmp));
+				memset(&tmp.msf, 0, sizeof(tmp.msf));
+				tmp.mode = 0;
+				errors |= checkEcc(&tmp);
+			} else {
+				// Form 2. No ECC, and the EDC is optional.
+				const uint32_t edc_stored = le32_to_cpu(*reinterpret_cast<const uint32_t*>(sector->m2xa_f2.spare));
+				if (edc_stored != 0 && edc(&sector8[0x010], 0x91C) != edc_stored) {
+					errors |= SECTERR_EDC;
+				}
+			}
+			break;
+		}
+
+		default:
+			// Invalid mode.
+			errors |= SECTERR_MODE;
+			break;
+	}
+
+	return errors;
+}
+
+/** Parallel verification **/
+
+// Number of sectors per work item. (~588 KB)
+static const unsigned int VERIFY_CHUNK_SECTORS = 256;
+
+struct VerifySectorsJob {
+	IRpFile *file;
+	int64_t offset;
+	uint32_t sectorCount;
+	uint32_t lba;
+
+	// Bad sectors for each chunk.
+	// Merged in order once all chunks are done.
+	vector<vector<CdromEdcEcc::BadSector> > chunkBadSectors;
+};
+
+/**
+ * Verify one chunk of sectors.
+ * @param param VerifySectorsJob.
+ * @param idx Chunk index.
+ */
+static void verifySectors_work(void *param, unsigned int idx)
+{
+	VerifySectorsJob *const job = static_cast<VerifySectorsJob*>(param);
+	const uint32_t firstSector = idx * VERIFY_CHUNK_SECTORS;
+	unsigned int count = job->sectorCount - firstSector;
+	if (count > VERIFY_CHUNK_SECTORS) {
+		count = VERIFY_CHUNK_SECTORS;
+	}
+
+	// NOTE: Each work item has its own buffer, since
+	// work items run on multiple threads.
+	unique_ptr<CDROM_2352_Sector_t[]> buf(new CDROM_2352_Sector_t[count]);
+	size_t sz_read = job->file->pread(
+		job->offset + ((int64_t)firstSector * sizeof(CDROM_2352_Sector_t)),
+		buf.get(), (size_t)count * sizeof(CDROM_2352_Sector_t));
+	const unsigned int sectorsRead = (unsigned int)(sz_read / sizeof(CDROM_2352_Sector_t));
+
+	vector<CdromEdcEcc::BadSector> &badSectors = job->chunkBadSectors[idx];
+	CdromEdcEcc::BadSector bad;
+	for (unsigned int i = 0; i < count; i++) {
+		bad.errors = (i < sectorsRead
+			? CdromEdcEcc::checkSector(&buf[i])
+			: (uint32_t)CdromEdcEcc::SECTERR_READ);
+		if (bad.errors != 0) {
+			bad.lba = job->lba + firstSector + i;
+			badSectors.push_back(bad);
+		}
+	}
+}
+
+/**
+ * Check a range of 2352-byte sectors in a file.
+ *
+ * The range is split into chunks, which are read and
+ * checked by the thread pool. Bad sectors are appended
+ * to the report in LBA order.
+ *
+ * @param report	[in,out] Sector verification report.
+ * @param pool		[in] Thread pool.
+ * @param file		[in] File. (Must support pread().)
+ * @param offset	[in] Starting address of the first sector.
+ * @param sectorCount	[in] Number of sectors.
+ * @param lba		[in] LBA of the first sector.
+ * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+ */
+int CdromEdcEcc::verifySectors(SectorReport &report, ThreadPool *pool,
+	IRpFile *file, int64_t offset,
+	uint32_t sectorCount, uint32_t lba)
+{
+	assert(pool != nullptr);
+	assert(file != nullptr);
+	if (!pool || !file || offset < 0) {
+		return -EINVAL;
+	} else if (sectorCount == 0) {
+		// Nothing to do.
+		return 0;
+	}
+
+	// Make sure the tables are initialized before
+	// starting the worker threads.
+	initTables();
+
+	VerifySectorsJob job;
+	job.file = file;
+	job.offset = offset;
+	job.sectorCount = sectorCount;
+	job.lba = lba;
+	const unsigned int chunkCount = (sectorCount + VERIFY_CHUNK_SECTORS - 1) / VERIFY_CHUNK_SECTORS;
+	job.chunkBadSectors.resize(chunkCount);
+	pool->run(chunkCount, verifySectors_work, &job);
+
+	// Merge the bad sector lists.
+	for (auto iter = job.chunkBadSectors.cbegin(); iter != job.chunkBadSectors.cend(); ++iter) {
+		report.badSectors.insert(report.badSectors.end(), iter->begin(), iter->end());
+	}
+	report.sectorCount += sectorCount;
+	return 0;
+}
+
+}
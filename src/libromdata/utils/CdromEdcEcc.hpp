@@ -0,0 +1,117 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CdromEdcEcc.hpp: CD-ROM sector EDC/ECC verification.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_UTILS_CDROMEDCECC_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_UTILS_CDROMEDCECC_HPP__
+
+#include "librpbase/common.h"
+#include "../cdrom_structs.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ includes.
+#include <vector>
+
+namespace LibRpBase {
+	class IRpFile;
+	class ThreadPool;
+}
+
+namespace LibRomData {
+
+class CdromEdcEcc
+{
+	private:
+		// Static class.
+		CdromEdcEcc();
+		~CdromEdcEcc();
+		RP_DISABLE_COPY(CdromEdcEcc)
+
+	public:
+		/**
+		 * Calculate a CD-ROM EDC.
+		 * This is a CRC-32 using the polynomial 0x8001801B.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @param edc Previous EDC value. (0 for the first block)
+		 * @return EDC.
+		 */
+		static uint32_t edc(const uint8_t *data, size_t size, uint32_t edc = 0);
+
+		// Sector error bits.
+		enum SectorErrorBits {
+			SECTERR_SYNC	= (1U << 0),	// Sync pattern is incorrect.
+			SECTERR_MODE	= (1U << 1),	// Sector mode is invalid.
+			SECTERR_EDC	= (1U << 2),	// EDC doesn't match.
+			SECTERR_ECC_P	= (1U << 3),	// ECC P parity doesn't match.
+			SECTERR_ECC_Q	= (1U << 4),	// ECC Q parity doesn't match.
+			SECTERR_READ	= (1U << 5),	// Sector could not be read.
+		};
+
+		/**
+		 * Check a 2352-byte sector's EDC and ECC.
+		 *
+		 * Mode 0 and Mode 2 Form 2 sectors don't have ECC,
+		 * so only the EDC is checked for Form 2. (If it's 0,
+		 * the EDC wasn't calculated, so it isn't checked.)
+		 *
+		 * @param sector 2352-byte sector.
+		 * @return 0 if the sector is valid; otherwise, SectorErrorBits.
+		 */
+		static unsigned int checkSector(const CDROM_2352_Sector_t *sector);
+
+		// Sector that failed verification.
+		struct BadSector {
+			uint32_t lba;		// Sector address.
+			uint32_t errors;	// Error bits. (See SectorErrorBits.)
+		};
+
+		// Sector verification report.
+		struct SectorReport {
+			uint32_t sectorCount;	// Number of sectors checked.
+			std::vector<BadSector> badSectors;	// Sorted by LBA.
+		};
+
+		/**
+		 * Check a range of 2352-byte sectors in a file.
+		 *
+		 * The range is split into chunks, which are read and
+		 * checked by the thread pool. Bad sectors are appended
+		 * to the report in LBA order.
+		 *
+		 * @param report	[in,out] Sector verification report.
+		 * @param pool		[in] Thread pool.
+		 * @param file		[in] File. (Must support pread().)
+		 * @param offset	[in] Starting address of the first sector.
+		 * @param sectorCount	[in] Number of sectors.
+		 * @param lba		[in] LBA of the first sector.
+		 * @return 0 on success (even if bad sectors were found); negative POSIX error code on error.
+		 */
+		static int verifySectors(SectorReport &report, LibRpBase::ThreadPool *pool,
+			LibRpBase::IRpFile *file, int64_t offset,
+			uint32_t sectorCount, uint32_t lba);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_UTILS_CDROMEDCECC_HPP__ */
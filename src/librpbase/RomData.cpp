@@ -60,6 +60,7 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	, fields(new RomFields())
 	, className(nullptr)
 	, fileType(RomData::FTYPE_ROM_IMAGE)
+	, fieldGroups(RomData::FG_ALL)
 {
 	// Initialize i18n.
 	rp_i18n_init();
@@ -643,6 +644,37 @@ const RomFields *RomData::fields(void) const
 	return d->fields;
 }
 
+/**
+ * Get the requested field groups.
+ * @return Bitfield of FieldGroup values. (default is FG_ALL)
+ */
+uint32_t RomData::fieldGroups(void) const
+{
+	RP_D(const RomData);
+	return d->fieldGroups;
+}
+
+/**
+ * Set the requested field groups.
+ *
+ * This should be called before fields().
+ * If fields have already been loaded and the new field
+ * groups aren't a subset of the old field groups, the
+ * field data will be reloaded by the next fields() call.
+ *
+ * @param fieldGroups Bitfield of FieldGroup values.
+ */
+void RomData::setFieldGroups(uint32_t fieldGroups)
+{
+	RP_D(RomData);
+	if ((fieldGroups & ~d->fieldGroups) != 0 && d->fields->isDataLoaded()) {
+		// New field groups were requested.
+		// Clear the fields so they'll be reloaded.
+		*d->fields = RomFields();
+	}
+	d->fieldGroups = fieldGroups;
+}
+
 /**
  * Get an internal image from the ROM.
  *
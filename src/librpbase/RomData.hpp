@@ -392,6 +392,42 @@ class RomData
 		 */
 		const RomFields *fields(void) const;
 
+		/**
+		 * Field groups.
+		 * Used to request a subset of the field data.
+		 *
+		 * Subclasses that support field groups can skip
+		 * I/O and decryption for groups that weren't requested.
+		 * Subclasses that don't support field groups will
+		 * always load all fields.
+		 */
+		enum FieldGroup {
+			FG_IDENTITY	= (1 << 0),	// Title, IDs, publisher, region, age ratings
+			FG_PERMISSIONS	= (1 << 1),	// Permissions and access control
+			FG_CONTENTS	= (1 << 2),	// Partition and contents tables
+			FG_DETAILS	= (1 << 3),	// Other technical details
+
+			FG_ALL		= 0xFFFFFFFF
+		};
+
+		/**
+		 * Get the requested field groups.
+		 * @return Bitfield of FieldGroup values. (default is FG_ALL)
+		 */
+		uint32_t fieldGroups(void) const;
+
+		/**
+		 * Set the requested field groups.
+		 *
+		 * This should be called before fields().
+		 * If fields have already been loaded and the new field
+		 * groups aren't a subset of the old field groups, the
+		 * field data will be reloaded by the next fields() call.
+		 *
+		 * @param fieldGroups Bitfield of FieldGroup values.
+		 */
+		void setFieldGroups(uint32_t fieldGroups);
+
 	private:
 		/**
 		 * Verify that the specified image type has been loaded.
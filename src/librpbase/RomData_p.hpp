@@ -67,6 +67,9 @@ class RomDataPrivate
 		const char *className;
 		// File type. (default is FTYPE_ROM_IMAGE)
 		RomData::FileType fileType;
+		// Requested field groups. (default is FG_ALL)
+		// Subclasses should check this in loadFieldData().
+		uint32_t fieldGroups;
 
 	public:
 		/** Convenience functions. **/
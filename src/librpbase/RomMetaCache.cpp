@@ -0,0 +1,1016 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RomMetaCache.cpp: Persistent on-disk metadata cache.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "RomMetaCache.hpp"
+#include "RomData.hpp"
+#include "RomData_p.hpp"
+#include "RomFields.hpp"
+#include "TextFuncs.hpp"
+#include "file/RpFile.hpp"
+#include "file/FileSystem.hpp"
+#include "threads/Atomics.h"
+using namespace LibRpBase::FileSystem;
+
+// C includes.
+#ifdef _WIN32
+#include "libwin32common/RpWin32_sdk.h"
+#include "libwin32common/w32time.h"
+#include "TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+// C++ includes.
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase {
+
+class RomMetaCachePrivate
+{
+	private:
+		RomMetaCachePrivate();
+		~RomMetaCachePrivate();
+	private:
+		RP_DISABLE_COPY(RomMetaCachePrivate)
+
+	public:
+		// Cache file header.
+		// All values are little-endian.
+		static const uint32_t CACHE_MAGIC = 'RPMC';
+		static const uint32_t CACHE_VERSION = 1;
+		static const unsigned int CACHE_HEADER_SIZE = 16;
+
+		// Maximum cache entry size.
+		static const unsigned int CACHE_ENTRY_MAX_SIZE = 4*1024*1024;
+
+		// Number of store() calls between automatic prune() calls.
+		static const int PRUNE_INTERVAL = 64;
+		static volatile int store_count;
+
+		// Temporary files older than this are assumed to be
+		// left over from a crash and are removed by prune().
+		static const int TEMP_FILE_MAX_AGE = 60*60;
+		static volatile int temp_count;
+
+		/**
+		 * Get the metadata cache directory.
+		 * @return Metadata cache directory, with a trailing separator, or empty string on error.
+		 */
+		static string getMetaCacheDirectory(void);
+
+		/**
+		 * Get the cache filename for a ROM.
+		 * @param filename ROM filename.
+		 * @return Cache filename, or empty string on error.
+		 */
+		static string getCacheFilename(const string &filename);
+
+		/**
+		 * Get a unique temporary filename for writing a cache entry.
+		 * The temporary file is in the same directory as the entry,
+		 * so it can be renamed over the entry atomically.
+		 * @param cache_filename Cache filename.
+		 * @return Temporary filename.
+		 */
+		static string getTempFilename(const string &cache_filename);
+
+		/**
+		 * 32-bit FNV-1a hash.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @return Hash.
+		 */
+		static uint32_t fnv1a_32(const uint8_t *data, size_t size);
+
+		/**
+		 * 64-bit FNV-1a hash.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @return Hash.
+		 */
+		static uint64_t fnv1a_64(const uint8_t *data, size_t size);
+
+	public:
+		/**
+		 * Serialization buffer.
+		 */
+		class Writer
+		{
+			public:
+				vector<uint8_t> buf;
+
+				void u8(uint8_t val)
+				{
+					buf.push_back(val);
+				}
+
+				void u32(uint32_t val)
+				{
+					for (unsigned int i = 0; i < 4; i++, val >>= 8) {
+						buf.push_back((uint8_t)(val & 0xFF));
+					}
+				}
+
+				void u64(uint64_t val)
+				{
+					for (unsigned int i = 0; i < 8; i++, val >>= 8) {
+						buf.push_back((uint8_t)(val & 0xFF));
+					}
+				}
+
+				// NOTE: nullptr is stored as 0xFFFFFFFF.
+				void str(const char *str)
+				{
+					if (!str) {
+						u32(0xFFFFFFFF);
+						return;
+					}
+					const size_t len = strlen(str);
+					u32((uint32_t)len);
+					buf.insert(buf.end(), str, str + len);
+				}
+
+				void str(const string &str)
+				{
+					u32((uint32_t)str.size());
+					buf.insert(buf.end(), str.begin(), str.end());
+				}
+
+				void strVector(const vector<string> *vec)
+				{
+					if (!vec) {
+						u32(0xFFFFFFFF);
+						return;
+					}
+					u32((uint32_t)vec->size());
+					for (auto iter = vec->cbegin(); iter != vec->cend(); ++iter) {
+						str(*iter);
+					}
+				}
+		};
+
+		/**
+		 * Deserialization buffer.
+		 * If any read goes out of bounds, ok is set to false
+		 * and all subsequent reads return 0 or empty strings.
+		 */
+		class Reader
+		{
+			public:
+				Reader(const uint8_t *p, size_t size)
+					: p(p), end(p + size), ok(true) { }
+
+				const uint8_t *p;
+				const uint8_t *const end;
+				bool ok;
+
+				bool check(size_t size)
+				{
+					if (!ok || (size_t)(end - p) < size) {
+						ok = false;
+						return false;
+					}
+					return true;
+				}
+
+				uint8_t u8(void)
+				{
+					if (!check(1))
+						return 0;
+					return *p++;
+				}
+
+				uint32_t u32(void)
+				{
+					if (!check(4))
+						return 0;
+					const uint32_t val = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+						((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+					p += 4;
+					return val;
+				}
+
+				uint64_t u64(void)
+				{
+					const uint64_t lo = u32();
+					const uint64_t hi = u32();
+					return lo | (hi << 32);
+				}
+
+				/**
+				 * Read a string.
+				 * @param isNull [out,opt] Set to true if the string is nullptr.
+				 * @return String.
+				 */
+				string str(bool *isNull = nullptr)
+				{
+					const uint32_t len = u32();
+					if (isNull) {
+						*isNull = (len == 0xFFFFFFFF);
+					}
+					if (len == 0xFFFFFFFF || !check(len))
+						return string();
+					string ret(reinterpret_cast<const char*>(p), len);
+					p += len;
+					return ret;
+				}
+
+				/**
+				 * Read a string vector.
+				 * @return Allocated string vector, or nullptr if it was nullptr.
+				 */
+				vector<string> *strVector(void)
+				{
+					const uint32_t count = u32();
+					if (count == 0xFFFFFFFF || !ok)
+						return nullptr;
+					// Each string has at least a 4-byte length.
+					if (!check((size_t)count * 4))
+						return nullptr;
+					vector<string> *vec = new vector<string>();
+					vec->reserve(count);
+					for (uint32_t i = 0; i < count && ok; i++) {
+						vec->push_back(str());
+					}
+					return vec;
+				}
+		};
+
+		/**
+		 * Serialize a RomFields object.
+		 * @param w Writer.
+		 * @param fields RomFields.
+		 */
+		static void writeFields(Writer &w, const RomFields *fields);
+
+		/**
+		 * Deserialize a RomFields object.
+		 * @param r Reader.
+		 * @param fields RomFields.
+		 * @return True on success; false on error.
+		 */
+		static bool readFields(Reader &r, RomFields *fields);
+
+		/**
+		 * Write the file identity to a serialization buffer.
+		 * @param w Writer.
+		 * @param filename ROM filename.
+		 * @param ident File identity.
+		 */
+		static void writeIdentity(Writer &w, const string &filename, const FileIdentity &ident);
+
+		/**
+		 * Check the file identity in a serialization buffer.
+		 * @param r Reader.
+		 * @param filename ROM filename.
+		 * @param ident File identity.
+		 * @return True if the identity matches; false if not.
+		 */
+		static bool checkIdentity(Reader &r, const string &filename, const FileIdentity &ident);
+};
+
+/** CachedRomData **/
+
+class CachedRomDataPrivate;
+class CachedRomData : public RomData
+{
+	public:
+		CachedRomData();
+
+	private:
+		typedef RomData super;
+		friend class RomMetaCache;
+		RP_DISABLE_COPY(CachedRomData)
+
+	public:
+		int isRomSupported(const DetectInfo *info) const override final;
+		const char *systemName(unsigned int type) const override final;
+		const char *const *supportedFileExtensions(void) const override final;
+
+	protected:
+		int loadFieldData(void) override final;
+};
+
+class CachedRomDataPrivate : public RomDataPrivate
+{
+	public:
+		explicit CachedRomDataPrivate(CachedRomData *q)
+			: super(q, nullptr) { }
+
+	private:
+		typedef RomDataPrivate super;
+		RP_DISABLE_COPY(CachedRomDataPrivate)
+
+	public:
+		// Class name. (d->className points to this.)
+		string s_className;
+
+		// System names, indexed by SystemNameType.
+		string sysNames[8];
+		bool sysNameValid[8];
+};
+
+CachedRomData::CachedRomData()
+	: super(new CachedRomDataPrivate(this))
+{
+	RP_D(CachedRomData);
+	memset(d->sysNameValid, 0, sizeof(d->sysNameValid));
+}
+
+int CachedRomData::isRomSupported(const DetectInfo *info) const
+{
+	// Cached RomData objects can't be detected.
+	RP_UNUSED(info);
+	return -1;
+}
+
+const char *CachedRomData::systemName(unsigned int type) const
+{
+	RP_D(const CachedRomData);
+	if (!d->isValid || !isSystemNameTypeValid(type))
+		return nullptr;
+	if (!d->sysNameValid[type & 7])
+		return nullptr;
+	return d->sysNames[type & 7].c_str();
+}
+
+const char *const *CachedRomData::supportedFileExtensions(void) const
+{
+	// Cached RomData objects don't have file extensions.
+	return nullptr;
+}
+
+int CachedRomData::loadFieldData(void)
+{
+	// Field data was loaded from the cache.
+	RP_D(CachedRomData);
+	return (d->isValid ? d->fields->count() : -EIO);
+}
+
+/** RomMetaCachePrivate **/
+
+volatile int RomMetaCachePrivate::store_count = 0;
+volatile int RomMetaCachePrivate::temp_count = 0;
+
+/**
+ * Get the metadata cache directory.
+ * @return Metadata cache directory, with a trailing separator, or empty string on error.
+ */
+string RomMetaCachePrivate::getMetaCacheDirectory(void)
+{
+	// Same base directory as CacheManager.
+	string dir = getCacheDirectory();
+	if (dir.empty())
+		return string();
+	if (dir.at(dir.size()-1) != DIR_SEP_CHR)
+		dir += DIR_SEP_CHR;
+	dir += "metadata";
+	dir += DIR_SEP_CHR;
+	return dir;
+}
+
+/**
+ * Get the cache filename for a ROM.
+ * @param filename ROM filename.
+ * @return Cache filename, or empty string on error.
+ */
+string RomMetaCachePrivate::getCacheFilename(const string &filename)
+{
+	string cache_filename = getMetaCacheDirectory();
+	if (cache_filename.empty() || filename.empty())
+		return string();
+
+	// The full filename is stored in the cache entry,
+	// so hash collisions are detected on lookup.
+	const uint64_t hash = fnv1a_64(
+		reinterpret_cast<const uint8_t*>(filename.data()), filename.size());
+	cache_filename += rp_sprintf("%08X%08X.rpmd",
+		(uint32_t)(hash >> 32), (uint32_t)hash);
+	return cache_filename;
+}
+
+/**
+ * Get a unique temporary filename for writing a cache entry.
+ * The temporary file is in the same directory as the entry,
+ * so it can be renamed over the entry atomically.
+ * @param cache_filename Cache filename.
+ * @return Temporary filename.
+ */
+string RomMetaCachePrivate::getTempFilename(const string &cache_filename)
+{
+	// Process ID and a per-process counter make the name unique
+	// across concurrent writers.
+#ifdef _WIN32
+	const unsigned int pid = (unsigned int)GetCurrentProcessId();
+#else /* !_WIN32 */
+	const unsigned int pid = (unsigned int)getpid();
+#endif /* _WIN32 */
+	const unsigned int count = (unsigned int)ATOMIC_INC_FETCH(&temp_count);
+	return cache_filename + rp_sprintf(".%u-%u.tmp", pid, count);
+}
+
+/**
+ * 32-bit FNV-1a hash.
+ * @param data Data.
+ * @param size Size of data.
+ * @return Hash.
+ */
+uint32_t RomMetaCachePrivate::fnv1a_32(const uint8_t *data, size_t size)
+{
+	uint32_t hash = 2166136261U;
+	for (; size > 0; size--, data++) {
+		hash ^= *data;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * 64-bit FNV-1a hash.
+ * @param data Data.
+ * @param size Size of data.
+ * @return Hash.
+ */
+uint64_t RomMetaCachePrivate::fnv1a_64(const uint8_t *data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (; size > 0; size--, data++) {
+		hash ^= *data;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * Serialize a RomFields object.
+ * @param w Writer.
+ * @param fields RomFields.
+ */
+void RomMetaCachePrivate::writeFields(Writer &w, const RomFields *fields)
+{
+	// Tabs.
+	const int tabCount = fields->tabCount();
+	w.u32((uint32_t)tabCount);
+	for (int i = 0; i < tabCount; i++) {
+		w.str(fields->tabName(i));
+	}
+
+	// Fields.
+	// NOTE: Invalid fields are skipped.
+	const int count = fields->count();
+	int validCount = 0;
+	for (int i = 0; i < count; i++) {
+		const RomFields::Field *field = fields->field(i);
+		if (field && field->isValid && field->type != RomFields::RFT_INVALID) {
+			validCount++;
+		}
+	}
+	w.u32((uint32_t)validCount);
+
+	for (int i = 0; i < count; i++) {
+		const RomFields::Field *field = fields->field(i);
+		if (!field || !field->isValid || field->type == RomFields::RFT_INVALID)
+			continue;
+
+		w.str(field->name);
+		w.u8((uint8_t)field->type);
+		w.u8(field->tabIdx);
+
+		switch (field->type) {
+			case RomFields::RFT_STRING:
+				w.u32(field->desc.flags);
+				w.str(field->data.str ? field->data.str->c_str() : nullptr);
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				w.u32((uint32_t)field->desc.bitfield.elemsPerRow);
+				w.strVector(field->desc.bitfield.names);
+				w.u32(field->data.bitfield);
+				break;
+
+			case RomFields::RFT_LISTDATA: {
+				w.u32(field->desc.list_data.flags);
+				w.u32((uint32_t)field->desc.list_data.rows_visible);
+				w.strVector(field->desc.list_data.names);
+				w.u32(field->data.list_checkboxes);
+				const vector<vector<string> > *const list_data = field->data.list_data;
+				if (!list_data) {
+					w.u32(0xFFFFFFFF);
+					break;
+				}
+				w.u32((uint32_t)list_data->size());
+				for (auto iter = list_data->cbegin(); iter != list_data->cend(); ++iter) {
+					w.strVector(&(*iter));
+				}
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				w.u32(field->desc.flags);
+				w.u64((uint64_t)(int64_t)field->data.date_time);
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				const RomFields::age_ratings_t *const age_ratings = field->data.age_ratings;
+				for (int j = 0; j < RomFields::AGE_MAX; j++) {
+					w.u32(age_ratings ? (*age_ratings)[j] : 0);
+				}
+				break;
+			}
+
+			default:
+				// Should not get here...
+				assert(!"Unsupported RomFields::RomFieldsType.");
+				break;
+		}
+	}
+}
+
+/**
+ * Deserialize a RomFields object.
+ * @param r Reader.
+ * @param fields RomFields.
+ * @return True on success; false on error.
+ */
+bool RomMetaCachePrivate::readFields(Reader &r, RomFields *fields)
+{
+	// Tabs.
+	const uint32_t tabCount = r.u32();
+	if (!r.ok || tabCount > 256)
+		return false;
+	fields->reserveTabs((int)tabCount);
+	for (uint32_t i = 0; i < tabCount && r.ok; i++) {
+		bool isNull;
+		const string name = r.str(&isNull);
+		fields->setTabName((int)i, (isNull ? nullptr : name.c_str()));
+	}
+
+	// Fields.
+	const uint32_t count = r.u32();
+	if (!r.ok || !r.check((size_t)count * 6))
+		return false;
+	fields->reserve((int)count);
+
+	for (uint32_t i = 0; i < count && r.ok; i++) {
+		const string name = r.str();
+		const uint8_t type = r.u8();
+		const uint8_t tabIdx = r.u8();
+		if (!r.ok)
+			return false;
+		fields->setTabIndex(tabIdx);
+
+		switch (type) {
+			case RomFields::RFT_STRING: {
+				const unsigned int flags = r.u32();
+				bool isNull;
+				const string str = r.str(&isNull);
+				fields->addField_string(name.c_str(), (isNull ? nullptr : str.c_str()), flags);
+				break;
+			}
+
+			case RomFields::RFT_BITFIELD: {
+				const int elemsPerRow = (int)r.u32();
+				vector<string> *const names = r.strVector();
+				const uint32_t bitfield = r.u32();
+				if (!names || !r.ok) {
+					delete names;
+					return false;
+				}
+				fields->addField_bitfield(name.c_str(), names, elemsPerRow, bitfield);
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				const unsigned int flags = r.u32();
+				const int rows_visible = (int)r.u32();
+				unique_ptr<vector<string> > headers(r.strVector());
+				const uint32_t checkboxes = r.u32();
+				const uint32_t rows = r.u32();
+				unique_ptr<vector<vector<string> > > list_data;
+				if (rows != 0xFFFFFFFF) {
+					if (!r.check((size_t)rows * 4))
+						return false;
+					list_data.reset(new vector<vector<string> >());
+					list_data->resize(rows);
+					for (uint32_t j = 0; j < rows && r.ok; j++) {
+						unique_ptr<vector<string> > row(r.strVector());
+						if (row) {
+							(*list_data)[j].swap(*row);
+						}
+					}
+				}
+				if (!r.ok)
+					return false;
+				fields->addField_listData(name.c_str(), headers.release(),
+					list_data.release(), rows_visible, flags, checkboxes);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME: {
+				const unsigned int flags = r.u32();
+				const time_t date_time = (time_t)(int64_t)r.u64();
+				fields->addField_dateTime(name.c_str(), date_time, flags);
+				break;
+			}
+
+			case RomFields::RFT_AGE_RATINGS: {
+				RomFields::age_ratings_t age_ratings;
+				for (int j = 0; j < RomFields::AGE_MAX; j++) {
+					age_ratings[j] = (uint16_t)r.u32();
+				}
+				fields->addField_ageRatings(name.c_str(), age_ratings);
+				break;
+			}
+
+			default:
+				// Unsupported field type.
+				return false;
+		}
+	}
+
+	return r.ok;
+}
+
+/**
+ * Write the file identity to a serialization buffer.
+ * @param w Writer.
+ * @param filename ROM filename.
+ * @param ident File identity.
+ */
+void RomMetaCachePrivate::writeIdentity(Writer &w, const string &filename, const FileIdentity &ident)
+{
+	w.str(filename);
+	w.u64((uint64_t)ident.size);
+	w.u64((uint64_t)(int64_t)ident.mtime);
+	w.u64(ident.device);
+	w.u64(ident.inode);
+}
+
+/**
+ * Check the file identity in a serialization buffer.
+ * @param r Reader.
+ * @param filename ROM filename.
+ * @param ident File identity.
+ * @return True if the identity matches; false if not.
+ */
+bool RomMetaCachePrivate::checkIdentity(Reader &r, const string &filename, const FileIdentity &ident)
+{
+	if (r.str() != filename)
+		return false;
+	if ((int64_t)r.u64() != ident.size)
+		return false;
+	if ((int64_t)r.u64() != (int64_t)ident.mtime)
+		return false;
+	if (r.u64() != ident.device)
+		return false;
+	if (r.u64() != ident.inode)
+		return false;
+	return r.ok;
+}
+
+/** RomMetaCache **/
+
+/**
+ * Look up a ROM in the metadata cache.
+ *
+ * If the ROM's size, mtime, or inode no longer match the
+ * cache entry, the entry is removed and nullptr is returned.
+ *
+ * NOTE: The returned RomData object does not have an open
+ * file, and it doesn't support any image types.
+ *
+ * @param filename ROM filename.
+ * @return Cached RomData object, or nullptr if not found. (Caller must unref() it.)
+ */
+RomData *RomMetaCache::lookup(const string &filename)
+{
+	const string cache_filename = RomMetaCachePrivate::getCacheFilename(filename);
+	if (cache_filename.empty())
+		return nullptr;
+
+	// Get the ROM's identity first.
+	// If the ROM doesn't exist, the cache entry is useless.
+	FileIdentity ident;
+	if (get_file_identity(filename, &ident) != 0)
+		return nullptr;
+
+	unique_ptr<IRpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
+	if (!file->isOpen())
+		return nullptr;
+
+	// Read the header.
+	uint8_t header[RomMetaCachePrivate::CACHE_HEADER_SIZE];
+	if (file->read(header, sizeof(header)) != sizeof(header)) {
+		file.reset();
+		delete_file(cache_filename);
+		return nullptr;
+	}
+	RomMetaCachePrivate::Reader hr(header, sizeof(header));
+	const uint32_t magic = hr.u32();
+	const uint32_t version = hr.u32();
+	const uint32_t payload_size = hr.u32();
+	const uint32_t checksum = hr.u32();
+	if (magic != RomMetaCachePrivate::CACHE_MAGIC ||
+	    version != RomMetaCachePrivate::CACHE_VERSION ||
+	    payload_size > RomMetaCachePrivate::CACHE_ENTRY_MAX_SIZE)
+	{
+		// Incorrect header. Remove the entry.
+		file.reset();
+		delete_file(cache_filename);
+		return nullptr;
+	}
+
+	// Read the payload.
+	unique_ptr<uint8_t[]> payload(new uint8_t[payload_size]);
+	if (file->read(payload.get(), payload_size) != payload_size ||
+	    RomMetaCachePrivate::fnv1a_32(payload.get(), payload_size) != checksum)
+	{
+		// Truncated or corrupted entry. Remove it.
+		file.reset();
+		delete_file(cache_filename);
+		return nullptr;
+	}
+	file.reset();
+
+	RomMetaCachePrivate::Reader r(payload.get(), payload_size);
+	if (!RomMetaCachePrivate::checkIdentity(r, filename, ident)) {
+		// ROM has been modified or replaced.
+		delete_file(cache_filename);
+		return nullptr;
+	}
+
+	CachedRomData *const romData = new CachedRomData();
+	CachedRomDataPrivate *const d = static_cast<CachedRomDataPrivate*>(romData->d_ptr);
+	d->s_className = r.str();
+	d->className = d->s_className.c_str();
+	d->fileType = (RomData::FileType)r.u32();
+	for (unsigned int i = 0; i < ARRAY_SIZE(d->sysNames); i++) {
+		bool isNull;
+		d->sysNames[i] = r.str(&isNull);
+		d->sysNameValid[i] = !isNull;
+	}
+
+	if (!r.ok || !RomMetaCachePrivate::readFields(r, d->fields)) {
+		// Error reading the entry.
+		romData->unref();
+		delete_file(cache_filename);
+		return nullptr;
+	}
+
+	// Update the entry's mtime for prune().
+	set_mtime(cache_filename, time(nullptr));
+
+	d->isValid = true;
+	return romData;
+}
+
+/**
+ * Store a RomData object's metadata in the cache.
+ *
+ * This will periodically prune the cache to DEFAULT_MAX_SIZE.
+ *
+ * @param filename ROM filename.
+ * @param romData RomData object. (Field data will be loaded if it isn't already.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomMetaCache::store(const string &filename, const RomData *romData)
+{
+	assert(romData != nullptr);
+	if (!romData || !romData->isValid())
+		return -EINVAL;
+	if (romData->fieldGroups() != RomData::FG_ALL) {
+		// Only complete field data can be cached.
+		return -EINVAL;
+	}
+
+	const string cache_filename = RomMetaCachePrivate::getCacheFilename(filename);
+	if (cache_filename.empty())
+		return -ENOENT;
+
+	FileIdentity ident;
+	int ret = get_file_identity(filename, &ident);
+	if (ret != 0)
+		return ret;
+
+	const RomFields *const fields = romData->fields();
+	if (!fields)
+		return -EIO;
+
+	// Serialize the metadata.
+	RomMetaCachePrivate::Writer w;
+	w.buf.reserve(4096);
+	RomMetaCachePrivate::writeIdentity(w, filename, ident);
+	w.str(romData->className());
+	w.u32((uint32_t)romData->fileType());
+	for (unsigned int i = 0; i < 8; i++) {
+		// SYSNAME_TYPE_MASK value 3 is invalid.
+		w.str(((i & RomData::SYSNAME_TYPE_MASK) <= RomData::SYSNAME_TYPE_ABBREVIATION)
+			? romData->systemName(i) : nullptr);
+	}
+	RomMetaCachePrivate::writeFields(w, fields);
+
+	if (w.buf.size() > RomMetaCachePrivate::CACHE_ENTRY_MAX_SIZE) {
+		// Too big to cache.
+		return -ENOSPC;
+	}
+
+	RomMetaCachePrivate::Writer hw;
+	hw.u32(RomMetaCachePrivate::CACHE_MAGIC);
+	hw.u32(RomMetaCachePrivate::CACHE_VERSION);
+	hw.u32((uint32_t)w.buf.size());
+	hw.u32(RomMetaCachePrivate::fnv1a_32(w.buf.data(), w.buf.size()));
+
+	// Make sure the cache directory exists.
+	if (rmkdir(cache_filename) != 0)
+		return -ENOENT;
+
+	// Write the entry to a temporary file in the same directory,
+	// then rename it over the cache entry. This prevents a crash
+	// or a concurrent lookup() from seeing a truncated entry.
+	const string tmp_filename = RomMetaCachePrivate::getTempFilename(cache_filename);
+	unique_ptr<IRpFile> file(new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE));
+	if (!file->isOpen()) {
+		ret = -file->lastError();
+		return (ret != 0 ? ret : -EIO);
+	}
+	if (file->write(hw.buf.data(), hw.buf.size()) != hw.buf.size() ||
+	    file->write(w.buf.data(), w.buf.size()) != w.buf.size())
+	{
+		// Write error.
+		ret = -file->lastError();
+		file.reset();
+		delete_file(tmp_filename);
+		return (ret != 0 ? ret : -EIO);
+	}
+	file.reset();
+
+	ret = rename_file(tmp_filename, cache_filename);
+	if (ret != 0) {
+		// Rename error.
+		delete_file(tmp_filename);
+		return ret;
+	}
+
+	// Prune the cache every PRUNE_INTERVAL stores.
+	// (This includes the first store in the process.)
+	if (((ATOMIC_INC_FETCH(&RomMetaCachePrivate::store_count) - 1) %
+	      RomMetaCachePrivate::PRUNE_INTERVAL) == 0)
+	{
+		prune(DEFAULT_MAX_SIZE);
+	}
+	return 0;
+}
+
+/**
+ * Remove a ROM from the metadata cache.
+ * @param filename ROM filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomMetaCache::remove(const string &filename)
+{
+	const string cache_filename = RomMetaCachePrivate::getCacheFilename(filename);
+	if (cache_filename.empty())
+		return -ENOENT;
+	return delete_file(cache_filename);
+}
+
+/**
+ * Prune the metadata cache.
+ *
+ * If the total size of the cache exceeds maxSize,
+ * the least recently used entries will be removed
+ * until it's below 75% of maxSize.
+ *
+ * @param maxSize Maximum cache size, in bytes.
+ * @return Number of entries removed, or negative POSIX error code on error.
+ */
+int RomMetaCache::prune(int64_t maxSize)
+{
+	const string dir = RomMetaCachePrivate::getMetaCacheDirectory();
+	if (dir.empty())
+		return -ENOENT;
+
+	struct CacheEntry {
+		string filename;
+		int64_t size;
+		time_t mtime;
+	};
+	vector<CacheEntry> entries;
+	int64_t totalSize = 0;
+	const time_t now = time(nullptr);
+
+#ifdef _WIN32
+	WIN32_FIND_DATA findData;
+	HANDLE hFind = FindFirstFile(RP2W_s(dir + "*.rpmd*"), &findData);
+	if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+		// No cache entries.
+		return 0;
+	}
+	do {
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			continue;
+		// NOTE: "*.rpmd" also matches "*.rpmd.*.tmp".
+		const size_t len = wcslen(findData.cFileName);
+		if (len >= 4 && !wcscmp(&findData.cFileName[len-4], L".tmp")) {
+			// Temporary file. Remove it if it's stale.
+			const time_t mtime = (time_t)FileTimeToUnixTime(&findData.ftLastWriteTime);
+			if (now - mtime > RomMetaCachePrivate::TEMP_FILE_MAX_AGE) {
+				delete_file(dir + W2U8(findData.cFileName));
+			}
+			continue;
+		}
+		CacheEntry entry;
+		entry.filename = dir + W2U8(findData.cFileName);
+		entry.size = ((int64_t)findData.nFileSizeHigh << 32) | (int64_t)findData.nFileSizeLow;
+		entry.mtime = (time_t)FileTimeToUnixTime(&findData.ftLastWriteTime);
+		totalSize += entry.size;
+		entries.push_back(entry);
+	} while (FindNextFile(hFind, &findData));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *pDir = opendir(dir.c_str());
+	if (!pDir) {
+		// No cache entries.
+		return 0;
+	}
+	struct dirent *dirent;
+	while ((dirent = readdir(pDir)) != nullptr) {
+		const size_t len = strlen(dirent->d_name);
+		const bool isTemp = (len >= 4 && !strcmp(&dirent->d_name[len-4], ".tmp"));
+		if (!isTemp && (len < 5 || strcmp(&dirent->d_name[len-5], ".rpmd") != 0))
+			continue;
+
+		CacheEntry entry;
+		entry.filename = dir + dirent->d_name;
+		struct stat buf;
+		if (stat(entry.filename.c_str(), &buf) != 0 || !S_ISREG(buf.st_mode))
+			continue;
+		if (isTemp) {
+			// Temporary file. Remove it if it's stale.
+			if (now - buf.st_mtime > RomMetaCachePrivate::TEMP_FILE_MAX_AGE) {
+				delete_file(entry.filename);
+			}
+			continue;
+		}
+		entry.size = buf.st_size;
+		entry.mtime = buf.st_mtime;
+		totalSize += entry.size;
+		entries.push_back(entry);
+	}
+	closedir(pDir);
+#endif /* _WIN32 */
+
+	if (totalSize <= maxSize)
+		return 0;
+
+	// Remove the least recently used entries first.
+	std::sort(entries.begin(), entries.end(),
+		[](const CacheEntry &a, const CacheEntry &b) {
+			return (a.mtime < b.mtime);
+		});
+
+	const int64_t targetSize = maxSize / 4 * 3;
+	int removed = 0;
+	for (auto iter = entries.cbegin(); iter != entries.cend() && totalSize > targetSize; ++iter) {
+		if (delete_file(iter->filename) == 0) {
+			totalSize -= iter->size;
+			removed++;
+		}
+	}
+	return removed;
+}
+
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RomMetaCache.hpp: Persistent on-disk metadata cache.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_ROMMETACACHE_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_ROMMETACACHE_HPP__
+
+#include "librpbase/config.librpbase.h"
+#include "librpbase/common.h"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+
+namespace LibRpBase {
+
+class RomData;
+
+/**
+ * Persistent on-disk metadata cache.
+ *
+ * Stores the RomFields, class name, file type, and system names
+ * of a RomData object in the rom-properties cache directory.
+ * Entries are keyed by the ROM's filename, size, mtime, and inode,
+ * so a cache lookup doesn't need to open the ROM at all.
+ *
+ * Cached RomData objects don't have any images, and the ROM
+ * file is not opened, so they're only suitable for frontends
+ * that only need the field data.
+ */
+class RomMetaCache
+{
+	private:
+		RomMetaCache();
+		~RomMetaCache();
+	private:
+		RP_DISABLE_COPY(RomMetaCache)
+
+	public:
+		// Default maximum cache size, in bytes.
+		static const int64_t DEFAULT_MAX_SIZE = 64*1024*1024;
+
+		/**
+		 * Look up a ROM in the metadata cache.
+		 *
+		 * If the ROM's size, mtime, or inode no longer match the
+		 * cache entry, the entry is removed and nullptr is returned.
+		 *
+		 * NOTE: The returned RomData object does not have an open
+		 * file, and it doesn't support any image types.
+		 *
+		 * @param filename ROM filename.
+		 * @return Cached RomData object, or nullptr if not found. (Caller must unref() it.)
+		 */
+		static RomData *lookup(const std::string &filename);
+
+		/**
+		 * Store a RomData object's metadata in the cache.
+		 *
+		 * This will periodically prune the cache to DEFAULT_MAX_SIZE.
+		 *
+		 * @param filename ROM filename.
+		 * @param romData RomData object. (Field data will be loaded if it isn't already.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int store(const std::string &filename, const RomData *romData);
+
+		/**
+		 * Remove a ROM from the metadata cache.
+		 * @param filename ROM filename.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int remove(const std::string &filename);
+
+		/**
+		 * Prune the metadata cache.
+		 *
+		 * If the total size of the cache exceeds maxSize,
+		 * the least recently used entries will be removed
+		 * until it's below 75% of maxSize.
+		 *
+		 * @param maxSize Maximum cache size, in bytes.
+		 * @return Number of entries removed, or negative POSIX error code on error.
+		 */
+		static int prune(int64_t maxSize = DEFAULT_MAX_SIZE);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_ROMMETACACHE_HPP__ */
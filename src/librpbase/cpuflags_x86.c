@@ -55,6 +55,7 @@
 #define CPUFLAG_IA32_ECX_SSSE3		((uint32_t)(1U << 9))
 #define CPUFLAG_IA32_ECX_SSE41		((uint32_t)(1U << 19))
 #define CPUFLAG_IA32_ECX_SSE42		((uint32_t)(1U << 20))
+#define CPUFLAG_IA32_ECX_AES		((uint32_t)(1U << 25))
 #define CPUFLAG_IA32_ECX_XSAVE		((uint32_t)(1U << 26))
 #define CPUFLAG_IA32_ECX_OSXSAVE	((uint32_t)(1U << 27))
 #define CPUFLAG_IA32_ECX_AVX		((uint32_t)(1U << 28))
@@ -64,6 +65,15 @@
 
 // Flags stored in the %ebx register.
 #define CPUFLAG_IA32_FN7_EBX_AVX2	((uint32_t)(1U << 5))
+#define CPUFLAG_IA32_FN7_EBX_SHA	((uint32_t)(1U << 29))
+
+// Flags stored in the %ecx register.
+#define CPUFLAG_IA32_FN7_ECX_VAES	((uint32_t)(1U << 9))
+
+// XCR0: Extended control register 0.
+// Both bits must be set for the OS to support AVX.
+#define XCR0_SSE_STATE			((uint32_t)(1U << 1))
+#define XCR0_YMM_STATE			((uint32_t)(1U << 2))
 
 // CPUID function 0x80000001: Extended Processor Info and Feature Bits
 
@@ -147,6 +157,7 @@ static FORCEINLINE int is_cpuid_supported(void)
 
 /**
  * Run the `cpuid` instruction.
+ * NOTE: The subleaf (%ecx) is always 0.
  * @param level
  * @param regs Registers. (%eax, %ebx, %ecx, %edx)
  */
@@ -161,17 +172,21 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 		"cpuid\n"
 		"xchgl	%%ebx, %1\n"
 		: "=a" (regs[0]), "=r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-		: "0" (level)
+		: "0" (level), "2" (0)
 		);
 # else /* !ASM_RESERVE_EBX */
 	__asm__ (
 		"cpuid\n"
 		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-		: "0" (level)
+		: "0" (level), "2" (0)
 		);
 # endif
 #elif defined(_MSC_VER)
-# if _MSC_VER >= 1400
+# if _MSC_VER >= 1600
+	// CPUID for MSVC 2010+
+	// Uses the __cpuidex() intrinsic.
+	__cpuidex((int*)regs, level, 0);
+# elif _MSC_VER >= 1400
 	// CPUID for MSVC 2005+
 	// Uses the __cpuid() intrinsic.
 	__cpuid((int*)regs, level);
@@ -182,6 +197,8 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #   error Cannot use inline assembly on 64-bit MSVC.
 #  endif
 	__asm {
+		mov	eax, level
+		xor	ecx, ecx
 		cpuid
 		mov	regs[0 * TYPE int], eax
 		mov	regs[1 * TYPE int], ebx
@@ -194,6 +211,35 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #endif
 }
 
+/**
+ * Run the `xgetbv` instruction.
+ * CPUID must indicate OSXSAVE support before calling this function.
+ * @param xcr Extended control register number.
+ * @return Low 32 bits of the register, or 0 if xgetbv isn't available.
+ */
+static FORCEINLINE uint32_t xgetbv(unsigned int xcr)
+{
+#if defined(__GNUC__)
+	// NOTE: Using the opcode directly, since older
+	// assemblers don't support the xgetbv mnemonic.
+	unsigned int __eax, __edx;
+	__asm__ (
+		".byte 0x0f, 0x01, 0xd0\n"
+		: "=a" (__eax), "=d" (__edx)
+		: "c" (xcr)
+		);
+	return __eax;
+#elif defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219
+	// xgetbv for MSVC 2010 SP1+
+	// Uses the _xgetbv() intrinsic.
+	return (uint32_t)_xgetbv(xcr);
+#else
+	// xgetbv isn't available. Assume AVX isn't supported.
+	((void)xcr);
+	return 0;
+#endif
+}
+
 // Register indexes.
 #define REG_EAX 0
 #define REG_EBX 1
@@ -316,6 +362,40 @@ static void RP_CPU_InitCPUFlags_int(void)
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
 #endif /* defined(__i386__) || defined(_M_IX86) */
+
+		// AES-NI uses SSE registers.
+		if (can_FXSAVE && (regs[REG_ECX] & CPUFLAG_IA32_ECX_AES))
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AES;
+
+		// AVX requires the OS to save the YMM registers.
+		if (can_FXSAVE &&
+		    (regs[REG_ECX] & CPUFLAG_IA32_ECX_AVX) &&
+		    (regs[REG_ECX] & CPUFLAG_IA32_ECX_OSXSAVE))
+		{
+			const uint32_t xcr0 = xgetbv(0);
+			if ((xcr0 & (XCR0_SSE_STATE | XCR0_YMM_STATE)) ==
+			           (XCR0_SSE_STATE | XCR0_YMM_STATE))
+			{
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX;
+			}
+		}
+	}
+
+	if (maxFunc >= CPUID_EXT_FEATURES) {
+		// Get the extended features.
+		cpuid(CPUID_EXT_FEATURES, regs);
+
+		// SHA extensions use SSE registers.
+		if (can_FXSAVE && (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_SHA))
+			RP_CPU_Flags |= RP_CPUFLAG_X86_SHA;
+
+		// AVX2 and VAES use YMM registers.
+		if (RP_CPU_Flags & RP_CPUFLAG_X86_AVX) {
+			if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX2)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX2;
+			if (regs[REG_ECX] & CPUFLAG_IA32_FN7_ECX_VAES)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_VAES;
+		}
 	}
 
 	// CPU flags initialized.
@@ -42,6 +42,11 @@ extern "C" {
 #define RP_CPUFLAG_X86_SSSE3		((uint32_t)(1U << 4))
 #define RP_CPUFLAG_X86_SSE41		((uint32_t)(1U << 5))
 #define RP_CPUFLAG_X86_SSE42		((uint32_t)(1U << 6))
+#define RP_CPUFLAG_X86_SHA		((uint32_t)(1U << 7))
+#define RP_CPUFLAG_X86_AES		((uint32_t)(1U << 8))
+#define RP_CPUFLAG_X86_AVX		((uint32_t)(1U << 9))
+#define RP_CPUFLAG_X86_AVX2		((uint32_t)(1U << 10))
+#define RP_CPUFLAG_X86_VAES		((uint32_t)(1U << 11))
 
 #endif /* defined(__i386__) || defined(__amd64__) || defined(__x86_64__) */
 
@@ -100,6 +105,68 @@ static FORCEINLINE int RP_CPU_HasSSSE3(void)
 	return (RP_CPU_Flags & RP_CPUFLAG_X86_SSSE3);
 }
 
+/**
+ * Check if the CPU supports SSE4.1.
+ * @return Non-zero if SSE4.1 is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasSSE41(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_SSE41);
+}
+
+/**
+ * Check if the CPU supports the SHA extensions.
+ * @return Non-zero if SHA is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasSHA(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_SHA);
+}
+
+/**
+ * Check if the CPU supports AES-NI.
+ * @return Non-zero if AES-NI is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAES(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AES);
+}
+
+/**
+ * Check if the CPU supports AVX2.
+ * This also checks if the OS saves the YMM registers.
+ * @return Non-zero if AVX2 is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAVX2(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AVX2);
+}
+
+/**
+ * Check if the CPU supports VAES. (256-bit AES instructions)
+ * This also checks if the OS saves the YMM registers.
+ * @return Non-zero if VAES is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasVAES(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_VAES);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,9 @@
 #elif defined(HAVE_NETTLE)
 # include "AesNettle.hpp"
 #endif
+#ifdef HAVE_AES_NI
+# include "AesNI.hpp"
+#endif
 
 namespace LibRpBase {
 
@@ -44,6 +47,43 @@ namespace LibRpBase {
  */
 IAesCipher *AesCipherFactory::create(void)
 {
+	return create(AES_IMPL_DEFAULT);
+}
+
+/**
+ * Create an IAesCipher class using a specific implementation.
+ * This is mostly useful for testing and benchmarking.
+ * @param impl Implementation.
+ * @return IAesCipher class, or nullptr if the implementation isn't available.
+ */
+IAesCipher *AesCipherFactory::create(Implementation impl)
+{
+	switch (impl) {
+		case AES_IMPL_DEFAULT:
+#ifdef HAVE_AES_NI
+			// Use AES-NI if the CPU supports it.
+			// It's significantly faster than the system libraries.
+			if (AesNI::isUsable()) {
+				return new AesNI();
+			}
+#endif /* HAVE_AES_NI */
+			break;
+
+		case AES_IMPL_SYSTEM:
+			break;
+
+		case AES_IMPL_AESNI:
+#ifdef HAVE_AES_NI
+			if (AesNI::isUsable()) {
+				return new AesNI();
+			}
+#endif /* HAVE_AES_NI */
+			return nullptr;
+
+		default:
+			return nullptr;
+	}
+
 #if defined(_WIN32)
 	// Windows: Use CryptoAPI NG if available.
 	// If not, fall back to CryptoAPI.
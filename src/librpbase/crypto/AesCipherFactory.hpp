@@ -46,6 +46,21 @@ class AesCipherFactory
 		 * @return IAesCipher class, or nullptr if decryption isn't supported
 		 */
 		static IAesCipher *create(void);
+
+		// IAesCipher implementations.
+		enum Implementation {
+			AES_IMPL_DEFAULT,	// Best available implementation.
+			AES_IMPL_SYSTEM,	// System library. (CryptoAPI, GNU Nettle)
+			AES_IMPL_AESNI,		// AES-NI (x86 only)
+		};
+
+		/**
+		 * Create an IAesCipher class using a specific implementation.
+		 * This is mostly useful for testing and benchmarking.
+		 * @param impl Implementation.
+		 * @return IAesCipher class, or nullptr if the implementation isn't available.
+		 */
+		static IAesCipher *create(Implementation impl);
 };
 
 }
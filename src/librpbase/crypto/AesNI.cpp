@@ -0,0 +1,541 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI.cpp: AES decryption class using AES-NI.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "librpbase/config.librpbase.h"
+
+#include "AesNI.hpp"
+#include "../byteswap.h"
+#include "../cpuflags_x86.h"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// AES-NI intrinsics.
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// AES block size, in bytes.
+#define AES_BLOCK_SIZE 16
+// Maximum number of round keys. (AES-256)
+#define AES_MAX_ROUND_KEYS 15
+
+// Number of blocks to process in parallel.
+// AESDEC has a latency of several cycles, but it's pipelined,
+// so interleaving independent blocks hides most of the latency.
+// CBC decryption and CTR don't have dependencies between blocks.
+#define AES_PARALLEL_BLOCKS 8
+
+// Apply an AES round to AES_PARALLEL_BLOCKS blocks.
+// NOTE: This is unrolled manually so the compiler
+// keeps all of the blocks in registers.
+#define AES_ROUND_X8(op, b, k) do { \
+	(b)[0] = op((b)[0], (k)); \
+	(b)[1] = op((b)[1], (k)); \
+	(b)[2] = op((b)[2], (k)); \
+	(b)[3] = op((b)[3], (k)); \
+	(b)[4] = op((b)[4], (k)); \
+	(b)[5] = op((b)[5], (k)); \
+	(b)[6] = op((b)[6], (k)); \
+	(b)[7] = op((b)[7], (k)); \
+} while (0)
+
+namespace LibRpBase {
+
+class AesNIPrivate
+{
+	public:
+		AesNIPrivate();
+		~AesNIPrivate() { }
+
+	private:
+		RP_DISABLE_COPY(AesNIPrivate)
+
+	public:
+		// Round keys.
+		// NOTE: Stored as bytes, since `new` doesn't guarantee
+		// 16-byte alignment on all systems. The keys are loaded
+		// into registers before decrypting.
+		uint8_t ek[AES_MAX_ROUND_KEYS][AES_BLOCK_SIZE];	// Encryption (CTR)
+		uint8_t dk[AES_MAX_ROUND_KEYS][AES_BLOCK_SIZE];	// Decryption (ECB, CBC)
+		unsigned int rounds;	// Number of rounds. (0 if no key is set)
+
+		// CBC: Initialization vector.
+		// CTR: Counter.
+		uint8_t iv[AES_BLOCK_SIZE];
+
+		IAesCipher::ChainingMode chainingMode;
+
+		/**
+		 * Apply the AES S-box to each byte of a word.
+		 * @param w Word.
+		 * @return SubWord(w)
+		 */
+		static inline uint32_t subWord(uint32_t w);
+
+		/**
+		 * Expand the key into the round keys.
+		 * @param key Key data.
+		 * @param len Key length, in bytes. (16, 24, or 32)
+		 */
+		void expandKey(const uint8_t *key, unsigned int len);
+
+		/**
+		 * Load round keys into registers.
+		 * @param k	[out] Registers. (rounds + 1)
+		 * @param keys	[in] Round keys.
+		 */
+		inline void loadKeys(__m128i *k, const uint8_t keys[][AES_BLOCK_SIZE]) const;
+
+		/**
+		 * Decrypt data in ECB mode.
+		 * @param data Data.
+		 * @param blocks Number of blocks.
+		 */
+		void ecb_decrypt(uint8_t *data, size_t blocks) const;
+
+		/**
+		 * Decrypt data in CBC mode.
+		 * The IV is updated for the next block.
+		 * @param data Data.
+		 * @param blocks Number of blocks.
+		 */
+		void cbc_decrypt(uint8_t *data, size_t blocks);
+
+		/**
+		 * Encrypt/decrypt data in CTR mode.
+		 * The counter is updated for the next block.
+		 * @param data Data.
+		 * @param blocks Number of blocks.
+		 */
+		void ctr_crypt(uint8_t *data, size_t blocks);
+};
+
+/** AesNIPrivate **/
+
+AesNIPrivate::AesNIPrivate()
+	: rounds(0)
+	, chainingMode(IAesCipher::CM_ECB)
+{
+	// Clear the keys.
+	memset(ek, 0, sizeof(ek));
+	memset(dk, 0, sizeof(dk));
+	memset(iv, 0, sizeof(iv));
+}
+
+/**
+ * Apply the AES S-box to each byte of a word.
+ * @param w Word.
+ * @return SubWord(w)
+ */
+inline uint32_t AesNIPrivate::subWord(uint32_t w)
+{
+	// AESKEYGENASSIST returns SubWord(X1) in dword 0.
+	const __m128i x = _mm_shuffle_epi32(_mm_cvtsi32_si128((int)w), 0x00);
+	return (uint32_t)_mm_cvtsi128_si32(_mm_aeskeygenassist_si128(x, 0));
+}
+
+/**
+ * Expand the key into the round keys.
+ * @param key Key data.
+ * @param len Key length, in bytes. (16, 24, or 32)
+ */
+void AesNIPrivate::expandKey(const uint8_t *key, unsigned int len)
+{
+	// FIPS-197 key expansion.
+	// AESKEYGENASSIST requires an immediate round constant,
+	// so it's only used for SubWord(), which works for all
+	// three key sizes.
+	// NOTE: Words are little-endian, so RotWord() is a right rotation.
+	const unsigned int nk = len / 4;
+	rounds = nk + 6;
+
+	uint32_t w[AES_MAX_ROUND_KEYS * 4];
+	memcpy(w, key, len);
+	uint32_t rcon = 0x01;
+	for (unsigned int i = nk; i < (rounds + 1) * 4; i++) {
+		uint32_t t = w[i - 1];
+		if (i % nk == 0) {
+			t = subWord((t >> 8) | (t << 24)) ^ rcon;
+			rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x11B : 0);
+		} else if (nk > 6 && i % nk == 4) {
+			t = subWord(t);
+		}
+		w[i] = w[i - nk] ^ t;
+	}
+	memcpy(ek, w, (rounds + 1) * AES_BLOCK_SIZE);
+
+	// Decryption keys for the equivalent inverse cipher:
+	// reverse order, with InvMixColumns applied to the
+	// inner round keys.
+	memcpy(dk[0], ek[rounds], AES_BLOCK_SIZE);
+	for (unsigned int i = 1; i < rounds; i++) {
+		const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ek[rounds - i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dk[i]), _mm_aesimc_si128(k));
+	}
+	memcpy(dk[rounds], ek[0], AES_BLOCK_SIZE);
+}
+
+/**
+ * Load round keys into registers.
+ * @param k	[out] Registers. (rounds + 1)
+ * @param keys	[in] Round keys.
+ */
+inline void AesNIPrivate::loadKeys(__m128i *k, const uint8_t keys[][AES_BLOCK_SIZE]) const
+{
+	for (unsigned int r = 0; r <= rounds; r++) {
+		k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[r]));
+	}
+}
+
+/**
+ * Decrypt data in ECB mode.
+ * @param data Data.
+ * @param blocks Number of blocks.
+ */
+void AesNIPrivate::ecb_decrypt(uint8_t *data, size_t blocks) const
+{
+	__m128i k[AES_MAX_ROUND_KEYS];
+	loadKeys(k, dk);
+
+	__m128i *p = reinterpret_cast<__m128i*>(data);
+	for (; blocks >= AES_PARALLEL_BLOCKS; blocks -= AES_PARALLEL_BLOCKS, p += AES_PARALLEL_BLOCKS) {
+		__m128i b[AES_PARALLEL_BLOCKS];
+		for (unsigned int i = 0; i < AES_PARALLEL_BLOCKS; i++) {
+			b[i] = _mm_xor_si128(_mm_loadu_si128(&p[i]), k[0]);
+		}
+		for (unsigned int r = 1; r < rounds; r++) {
+			AES_ROUND_X8(_mm_aesdec_si128, b, k[r]);
+		}
+		AES_ROUND_X8(_mm_aesdeclast_si128, b, k[rounds]);
+		for (unsigned int i = 0; i < AES_PARALLEL_BLOCKS; i++) {
+			_mm_storeu_si128(&p[i], b[i]);
+		}
+	}
+
+	// Remaining blocks.
+	for (; blocks > 0; blocks--, p++) {
+		__m128i b = _mm_xor_si128(_mm_loadu_si128(p), k[0]);
+		for (unsigned int r = 1; r < rounds; r++) {
+			b = _mm_aesdec_si128(b, k[r]);
+		}
+		_mm_storeu_si128(p, _mm_aesdeclast_si128(b, k[rounds]));
+	}
+}
+
+/**
+ * Decrypt data in CBC mode.
+ * The IV is updated for the next block.
+ * @param data Data.
+ * @param blocks Number of blocks.
+ */
+void AesNIPrivate::cbc_decrypt(uint8_t *data, size_t blocks)
+{
+#ifdef HAVE_VAES
+	if (blocks >= 16 && RP_CPU_HasVAES() && RP_CPU_HasAVX2()) {
+		// Process as much as possible using VAES.
+		const size_t done = AesNI::cbc_decrypt_vaes(dk[0], rounds, iv, data, blocks);
+		data += done * AES_BLOCK_SIZE;
+		blocks -= done;
+	}
+#endif /* HAVE_VAES */
+
+	__m128i k[AES_MAX_ROUND_KEYS];
+	loadKeys(k, dk);
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+	__m128i *p = reinterpret_cast<__m128i*>(data);
+	for (; blocks >= AES_PARALLEL_BLOCKS; blocks -= AES_PARALLEL_BLOCKS, p += AES_PARALLEL_BLOCKS) {
+		__m128i b[AES_PARALLEL_BLOCKS];
+		for (unsigned int i = 0; i < AES_PARALLEL_BLOCKS; i++) {
+			b[i] = _mm_xor_si128(_mm_loadu_si128(&p[i]), k[0]);
+		}
+		for (unsigned int r = 1; r < rounds; r++) {
+			AES_ROUND_X8(_mm_aesdec_si128, b, k[r]);
+		}
+		AES_ROUND_X8(_mm_aesdeclast_si128, b, k[rounds]);
+
+		// Each plaintext block is XORed with the previous ciphertext block.
+		// The ciphertext is reloaded from memory, since it's not
+		// overwritten until the block after it is stored.
+		const __m128i next_prev = _mm_loadu_si128(&p[AES_PARALLEL_BLOCKS - 1]);
+		for (unsigned int i = AES_PARALLEL_BLOCKS - 1; i > 0; i--) {
+			_mm_storeu_si128(&p[i], _mm_xor_si128(b[i], _mm_loadu_si128(&p[i - 1])));
+		}
+		_mm_storeu_si128(&p[0], _mm_xor_si128(b[0], prev));
+		prev = next_prev;
+	}
+
+	// Remaining blocks.
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i c = _mm_loadu_si128(p);
+		__m128i b = _mm_xor_si128(c, k[0]);
+		for (unsigned int r = 1; r < rounds; r++) {
+			b = _mm_aesdec_si128(b, k[r]);
+		}
+		_mm_storeu_si128(p, _mm_xor_si128(_mm_aesdeclast_si128(b, k[rounds]), prev));
+		prev = c;
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+
+/**
+ * Encrypt/decrypt data in CTR mode.
+ * The counter is updated for the next block.
+ * @param data Data.
+ * @param blocks Number of blocks.
+ */
+void AesNIPrivate::ctr_crypt(uint8_t *data, size_t blocks)
+{
+#ifdef HAVE_VAES
+	if (blocks >= 16 && RP_CPU_HasVAES() && RP_CPU_HasAVX2()) {
+		// Process as much as possible using VAES.
+		const size_t done = AesNI::ctr_crypt_vaes(ek[0], rounds, iv, data, blocks);
+		data += done * AES_BLOCK_SIZE;
+		blocks -= done;
+	}
+#endif /* HAVE_VAES */
+
+	__m128i k[AES_MAX_ROUND_KEYS];
+	loadKeys(k, ek);
+
+	// The counter is a 128-bit big-endian integer.
+	uint64_t ctr[2];
+	memcpy(ctr, iv, sizeof(ctr));
+	uint64_t ctr_hi = be64_to_cpu(ctr[0]);
+	uint64_t ctr_lo = be64_to_cpu(ctr[1]);
+
+	__m128i *p = reinterpret_cast<__m128i*>(data);
+	while (blocks > 0) {
+		// Generate the counter blocks.
+		// If there are fewer than AES_PARALLEL_BLOCKS blocks left,
+		// the extra keystream blocks are discarded.
+		// NOTE: The counter blocks are built in registers. Storing
+		// them to memory and reloading them causes store forwarding
+		// stalls, which are slower than the AES rounds.
+		__m128i b[AES_PARALLEL_BLOCKS];
+		for (unsigned int i = 0; i < AES_PARALLEL_BLOCKS; i++) {
+			b[i] = _mm_xor_si128(_mm_set_epi64x(
+				(long long)cpu_to_be64(ctr_lo), (long long)cpu_to_be64(ctr_hi)), k[0]);
+			if (++ctr_lo == 0) {
+				ctr_hi++;
+			}
+		}
+		for (unsigned int r = 1; r < rounds; r++) {
+			AES_ROUND_X8(_mm_aesenc_si128, b, k[r]);
+		}
+		AES_ROUND_X8(_mm_aesenclast_si128, b, k[rounds]);
+
+		const unsigned int n = (blocks >= AES_PARALLEL_BLOCKS
+			? AES_PARALLEL_BLOCKS : (unsigned int)blocks);
+		for (unsigned int i = 0; i < n; i++) {
+			_mm_storeu_si128(&p[i], _mm_xor_si128(_mm_loadu_si128(&p[i]), b[i]));
+		}
+		if (n < AES_PARALLEL_BLOCKS) {
+			// Rewind the counter to the first unused block.
+			const uint64_t unused = AES_PARALLEL_BLOCKS - n;
+			if (ctr_lo < unused) {
+				ctr_hi--;
+			}
+			ctr_lo -= unused;
+		}
+		p += n;
+		blocks -= n;
+	}
+
+	ctr[0] = cpu_to_be64(ctr_hi);
+	ctr[1] = cpu_to_be64(ctr_lo);
+	memcpy(iv, ctr, sizeof(ctr));
+}
+
+/** AesNI **/
+
+AesNI::AesNI()
+	: d_ptr(new AesNIPrivate())
+{ }
+
+AesNI::~AesNI()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is AES-NI usable on this system?
+ * @return True if the CPU supports AES-NI.
+ */
+bool AesNI::isUsable(void)
+{
+	return (RP_CPU_HasSSE2() && RP_CPU_HasAES());
+}
+
+/**
+ * Get the name of the AesCipher implementation.
+ * @return Name.
+ */
+const char *AesNI::name(void) const
+{
+#ifdef HAVE_VAES
+	if (RP_CPU_HasVAES() && RP_CPU_HasAVX2()) {
+		return "AES-NI (VAES)";
+	}
+#endif /* HAVE_VAES */
+	return "AES-NI";
+}
+
+/**
+ * Has the cipher been initialized properly?
+ * @return True if initialized; false if not.
+ */
+bool AesNI::isInit(void) const
+{
+	// The CPU must support AES-NI.
+	return isUsable();
+}
+
+/**
+ * Set the encryption key.
+ * @param key Key data.
+ * @param len Key length, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setKey(const uint8_t *RESTRICT key, unsigned int len)
+{
+	// Acceptable key lengths:
+	// - 16 (AES-128)
+	// - 24 (AES-192)
+	// - 32 (AES-256)
+	if (!key || !(len == 16 || len == 24 || len == 32)) {
+		return -EINVAL;
+	} else if (!isUsable()) {
+		return -ENOTSUP;
+	}
+
+	RP_D(AesNI);
+	d->expandKey(key, len);
+	return 0;
+}
+
+/**
+ * Set the cipher chaining mode.
+ *
+ * Note that the IV/counter must be set *after* setting
+ * the chaining mode; otherwise, setIV() will fail.
+ *
+ * @param mode Cipher chaining mode.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setChainingMode(ChainingMode mode)
+{
+	if (mode < CM_ECB || mode > CM_CTR) {
+		return -EINVAL;
+	}
+
+	RP_D(AesNI);
+	d->chainingMode = mode;
+	return 0;
+}
+
+/**
+ * Set the IV (CBC mode) or counter (CTR mode).
+ * @param iv IV/counter data.
+ * @param len IV/counter length, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setIV(const uint8_t *RESTRICT iv, unsigned int len)
+{
+	RP_D(AesNI);
+	if (!iv || len != AES_BLOCK_SIZE ||
+	    d->chainingMode < CM_CBC || d->chainingMode > CM_CTR)
+	{
+		// Invalid parameters and/or chaining mode.
+		return -EINVAL;
+	}
+
+	// Set the IV/counter.
+	memcpy(d->iv, iv, AES_BLOCK_SIZE);
+	return 0;
+}
+
+/**
+ * Decrypt a block of data.
+ * @param data Data block.
+ * @param data_len Length of data block.
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+unsigned int AesNI::decrypt(uint8_t *RESTRICT data, unsigned int data_len)
+{
+	if (!data || data_len == 0 || (data_len % AES_BLOCK_SIZE != 0)) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	RP_D(AesNI);
+	if (d->rounds == 0) {
+		// No key set...
+		return 0;
+	}
+
+	// Decrypt the data.
+	const size_t blocks = data_len / AES_BLOCK_SIZE;
+	switch (d->chainingMode) {
+		case CM_ECB:
+			d->ecb_decrypt(data, blocks);
+			break;
+		case CM_CBC:
+			d->cbc_decrypt(data, blocks);
+			break;
+		case CM_CTR:
+			d->ctr_crypt(data, blocks);
+			break;
+		default:
+			return 0;
+	}
+
+	return data_len;
+}
+
+/**
+ * Decrypt a block of data using the specified IV (CBC mode) or counter (CTR mode).
+ * @param data Data block.
+ * @param data_len Length of data block.
+ * @param iv IV/counter for the data block.
+ * @param iv_len Length of the IV/counter.
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+unsigned int AesNI::decrypt(uint8_t *RESTRICT data, unsigned int data_len,
+	const uint8_t *RESTRICT iv, unsigned int iv_len)
+{
+	if (!data || data_len == 0 || (data_len % AES_BLOCK_SIZE != 0) ||
+	    !iv || iv_len != AES_BLOCK_SIZE) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	// Set the IV.
+	RP_D(AesNI);
+	memcpy(d->iv, iv, AES_BLOCK_SIZE);
+
+	// Use the regular decrypt() function.
+	return decrypt(data, data_len);
+}
+
+}
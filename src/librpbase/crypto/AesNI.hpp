@@ -0,0 +1,143 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI.hpp: AES decryption class using AES-NI.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_AESNI_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_AESNI_HPP__
+
+#include "IAesCipher.hpp"
+
+// C includes.
+#include <stddef.h>
+
+namespace LibRpBase {
+
+class AesNIPrivate;
+class AesNI : public IAesCipher
+{
+	public:
+		AesNI();
+		virtual ~AesNI();
+
+	private:
+		typedef IAesCipher super;
+		RP_DISABLE_COPY(AesNI)
+	private:
+		friend class AesNIPrivate;
+		AesNIPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is AES-NI usable on this system?
+		 * @return True if the CPU supports AES-NI.
+		 */
+		static bool isUsable(void);
+
+		/**
+		 * Get the name of the AesCipher implementation.
+		 * @return Name.
+		 */
+		virtual const char *name(void) const override final;
+
+		/**
+		 * Has the cipher been initialized properly?
+		 * @return True if initialized; false if not.
+		 */
+		virtual bool isInit(void) const override final;
+
+		/**
+		 * Set the encryption key.
+		 * @param key Key data.
+		 * @param len Key length, in bytes.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int setKey(const uint8_t *RESTRICT key, unsigned int len) override final;
+
+		/**
+		 * Set the cipher chaining mode.
+		 *
+		 * Note that the IV/counter must be set *after* setting
+		 * the chaining mode; otherwise, setIV() will fail.
+		 *
+		 * @param mode Cipher chaining mode.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int setChainingMode(ChainingMode mode) override final;
+
+		/**
+		 * Set the IV (CBC mode) or counter (CTR mode).
+		 * @param iv IV/counter data.
+		 * @param len IV/counter length, in bytes.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int setIV(const uint8_t *RESTRICT iv, unsigned int len) override final;
+
+		/**
+		 * Decrypt a block of data.
+		 * @param data Data block.
+		 * @param data_len Length of data block.
+		 * @return Number of bytes decrypted on success; 0 on error.
+		 */
+		virtual unsigned int decrypt(uint8_t *RESTRICT data, unsigned int data_len) override final;
+
+		/**
+		 * Decrypt a block of data using the specified IV (CBC mode) or counter (CTR mode).
+		 * @param data Data block.
+		 * @param data_len Length of data block.
+		 * @param iv IV/counter for the data block.
+		 * @param iv_len Length of the IV/counter.
+		 * @return Number of bytes decrypted on success; 0 on error.
+		 */
+		virtual unsigned int decrypt(uint8_t *RESTRICT data, unsigned int data_len,
+			const uint8_t *RESTRICT iv, unsigned int iv_len) override final;
+
+#ifdef HAVE_VAES
+	private:
+		/**
+		 * Decrypt data in CBC mode.
+		 * VAES version. Only full 16-block chunks are processed.
+		 * @param dk	[in] Decryption round keys. ((rounds + 1) * 16 bytes)
+		 * @param rounds [in] Number of rounds.
+		 * @param iv	[in/out] IV. (updated for the next block)
+		 * @param data	[in/out] Data.
+		 * @param blocks [in] Number of blocks.
+		 * @return Number of blocks decrypted.
+		 */
+		static size_t cbc_decrypt_vaes(const uint8_t *dk, unsigned int rounds,
+			uint8_t *iv, uint8_t *data, size_t blocks);
+
+		/**
+		 * Encrypt/decrypt data in CTR mode.
+		 * VAES version. Only full 16-block chunks are processed.
+		 * @param ek	[in] Encryption round keys. ((rounds + 1) * 16 bytes)
+		 * @param rounds [in] Number of rounds.
+		 * @param ctr	[in/out] Counter. (big-endian; updated for the next block)
+		 * @param data	[in/out] Data.
+		 * @param blocks [in] Number of blocks.
+		 * @return Number of blocks processed.
+		 */
+		static size_t ctr_crypt_vaes(const uint8_t *ek, unsigned int rounds,
+			uint8_t *ctr, uint8_t *data, size_t blocks);
+#endif /* HAVE_VAES */
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_AESNI_HPP__ */
@@ -0,0 +1,202 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI_vaes.cpp: AES decryption class using AES-NI. (VAES)               *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "AesNI.hpp"
+#include "../byteswap.h"
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+// AVX2 and VAES intrinsics.
+#include <immintrin.h>
+
+// AES block size, in bytes.
+#define AES_BLOCK_SIZE 16
+// Maximum number of round keys. (AES-256)
+#define AES_MAX_ROUND_KEYS 15
+
+// Number of 256-bit registers to process in parallel.
+// Each register has two blocks.
+#define VAES_PARALLEL_REGS 8
+#define VAES_PARALLEL_BLOCKS (VAES_PARALLEL_REGS * 2)
+
+// Apply an AES round to VAES_PARALLEL_REGS registers.
+// NOTE: This is unrolled manually so the compiler
+// keeps all of the blocks in registers.
+#define VAES_ROUND_X8(op, b, k) do { \
+	(b)[0] = op((b)[0], (k)); \
+	(b)[1] = op((b)[1], (k)); \
+	(b)[2] = op((b)[2], (k)); \
+	(b)[3] = op((b)[3], (k)); \
+	(b)[4] = op((b)[4], (k)); \
+	(b)[5] = op((b)[5], (k)); \
+	(b)[6] = op((b)[6], (k)); \
+	(b)[7] = op((b)[7], (k)); \
+} while (0)
+
+namespace LibRpBase {
+
+/**
+ * Load round keys into registers.
+ * Each round key is copied to both 128-bit lanes.
+ * @param k	[out] Registers. (rounds + 1)
+ * @param keys	[in] Round keys.
+ * @param rounds [in] Number of rounds.
+ */
+static inline void loadKeys_vaes(__m256i *k, const uint8_t *keys, unsigned int rounds)
+{
+	for (unsigned int r = 0; r <= rounds; r++) {
+		k[r] = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(&keys[r * AES_BLOCK_SIZE])));
+	}
+}
+
+/**
+ * Decrypt data in CBC mode.
+ * VAES version. Only full 16-block chunks are processed.
+ * @param dk	[in] Decryption round keys. ((rounds + 1) * 16 bytes)
+ * @param rounds [in] Number of rounds.
+ * @param iv	[in/out] IV. (updated for the next block)
+ * @param data	[in/out] Data.
+ * @param blocks [in] Number of blocks.
+ * @return Number of blocks decrypted.
+ */
+size_t AesNI::cbc_decrypt_vaes(const uint8_t *dk, unsigned int rounds,
+	uint8_t *iv, uint8_t *data, size_t blocks)
+{
+	__m256i k[AES_MAX_ROUND_KEYS];
+	loadKeys_vaes(k, dk, rounds);
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+	size_t done = 0;
+	for (; blocks - done >= VAES_PARALLEL_BLOCKS; done += VAES_PARALLEL_BLOCKS) {
+		uint8_t *const p = &data[done * AES_BLOCK_SIZE];
+		__m256i b[VAES_PARALLEL_REGS];
+		for (unsigned int i = 0; i < VAES_PARALLEL_REGS; i++) {
+			b[i] = _mm256_xor_si256(_mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(&p[i * 32])), k[0]);
+		}
+		for (unsigned int r = 1; r < rounds; r++) {
+			VAES_ROUND_X8(_mm256_aesdec_epi128, b, k[r]);
+		}
+		VAES_ROUND_X8(_mm256_aesdeclast_epi128, b, k[rounds]);
+
+		// Each plaintext block is XORed with the previous ciphertext block.
+		// For register i, that's the unaligned pair starting one block
+		// earlier, which must be loaded before register i-1 is stored.
+		const __m128i next_prev = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(&p[(VAES_PARALLEL_BLOCKS - 1) * AES_BLOCK_SIZE]));
+		__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(prev),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), 1);
+		for (unsigned int i = 0; i < VAES_PARALLEL_REGS; i++) {
+			__m256i x_next = x;
+			if (i + 1 < VAES_PARALLEL_REGS) {
+				x_next = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(&p[(i + 1) * 32 - AES_BLOCK_SIZE]));
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&p[i * 32]),
+				_mm256_xor_si256(b[i], x));
+			x = x_next;
+		}
+		prev = next_prev;
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+	return done;
+}
+
+/**
+ * Encrypt/decrypt data in CTR mode.
+ * VAES version. Only full 16-block chunks are processed.
+ * @param ek	[in] Encryption round keys. ((rounds + 1) * 16 bytes)
+ * @param rounds [in] Number of rounds.
+ * @param ctr	[in/out] Counter. (big-endian; updated for the next block)
+ * @param data	[in/out] Data.
+ * @param blocks [in] Number of blocks.
+ * @return Number of blocks processed.
+ */
+size_t AesNI::ctr_crypt_vaes(const uint8_t *ek, unsigned int rounds,
+	uint8_t *ctr, uint8_t *data, size_t blocks)
+{
+	__m256i k[AES_MAX_ROUND_KEYS];
+	loadKeys_vaes(k, ek, rounds);
+
+	// The counter is a 128-bit big-endian integer.
+	uint64_t ctrbuf[VAES_PARALLEL_BLOCKS * 2];
+	memcpy(ctrbuf, ctr, AES_BLOCK_SIZE);
+	uint64_t ctr_hi = be64_to_cpu(ctrbuf[0]);
+	uint64_t ctr_lo = be64_to_cpu(ctrbuf[1]);
+
+	// Reverse the bytes in each 128-bit lane.
+	const __m256i bswap128 = _mm256_set_epi8(
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	// Each register has two consecutive counters.
+	const __m256i two = _mm256_set_epi64x(0, 2, 0, 2);
+
+	size_t done = 0;
+	for (; blocks - done >= VAES_PARALLEL_BLOCKS; done += VAES_PARALLEL_BLOCKS) {
+		uint8_t *const p = &data[done * AES_BLOCK_SIZE];
+
+		// Generate the counter blocks.
+		__m256i b[VAES_PARALLEL_REGS];
+		if (ctr_lo <= ~0ULL - VAES_PARALLEL_BLOCKS) {
+			// The low 64 bits won't carry, so the counters can be
+			// incremented in registers in host byte order, then
+			// byteswapped to big-endian.
+			__m256i cur = _mm256_set_epi64x((long long)ctr_hi, (long long)(ctr_lo + 1),
+							(long long)ctr_hi, (long long)ctr_lo);
+			for (unsigned int i = 0; i < VAES_PARALLEL_REGS; i++) {
+				b[i] = _mm256_xor_si256(_mm256_shuffle_epi8(cur, bswap128), k[0]);
+				cur = _mm256_add_epi64(cur, two);
+			}
+			ctr_lo += VAES_PARALLEL_BLOCKS;
+		} else {
+			// The low 64 bits will carry.
+			for (unsigned int i = 0; i < VAES_PARALLEL_BLOCKS; i++) {
+				ctrbuf[i * 2] = cpu_to_be64(ctr_hi);
+				ctrbuf[i * 2 + 1] = cpu_to_be64(ctr_lo);
+				if (++ctr_lo == 0) {
+					ctr_hi++;
+				}
+			}
+			for (unsigned int i = 0; i < VAES_PARALLEL_REGS; i++) {
+				b[i] = _mm256_xor_si256(_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(&ctrbuf[i * 4])), k[0]);
+			}
+		}
+		for (unsigned int r = 1; r < rounds; r++) {
+			VAES_ROUND_X8(_mm256_aesenc_epi128, b, k[r]);
+		}
+		VAES_ROUND_X8(_mm256_aesenclast_epi128, b, k[rounds]);
+		for (unsigned int i = 0; i < VAES_PARALLEL_REGS; i++) {
+			__m256i *const pv = reinterpret_cast<__m256i*>(&p[i * 32]);
+			_mm256_storeu_si256(pv, _mm256_xor_si256(_mm256_loadu_si256(pv), b[i]));
+		}
+	}
+
+	ctrbuf[0] = cpu_to_be64(ctr_hi);
+	ctrbuf[1] = cpu_to_be64(ctr_lo);
+	memcpy(ctr, ctrbuf, AES_BLOCK_SIZE);
+	return done;
+}
+
+}
@@ -0,0 +1,251 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha1.cpp: SHA-1 hash class.                                             *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "Sha1.hpp"
+#include "../byteswap.h"
+
+#ifdef HAVE_SHA_NI
+# include "../cpuflags_x86.h"
+#endif /* HAVE_SHA_NI */
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+namespace LibRpBase {
+
+// Initial SHA-1 state.
+static const uint32_t sha1_init_state[5] = {
+	0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+};
+
+/**
+ * Create a SHA-1 hash object.
+ * If the requested implementation isn't supported,
+ * the standard C++ implementation will be used.
+ * @param impl Implementation.
+ */
+Sha1::Sha1(Implementation impl)
+	: m_transform(transform_cpp)
+{
+#ifdef HAVE_SHA_NI
+	if ((impl == IMPL_DEFAULT || impl == IMPL_SHANI) && isImplSupported(IMPL_SHANI)) {
+		m_transform = transform_shani;
+	}
+#else /* !HAVE_SHA_NI */
+	RP_UNUSED(impl);
+#endif /* HAVE_SHA_NI */
+	reset();
+}
+
+/**
+ * Reset the hash state.
+ */
+void Sha1::reset(void)
+{
+	memcpy(m_state, sha1_init_state, sizeof(m_state));
+	m_length = 0;
+	m_bufLen = 0;
+}
+
+/**
+ * Add data to the hash.
+ * @param data Data.
+ * @param len Length of data, in bytes.
+ */
+void Sha1::update(const void *data, size_t len)
+{
+	const uint8_t *data8 = static_cast<const uint8_t*>(data);
+	m_length += len;
+
+	if (m_bufLen > 0) {
+		// Fill the partial block first.
+		size_t sz = BLOCK_SIZE - m_bufLen;
+		if (sz > len) {
+			sz = len;
+		}
+		memcpy(&m_buf[m_bufLen], data8, sz);
+		m_bufLen += (unsigned int)sz;
+		data8 += sz;
+		len -= sz;
+
+		if (m_bufLen < BLOCK_SIZE) {
+			// Block is still incomplete.
+			return;
+		}
+		m_transform(m_state, m_buf, 1);
+		m_bufLen = 0;
+	}
+
+	// Process full blocks directly from the source data.
+	const size_t blocks = len / BLOCK_SIZE;
+	if (blocks > 0) {
+		m_transform(m_state, data8, blocks);
+		data8 += blocks * BLOCK_SIZE;
+		len -= blocks * BLOCK_SIZE;
+	}
+
+	// Save the remaining data.
+	if (len > 0) {
+		memcpy(m_buf, data8, len);
+		m_bufLen = (unsigned int)len;
+	}
+}
+
+/**
+ * Finish the hash and get the digest.
+ * The hash state is reset afterwards.
+ * @param digest Output buffer. (DIGEST_SIZE bytes)
+ */
+void Sha1::final(uint8_t *digest)
+{
+	// Length, in bits. (big-endian)
+	const uint64_t bitLength = cpu_to_be64(m_length << 3);
+
+	// Padding: 0x80, zeroes, then the length.
+	m_buf[m_bufLen++] = 0x80;
+	if (m_bufLen > BLOCK_SIZE - 8) {
+		// Not enough room for the length.
+		memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - m_bufLen);
+		m_transform(m_state, m_buf, 1);
+		m_bufLen = 0;
+	}
+	memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - 8 - m_bufLen);
+	memcpy(&m_buf[BLOCK_SIZE - 8], &bitLength, 8);
+	m_transform(m_state, m_buf, 1);
+
+	// Save the digest. (big-endian)
+	for (unsigned int i = 0; i < 5; i++) {
+		const uint32_t s = cpu_to_be32(m_state[i]);
+		memcpy(&digest[i * 4], &s, 4);
+	}
+
+	reset();
+}
+
+/**
+ * Hash a block of data.
+ * @param data	[in] Data.
+ * @param len	[in] Length of data, in bytes.
+ * @param digest [out] Output buffer. (DIGEST_SIZE bytes)
+ */
+void Sha1::hash(const void *data, size_t len, uint8_t *digest)
+{
+	Sha1 sha1;
+	sha1.update(data, len);
+	sha1.final(digest);
+}
+
+/**
+ * Get the name of the SHA-1 implementation in use.
+ * @return Name.
+ */
+const char *Sha1::implName(void)
+{
+	if (isImplSupported(IMPL_SHANI)) {
+		return "SHA-NI";
+	}
+	return "C++";
+}
+
+/**
+ * Check if a SHA-1 implementation is supported on this system.
+ * @param impl Implementation.
+ * @return True if supported; false if not.
+ */
+bool Sha1::isImplSupported(Implementation impl)
+{
+	switch (impl) {
+		case IMPL_DEFAULT:
+		case IMPL_CPP:
+			return true;
+		case IMPL_SHANI:
+#ifdef HAVE_SHA_NI
+			return (RP_CPU_HasSHA() && RP_CPU_HasSSE41());
+#else /* !HAVE_SHA_NI */
+			return false;
+#endif /* HAVE_SHA_NI */
+		default:
+			break;
+	}
+	return false;
+}
+
+// SHA-1 round functions.
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define SHA1_F0(b,c,d) (((b) & (c)) | (~(b) & (d)))
+#define SHA1_F1(b,c,d) ((b) ^ (c) ^ (d))
+#define SHA1_F2(b,c,d) (((b) & (c)) | ((b) & (d)) | ((c) & (d)))
+#define SHA1_F3(b,c,d) ((b) ^ (c) ^ (d))
+
+/**
+ * Process 64-byte blocks.
+ * Standard version using regular C++ code.
+ * @param state SHA-1 state.
+ * @param data Data.
+ * @param blocks Number of blocks.
+ */
+void Sha1::transform_cpp(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+	uint32_t w[80];
+
+	for (; blocks > 0; blocks--, data += BLOCK_SIZE) {
+		// Load the message schedule. (big-endian)
+		for (unsigned int i = 0; i < 16; i++) {
+			uint32_t x;
+			memcpy(&x, &data[i * 4], 4);
+			w[i] = be32_to_cpu(x);
+		}
+		for (unsigned int i = 16; i < 80; i++) {
+			const uint32_t x = w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16];
+			w[i] = ROL32(x, 1);
+		}
+
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+
+#define SHA1_ROUND(f, k, i) do { \
+			const uint32_t t = ROL32(a, 5) + f(b,c,d) + e + (k) + w[i]; \
+			e = d; d = c; c = ROL32(b, 30); b = a; a = t; \
+		} while (0)
+
+		unsigned int i;
+		for (i = 0; i < 20; i++)
+			SHA1_ROUND(SHA1_F0, 0x5A827999, i);
+		for (; i < 40; i++)
+			SHA1_ROUND(SHA1_F1, 0x6ED9EBA1, i);
+		for (; i < 60; i++)
+			SHA1_ROUND(SHA1_F2, 0x8F1BBCDC, i);
+		for (; i < 80; i++)
+			SHA1_ROUND(SHA1_F3, 0xCA62C1D6, i);
+#undef SHA1_ROUND
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+}
+
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha1.hpp: SHA-1 hash class.                                             *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA1_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA1_HPP__
+
+#include "librpbase/config.librpbase.h"
+#include "../common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase {
+
+/**
+ * SHA-1 hash class.
+ *
+ * Used for verifying hashes in disc images, e.g. the
+ * Wii partition hash tree. This is not a general-purpose
+ * cryptographic library; SHA-1 should not be used for
+ * anything security-related.
+ *
+ * On x86, the SHA extensions are used if available.
+ */
+class Sha1
+{
+	public:
+		enum Implementation {
+			IMPL_DEFAULT,	// Best available implementation.
+			IMPL_CPP,	// Standard C++ implementation.
+			IMPL_SHANI,	// x86 SHA extensions.
+		};
+
+		/**
+		 * Create a SHA-1 hash object.
+		 * If the requested implementation isn't supported,
+		 * the standard C++ implementation will be used.
+		 * @param impl Implementation.
+		 */
+		explicit Sha1(Implementation impl = IMPL_DEFAULT);
+
+	private:
+		RP_DISABLE_COPY(Sha1)
+
+	public:
+		// SHA-1 digest size, in bytes.
+		static const unsigned int DIGEST_SIZE = 20;
+		// SHA-1 block size, in bytes.
+		static const unsigned int BLOCK_SIZE = 64;
+
+		/**
+		 * Reset the hash state.
+		 */
+		void reset(void);
+
+		/**
+		 * Add data to the hash.
+		 * @param data Data.
+		 * @param len Length of data, in bytes.
+		 */
+		void update(const void *data, size_t len);
+
+		/**
+		 * Finish the hash and get the digest.
+		 * The hash state is reset afterwards.
+		 * @param digest Output buffer. (DIGEST_SIZE bytes)
+		 */
+		void final(uint8_t *digest);
+
+		/**
+		 * Hash a block of data.
+		 * @param data	[in] Data.
+		 * @param len	[in] Length of data, in bytes.
+		 * @param digest [out] Output buffer. (DIGEST_SIZE bytes)
+		 */
+		static void hash(const void *data, size_t len, uint8_t *digest);
+
+		/**
+		 * Get the name of the SHA-1 implementation in use.
+		 * @return Name.
+		 */
+		static const char *implName(void);
+
+		/**
+		 * Check if a SHA-1 implementation is supported on this system.
+		 * @param impl Implementation.
+		 * @return True if supported; false if not.
+		 */
+		static bool isImplSupported(Implementation impl);
+
+	private:
+		/**
+		 * Process 64-byte blocks.
+		 * Standard version using regular C++ code.
+		 * @param state SHA-1 state.
+		 * @param data Data.
+		 * @param blocks Number of blocks.
+		 */
+		static void transform_cpp(uint32_t state[5], const uint8_t *data, size_t blocks);
+
+#ifdef HAVE_SHA_NI
+		/**
+		 * Process 64-byte blocks.
+		 * x86 SHA extensions version.
+		 * @param state SHA-1 state.
+		 * @param data Data.
+		 * @param blocks Number of blocks.
+		 */
+		static void transform_shani(uint32_t state[5], const uint8_t *data, size_t blocks);
+#endif /* HAVE_SHA_NI */
+
+	private:
+		// Block transform function for the selected implementation.
+		typedef void (*pFnTransform)(uint32_t state[5], const uint8_t *data, size_t blocks);
+		pFnTransform m_transform;
+
+		uint32_t m_state[5];
+		uint64_t m_length;	// Total length, in bytes.
+		uint8_t m_buf[BLOCK_SIZE];
+		unsigned int m_bufLen;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA1_HPP__ */
@@ -0,0 +1,104 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha1_shani.cpp: SHA-1 hash class. (x86 SHA extensions version)          *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "Sha1.hpp"
+
+// SSSE3, SSE4.1, and SHA intrinsics.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Process 64-byte blocks.
+ * x86 SHA extensions version.
+ *
+ * Message words are kept in four registers, each holding
+ * four rounds' worth of the message schedule. Registers
+ * are reused as the schedule is extended.
+ *
+ * @param state SHA-1 state.
+ * @param data Data.
+ * @param blocks Number of blocks.
+ */
+void Sha1::transform_shani(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+	// Byteswap mask for big-endian message words.
+	const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+	// Load the state.
+	__m128i abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+	abcd = _mm_shuffle_epi32(abcd, 0x1B);
+	__m128i e[2];
+	e[0] = _mm_set_epi32(state[4], 0, 0, 0);
+
+	for (; blocks > 0; blocks--, data += BLOCK_SIZE) {
+		const __m128i abcd_save = abcd;
+		const __m128i e_save = e[0];
+		__m128i msg[4];
+
+		// Four rounds per step. Step i uses message words [4i, 4i+3],
+		// stored in msg[i & 3]. The schedule for step i+1 is completed
+		// (sha1msg2) in step i; it's started in steps i-2 and i-1.
+#define SHA1_STEP(i) do { \
+			if ((i) < 4) { \
+				msg[(i)] = _mm_shuffle_epi8(_mm_loadu_si128( \
+					reinterpret_cast<const __m128i*>(&data[(i) * 16])), MASK); \
+			} \
+			if ((i) == 0) { \
+				e[0] = _mm_add_epi32(e[0], msg[0]); \
+			} else { \
+				e[(i) & 1] = _mm_sha1nexte_epu32(e[(i) & 1], msg[(i) & 3]); \
+			} \
+			e[((i) + 1) & 1] = abcd; \
+			if ((i) >= 3 && (i) <= 18) { \
+				msg[((i) - 3) & 3] = _mm_sha1msg2_epu32(msg[((i) - 3) & 3], msg[(i) & 3]); \
+			} \
+			abcd = _mm_sha1rnds4_epu32(abcd, e[(i) & 1], (i) / 5); \
+			if ((i) >= 1 && (i) <= 16) { \
+				msg[((i) - 1) & 3] = _mm_sha1msg1_epu32(msg[((i) - 1) & 3], msg[(i) & 3]); \
+			} \
+			if ((i) >= 2 && (i) <= 17) { \
+				msg[((i) - 2) & 3] = _mm_xor_si128(msg[((i) - 2) & 3], msg[(i) & 3]); \
+			} \
+		} while (0)
+
+		SHA1_STEP(0);  SHA1_STEP(1);  SHA1_STEP(2);  SHA1_STEP(3);
+		SHA1_STEP(4);  SHA1_STEP(5);  SHA1_STEP(6);  SHA1_STEP(7);
+		SHA1_STEP(8);  SHA1_STEP(9);  SHA1_STEP(10); SHA1_STEP(11);
+		SHA1_STEP(12); SHA1_STEP(13); SHA1_STEP(14); SHA1_STEP(15);
+		SHA1_STEP(16); SHA1_STEP(17); SHA1_STEP(18); SHA1_STEP(19);
+#undef SHA1_STEP
+
+		// Add this block's hash to the state.
+		e[0] = _mm_sha1nexte_epu32(e[0], e_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	// Save the state.
+	abcd = _mm_shuffle_epi32(abcd, 0x1B);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), abcd);
+	state[4] = (uint32_t)_mm_extract_epi32(e[0], 3);
+}
+
+}
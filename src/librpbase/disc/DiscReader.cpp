@@ -28,6 +28,10 @@
 #include <cassert>
 #include <cerrno>
 
+// C++ includes.
+#include <vector>
+using std::vector;
+
 namespace LibRpBase {
 
 /**
@@ -225,4 +229,78 @@ int64_t DiscReader::size(void)
 	return m_length;
 }
 
+/**
+ * Read data from the specified position in the disc image.
+ * The request is forwarded to IRpFile::pread().
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t DiscReader::pread(int64_t pos, void *ptr, size_t size)
+{
+	assert(m_file != nullptr);
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Constrain size based on offset and length.
+	if (pos < 0 || pos >= m_length) {
+		return 0;
+	} else if ((int64_t)(pos + size) > m_length) {
+		size = (size_t)(m_length - pos);
+	}
+
+	size_t ret = m_file->pread(pos + m_offset, ptr, size);
+	if (ret != size) {
+		m_lastError = m_file->lastError();
+	}
+	return ret;
+}
+
+/**
+ * Read data from multiple locations in the disc image.
+ * The requests are forwarded to IRpFile::readv().
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int DiscReader::readv(IRpFile::ReadRequest *reqs, unsigned int count)
+{
+	assert(m_file != nullptr);
+	if (!m_file) {
+		m_lastError = EBADF;
+		for (unsigned int i = 0; i < count; i++) {
+			reqs[i].ret = 0;
+		}
+		return 0;
+	}
+
+	// Adjust the requests for the disc offset and length.
+	vector<IRpFile::ReadRequest> fileReqs(reqs, reqs + count);
+	for (unsigned int i = 0; i < count; i++) {
+		IRpFile::ReadRequest &req = fileReqs[i];
+		if (req.pos < 0 || req.pos >= m_length) {
+			// Out of range.
+			req.size = 0;
+		} else if ((int64_t)(req.pos + req.size) > m_length) {
+			req.size = (size_t)(m_length - req.pos);
+		}
+		req.pos += m_offset;
+	}
+
+	m_file->readv(fileReqs.data(), count);
+	m_lastError = m_file->lastError();
+
+	unsigned int complete = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		reqs[i].ret = fileReqs[i].ret;
+		if (reqs[i].ret == reqs[i].size) {
+			complete++;
+		}
+	}
+	return complete;
+}
+
 }
@@ -114,6 +114,25 @@ class DiscReader : public IDiscReader
 		 */
 		virtual int64_t size(void) override;
 
+		/**
+		 * Read data from the specified position in the disc image.
+		 * The request is forwarded to IRpFile::pread().
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override;
+
+		/**
+		 * Read data from multiple locations in the disc image.
+		 * The requests are forwarded to IRpFile::readv().
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(IRpFile::ReadRequest *reqs, unsigned int count) override;
+
 	protected:
 		IRpFile *m_file;
 
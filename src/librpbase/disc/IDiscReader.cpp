@@ -20,13 +20,25 @@
  ***************************************************************************/
 
 #include "IDiscReader.hpp"
+#include "../threads/Mutex.hpp"
 
 namespace LibRpBase {
 
 IDiscReader::IDiscReader()
 	: m_lastError(0)
+	, m_preadMutex(new Mutex())
 { }
 
+/**
+ * Both gcc and MSVC fail to compile unless we provide
+ * an implementation, even though the function is
+ * declared as pure-virtual.
+ */
+IDiscReader::~IDiscReader()
+{
+	delete m_preadMutex;
+}
+
 /**
  * Get the last error.
  * @return Last POSIX error, or 0 if no error.
@@ -61,4 +73,59 @@ size_t IDiscReader::seekAndRead(int64_t pos, void *ptr, size_t size)
 	return this->read(ptr, size);
 }
 
+/**
+ * Read data from the specified position in the disc image.
+ *
+ * Unlike seekAndRead(), this does not use the disc image
+ * position, so it's safe to call from multiple threads on
+ * the same disc image at the same time.
+ *
+ * The default implementation uses seek() and read() while
+ * holding a per-object mutex, and restores the disc image
+ * position afterwards. It's serialized against other
+ * pread() calls on this object, but not against read()
+ * calls from other threads.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IDiscReader::pread(int64_t pos, void *ptr, size_t size)
+{
+	MutexLocker preadLock(*m_preadMutex);
+
+	const int64_t prev_pos = this->tell();
+	size_t ret = seekAndRead(pos, ptr, size);
+	if (prev_pos >= 0) {
+		this->seek(prev_pos);
+	}
+	return ret;
+}
+
+/**
+ * Read data from multiple locations in the disc image.
+ *
+ * The default implementation calls seekAndRead()
+ * for each request. Subclasses that wrap an IRpFile
+ * directly may forward the requests to IRpFile::readv().
+ *
+ * NOTE: The disc image position is undefined afterwards.
+ *
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int IDiscReader::readv(IRpFile::ReadRequest *reqs, unsigned int count)
+{
+	unsigned int complete = 0;
+	for (; count > 0; reqs++, count--) {
+		reqs->ret = seekAndRead(reqs->pos, reqs->ptr, reqs->size);
+		if (reqs->ret == reqs->size) {
+			complete++;
+		}
+	}
+	return complete;
+}
+
 }
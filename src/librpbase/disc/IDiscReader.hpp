@@ -25,6 +25,9 @@
 #include "librpbase/config.librpbase.h"
 #include "librpbase/common.h"
 
+// IRpFile::ReadRequest
+#include "../file/IRpFile.hpp"
+
 // C includes.
 #include <stdint.h>
 
@@ -33,6 +36,8 @@
 
 namespace LibRpBase {
 
+class Mutex;
+
 class IDiscReader
 {
 	protected:
@@ -118,16 +123,48 @@ class IDiscReader
 		 */
 		size_t seekAndRead(int64_t pos, void *ptr, size_t size);
 
+		/**
+		 * Read data from the specified position in the disc image.
+		 *
+		 * Unlike seekAndRead(), this does not use the disc image
+		 * position, so it's safe to call from multiple threads on
+		 * the same disc image at the same time.
+		 *
+		 * The default implementation uses seek() and read() while
+		 * holding a per-object mutex, and restores the disc image
+		 * position afterwards. It's serialized against other
+		 * pread() calls on this object, but not against read()
+		 * calls from other threads.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Read data from multiple locations in the disc image.
+		 *
+		 * The default implementation calls seekAndRead()
+		 * for each request. Subclasses that wrap an IRpFile
+		 * directly may forward the requests to IRpFile::readv().
+		 *
+		 * NOTE: The disc image position is undefined afterwards.
+		 *
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(IRpFile::ReadRequest *reqs, unsigned int count);
+
 	protected:
 		int m_lastError;
-};
 
-/**
- * Both gcc and MSVC fail to compile unless we provide
- * an empty implementation, even though the function is
- * declared as pure-virtual.
- */
-inline IDiscReader::~IDiscReader() { }
+	private:
+		// Serializes the default pread() implementation.
+		Mutex *m_preadMutex;
+};
 
 }
 
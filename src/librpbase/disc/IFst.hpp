@@ -66,7 +66,8 @@ class IFst
 			int64_t offset;		// Starting address.
 			int64_t size;		// File size.
 			uint8_t type;		// File type. (See d_type.h)
-			const char *name;	// Filename.
+			const char *name;	// Filename. (UTF-8, NULL-terminated)
+			uint32_t name_len;	// Filename length, in bytes.
 
 			// TODO: Additional placeholders?
 			int idx;		// File index.
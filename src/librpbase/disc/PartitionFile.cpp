@@ -22,8 +22,13 @@
 #include "PartitionFile.hpp"
 #include "IDiscReader.hpp"
 
+// C includes.
+#include <stdlib.h>
+
 // C includes. (C++ namespace)
+#include <cassert>
 #include <cerrno>
+#include <cstring>
 
 // C++ includes.
 #include <string>
@@ -31,6 +36,13 @@ using std::string;
 
 namespace LibRpBase {
 
+// Read-ahead window sizes.
+// Buffer fills are aligned to READAHEAD_ALIGN, relative to the
+// start of the partition, so they line up with block boundaries.
+static const unsigned int READAHEAD_MIN = 4096;
+static const unsigned int READAHEAD_MAX = 64*1024;
+static const unsigned int READAHEAD_ALIGN = 4096;
+
 /**
  * Open a file from an IPartition.
  * NOTE: These files are read-only.
@@ -44,17 +56,25 @@ PartitionFile::PartitionFile(IDiscReader *partition, int64_t offset, int64_t siz
 	, m_offset(offset)
 	, m_size(size)
 	, m_pos(0)
+	, m_raBuf(nullptr)
+	, m_raPos(0)
+	, m_raLen(0)
+	, m_raWindow(READAHEAD_MIN)
+	, m_lastReadEnd(0)
 {
 	if (!partition) {
 		m_lastError = EBADF;
 	}
 
+	memset(&m_raStats, 0, sizeof(m_raStats));
+
 	// TODO: Reference counting?
 }
 
 PartitionFile::~PartitionFile()
 {
 	// TODO: Reference counting?
+	free(m_raBuf);
 }
 
 /**
@@ -67,9 +87,15 @@ PartitionFile::PartitionFile(const PartitionFile &other)
 	, m_offset(other.m_offset)
 	, m_size(other.m_size)
 	, m_pos(0)
+	, m_raBuf(nullptr)
+	, m_raPos(0)
+	, m_raLen(0)
+	, m_raWindow(READAHEAD_MIN)
+	, m_lastReadEnd(0)
 {
 	// TODO: Copy m_pos? (RpMemFile doesn't.)
 	// TODO: Reference counting?
+	memset(&m_raStats, 0, sizeof(m_raStats));
 }
 
 /**
@@ -85,6 +111,12 @@ PartitionFile &PartitionFile::operator=(const PartitionFile &other)
 	m_size = other.m_size;
 	m_pos = 0;
 
+	// Invalidate the read-ahead buffer.
+	m_raLen = 0;
+	m_raWindow = READAHEAD_MIN;
+	m_lastReadEnd = 0;
+	memset(&m_raStats, 0, sizeof(m_raStats));
+
 	m_lastError = (m_partition ? 0 : EBADF);
 	return *this;
 }
@@ -121,6 +153,11 @@ IRpFile *PartitionFile::dup(void)
 void PartitionFile::close(void)
 {
 	m_partition = nullptr;
+
+	// Free the read-ahead buffer.
+	free(m_raBuf);
+	m_raBuf = nullptr;
+	m_raLen = 0;
 }
 
 /**
@@ -136,28 +173,171 @@ size_t PartitionFile::read(void *ptr, size_t size)
 		return 0;
 	}
 
-	m_partition->clearError();
-	int iRet = m_partition->seek(m_offset + m_pos);
-	if (iRet != 0) {
-		m_lastError = m_partition->lastError();
+	// Check if pos and size are in bounds.
+	if (m_pos >= m_size || size == 0) {
 		return 0;
-	}
-
-	// Check if size is in bounds.
-	if (m_pos > (int64_t)(m_size - size)) {
+	} else if (m_pos > (int64_t)(m_size - size)) {
 		// Not enough data.
 		// Copy whatever's left in the file.
 		size = (size_t)(m_size - m_pos);
 	}
 
-	size_t ret = 0;
+	m_raStats.reads++;
+
+	// If the file position jumped, reset the read-ahead window.
+	const bool sequential = (m_pos == m_lastReadEnd);
+	if (!sequential) {
+		m_raWindow = READAHEAD_MIN;
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t total = 0;
+
+	// Copy whatever's available in the read-ahead buffer.
+	if (m_raLen > 0 && m_pos >= m_raPos && m_pos < m_raPos + m_raLen) {
+		size_t avail = (size_t)(m_raPos + m_raLen - m_pos);
+		if (avail > size) {
+			avail = size;
+		}
+		memcpy(ptr8, &m_raBuf[m_pos - m_raPos], avail);
+		ptr8 += avail;
+		size -= avail;
+		total += avail;
+		m_pos += avail;
+
+		if (size == 0) {
+			// Read request handled entirely by the buffer.
+			m_raStats.bufferHits++;
+			m_lastReadEnd = m_pos;
+			return total;
+		}
+	}
+
+	if (size < m_raWindow) {
+		// Small read. Fill the read-ahead buffer.
+		if (sequential && m_raLen > 0) {
+			// Sequential access. Increase the window size.
+			m_raWindow *= 2;
+			if (m_raWindow > READAHEAD_MAX) {
+				m_raWindow = READAHEAD_MAX;
+			}
+		}
+
+		if (fillReadAhead(m_pos, size)) {
+			size_t avail = (size_t)(m_raPos + m_raLen - m_pos);
+			if (avail > size) {
+				avail = size;
+			}
+			memcpy(ptr8, &m_raBuf[m_pos - m_raPos], avail);
+			ptr8 += avail;
+			size -= avail;
+			total += avail;
+			m_pos += avail;
+		}
+	}
+
 	if (size > 0) {
-		m_partition->clearError();
-		ret = m_partition->read(ptr, size);
+		// Large read, or the buffer couldn't handle all of it.
+		// Read directly from the partition.
+		m_raStats.directReads++;
+		size_t ret = this->pread(m_pos, ptr8, size);
+		total += ret;
 		m_pos += ret;
+	}
+
+	m_lastReadEnd = m_pos;
+	return total;
+}
+
+/**
+ * Fill the read-ahead buffer.
+ * @param pos File position. (Will be aligned.)
+ * @param size Size of the read request.
+ * @return True on success; false on error.
+ */
+bool PartitionFile::fillReadAhead(int64_t pos, size_t size)
+{
+	m_raLen = 0;
+	if (!m_raBuf) {
+		m_raBuf = static_cast<uint8_t*>(malloc(READAHEAD_MAX));
+		if (!m_raBuf) {
+			// malloc() failed.
+			return false;
+		}
+	}
+
+	// Align the starting position relative to the partition.
+	int64_t start = ((m_offset + pos) & ~(int64_t)(READAHEAD_ALIGN - 1)) - m_offset;
+	if (start < 0) {
+		start = 0;
+	}
+	size_t len = m_raWindow;
+	if ((size_t)(pos - start) + size > len) {
+		// Make sure the read request is covered.
+		len = (size_t)(pos - start) + size;
+		if (len > READAHEAD_MAX) {
+			len = READAHEAD_MAX;
+		}
+	}
+	if (start > m_size - (int64_t)len) {
+		len = (size_t)(m_size - start);
+	}
+
+	size_t ret = m_partition->pread(m_offset + start, m_raBuf, len);
+	if (ret != len) {
 		m_lastError = m_partition->lastError();
+		if (ret > len) {
+			// Some partition classes return a negative
+			// POSIX error code on error.
+			ret = 0;
+		}
+	}
+	if ((int64_t)ret <= pos - start) {
+		// Nothing was read at the requested position.
+		return false;
+	}
+
+	m_raPos = start;
+	m_raLen = (unsigned int)ret;
+	m_raStats.fills++;
+	m_raStats.bytesFilled += ret;
+	return true;
+}
+
+/**
+ * Read data from the specified position in the file.
+ * This does not use the file position, so it's thread-safe
+ * as long as the partition's pread() is thread-safe.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t PartitionFile::pread(int64_t pos, void *ptr, size_t size)
+{
+	if (!m_partition) {
+		m_lastError = EBADF;
+		return 0;
 	}
 
+	// Check if pos and size are in bounds.
+	if (pos < 0 || pos >= m_size) {
+		return 0;
+	} else if (pos > (int64_t)(m_size - size)) {
+		// Not enough data.
+		// Copy whatever's left in the file.
+		size = (size_t)(m_size - pos);
+	}
+
+	size_t ret = m_partition->pread(m_offset + pos, ptr, size);
+	if (ret != size) {
+		m_lastError = m_partition->lastError();
+		if (ret > size) {
+			// Some partition classes return a negative
+			// POSIX error code on error.
+			ret = 0;
+		}
+	}
 	return ret;
 }
 
@@ -253,4 +433,28 @@ string PartitionFile::filename(void) const
 	return string();
 }
 
+/** Read-ahead buffer. **/
+
+/**
+ * Get the read-ahead statistics.
+ * @param stats ReadAheadStats struct.
+ */
+void PartitionFile::getReadAheadStats(ReadAheadStats *stats) const
+{
+	assert(stats != nullptr);
+	if (!stats)
+		return;
+
+	*stats = m_raStats;
+	stats->window = m_raWindow;
+}
+
+/**
+ * Reset the read-ahead statistics.
+ */
+void PartitionFile::resetReadAheadStats(void)
+{
+	memset(&m_raStats, 0, sizeof(m_raStats));
+}
+
 }
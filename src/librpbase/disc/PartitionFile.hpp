@@ -127,11 +127,70 @@ class PartitionFile : public IRpFile
 		 */
 		virtual std::string filename(void) const override final;
 
+	public:
+		/** Positional I/O. **/
+
+		/**
+		 * Read data from the specified position in the file.
+		 * This does not use the file position, so it's thread-safe
+		 * as long as the partition's pread() is thread-safe.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override final;
+
+	public:
+		/** Read-ahead buffer. **/
+
+		struct ReadAheadStats {
+			unsigned int reads;		// Number of read() calls.
+			unsigned int bufferHits;	// read() calls handled entirely by the buffer.
+			unsigned int fills;		// Number of times the buffer was filled.
+			unsigned int directReads;	// read() calls that bypassed the buffer.
+			uint64_t bytesFilled;		// Total bytes read into the buffer.
+			unsigned int window;		// Current read-ahead window size, in bytes.
+		};
+
+		/**
+		 * Get the read-ahead statistics.
+		 * @param stats ReadAheadStats struct.
+		 */
+		void getReadAheadStats(ReadAheadStats *stats) const;
+
+		/**
+		 * Reset the read-ahead statistics.
+		 */
+		void resetReadAheadStats(void);
+
+	private:
+		/**
+		 * Fill the read-ahead buffer.
+		 * @param pos File position. (Will be aligned.)
+		 * @param size Size of the read request.
+		 * @return True on success; false on error.
+		 */
+		bool fillReadAhead(int64_t pos, size_t size);
+
 	protected:
 		IDiscReader *m_partition;
 		int64_t m_offset;	// File starting offset.
 		int64_t m_size;		// File size.
 		int64_t m_pos;		// Current position.
+
+		// Read-ahead buffer.
+		// read() requests smaller than the current window are
+		// handled by reading an aligned chunk into the buffer.
+		// The window doubles for each sequential buffer fill,
+		// and it's reset when the file position jumps.
+		// NOTE: pread() doesn't use the buffer.
+		uint8_t *m_raBuf;
+		int64_t m_raPos;	// File position of m_raBuf.
+		unsigned int m_raLen;	// Amount of valid data in m_raBuf.
+		unsigned int m_raWindow;	// Current window size.
+		int64_t m_lastReadEnd;	// File position after the last read().
+		ReadAheadStats m_raStats;
 };
 
 }
@@ -28,6 +28,11 @@
 // C includes. (C++ namespace)
 #include <cassert>
 #include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+using std::unique_ptr;
 
 namespace LibRpBase {
 
@@ -39,6 +44,11 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q, IRpFile *f
 	, disc_size(0)
 	, pos(-1)
 	, block_size(0)
+	, cacheSize(SparseDiscReader::DEFAULT_CACHE_SIZE)
+	, cacheLineSize(0)
+	, cacheTick(0)
+	, cacheHits(0)
+	, cacheMisses(0)
 {
 	if (!file) {
 		q->m_lastError = EBADF;
@@ -55,6 +65,138 @@ SparseDiscReaderPrivate::~SparseDiscReaderPrivate()
 	delete file;
 }
 
+/**
+ * Initialize the block cache using the current cacheSize.
+ * cacheMutex must be locked by the caller.
+ */
+void SparseDiscReaderPrivate::initCache(void)
+{
+	assert(block_size != 0);
+
+	// Split large blocks into multiple lines if possible.
+	unsigned int lineSize = block_size;
+	if (block_size > CACHE_LINE_SIZE_MAX && (block_size % CACHE_LINE_SIZE_MAX) == 0) {
+		lineSize = CACHE_LINE_SIZE_MAX;
+	}
+
+	const size_t count = (lineSize != 0 ? cacheSize / lineSize : 0);
+	const CacheLine emptyLine = {0, 0, false};
+	cacheLines.assign(count, emptyLine);
+	cacheData.reset(count > 0 ? new uint8_t[count * lineSize] : nullptr);
+	cacheMap.clear();
+	cacheMap.reserve(count);
+	cacheLineSize = lineSize;
+}
+
+/**
+ * Read part of a block using the block cache.
+ * @param blockIdx	[in] Block index.
+ * @param ptr		[out] Output data buffer.
+ * @param pos		[in] Starting position within the block.
+ * @param size		[in] Amount of data to read, in bytes.
+ * @return Number of bytes read, or -1 if the block index is invalid.
+ */
+int SparseDiscReaderPrivate::readBlockCached(uint32_t blockIdx, uint8_t *ptr, int pos, size_t size)
+{
+	RP_Q(SparseDiscReader);
+
+	unsigned int lineSize;
+	{
+		MutexLocker cacheLock(cacheMutex);
+		if (cacheLineSize == 0) {
+			initCache();
+		}
+		lineSize = cacheLineSize;
+		if (cacheLines.empty()) {
+			// Cache is disabled.
+			lineSize = 0;
+		}
+	}
+	if (lineSize == 0) {
+		// Cache is disabled. Read the block directly.
+		return q->readBlock(blockIdx, ptr, pos, size);
+	}
+
+	const unsigned int linesPerBlock = block_size / lineSize;
+	unique_ptr<uint8_t[]> lineBuf;
+	int ret = 0;
+	while (size > 0) {
+		const unsigned int lineIdx = (unsigned int)pos / lineSize;
+		const unsigned int lineOffset = (unsigned int)pos % lineSize;
+		size_t chunk = lineSize - lineOffset;
+		if (chunk > size) {
+			chunk = size;
+		}
+		const uint64_t key = ((uint64_t)blockIdx * linesPerBlock) + lineIdx;
+
+		// Check if the line is in the cache.
+		bool hit = false;
+		{
+			MutexLocker cacheLock(cacheMutex);
+			auto iter = cacheMap.find(key);
+			if (iter != cacheMap.end()) {
+				CacheLine &line = cacheLines[iter->second];
+				line.lastUsed = ++cacheTick;
+				memcpy(ptr, &cacheData[(size_t)iter->second * lineSize + lineOffset], chunk);
+				cacheHits++;
+				hit = true;
+			} else {
+				cacheMisses++;
+			}
+		}
+
+		if (!hit) {
+			// Read the entire line.
+			if (!lineBuf) {
+				lineBuf.reset(new uint8_t[lineSize]);
+			}
+			int rd = q->readBlock(blockIdx, lineBuf.get(), lineIdx * lineSize, lineSize);
+			if (rd != (int)lineSize) {
+				// Short read. Don't cache this line;
+				// read the requested data directly.
+				rd = q->readBlock(blockIdx, ptr, (int)pos, chunk);
+				if (rd < 0) {
+					return (ret > 0 ? ret : rd);
+				}
+				return ret + rd;
+			}
+			memcpy(ptr, &lineBuf[lineOffset], chunk);
+
+			// Add the line to the cache, replacing the
+			// least recently used line if necessary.
+			MutexLocker cacheLock(cacheMutex);
+			if (cacheLineSize == lineSize && cacheMap.find(key) == cacheMap.end()) {
+				unsigned int victim = 0;
+				for (unsigned int i = 0; i < (unsigned int)cacheLines.size(); i++) {
+					if (!cacheLines[i].valid) {
+						victim = i;
+						break;
+					} else if (cacheLines[i].lastUsed < cacheLines[victim].lastUsed) {
+						victim = i;
+					}
+				}
+
+				CacheLine &line = cacheLines[victim];
+				if (line.valid) {
+					cacheMap.erase(line.key);
+				}
+				line.key = key;
+				line.lastUsed = ++cacheTick;
+				line.valid = true;
+				memcpy(&cacheData[(size_t)victim * lineSize], lineBuf.get(), lineSize);
+				cacheMap.insert(std::make_pair(key, victim));
+			}
+		}
+
+		ptr += chunk;
+		pos += (int)chunk;
+		size -= chunk;
+		ret += (int)chunk;
+	}
+
+	return ret;
+}
+
 /** SparseDiscReader **/
 
 SparseDiscReader::SparseDiscReader(SparseDiscReaderPrivate *d)
@@ -98,24 +240,56 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 		return -1;
 	}
 
+	size_t ret = this->pread(d->pos, ptr, size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the specified position in the disc image.
+ *
+ * This does not use the disc image position. It's thread-safe
+ * as long as the subclass's readBlock() is thread-safe.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SparseDiscReader::pread(int64_t pos, void *ptr, size_t size)
+{
+	RP_D(SparseDiscReader);
+	assert(d->file != nullptr);
+	assert(d->disc_size > 0);
+	assert(d->block_size != 0);
+	if (!d->file || d->disc_size <= 0 || d->block_size == 0) {
+		// Disc image wasn't initialized properly.
+		m_lastError = EBADF;
+		return 0;
+	}
+
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t ret = 0;
 
 	// Are we already at the end of the disc?
-	if (d->pos >= d->disc_size) {
+	if (pos < 0 || pos >= d->disc_size) {
 		// End of the disc.
 		return 0;
 	}
 
-	// Make sure d->pos + size <= d->disc_size.
+	// Make sure pos + size <= d->disc_size.
 	// If it isn't, we'll do a short read.
-	if (d->pos + (int64_t)size >= d->disc_size) {
-		size = (size_t)(d->disc_size - d->pos);
+	if (pos + (int64_t)size >= d->disc_size) {
+		size = (size_t)(d->disc_size - pos);
 	}
 
+	// Small reads go through the block cache.
+	// Larger reads only use it for partial blocks.
+	const bool useCache = (size <= SparseDiscReaderPrivate::CACHE_READ_SIZE_MAX);
+
 	// Check if we're not starting on a block boundary.
 	const uint32_t block_size = d->block_size;
-	const uint32_t blockStartOffset = d->pos % block_size;
+	const uint32_t blockStartOffset = pos % block_size;
 	if (blockStartOffset != 0) {
 		// Not a block boundary.
 		// Read the end of the block.
@@ -124,8 +298,8 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 			read_sz = (uint32_t)size;
 		}
 
-		const unsigned int blockIdx = (unsigned int)(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, ptr8, blockStartOffset, read_sz);
+		const unsigned int blockIdx = (unsigned int)(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, ptr8, blockStartOffset, read_sz);
 		if (rd < 0 || rd != (int)read_sz) {
 			// Error reading the data.
 			return (rd > 0 ? rd : 0);
@@ -135,38 +309,55 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 		size -= read_sz;
 		ptr8 += read_sz;
 		ret += read_sz;
-		d->pos += read_sz;
+		pos += read_sz;
 	}
 
 	// Read entire blocks.
-	for (; size >= block_size;
-	    size -= block_size, ptr8 += block_size,
-	    ret += block_size, d->pos += block_size)
-	{
-		assert(d->pos % block_size == 0);
-		const unsigned int blockIdx = (unsigned int)(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, ptr8, 0, block_size);
-		if (rd < 0 || rd != (int)block_size) {
+	if (useCache) {
+		for (; size >= block_size;
+		    size -= block_size, ptr8 += block_size,
+		    ret += block_size, pos += block_size)
+		{
+			assert(pos % block_size == 0);
+			const unsigned int blockIdx = (unsigned int)(pos / block_size);
+			int rd = d->readBlockCached(blockIdx, ptr8, 0, block_size);
+			if (rd < 0 || rd != (int)block_size) {
+				// Error reading the data.
+				return ret + (rd > 0 ? rd : 0);
+			}
+		}
+	} else if (size >= block_size) {
+		// Let the subclass merge physically contiguous blocks.
+		assert(pos % block_size == 0);
+		const unsigned int blockIdx = (unsigned int)(pos / block_size);
+		const unsigned int count = (unsigned int)(size / block_size);
+		const size_t blocks_sz = (size_t)count * block_size;
+		size_t rd = this->readBlocks(blockIdx, count, ptr8);
+		if (rd != blocks_sz) {
 			// Error reading the data.
-			return ret + (rd > 0 ? rd : 0);
+			return ret + rd;
 		}
+
+		size -= blocks_sz;
+		ptr8 += blocks_sz;
+		ret += blocks_sz;
+		pos += blocks_sz;
 	}
 
 	// Check if we still have data left. (not a full block)
 	if (size > 0) {
 		// Not a full block.
-		assert(d->pos % block_size == 0);
+		assert(pos % block_size == 0);
 
 		// Read the start of the block.
-		const unsigned int blockIdx = (unsigned int)(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, ptr8, 0, size);
+		const unsigned int blockIdx = (unsigned int)(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, ptr8, 0, size);
 		if (rd < 0 || rd != (int)size) {
 			// Error reading the data.
 			return ret + (rd > 0 ? rd : 0);
 		}
 
 		ret += size;
-		d->pos += size;
 	}
 
 	// Finished reading the data.
@@ -263,4 +454,122 @@ int64_t SparseDiscReader::size(void)
 	return d->disc_size;
 }
 
+/** Virtual functions for SparseDiscReader subclasses. **/
+
+/**
+ * Read multiple consecutive full blocks.
+ *
+ * Subclasses should override this if they can merge
+ * physically contiguous blocks into a single read.
+ * The default implementation calls readBlock() for
+ * each block.
+ *
+ * NOTE: This may be called from multiple threads at once,
+ * so it must not use the file position. Use IRpFile::pread().
+ *
+ * @param firstIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+ * @return Number of bytes read. (Less than count * block_size on error.)
+ */
+size_t SparseDiscReader::readBlocks(uint32_t firstIdx, unsigned int count, void *ptr)
+{
+	RP_D(const SparseDiscReader);
+	const unsigned int block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	for (; count > 0; count--, firstIdx++, ptr8 += block_size) {
+		int rd = this->readBlock(firstIdx, ptr8, 0, block_size);
+		if (rd < 0 || rd != (int)block_size) {
+			// Error reading the data.
+			return ret + (rd > 0 ? rd : 0);
+		}
+		ret += block_size;
+	}
+
+	return ret;
+}
+
+/** Block cache. **/
+
+/**
+ * Set the block cache size, in bytes.
+ *
+ * Blocks are cached in lines of up to 64 KB, so larger
+ * blocks are split into multiple lines. Reads of up to
+ * 64 KB go through the cache; larger reads only use the
+ * cache for partial blocks at the start and end.
+ *
+ * Cached data is discarded when the size is changed.
+ *
+ * @param size Cache size, in bytes. (0 to disable)
+ */
+void SparseDiscReader::setCacheSize(size_t size)
+{
+	RP_D(SparseDiscReader);
+	MutexLocker cacheLock(d->cacheMutex);
+	d->cacheSize = size;
+
+	// Reinitialize the cache on the next read.
+	d->cacheLineSize = 0;
+	d->cacheLines.clear();
+	d->cacheData.reset();
+	d->cacheMap.clear();
+}
+
+/**
+ * Set the block cache size, in blocks.
+ * @param count Number of blocks. (0 to disable)
+ */
+void SparseDiscReader::setCacheBlockCount(unsigned int count)
+{
+	RP_D(const SparseDiscReader);
+	setCacheSize((size_t)count * d->block_size);
+}
+
+/**
+ * Get the block cache size, in bytes.
+ * @return Block cache size, in bytes.
+ */
+size_t SparseDiscReader::cacheSize(void) const
+{
+	RP_D(const SparseDiscReader);
+	MutexLocker cacheLock(d->cacheMutex);
+	return d->cacheSize;
+}
+
+/**
+ * Get the number of block cache hits.
+ * @return Number of block cache hits.
+ */
+uint64_t SparseDiscReader::cacheHits(void) const
+{
+	RP_D(const SparseDiscReader);
+	MutexLocker cacheLock(d->cacheMutex);
+	return d->cacheHits;
+}
+
+/**
+ * Get the number of block cache misses.
+ * @return Number of block cache misses.
+ */
+uint64_t SparseDiscReader::cacheMisses(void) const
+{
+	RP_D(const SparseDiscReader);
+	MutexLocker cacheLock(d->cacheMutex);
+	return d->cacheMisses;
+}
+
+/**
+ * Reset the block cache hit and miss counters.
+ */
+void SparseDiscReader::resetCacheStats(void)
+{
+	RP_D(SparseDiscReader);
+	MutexLocker cacheLock(d->cacheMutex);
+	d->cacheHits = 0;
+	d->cacheMisses = 0;
+}
+
 }
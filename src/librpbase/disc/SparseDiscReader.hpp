@@ -60,6 +60,19 @@ class SparseDiscReader : public IDiscReader
 		 */
 		virtual size_t read(void *ptr, size_t size) override final;
 
+		/**
+		 * Read data from the specified position in the disc image.
+		 *
+		 * This does not use the disc image position. It's thread-safe
+		 * as long as the subclass's readBlock() is thread-safe.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override final;
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
@@ -84,6 +97,55 @@ class SparseDiscReader : public IDiscReader
 		 */
 		virtual int64_t size(void) override final;
 
+	public:
+		/** Block cache. **/
+
+		// Default block cache size, in bytes.
+		static const size_t DEFAULT_CACHE_SIZE = 1024*1024;
+
+		/**
+		 * Set the block cache size, in bytes.
+		 *
+		 * Blocks are cached in lines of up to 64 KB, so larger
+		 * blocks are split into multiple lines. Reads of up to
+		 * 64 KB go through the cache; larger reads only use the
+		 * cache for partial blocks at the start and end.
+		 *
+		 * Cached data is discarded when the size is changed.
+		 *
+		 * @param size Cache size, in bytes. (0 to disable)
+		 */
+		void setCacheSize(size_t size);
+
+		/**
+		 * Set the block cache size, in blocks.
+		 * @param count Number of blocks. (0 to disable)
+		 */
+		void setCacheBlockCount(unsigned int count);
+
+		/**
+		 * Get the block cache size, in bytes.
+		 * @return Block cache size, in bytes.
+		 */
+		size_t cacheSize(void) const;
+
+		/**
+		 * Get the number of block cache hits.
+		 * @return Number of block cache hits.
+		 */
+		uint64_t cacheHits(void) const;
+
+		/**
+		 * Get the number of block cache misses.
+		 * @return Number of block cache misses.
+		 */
+		uint64_t cacheMisses(void) const;
+
+		/**
+		 * Reset the block cache hit and miss counters.
+		 */
+		void resetCacheStats(void);
+
 	protected:
 		/** Virtual functions for SparseDiscReader subclasses. **/
 
@@ -93,6 +155,9 @@ class SparseDiscReader : public IDiscReader
 		 * This can read either a full block or a partial block.
 		 * For a full block, set pos = 0 and size = block_size.
 		 *
+		 * NOTE: This may be called from multiple threads at once,
+		 * so it must not use the file position. Use IRpFile::pread().
+		 *
 		 * @param blockIdx	[in] Block index.
 		 * @param ptr		[out] Output data buffer.
 		 * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
@@ -100,6 +165,24 @@ class SparseDiscReader : public IDiscReader
 		 * @return Number of bytes read, or -1 if the block index is invalid.
 		 */
 		virtual int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size) = 0;
+
+		/**
+		 * Read multiple consecutive full blocks.
+		 *
+		 * Subclasses should override this if they can merge
+		 * physically contiguous blocks into a single read.
+		 * The default implementation calls readBlock() for
+		 * each block.
+		 *
+		 * NOTE: This may be called from multiple threads at once,
+		 * so it must not use the file position. Use IRpFile::pread().
+		 *
+		 * @param firstIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes.)
+		 * @return Number of bytes read. (Less than count * block_size on error.)
+		 */
+		virtual size_t readBlocks(uint32_t firstIdx, unsigned int count, void *ptr);
 };
 
 }
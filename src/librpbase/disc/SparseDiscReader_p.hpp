@@ -26,6 +26,12 @@
 
 #include <stdint.h>
 #include "../common.h"
+#include "../threads/Mutex.hpp"
+
+// C++ includes.
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace LibRpBase {
 
@@ -50,6 +56,50 @@ class SparseDiscReaderPrivate
 		int64_t disc_size;	// Virtual disc image size.
 		int64_t pos;		// Read position.
 		unsigned int block_size;	// Block size.
+
+	public:
+		/** Block cache. **/
+
+		// Maximum size of a cache line.
+		// Blocks larger than this are split into multiple lines,
+		// so a small read doesn't have to read an entire block.
+		static const unsigned int CACHE_LINE_SIZE_MAX = 64*1024;
+
+		// Reads up to this size go through the cache.
+		// Larger reads only cache partial blocks at the edges.
+		static const size_t CACHE_READ_SIZE_MAX = 64*1024;
+
+		struct CacheLine {
+			uint64_t key;		// Line index. (block index * lines per block + line in block)
+			uint64_t lastUsed;	// LRU tick.
+			bool valid;
+		};
+
+		size_t cacheSize;		// Requested cache size, in bytes.
+		unsigned int cacheLineSize;	// Cache line size. (0 if not initialized)
+		std::vector<CacheLine> cacheLines;
+		std::unique_ptr<uint8_t[]> cacheData;	// cacheLines.size() * cacheLineSize
+		std::unordered_map<uint64_t, unsigned int> cacheMap;	// key -> line
+		uint64_t cacheTick;
+		uint64_t cacheHits;
+		uint64_t cacheMisses;
+		mutable Mutex cacheMutex;
+
+		/**
+		 * Initialize the block cache using the current cacheSize.
+		 * cacheMutex must be locked by the caller.
+		 */
+		void initCache(void);
+
+		/**
+		 * Read part of a block using the block cache.
+		 * @param blockIdx	[in] Block index.
+		 * @param ptr		[out] Output data buffer.
+		 * @param pos		[in] Starting position within the block.
+		 * @param size		[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read, or -1 if the block index is invalid.
+		 */
+		int readBlockCached(uint32_t blockIdx, uint8_t *ptr, int pos, size_t size);
 };
 
 }
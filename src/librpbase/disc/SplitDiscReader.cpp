@@ -0,0 +1,465 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * SplitDiscReader.cpp: Disc reader for disc images split into parts.      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+
+#include "SplitDiscReader.hpp"
+#include "file/IRpFile.hpp"
+#include "file/FileSystem.hpp"
+#include "file/RelatedFile.hpp"
+
+// C includes.
+#include <stdio.h>
+#include <string.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase {
+
+// Split naming schemes.
+enum SplitScheme {
+	SPLIT_NONE,	// Not split.
+	SPLIT_PART,	// "*.part0.iso", "*.part1.iso", ...
+	SPLIT_WBFS,	// "*.wbfs", "*.wbf1", ..., "*.wbf9"
+};
+
+// Maximum number of parts.
+// WBFS is limited to "*.wbf9".
+static const unsigned int SPLIT_PART_MAX = 100;
+static const unsigned int SPLIT_WBFS_MAX = 10;
+
+/**
+ * Determine the split naming scheme of a filename.
+ * @param filename	[in] Filename.
+ * @param pBasename	[out,opt] Basename for the other parts, without the part number.
+ * @param pExt		[out,opt] Extension for the other parts, without the part number.
+ * @return Split naming scheme.
+ */
+static SplitScheme getSplitScheme(const string &filename, string *pBasename, string *pExt)
+{
+	// Get the filename portion.
+	size_t slash_pos = filename.find_last_of(DIR_SEP_CHR);
+	const string name = (slash_pos != string::npos
+		? filename.substr(slash_pos + 1)
+		: filename);
+
+	// Separate the file extension.
+	size_t dot_pos = name.find_last_of('.');
+	if (dot_pos == string::npos) {
+		// No extension.
+		return SPLIT_NONE;
+	}
+	const string base = name.substr(0, dot_pos);
+	const string ext = name.substr(dot_pos);
+
+	if (!strcasecmp(ext.c_str(), ".wbfs")) {
+		// WBFS: Other parts are "*.wbf1" through "*.wbf9".
+		if (pBasename) {
+			*pBasename = base;
+		}
+		if (pExt) {
+			*pExt = ext.substr(0, 4);
+		}
+		return SPLIT_WBFS;
+	}
+
+	static const char part0[] = ".part0";
+	static const size_t part0_len = sizeof(part0) - 1;
+	if (base.size() > part0_len &&
+	    !strcasecmp(&base[base.size() - part0_len], part0))
+	{
+		// "*.part0.ext": Other parts are "*.part1.ext", etc.
+		if (pBasename) {
+			*pBasename = base.substr(0, base.size() - 1);
+		}
+		if (pExt) {
+			*pExt = ext;
+		}
+		return SPLIT_PART;
+	}
+
+	// Not a split filename.
+	return SPLIT_NONE;
+}
+
+/**
+ * Construct a SplitDiscReader with the specified file.
+ *
+ * If the filename uses a known split naming scheme,
+ * the remaining parts are opened using
+ * FileSystem::openRelatedFile():
+ * - "*.part0.iso", "*.part1.iso", ...
+ * - "*.wbfs", "*.wbf1", ..., "*.wbf9"
+ *
+ * Otherwise, the disc image consists of one part.
+ *
+ * The file is dup()'d, so the original file can be
+ * closed afterwards.
+ *
+ * @param file First part of the disc image.
+ */
+SplitDiscReader::SplitDiscReader(IRpFile *file)
+	: m_pos(0)
+{
+	if (!file) {
+		m_lastError = EBADF;
+		return;
+	}
+
+	// First part.
+	IRpFile *part = file->dup();
+	if (!part) {
+		m_lastError = EBADF;
+		return;
+	}
+	int64_t partSize = part->size();
+	if (partSize < 0) {
+		partSize = 0;
+	}
+	m_files.push_back(part);
+	m_partStart.push_back(0);
+	m_partStart.push_back(partSize);
+
+	// Check for other parts.
+	const string filename = file->filename();
+	string basename, ext;
+	const SplitScheme scheme = getSplitScheme(filename, &basename, &ext);
+	if (scheme == SPLIT_NONE) {
+		// Single-part disc image.
+		return;
+	}
+
+	const unsigned int maxParts = (scheme == SPLIT_WBFS ? SPLIT_WBFS_MAX : SPLIT_PART_MAX);
+	for (unsigned int i = 1; i < maxParts; i++) {
+		if (partSize <= 0) {
+			// Previous part is empty.
+			// Don't look for any more parts.
+			break;
+		}
+
+		// Get the filename for this part.
+		char partnum[16];
+		snprintf(partnum, sizeof(partnum), "%u", i);
+		string part_basename = basename;
+		string part_ext = ext;
+		if (scheme == SPLIT_WBFS) {
+			part_ext += partnum;
+		} else {
+			part_basename += partnum;
+		}
+
+		part = FileSystem::openRelatedFile(filename.c_str(),
+			part_basename.c_str(), part_ext.c_str());
+		if (!part) {
+			// No more parts.
+			break;
+		}
+
+		partSize = part->size();
+		if (partSize <= 0) {
+			// Empty part.
+			delete part;
+			break;
+		}
+		m_files.push_back(part);
+		m_partStart.push_back(m_partStart.back() + partSize);
+	}
+}
+
+SplitDiscReader::~SplitDiscReader()
+{
+	for (auto iter = m_files.begin(); iter != m_files.end(); ++iter) {
+		delete *iter;
+	}
+}
+
+/**
+ * Is a disc image supported by this class?
+ * @param pHeader Disc image header.
+ * @param szHeader Size of header.
+ * @return Class-specific disc format ID (>= 0) if supported; -1 if not.
+ */
+int SplitDiscReader::isDiscSupported_static(const uint8_t *pHeader, size_t szHeader)
+{
+	// SplitDiscReader supports everything.
+	RP_UNUSED(pHeader);
+	RP_UNUSED(szHeader);
+	return 0;
+}
+
+/**
+ * Is a disc image supported by this object?
+ * @param pHeader Disc image header.
+ * @param szHeader Size of header.
+ * @return Class-specific system ID (>= 0) if supported; -1 if not.
+ */
+int SplitDiscReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
+{
+	// SplitDiscReader supports everything.
+	RP_UNUSED(pHeader);
+	RP_UNUSED(szHeader);
+	return 0;
+}
+
+/**
+ * Is the disc image open?
+ * This usually only returns false if an error occurred.
+ * @return True if the disc image is open; false if it isn't.
+ */
+bool SplitDiscReader::isOpen(void) const
+{
+	return !m_files.empty();
+}
+
+/**
+ * Read data from the disc image.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SplitDiscReader::read(void *ptr, size_t size)
+{
+	size_t ret = this->pread(m_pos, ptr, size);
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Set the disc image position.
+ * @param pos Disc image position.
+ * @return 0 on success; -1 on error.
+ */
+int SplitDiscReader::seek(int64_t pos)
+{
+	if (m_files.empty()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	if (pos <= 0) {
+		m_pos = 0;
+	} else if (pos >= m_partStart.back()) {
+		m_pos = m_partStart.back();
+	} else {
+		m_pos = pos;
+	}
+	return 0;
+}
+
+/**
+ * Seek to the beginning of the disc image.
+ */
+void SplitDiscReader::rewind(void)
+{
+	seek(0);
+}
+
+/**
+ * Get the disc image position.
+ * @return Disc image position on success; -1 on error.
+ */
+int64_t SplitDiscReader::tell(void)
+{
+	if (m_files.empty()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+	return m_pos;
+}
+
+/**
+ * Get the disc image size.
+ * @return Disc image size, or -1 on error.
+ */
+int64_t SplitDiscReader::size(void)
+{
+	if (m_files.empty()) {
+		m_lastError = EBADF;
+		return -1;
+	}
+	return m_partStart.back();
+}
+
+/**
+ * Find the part containing a disc image position.
+ * @param pos Disc image position. (Must be in range!)
+ * @return Part index.
+ */
+unsigned int SplitDiscReader::findPart(int64_t pos) const
+{
+	// Find the first part that starts after pos.
+	// The part before it contains pos.
+	assert(pos >= 0 && pos < m_partStart.back());
+	auto iter = std::upper_bound(m_partStart.begin(), m_partStart.end(), pos);
+	return (unsigned int)(iter - m_partStart.begin()) - 1;
+}
+
+/**
+ * Read data from the specified position in the disc image.
+ * Reads that cross a part boundary are split between
+ * the parts and read directly into the output buffer.
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SplitDiscReader::pread(int64_t pos, void *ptr, size_t size)
+{
+	if (m_files.empty()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Constrain size based on the disc image size.
+	const int64_t discSize = m_partStart.back();
+	if (pos < 0 || pos >= discSize) {
+		return 0;
+	} else if ((int64_t)(pos + size) > discSize) {
+		size = (size_t)(discSize - pos);
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	unsigned int part = findPart(pos);
+	while (size > 0) {
+		// Read as much as possible from this part.
+		const int64_t partPos = pos - m_partStart[part];
+		const int64_t partRemain = m_partStart[part+1] - pos;
+		const size_t sz_req = ((int64_t)size > partRemain ? (size_t)partRemain : size);
+		IRpFile *const file = m_files[part];
+		size_t sz_read = file->pread(partPos, ptr8, sz_req);
+		ret += sz_read;
+		if (sz_read != sz_req) {
+			// Short read.
+			m_lastError = file->lastError();
+			break;
+		}
+
+		// Next part.
+		pos += sz_read;
+		ptr8 += sz_read;
+		size -= sz_read;
+		part++;
+	}
+
+	return ret;
+}
+
+/**
+ * Read data from multiple locations in the disc image.
+ * Requests within a single part are forwarded to that
+ * part's IRpFile::readv().
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int SplitDiscReader::readv(IRpFile::ReadRequest *reqs, unsigned int count)
+{
+	if (m_files.size() == 1) {
+		// Single-part disc image.
+		// Forward the requests directly.
+		// NOTE: Requests past the end of the file are
+		// handled by IRpFile::readv().
+		unsigned int ret = m_files[0]->readv(reqs, count);
+		m_lastError = m_files[0]->lastError();
+		return ret;
+	}
+
+	// Group the requests by part.
+	// Requests that cross a part boundary use pread().
+	vector<vector<IRpFile::ReadRequest> > partReqs(m_files.size());
+	vector<vector<unsigned int> > partReqIdx(m_files.size());
+	const int64_t discSize = (m_files.empty() ? 0 : m_partStart.back());
+	unsigned int complete = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		IRpFile::ReadRequest &req = reqs[i];
+		if (req.pos < 0 || req.pos >= discSize) {
+			// Out of range.
+			req.ret = 0;
+			if (req.size == 0) {
+				complete++;
+			}
+			continue;
+		}
+
+		const unsigned int part = findPart(req.pos);
+		if ((int64_t)(req.pos + req.size) > m_partStart[part+1]) {
+			// Crosses a part boundary.
+			req.ret = this->pread(req.pos, req.ptr, req.size);
+			if (req.ret == req.size) {
+				complete++;
+			}
+			continue;
+		}
+
+		IRpFile::ReadRequest partReq = req;
+		partReq.pos -= m_partStart[part];
+		partReqs[part].push_back(partReq);
+		partReqIdx[part].push_back(i);
+	}
+
+	for (unsigned int part = 0; part < (unsigned int)m_files.size(); part++) {
+		vector<IRpFile::ReadRequest> &v = partReqs[part];
+		if (v.empty())
+			continue;
+
+		IRpFile *const file = m_files[part];
+		complete += file->readv(v.data(), (unsigned int)v.size());
+		for (size_t j = 0; j < v.size(); j++) {
+			reqs[partReqIdx[part][j]].ret = v[j].ret;
+		}
+		if (file->lastError() != 0) {
+			m_lastError = file->lastError();
+		}
+	}
+
+	return complete;
+}
+
+/**
+ * Get the number of parts.
+ * @return Number of parts, or 0 if the disc image isn't open.
+ */
+unsigned int SplitDiscReader::partCount(void) const
+{
+	return (unsigned int)m_files.size();
+}
+
+/**
+ * Check if a filename uses a known split naming scheme.
+ * This doesn't check if the other parts exist.
+ * @param filename Filename.
+ * @return True if the filename is the first part of a split disc image.
+ */
+bool SplitDiscReader::isSplitFilename(const string &filename)
+{
+	return (getSplitScheme(filename, nullptr, nullptr) != SPLIT_NONE);
+}
+
+}
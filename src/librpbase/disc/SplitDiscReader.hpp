@@ -0,0 +1,177 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * SplitDiscReader.hpp: Disc reader for disc images split into parts.      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_SPLITDISCREADER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_SPLITDISCREADER_HPP__
+
+#include "IDiscReader.hpp"
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+namespace LibRpBase {
+
+class IRpFile;
+class SplitDiscReader : public IDiscReader
+{
+	public:
+		/**
+		 * Construct a SplitDiscReader with the specified file.
+		 *
+		 * If the filename uses a known split naming scheme,
+		 * the remaining parts are opened using
+		 * FileSystem::openRelatedFile():
+		 * - "*.part0.iso", "*.part1.iso", ...
+		 * - "*.wbfs", "*.wbf1", ..., "*.wbf9"
+		 *
+		 * Otherwise, the disc image consists of one part.
+		 *
+		 * The file is dup()'d, so the original file can be
+		 * closed afterwards.
+		 *
+		 * @param file First part of the disc image.
+		 */
+		explicit SplitDiscReader(IRpFile *file);
+
+		virtual ~SplitDiscReader();
+
+	private:
+		RP_DISABLE_COPY(SplitDiscReader)
+
+	public:
+		/** Disc image detection functions. **/
+
+		/**
+		 * Is a disc image supported by this class?
+		 * @param pHeader Disc image header.
+		 * @param szHeader Size of header.
+		 * @return Class-specific disc format ID (>= 0) if supported; -1 if not.
+		 */
+		static int isDiscSupported_static(const uint8_t *pHeader, size_t szHeader);
+
+		/**
+		 * Is a disc image supported by this object?
+		 * @param pHeader Disc image header.
+		 * @param szHeader Size of header.
+		 * @return Class-specific disc format ID (>= 0) if supported; -1 if not.
+		 */
+		virtual int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const override;
+
+	public:
+		/**
+		 * Is the disc image open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the disc image is open; false if it isn't.
+		 */
+		virtual bool isOpen(void) const override;
+
+		/**
+		 * Read data from the disc image.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t read(void *ptr, size_t size) override;
+
+		/**
+		 * Set the disc image position.
+		 * @param pos Disc image position.
+		 * @return 0 on success; -1 on error.
+		 */
+		virtual int seek(int64_t pos) override;
+
+		/**
+		 * Seek to the beginning of the disc image.
+		 */
+		virtual void rewind(void) override;
+
+		/**
+		 * Get the disc image position.
+		 * @return Disc image position on success; -1 on error.
+		 */
+		virtual int64_t tell(void) override final;
+
+		/**
+		 * Get the disc image size.
+		 * @return Disc image size, or -1 on error.
+		 */
+		virtual int64_t size(void) override;
+
+		/**
+		 * Read data from the specified position in the disc image.
+		 * Reads that cross a part boundary are split between
+		 * the parts and read directly into the output buffer.
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override;
+
+		/**
+		 * Read data from multiple locations in the disc image.
+		 * Requests within a single part are forwarded to that
+		 * part's IRpFile::readv().
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(IRpFile::ReadRequest *reqs, unsigned int count) override;
+
+	public:
+		/**
+		 * Get the number of parts.
+		 * @return Number of parts, or 0 if the disc image isn't open.
+		 */
+		unsigned int partCount(void) const;
+
+		/**
+		 * Check if a filename uses a known split naming scheme.
+		 * This doesn't check if the other parts exist.
+		 * @param filename Filename.
+		 * @return True if the filename is the first part of a split disc image.
+		 */
+		static bool isSplitFilename(const std::string &filename);
+
+	protected:
+		/**
+		 * Find the part containing a disc image position.
+		 * @param pos Disc image position. (Must be in range!)
+		 * @return Part index.
+		 */
+		unsigned int findPart(int64_t pos) const;
+
+	protected:
+		// Part files.
+		std::vector<IRpFile*> m_files;
+
+		// Starting position of each part.
+		// Has one more entry than m_files; the last
+		// entry is the total size of the disc image.
+		std::vector<int64_t> m_partStart;
+
+		int64_t m_pos;		// Read position.
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_SPLITDISCREADER_HPP__ */
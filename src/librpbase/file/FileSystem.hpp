@@ -122,6 +122,26 @@ int set_mtime(const std::string &filename, time_t mtime);
  */
 int get_mtime(const std::string &filename, time_t *pMtime);
 
+/**
+ * File identity.
+ * Used to determine if a file has been modified or replaced
+ * without having to open it.
+ */
+struct FileIdentity {
+	int64_t size;		// File size.
+	time_t mtime;		// Modification time.
+	uint64_t device;	// Device ID. (Windows: Volume serial number)
+	uint64_t inode;		// Inode number. (Windows: File index)
+};
+
+/**
+ * Get the identity of a file.
+ * @param filename Filename.
+ * @param pIdent Buffer for the file identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const std::string &filename, FileIdentity *pIdent);
+
 /**
  * Delete a file.
  * @param filename Filename.
@@ -139,6 +159,30 @@ static inline int delete_file(const std::string &filename)
 	return delete_file(filename.c_str());
 }
 
+/**
+ * Rename a file, replacing the destination if it exists.
+ * On POSIX systems, the replacement is atomic.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename_file(const std::string &oldname, const std::string &newname);
+
+/**
+ * Check if a file is on a local, fixed filesystem.
+ *
+ * Files on network shares (and, on Windows, removable drives)
+ * may disappear while they're open. This can be used to decide
+ * if it's safe to memory-map a file.
+ *
+ * NOTE: On Linux, removable media can't be distinguished from
+ * fixed disks, so only network filesystems are excluded.
+ *
+ * @param filename Filename.
+ * @return True if the file is on a local filesystem; false if not, or on error.
+ */
+bool is_on_local_fs(const std::string &filename);
+
 /**
  * Get the file extension from a filename or pathname.
  * @param filename Filename.
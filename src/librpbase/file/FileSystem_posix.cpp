@@ -30,10 +30,17 @@
 #include "threads/pthread_once.h"
 
 // C includes.
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <utime.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
 
 // C includes. (C++ namespace)
 #include <cstring>
@@ -248,6 +255,32 @@ int get_mtime(const string &filename, time_t *pMtime)
 	return (ret == 0 ? 0 : -errno);
 }
 
+/**
+ * Get the identity of a file.
+ * @param filename Filename.
+ * @param pIdent Buffer for the file identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const string &filename, FileIdentity *pIdent)
+{
+	if (!pIdent)
+		return -EINVAL;
+
+	struct stat buf;
+	int ret = stat(RP2U8_s(filename), &buf);
+	if (ret != 0) {
+		// stat() failed.
+		ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	pIdent->size = buf.st_size;
+	pIdent->mtime = buf.st_mtime;
+	pIdent->device = buf.st_dev;
+	pIdent->inode = buf.st_ino;
+	return 0;
+}
+
 /**
  * Delete a file.
  * @param filename Filename.
@@ -267,6 +300,82 @@ int delete_file(const char *filename)
 	return ret;
 }
 
+/**
+ * Rename a file, replacing the destination if it exists.
+ * On POSIX systems, the replacement is atomic.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename_file(const string &oldname, const string &newname)
+{
+	if (unlikely(oldname.empty() || newname.empty()))
+		return -EINVAL;
+
+	int ret = rename(RP2U8_s(oldname), RP2U8_s(newname));
+	if (ret != 0) {
+		// Error renaming the file.
+		ret = -errno;
+	}
+
+	return ret;
+}
+
+/**
+ * Check if a file is on a local, fixed filesystem.
+ *
+ * Files on network shares (and, on Windows, removable drives)
+ * may disappear while they're open. This can be used to decide
+ * if it's safe to memory-map a file.
+ *
+ * NOTE: On Linux, removable media can't be distinguished from
+ * fixed disks, so only network filesystems are excluded.
+ *
+ * @param filename Filename.
+ * @return True if the file is on a local filesystem; false if not, or on error.
+ */
+bool is_on_local_fs(const string &filename)
+{
+	if (unlikely(filename.empty()))
+		return false;
+
+#if defined(__linux__)
+	struct statfs sfbuf;
+	if (statfs(RP2U8_s(filename), &sfbuf) != 0)
+		return false;
+
+	// Network and userspace filesystems.
+	// Reference: statfs(2)
+	switch ((uint32_t)sfbuf.f_type) {
+		case 0x6969:		// NFS_SUPER_MAGIC
+		case 0x517B:		// SMB_SUPER_MAGIC
+		case 0xFE534D42:	// SMB2_MAGIC_NUMBER
+		case 0xFF534D42:	// CIFS_MAGIC_NUMBER
+		case 0x5346414F:	// AFS_SUPER_MAGIC
+		case 0x6B414653:	// AFS_FS_MAGIC
+		case 0x01021997:	// V9FS_MAGIC
+		case 0x65735546:	// FUSE_SUPER_MAGIC
+		case 0x564C:		// NCP_SUPER_MAGIC
+		case 0x73757245:	// CODA_SUPER_MAGIC
+		case 0x7461636F:	// OCFS2_SUPER_MAGIC
+		case 0x47504653:	// GPFS_SUPER_MAGIC
+		case 0x00C36400:	// CEPH_SUPER_MAGIC
+			return false;
+		default:
+			break;
+	}
+	return true;
+#elif defined(MNT_LOCAL)
+	struct statfs sfbuf;
+	if (statfs(RP2U8_s(filename), &sfbuf) != 0)
+		return false;
+	return !!(sfbuf.f_flags & MNT_LOCAL);
+#else
+	// Unknown system. Assume the file isn't local.
+	return false;
+#endif
+}
+
 /**
  * Check if the specified file is a symbolic link.
  * @return True if the file is a symbolic link; false if not.
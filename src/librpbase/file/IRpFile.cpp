@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 #include "IRpFile.hpp"
+#include "../threads/Mutex.hpp"
 
 // C includes. (C++ namespace)
 #include <cstdio>
@@ -28,8 +29,14 @@ namespace LibRpBase {
 
 IRpFile::IRpFile()
 	: m_lastError(0)
+	, m_preadMutex(new Mutex())
 { }
 
+IRpFile::~IRpFile()
+{
+	delete m_preadMutex;
+}
+
 /**
  * Get the last error.
  * @return Last POSIX error, or 0 if no error.
@@ -99,4 +106,93 @@ size_t IRpFile::seekAndRead(int64_t pos, void *ptr, size_t size)
 	return this->read(ptr, size);
 }
 
+/** Positional I/O. **/
+
+/**
+ * Read data from the specified position in the file.
+ *
+ * Unlike seekAndRead(), this does not use the file position,
+ * so it's safe to call from multiple threads on the same file
+ * (or on dup()'d copies of it) at the same time.
+ *
+ * The default implementation uses seek() and read() while
+ * holding a per-object mutex, and restores the file position
+ * afterwards. It's serialized against other pread() calls
+ * on this object, but not against read() calls from other
+ * threads or against pread() calls on dup()'d copies.
+ * Subclasses whose dup()'d copies share a file position
+ * should reimplement this function.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IRpFile::pread(int64_t pos, void *ptr, size_t size)
+{
+	MutexLocker preadLock(*m_preadMutex);
+
+	const int64_t prev_pos = this->tell();
+	size_t ret = seekAndRead(pos, ptr, size);
+	if (prev_pos >= 0) {
+		this->seek(prev_pos);
+	}
+	return ret;
+}
+
+/** Vectored I/O. **/
+
+/**
+ * Read data from multiple locations in the file.
+ *
+ * The requests don't need to be sorted. Implementations
+ * may reorder and coalesce them in order to reduce the
+ * number of system calls.
+ *
+ * The default implementation calls seekAndRead()
+ * for each request.
+ *
+ * NOTE: The file position is undefined afterwards.
+ *
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int IRpFile::readv(ReadRequest *reqs, unsigned int count)
+{
+	unsigned int complete = 0;
+	for (; count > 0; reqs++, count--) {
+		reqs->ret = seekAndRead(reqs->pos, reqs->ptr, reqs->size);
+		if (reqs->ret == reqs->size) {
+			complete++;
+		}
+	}
+	return complete;
+}
+
+/** Zero-copy access. **/
+
+/**
+ * Get a read-only pointer to a region of the file.
+ *
+ * This is only supported by memory-backed files, e.g.
+ * RpMemFile and RpMmapFile. If it isn't supported, or
+ * if the region is out of bounds, nullptr is returned,
+ * and the caller should use seekAndRead() instead.
+ *
+ * The pointer remains valid until this IRpFile object
+ * (and all of its dup()'d copies) are closed.
+ *
+ * @param pos	[in] Start address.
+ * @param size	[in] Size of the region, in bytes.
+ * @return Pointer to the region, or nullptr if it can't be mapped.
+ */
+const void *IRpFile::map(int64_t pos, size_t size)
+{
+	// Not supported by default.
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return nullptr;
+}
+
 }
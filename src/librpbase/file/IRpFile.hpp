@@ -36,12 +36,14 @@
 
 namespace LibRpBase {
 
+class Mutex;
+
 class IRpFile
 {
 	protected:
 		IRpFile();
 	public:
-		virtual ~IRpFile() { }
+		virtual ~IRpFile();
 
 	private:
 		RP_DISABLE_COPY(IRpFile)
@@ -172,8 +174,88 @@ class IRpFile
 		 */
 		size_t seekAndRead(int64_t pos, void *ptr, size_t size);
 
+	public:
+		/** Positional I/O. **/
+
+		/**
+		 * Read data from the specified position in the file.
+		 *
+		 * Unlike seekAndRead(), this does not use the file position,
+		 * so it's safe to call from multiple threads on the same file
+		 * (or on dup()'d copies of it) at the same time.
+		 *
+		 * The default implementation uses seek() and read() while
+		 * holding a per-object mutex, and restores the file position
+		 * afterwards. It's serialized against other pread() calls
+		 * on this object, but not against read() calls from other
+		 * threads or against pread() calls on dup()'d copies.
+		 * Subclasses whose dup()'d copies share a file position
+		 * should reimplement this function.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size);
+
+	public:
+		/** Vectored I/O. **/
+
+		/**
+		 * Read request for readv().
+		 */
+		struct ReadRequest {
+			int64_t pos;	// [in] File position.
+			void *ptr;	// [out] Output data buffer.
+			size_t size;	// [in] Amount of data to read, in bytes.
+			size_t ret;	// [out] Number of bytes read.
+		};
+
+		/**
+		 * Read data from multiple locations in the file.
+		 *
+		 * The requests don't need to be sorted. Implementations
+		 * may reorder and coalesce them in order to reduce the
+		 * number of system calls.
+		 *
+		 * The default implementation calls seekAndRead()
+		 * for each request.
+		 *
+		 * NOTE: The file position is undefined afterwards.
+		 *
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(ReadRequest *reqs, unsigned int count);
+
+	public:
+		/** Zero-copy access. **/
+
+		/**
+		 * Get a read-only pointer to a region of the file.
+		 *
+		 * This is only supported by memory-backed files, e.g.
+		 * RpMemFile and RpMmapFile. If it isn't supported, or
+		 * if the region is out of bounds, nullptr is returned,
+		 * and the caller should use seekAndRead() instead.
+		 *
+		 * The pointer remains valid until this IRpFile object
+		 * (and all of its dup()'d copies) are closed.
+		 *
+		 * @param pos	[in] Start address.
+		 * @param size	[in] Size of the region, in bytes.
+		 * @return Pointer to the region, or nullptr if it can't be mapped.
+		 */
+		virtual const void *map(int64_t pos, size_t size);
+
 	protected:
 		int m_lastError;
+
+	private:
+		// Serializes the default pread() implementation.
+		Mutex *m_preadMutex;
 };
 
 }
@@ -153,7 +153,45 @@ class RpFile : public IRpFile
 		 */
 		virtual std::string filename(void) const override final;
 
+	public:
+		/** Positional I/O. **/
+
+		/**
+		 * Read data from the specified position in the file.
+		 *
+		 * On POSIX systems, this uses pread(), so it's thread-safe,
+		 * and the file position is not changed.
+		 *
+		 * On Windows, this uses ReadFile() with the position set in
+		 * an OVERLAPPED struct, so it's thread-safe, but the file
+		 * position (which is shared with dup()'d copies) is moved
+		 * to the end of the data that was read.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override final;
+
 #ifndef _WIN32
+	public:
+		/** Vectored I/O. **/
+
+		/**
+		 * Read data from multiple locations in the file.
+		 *
+		 * The requests are sorted by file position, and adjacent
+		 * requests are coalesced into a single preadv() call.
+		 *
+		 * NOTE: The file position is not changed.
+		 *
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(ReadRequest *reqs, unsigned int count) override final;
+
 	protected:
 		// On non-Windows platforms, m_file is an stdio FILE.
 		// TODO: Move to a private class?
@@ -50,6 +50,17 @@ typedef char mode_str_t;
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_PREADV
+// preadv()
+# include <sys/uio.h>
+# include <climits>
+# include <algorithm>
+# include <memory>
+# include <vector>
+using std::unique_ptr;
+using std::vector;
+#endif /* HAVE_PREADV */
+
 namespace LibRpBase {
 
 // Deleter for std::unique_ptr<FILE> m_file.
@@ -384,4 +395,213 @@ string RpFile::filename(void) const
 	return m_filename;
 }
 
+#ifndef _WIN32
+/** Positional I/O. **/
+
+/**
+ * Read data from the specified position in the file.
+ * This uses pread(), so it's thread-safe, and the
+ * file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::pread(int64_t pos, void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (m_mode & FM_WRITE) {
+		// Make sure buffered writes are visible to pread().
+		::fflush(m_file.get());
+	}
+	const int fd = fileno(m_file.get());
+
+	// pread() may return less data than requested,
+	// so keep reading until we hit EOF or an error.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		ssize_t n = ::pread(fd, ptr8, size, pos);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			// Read error.
+			m_lastError = errno;
+			break;
+		} else if (n == 0) {
+			// End of file.
+			break;
+		}
+
+		ptr8 += n;
+		pos += n;
+		size -= (size_t)n;
+		ret += (size_t)n;
+	}
+	return ret;
+}
+
+/** Vectored I/O. **/
+
+#ifdef HAVE_PREADV
+// Maximum number of iovecs per preadv() call.
+#if defined(IOV_MAX) && IOV_MAX < 64
+# define READV_MAX_IOV IOV_MAX
+#else
+# define READV_MAX_IOV 64
+#endif
+
+// Maximum gap between two requests that will be coalesced.
+// The gap is read into a scratch buffer and discarded.
+#define READV_MAX_GAP (32*1024)
+#endif /* HAVE_PREADV */
+
+/**
+ * Read data from multiple locations in the file.
+ *
+ * The requests are sorted by file position, and adjacent
+ * requests are coalesced into a single preadv() call.
+ *
+ * NOTE: The file position is not changed.
+ *
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int RpFile::readv(ReadRequest *reqs, unsigned int count)
+{
+#ifndef HAVE_PREADV
+	// preadv() isn't available.
+	return super::readv(reqs, count);
+#else /* HAVE_PREADV */
+	if (!m_file) {
+		m_lastError = EBADF;
+		for (unsigned int i = 0; i < count; i++) {
+			reqs[i].ret = 0;
+		}
+		return 0;
+	}
+
+	if (m_mode & FM_WRITE) {
+		// Make sure buffered writes are visible to preadv().
+		::fflush(m_file.get());
+	}
+	const int fd = fileno(m_file.get());
+
+	// Sort the requests by file position.
+	vector<ReadRequest*> sorted(count);
+	for (unsigned int i = 0; i < count; i++) {
+		sorted[i] = &reqs[i];
+	}
+	std::sort(sorted.begin(), sorted.end(),
+		[](const ReadRequest *a, const ReadRequest *b) {
+			return (a->pos < b->pos);
+		});
+
+	// Scratch buffer for gaps between coalesced requests.
+	// Allocated on demand.
+	unique_ptr<uint8_t[]> gapBuf;
+
+	unsigned int complete = 0;
+	struct iovec iov[READV_MAX_IOV];
+	unsigned int i = 0;
+	while (i < count) {
+		ReadRequest *const first = sorted[i];
+		if (first->pos < 0) {
+			// Invalid position.
+			first->ret = 0;
+			if (first->size == 0) {
+				complete++;
+			}
+			i++;
+			continue;
+		}
+
+		// Coalesce requests until there's an overlap,
+		// a gap that's too large, or we run out of iovecs.
+		int iovcnt = 0;
+		int64_t end = first->pos;
+		unsigned int j = i;
+		for (; j < count && iovcnt < READV_MAX_IOV-1; j++) {
+			ReadRequest *const req = sorted[j];
+			const int64_t gap = req->pos - end;
+			if (gap < 0 || gap > READV_MAX_GAP) {
+				// Overlapping request, or the gap is too large.
+				break;
+			} else if (gap > 0) {
+				// Read the gap into the scratch buffer.
+				if (!gapBuf) {
+					gapBuf.reset(new uint8_t[READV_MAX_GAP]);
+				}
+				iov[iovcnt].iov_base = gapBuf.get();
+				iov[iovcnt].iov_len = (size_t)gap;
+				iovcnt++;
+			}
+
+			iov[iovcnt].iov_base = req->ptr;
+			iov[iovcnt].iov_len = req->size;
+			iovcnt++;
+			end = req->pos + req->size;
+		}
+
+		// preadv() may return a short read, e.g. if it was
+		// interrupted by a signal after reading some data.
+		// Keep reading until EOF or an error occurs.
+		uint64_t n = 0;
+		struct iovec *piov = iov;
+		while (iovcnt > 0) {
+			const ssize_t rd = preadv(fd, piov, iovcnt, first->pos + (int64_t)n);
+			if (rd < 0) {
+				if (errno == EINTR)
+					continue;
+				// Read error.
+				m_lastError = errno;
+				break;
+			} else if (rd == 0) {
+				// End of file.
+				break;
+			}
+			n += (uint64_t)rd;
+
+			// Skip the iovecs that were read completely.
+			size_t done = (size_t)rd;
+			while (iovcnt > 0 && done >= piov->iov_len) {
+				done -= piov->iov_len;
+				piov++;
+				iovcnt--;
+			}
+			if (iovcnt > 0) {
+				piov->iov_base = static_cast<uint8_t*>(piov->iov_base) + done;
+				piov->iov_len -= done;
+			}
+		}
+
+		// Determine how much data was read for each request.
+		for (; i < j; i++) {
+			ReadRequest *const req = sorted[i];
+			const uint64_t offset = (uint64_t)(req->pos - first->pos);
+			if (n <= offset) {
+				req->ret = 0;
+			} else {
+				const uint64_t avail = n - offset;
+				req->ret = (avail < req->size ? (size_t)avail : req->size);
+			}
+			if (req->ret == req->size) {
+				complete++;
+			}
+		}
+	}
+
+	return complete;
+#endif /* HAVE_PREADV */
+}
+#endif /* !_WIN32 */
+
 }
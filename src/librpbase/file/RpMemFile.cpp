@@ -244,4 +244,108 @@ string RpMemFile::filename(void) const
 	return string();
 }
 
+/** Positional I/O. **/
+
+/**
+ * Read data from the specified position in the file.
+ * This is thread-safe, and the file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpMemFile::pread(int64_t pos, void *ptr, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (pos < 0 || (uint64_t)pos >= (uint64_t)m_size) {
+		// Out of bounds.
+		return 0;
+	}
+
+	// Copy whatever's available.
+	// Convert the const void* to a const uint8_t*.
+	const uint8_t *const buf = static_cast<const uint8_t*>(m_buf);
+
+	if (size > m_size - (size_t)pos) {
+		size = m_size - (size_t)pos;
+	}
+	memcpy(ptr, &buf[(size_t)pos], size);
+	return size;
+}
+
+/** Vectored I/O. **/
+
+/**
+ * Read data from multiple locations in the file.
+ * NOTE: The file position is not changed.
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int RpMemFile::readv(ReadRequest *reqs, unsigned int count)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		for (; count > 0; reqs++, count--) {
+			reqs->ret = 0;
+		}
+		return 0;
+	}
+
+	// Convert the const void* to a const uint8_t*.
+	const uint8_t *const buf = static_cast<const uint8_t*>(m_buf);
+
+	unsigned int complete = 0;
+	for (; count > 0; reqs++, count--) {
+		if (reqs->pos < 0 || (uint64_t)reqs->pos >= (uint64_t)m_size) {
+			// Out of bounds.
+			reqs->ret = 0;
+			if (reqs->size == 0) {
+				complete++;
+			}
+			continue;
+		}
+
+		// Copy whatever's available.
+		const size_t pos = (size_t)reqs->pos;
+		size_t size = reqs->size;
+		if (size > m_size - pos) {
+			size = m_size - pos;
+		}
+		memcpy(reqs->ptr, &buf[pos], size);
+		reqs->ret = size;
+		if (size == reqs->size) {
+			complete++;
+		}
+	}
+	return complete;
+}
+
+/** Zero-copy access. **/
+
+/**
+ * Get a read-only pointer to a region of the file.
+ * @param pos	[in] Start address.
+ * @param size	[in] Size of the region, in bytes.
+ * @return Pointer to the region, or nullptr if it's out of bounds.
+ */
+const void *RpMemFile::map(int64_t pos, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+
+	if (pos < 0 || (uint64_t)pos > (uint64_t)m_size || size > m_size - (size_t)pos) {
+		// Out of bounds.
+		return nullptr;
+	}
+
+	return static_cast<const uint8_t*>(m_buf) + (size_t)pos;
+}
+
 }
@@ -125,6 +125,42 @@ class RpMemFile : public IRpFile
 		 */
 		virtual std::string filename(void) const override final;
 
+	public:
+		/** Positional I/O. **/
+
+		/**
+		 * Read data from the specified position in the file.
+		 * This is thread-safe, and the file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override final;
+
+	public:
+		/** Vectored I/O. **/
+
+		/**
+		 * Read data from multiple locations in the file.
+		 * NOTE: The file position is not changed.
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(ReadRequest *reqs, unsigned int count) override final;
+
+	public:
+		/** Zero-copy access. **/
+
+		/**
+		 * Get a read-only pointer to a region of the file.
+		 * @param pos	[in] Start address.
+		 * @param size	[in] Size of the region, in bytes.
+		 * @return Pointer to the region, or nullptr if it's out of bounds.
+		 */
+		virtual const void *map(int64_t pos, size_t size) override final;
+
 	protected:
 		const void *m_buf;	// Memory buffer.
 		size_t m_size;		// Size of memory buffer.
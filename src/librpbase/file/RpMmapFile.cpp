@@ -0,0 +1,549 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RpMmapFile.cpp: IRpFile implementation using a memory-mapped file.      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "RpMmapFile.hpp"
+
+#ifdef _WIN32
+# include "TextFuncs.hpp"
+# include "libwin32common/RpWin32_sdk.h"
+# include "libwin32common/w32err.h"
+# include <cctype>
+#else /* !_WIN32 */
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif /* _WIN32 */
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+using std::string;
+#ifdef _WIN32
+using std::wstring;
+#endif /* _WIN32 */
+
+namespace LibRpBase {
+
+/**
+ * Mapped region.
+ * The mapping is released when the last
+ * RpMmapFile referencing it is closed.
+ */
+struct RpMmapFile::MmapRegion
+{
+	void *addr;
+	size_t size;
+#ifdef _WIN32
+	HANDLE hMapping;
+#endif /* _WIN32 */
+
+	MmapRegion()
+		: addr(nullptr), size(0)
+#ifdef _WIN32
+		, hMapping(nullptr)
+#endif /* _WIN32 */
+	{ }
+
+	~MmapRegion()
+	{
+#ifdef _WIN32
+		if (addr) {
+			UnmapViewOfFile(addr);
+		}
+		if (hMapping) {
+			CloseHandle(hMapping);
+		}
+#else /* !_WIN32 */
+		if (addr) {
+			munmap(addr, size);
+		}
+#endif /* _WIN32 */
+	}
+
+	/**
+	 * Map a file.
+	 * @param filename Filename.
+	 * @return 0 on success; positive POSIX error code on error.
+	 */
+	int open(const string &filename);
+
+	private:
+		RP_DISABLE_COPY(MmapRegion)
+};
+
+#ifdef _WIN32
+/**
+ * Map a file.
+ * @param filename Filename.
+ * @return 0 on success; positive POSIX error code on error.
+ */
+int RpMmapFile::MmapRegion::open(const string &filename)
+{
+	// Unicode filename.
+	wstring filenameW;
+	if (filename.size() > 3 &&
+	    isascii(filename[0]) && isalpha(filename[0]) &&
+	    filename[1] == ':' && filename[2] == '\\')
+	{
+		// Absolute path.
+		// Prepend "\\?\" in order to support filenames longer than MAX_PATH.
+		filenameW = L"\\\\?\\";
+		filenameW += RP2W_s(filename);
+	} else {
+		// Not an absolute path, or "\\?\" is already
+		// prepended. Use it as-is.
+		// NOTE: Drive letters (block devices) can't be mapped.
+		if (filename.size() == 3 && filename[1] == ':') {
+			return ENOTSUP;
+		}
+		filenameW = RP2W_s(filename);
+	}
+
+	HANDLE hFile = CreateFile(filenameW.c_str(),
+		GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		return w32err_to_posix(GetLastError());
+	}
+
+	LARGE_INTEGER liFileSize;
+	if (!GetFileSizeEx(hFile, &liFileSize)) {
+		int err = w32err_to_posix(GetLastError());
+		CloseHandle(hFile);
+		return err;
+	}
+	if (liFileSize.QuadPart <= 0 || (uint64_t)liFileSize.QuadPart > (uint64_t)SIZE_MAX) {
+		// Empty files can't be mapped, and files larger
+		// than the address space can't be mapped fully.
+		CloseHandle(hFile);
+		return (liFileSize.QuadPart <= 0 ? EINVAL : EFBIG);
+	}
+
+	hMapping = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// The file mapping object keeps its own reference to the file.
+	CloseHandle(hFile);
+	if (!hMapping) {
+		return w32err_to_posix(GetLastError());
+	}
+
+	addr = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!addr) {
+		int err = w32err_to_posix(GetLastError());
+		CloseHandle(hMapping);
+		hMapping = nullptr;
+		return err;
+	}
+
+	size = (size_t)liFileSize.QuadPart;
+	return 0;
+}
+#else /* !_WIN32 */
+/**
+ * Map a file.
+ * @param filename Filename.
+ * @return 0 on success; positive POSIX error code on error.
+ */
+int RpMmapFile::MmapRegion::open(const string &filename)
+{
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return errno;
+	}
+
+	struct stat sb;
+	if (fstat(fd, &sb) != 0) {
+		int err = errno;
+		::close(fd);
+		return err;
+	}
+	if (!S_ISREG(sb.st_mode)) {
+		// Only regular files can be mapped.
+		::close(fd);
+		return (S_ISDIR(sb.st_mode) ? EISDIR : ENOTSUP);
+	}
+	if (sb.st_size <= 0 || (uint64_t)sb.st_size > (uint64_t)SIZE_MAX) {
+		// Empty files can't be mapped, and files larger
+		// than the address space can't be mapped fully.
+		::close(fd);
+		return (sb.st_size <= 0 ? EINVAL : EFBIG);
+	}
+
+	void *const p = mmap(nullptr, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file.
+	::close(fd);
+	if (p == MAP_FAILED) {
+		return errno;
+	}
+
+	addr = p;
+	size = (size_t)sb.st_size;
+	return 0;
+}
+#endif /* _WIN32 */
+
+/** RpMmapFile **/
+
+/**
+ * Open a file and map it into memory.
+ * The resulting IRpFile is read-only.
+ * @param filename Filename.
+ */
+RpMmapFile::RpMmapFile(const char *filename)
+	: super()
+	, m_buf(nullptr)
+	, m_size(0)
+	, m_pos(0)
+	, m_filename(filename)
+{
+	init();
+}
+
+/**
+ * Open a file and map it into memory.
+ * The resulting IRpFile is read-only.
+ * @param filename Filename.
+ */
+RpMmapFile::RpMmapFile(const string &filename)
+	: super()
+	, m_buf(nullptr)
+	, m_size(0)
+	, m_pos(0)
+	, m_filename(filename)
+{
+	init();
+}
+
+/**
+ * Common initialization function for RpMmapFile's constructors.
+ * Filename must be set in m_filename.
+ */
+void RpMmapFile::init(void)
+{
+	std::shared_ptr<MmapRegion> region(new MmapRegion());
+	int err = region->open(m_filename);
+	if (err != 0) {
+		// Unable to map the file.
+		m_lastError = err;
+		return;
+	}
+
+	m_region = region;
+	m_buf = static_cast<const uint8_t*>(region->addr);
+	m_size = region->size;
+}
+
+/**
+ * Copy constructor.
+ * @param other Other instance.
+ */
+RpMmapFile::RpMmapFile(const RpMmapFile &other)
+	: super()
+	, m_region(other.m_region)
+	, m_buf(other.m_buf)
+	, m_size(other.m_size)
+	, m_pos(0)
+	, m_filename(other.m_filename)
+{
+	m_lastError = other.m_lastError;
+}
+
+/**
+ * Assignment operator.
+ * @param other Other instance.
+ * @return This instance.
+ */
+RpMmapFile &RpMmapFile::operator=(const RpMmapFile &other)
+{
+	m_region = other.m_region;
+	m_buf = other.m_buf;
+	m_size = other.m_size;
+	m_pos = 0;
+	m_filename = other.m_filename;
+	m_lastError = other.m_lastError;
+	return *this;
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool RpMmapFile::isOpen(void) const
+{
+	return (m_buf != nullptr);
+}
+
+/**
+ * dup() the file handle.
+ *
+ * Needed because IRpFile* objects are typically
+ * pointers, not actual instances of the object.
+ *
+ * NOTE: For RpMmapFile, the mapping is shared,
+ * but the file position is not.
+ *
+ * @return dup()'d file, or nullptr on error.
+ */
+IRpFile *RpMmapFile::dup(void)
+{
+	return new RpMmapFile(*this);
+}
+
+/**
+ * Close the file.
+ */
+void RpMmapFile::close(void)
+{
+	m_region.reset();
+	m_buf = nullptr;
+	m_size = 0;
+	m_pos = 0;
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpMmapFile::read(void *ptr, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	if (size > m_size - m_pos) {
+		// Not enough data.
+		// Copy whatever's left in the buffer.
+		size = m_size - m_pos;
+	}
+
+	if (size > 0) {
+		// Copy the data.
+		memcpy(ptr, &m_buf[m_pos], size);
+		m_pos += size;
+	}
+
+	return size;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for RpMmapFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t RpMmapFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for RpMmapFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int RpMmapFile::seek(int64_t pos)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	// NOTE: m_pos is size_t, since it's referring to
+	// a position within the mapping.
+	if (pos <= 0) {
+		m_pos = 0;
+	} else if ((uint64_t)pos >= (uint64_t)m_size) {
+		m_pos = m_size;
+	} else {
+		m_pos = (size_t)pos;
+	}
+
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+int64_t RpMmapFile::tell(void)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return (int64_t)m_pos;
+}
+
+/**
+ * Truncate the file.
+ * (NOTE: Not valid for RpMmapFile; this will always return -1.)
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int RpMmapFile::truncate(int64_t size)
+{
+	// Not supported.
+	RP_UNUSED(size);
+	m_lastError = ENOTSUP;
+	return -1;
+}
+
+/** File properties. **/
+
+/**
+ * Get the file size.
+ * @return File size, or negative on error.
+ */
+int64_t RpMmapFile::size(void)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return (int64_t)m_size;
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string RpMmapFile::filename(void) const
+{
+	return m_filename;
+}
+
+/** Positional I/O. **/
+
+/**
+ * Read data from the specified position in the file.
+ * This is thread-safe, and the file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpMmapFile::pread(int64_t pos, void *ptr, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (pos < 0 || (uint64_t)pos >= (uint64_t)m_size) {
+		// Out of bounds.
+		return 0;
+	}
+
+	// Copy whatever's available.
+	if (size > m_size - (size_t)pos) {
+		size = m_size - (size_t)pos;
+	}
+	memcpy(ptr, &m_buf[(size_t)pos], size);
+	return size;
+}
+
+/** Vectored I/O. **/
+
+/**
+ * Read data from multiple locations in the file.
+ * NOTE: The file position is not changed.
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int RpMmapFile::readv(ReadRequest *reqs, unsigned int count)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		for (; count > 0; reqs++, count--) {
+			reqs->ret = 0;
+		}
+		return 0;
+	}
+
+	unsigned int complete = 0;
+	for (; count > 0; reqs++, count--) {
+		if (reqs->pos < 0 || (uint64_t)reqs->pos >= (uint64_t)m_size) {
+			// Out of bounds.
+			reqs->ret = 0;
+			if (reqs->size == 0) {
+				complete++;
+			}
+			continue;
+		}
+
+		// Copy whatever's available.
+		const size_t pos = (size_t)reqs->pos;
+		size_t size = reqs->size;
+		if (size > m_size - pos) {
+			size = m_size - pos;
+		}
+		memcpy(reqs->ptr, &m_buf[pos], size);
+		reqs->ret = size;
+		if (size == reqs->size) {
+			complete++;
+		}
+	}
+	return complete;
+}
+
+/** Zero-copy access. **/
+
+/**
+ * Get a read-only pointer to a region of the file.
+ * @param pos	[in] Start address.
+ * @param size	[in] Size of the region, in bytes.
+ * @return Pointer to the region, or nullptr if it's out of bounds.
+ */
+const void *RpMmapFile::map(int64_t pos, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+
+	if (pos < 0 || (uint64_t)pos > (uint64_t)m_size || size > m_size - (size_t)pos) {
+		// Out of bounds.
+		return nullptr;
+	}
+
+	return &m_buf[(size_t)pos];
+}
+
+}
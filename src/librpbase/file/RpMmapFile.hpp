@@ -0,0 +1,194 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RpMmapFile.hpp: IRpFile implementation using a memory-mapped file.      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_RPMMAPFILE_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_RPMMAPFILE_HPP__
+
+#include "IRpFile.hpp"
+
+// C++ includes.
+#include <memory>
+#include <string>
+
+namespace LibRpBase {
+
+class RpMmapFile : public IRpFile
+{
+	public:
+		/**
+		 * Open a file and map it into memory.
+		 * The resulting IRpFile is read-only.
+		 *
+		 * The entire file is mapped, so reads don't require
+		 * any system calls, and map() returns pointers into
+		 * the mapping directly.
+		 *
+		 * If the file can't be mapped (e.g. it's empty, it's a
+		 * device, or it's too large for the address space),
+		 * isOpen() will return false, and the caller should
+		 * fall back to RpFile.
+		 *
+		 * NOTE: If the file is truncated by another process
+		 * while it's mapped, accessing the truncated region
+		 * may result in SIGBUS (or an access violation).
+		 *
+		 * @param filename Filename.
+		 */
+		explicit RpMmapFile(const char *filename);
+		explicit RpMmapFile(const std::string &filename);
+	private:
+		void init(void);
+
+	private:
+		typedef IRpFile super;
+	public:
+		RpMmapFile(const RpMmapFile &other);
+		RpMmapFile &operator=(const RpMmapFile &other);
+
+	public:
+		/**
+		 * Is the file open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		virtual bool isOpen(void) const override final;
+
+		/**
+		 * dup() the file handle.
+		 *
+		 * Needed because IRpFile* objects are typically
+		 * pointers, not actual instances of the object.
+		 *
+		 * NOTE: For RpMmapFile, the mapping is shared,
+		 * but the file position is not.
+		 *
+		 * @return dup()'d file, or nullptr on error.
+		 */
+		virtual IRpFile *dup(void) override final;
+
+		/**
+		 * Close the file.
+		 */
+		virtual void close(void) override final;
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t read(void *ptr, size_t size) override final;
+
+		/**
+		 * Write data to the file.
+		 * (NOTE: Not valid for RpMmapFile; this will always return 0.)
+		 * @param ptr Input data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes written.
+		 */
+		virtual size_t write(const void *ptr, size_t size) override final;
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		virtual int seek(int64_t pos) override final;
+
+		/**
+		 * Get the file position.
+		 * @return File position, or -1 on error.
+		 */
+		virtual int64_t tell(void) override final;
+
+		/**
+		 * Truncate the file.
+		 * (NOTE: Not valid for RpMmapFile; this will always return -1.)
+		 * @param size New size. (default is 0)
+		 * @return 0 on success; -1 on error.
+		 */
+		virtual int truncate(int64_t size = 0) override final;
+
+	public:
+		/** File properties. **/
+
+		/**
+		 * Get the file size.
+		 * @return File size, or negative on error.
+		 */
+		virtual int64_t size(void) override final;
+
+		/**
+		 * Get the filename.
+		 * @return Filename. (May be empty if the filename is not available.)
+		 */
+		virtual std::string filename(void) const override final;
+
+	public:
+		/** Positional I/O. **/
+
+		/**
+		 * Read data from the specified position in the file.
+		 * This is thread-safe, and the file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(int64_t pos, void *ptr, size_t size) override final;
+
+	public:
+		/** Vectored I/O. **/
+
+		/**
+		 * Read data from multiple locations in the file.
+		 * NOTE: The file position is not changed.
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readv(ReadRequest *reqs, unsigned int count) override final;
+
+	public:
+		/** Zero-copy access. **/
+
+		/**
+		 * Get a read-only pointer to a region of the file.
+		 * @param pos	[in] Start address.
+		 * @param size	[in] Size of the region, in bytes.
+		 * @return Pointer to the region, or nullptr if it's out of bounds.
+		 */
+		virtual const void *map(int64_t pos, size_t size) override final;
+
+	protected:
+		// Mapped region. Shared between dup()'d files.
+		struct MmapRegion;
+		std::shared_ptr<MmapRegion> m_region;
+
+		const uint8_t *m_buf;	// Start of the mapping.
+		size_t m_size;		// Size of the mapping.
+		size_t m_pos;		// Current position.
+		std::string m_filename;	// Filename.
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_RPMMAPFILE_HPP__ */
@@ -370,6 +370,45 @@ int get_mtime(const string &filename, time_t *pMtime)
 	return 0;
 }
 
+/**
+ * Get the identity of a file.
+ * @param filename Filename.
+ * @param pIdent Buffer for the file identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const string &filename, FileIdentity *pIdent)
+{
+	if (!pIdent) {
+		return -EINVAL;
+	}
+	const wstring filenameW = makeWinPath(filename);
+
+	// NOTE: _stati64() doesn't return a usable st_ino on Windows,
+	// so use GetFileInformationByHandle() instead.
+	HANDLE hFile = CreateFile(filenameW.c_str(),
+		FILE_READ_ATTRIBUTES,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		// Error opening the file.
+		return -w32err_to_posix(GetLastError());
+	}
+
+	BY_HANDLE_FILE_INFORMATION bhfi;
+	BOOL bRet = GetFileInformationByHandle(hFile, &bhfi);
+	CloseHandle(hFile);
+	if (!bRet) {
+		// Error getting the file information.
+		return -w32err_to_posix(GetLastError());
+	}
+
+	pIdent->size = ((int64_t)bhfi.nFileSizeHigh << 32) | (int64_t)bhfi.nFileSizeLow;
+	pIdent->mtime = FileTimeToUnixTime(&bhfi.ftLastWriteTime);
+	pIdent->device = bhfi.dwVolumeSerialNumber;
+	pIdent->inode = ((uint64_t)bhfi.nFileIndexHigh << 32) | (uint64_t)bhfi.nFileIndexLow;
+	return 0;
+}
+
 /**
  * Delete a file.
  * @param filename Filename.
@@ -391,6 +430,59 @@ int delete_file(const char *filename)
 	return ret;
 }
 
+/**
+ * Rename a file, replacing the destination if it exists.
+ * On POSIX systems, the replacement is atomic.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename_file(const string &oldname, const string &newname)
+{
+	if (unlikely(oldname.empty() || newname.empty()))
+		return -EINVAL;
+	int ret = 0;
+	const wstring oldnameW = makeWinPath(oldname);
+	const wstring newnameW = makeWinPath(newname);
+
+	BOOL bRet = MoveFileEx(oldnameW.c_str(), newnameW.c_str(), MOVEFILE_REPLACE_EXISTING);
+	if (!bRet) {
+		// Error renaming the file.
+		ret = -w32err_to_posix(GetLastError());
+	}
+
+	return ret;
+}
+
+/**
+ * Check if a file is on a local, fixed filesystem.
+ *
+ * Files on network shares (and, on Windows, removable drives)
+ * may disappear while they're open. This can be used to decide
+ * if it's safe to memory-map a file.
+ *
+ * NOTE: On Linux, removable media can't be distinguished from
+ * fixed disks, so only network filesystems are excluded.
+ *
+ * @param filename Filename.
+ * @return True if the file is on a local filesystem; false if not, or on error.
+ */
+bool is_on_local_fs(const string &filename)
+{
+	// Only drive letter paths are considered local.
+	// UNC paths are always network paths.
+	if (filename.size() < 3 ||
+	    !isascii(filename[0]) || !isalpha(filename[0]) ||
+	    filename[1] != ':' || filename[2] != '\\')
+	{
+		return false;
+	}
+
+	wchar_t szDrivePath[4] = L"X:\\";
+	szDrivePath[0] = (wchar_t)filename[0];
+	return (GetDriveType(szDrivePath) == DRIVE_FIXED);
+}
+
 /**
  * Check if the specified file is a symbolic link.
  * @return True if the file is a symbolic link; false if not.
@@ -102,6 +102,17 @@ class RpFilePrivate
 		 * @return Number of bytes read.
 		 */
 		size_t readUsingBlocks(void *ptr, size_t size);
+
+		/**
+		 * Read data from the specified position using ReadFile()
+		 * with the position set in an OVERLAPPED struct.
+		 * This doesn't handle block device alignment.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t preadOverlapped(int64_t pos, void *ptr, size_t size);
 };
 
 /** RpFilePrivate **/
@@ -289,6 +300,58 @@ size_t RpFilePrivate::readUsingBlocks(void *ptr, size_t size)
 	return ret;
 }
 
+/**
+ * Read data from the specified position using ReadFile()
+ * with the position set in an OVERLAPPED struct.
+ * This doesn't handle block device alignment.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFilePrivate::preadOverlapped(int64_t pos, void *ptr, size_t size)
+{
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	// ReadFile() takes a DWORD size, so read large
+	// requests in 1 GB chunks.
+	static const size_t MAX_CHUNK = 1U << 30;
+	while (size > 0) {
+		const DWORD chunk = (DWORD)(size > MAX_CHUNK ? MAX_CHUNK : size);
+		OVERLAPPED ov;
+		memset(&ov, 0, sizeof(ov));
+		ov.Offset = (DWORD)(pos & 0xFFFFFFFF);
+		ov.OffsetHigh = (DWORD)((uint64_t)pos >> 32);
+
+		DWORD bytesRead = 0;
+		BOOL bRet = ReadFile(file.get(), ptr8, chunk, &bytesRead, &ov);
+		if (!bRet) {
+			// ERROR_HANDLE_EOF is returned if pos is past EOF.
+			const DWORD w32err = GetLastError();
+			if (w32err != ERROR_HANDLE_EOF) {
+				RP_Q(RpFile);
+				q->m_lastError = w32err_to_posix(w32err);
+			}
+			break;
+		} else if (bytesRead == 0) {
+			// End of file.
+			break;
+		}
+
+		ptr8 += bytesRead;
+		pos += bytesRead;
+		size -= bytesRead;
+		ret += bytesRead;
+		if (bytesRead < chunk) {
+			// Short read. (end of file)
+			break;
+		}
+	}
+
+	return ret;
+}
+
 /** RpFile **/
 
 /**
@@ -724,4 +787,90 @@ string RpFile::filename(void) const
 	return d->filename;
 }
 
+/** Positional I/O. **/
+
+/**
+ * Read data from the specified position in the file.
+ *
+ * This uses ReadFile() with the position set in an OVERLAPPED
+ * struct, so it's thread-safe, but the file position (which is
+ * shared with dup()'d copies) is moved to the end of the data
+ * that was read.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::pread(int64_t pos, void *ptr, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file.get() == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	} else if (size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	if (d->sector_size == 0) {
+		// Regular file.
+		return d->preadOverlapped(pos, ptr, size);
+	}
+
+	// Block device. Reads must be sector-aligned,
+	// so read whole sectors into a bounce buffer.
+	if (pos >= d->device_size) {
+		// End of the block device.
+		return 0;
+	}
+	if (pos + (int64_t)size > d->device_size) {
+		// Short read.
+		size = (size_t)(d->device_size - pos);
+	}
+
+	// TODO: Make sure sector_size is a power of 2.
+	const unsigned int sector_size = d->sector_size;
+	const size_t bufSize = (size_t)sector_size * 64;
+	unique_ptr<uint8_t[]> sector_buffer(new uint8_t[bufSize]);
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		const int64_t blockStart = pos & ~((int64_t)sector_size - 1);
+		const size_t blockOffset = (size_t)(pos - blockStart);
+		size_t toRead = blockOffset + size;
+		toRead = (toRead + sector_size - 1) & ~((size_t)sector_size - 1);
+		if (toRead > bufSize) {
+			toRead = bufSize;
+		}
+
+		const size_t sz_read = d->preadOverlapped(blockStart, sector_buffer.get(), toRead);
+		if (sz_read <= blockOffset) {
+			// Read error.
+			break;
+		}
+
+		size_t copy_sz = sz_read - blockOffset;
+		if (copy_sz > size) {
+			copy_sz = size;
+		}
+		memcpy(ptr8, &sector_buffer[blockOffset], copy_sz);
+
+		ptr8 += copy_sz;
+		pos += copy_sz;
+		size -= copy_sz;
+		ret += copy_sz;
+		if (sz_read < toRead) {
+			// Short read.
+			break;
+		}
+	}
+
+	return ret;
+}
+
 }
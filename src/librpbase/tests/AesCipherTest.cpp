@@ -30,6 +30,8 @@
 
 // C includes. (C++ namespace)
 #include <cstdio>
+#include <cstring>
+#include <ctime>
 
 // C++ includes.
 #include <iostream>
@@ -494,6 +496,162 @@ INSTANTIATE_TEST_CASE_P(AesDecryptTest, AesCipherTest,
 		)
 
 	, AesCipherTest::test_case_suffix_generator);
+
+/** Bulk decryption tests. **/
+
+// Bulk test buffer size.
+// This isn't a multiple of the parallel block count,
+// so the tail handling is tested, too.
+static const unsigned int BULK_TEST_SIZE = (1024 + 3) * 16;
+
+// Benchmark buffer size and iterations.
+static const unsigned int BENCHMARK_SIZE = 1024 * 1024;
+static const unsigned int BENCHMARK_ITERATIONS = 64;
+
+/**
+ * Fill a buffer with pseudo-random data.
+ * @param buf Buffer.
+ * @param size Size of buffer.
+ */
+static void fillBuffer(uint8_t *buf, size_t size)
+{
+	uint32_t x = 0x12345678;
+	for (; size > 0; size--, buf++) {
+		x = (x * 1103515245) + 12345;
+		*buf = (uint8_t)(x >> 16);
+	}
+}
+
+/**
+ * Decrypt a buffer in two parts.
+ * The second part uses the IV/counter left over from the first part.
+ * @param cipher Cipher.
+ * @param key_len Key length.
+ * @param mode Chaining mode.
+ * @param iv IV/counter.
+ * @param buf Buffer.
+ * @param size Size of buffer.
+ */
+static void decryptBulk(IAesCipher *cipher, unsigned int key_len,
+	IAesCipher::ChainingMode mode, const uint8_t *iv,
+	uint8_t *buf, unsigned int size)
+{
+	ASSERT_EQ(0, cipher->setKey(AesCipherTest::aes_key, key_len));
+	ASSERT_EQ(0, cipher->setChainingMode(mode));
+	if (mode != IAesCipher::CM_ECB) {
+		ASSERT_EQ(0, cipher->setIV(iv, 16));
+	}
+
+	const unsigned int part1 = (size / 2) & ~15U;
+	EXPECT_EQ(part1, cipher->decrypt(buf, part1));
+	EXPECT_EQ(size - part1, cipher->decrypt(&buf[part1], size - part1));
+}
+
+/**
+ * Compare AES-NI bulk decryption with the system implementation.
+ */
+TEST(AesCipherBulkTest, compareWithSystem)
+{
+	IAesCipher *const aesni = AesCipherFactory::create(AesCipherFactory::AES_IMPL_AESNI);
+	if (!aesni) {
+		fprintf(stderr, "*** AES-NI is not supported on this system. Skipping test.\n");
+		return;
+	}
+	IAesCipher *const sys = AesCipherFactory::create(AesCipherFactory::AES_IMPL_SYSTEM);
+	ASSERT_TRUE(sys != nullptr);
+	printf("Comparing %s with %s.\n", aesni->name(), sys->name());
+
+	// The second IV has a counter that carries into the upper 64 bits.
+	static const uint8_t ivs[2][16] = {
+		{0xD9,0x83,0xC2,0xA0,0x1C,0xFA,0x8B,0x88,
+		 0x3A,0xE3,0xA4,0xBD,0x70,0x1F,0xC1,0x0B},
+		{0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,
+		 0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF0},
+	};
+	static const IAesCipher::ChainingMode modes[3] = {
+		IAesCipher::CM_ECB, IAesCipher::CM_CBC, IAesCipher::CM_CTR,
+	};
+
+	vector<uint8_t> expected(BULK_TEST_SIZE), actual(BULK_TEST_SIZE);
+	for (unsigned int key_len = 16; key_len <= 32; key_len += 8) {
+		for (unsigned int m = 0; m < ARRAY_SIZE(modes); m++) {
+			for (unsigned int v = 0; v < ARRAY_SIZE(ivs); v++) {
+				fillBuffer(expected.data(), expected.size());
+				memcpy(actual.data(), expected.data(), actual.size());
+				decryptBulk(sys, key_len, modes[m], ivs[v], expected.data(), BULK_TEST_SIZE);
+				decryptBulk(aesni, key_len, modes[m], ivs[v], actual.data(), BULK_TEST_SIZE);
+				EXPECT_EQ(0, memcmp(expected.data(), actual.data(), BULK_TEST_SIZE)) <<
+					"AES-" << (key_len * 8) << " mode " << (int)modes[m] << " IV " << v;
+			}
+		}
+	}
+
+	delete aesni;
+	delete sys;
+}
+
+/**
+ * Benchmark an AES implementation.
+ * @param impl Implementation.
+ * @param mode Chaining mode.
+ */
+static void benchmarkImpl(AesCipherFactory::Implementation impl, IAesCipher::ChainingMode mode)
+{
+	IAesCipher *const cipher = AesCipherFactory::create(impl);
+	if (!cipher) {
+		fprintf(stderr, "*** This implementation is not supported on this system. Skipping test.\n");
+		return;
+	}
+
+	vector<uint8_t> buf(BENCHMARK_SIZE);
+	fillBuffer(buf.data(), buf.size());
+	ASSERT_EQ(0, cipher->setKey(AesCipherTest::aes_key, 16));
+	ASSERT_EQ(0, cipher->setChainingMode(mode));
+	ASSERT_EQ(0, cipher->setIV(AesCipherTest::aes_iv, sizeof(AesCipherTest::aes_iv)));
+
+	const clock_t start = clock();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		EXPECT_EQ(BENCHMARK_SIZE, cipher->decrypt(buf.data(), BENCHMARK_SIZE));
+	}
+	const double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (secs > 0) {
+		printf("%s: %.1f MB/s\n", cipher->name(),
+			((double)BENCHMARK_SIZE * BENCHMARK_ITERATIONS / (1024.0 * 1024.0)) / secs);
+	}
+	delete cipher;
+}
+
+/**
+ * Benchmark AES-128-CBC decryption. (system implementation)
+ */
+TEST(AesCipherBulkTest, AES_128_CBC_system_benchmark)
+{
+	benchmarkImpl(AesCipherFactory::AES_IMPL_SYSTEM, IAesCipher::CM_CBC);
+}
+
+/**
+ * Benchmark AES-128-CBC decryption. (AES-NI)
+ */
+TEST(AesCipherBulkTest, AES_128_CBC_aesni_benchmark)
+{
+	benchmarkImpl(AesCipherFactory::AES_IMPL_AESNI, IAesCipher::CM_CBC);
+}
+
+/**
+ * Benchmark AES-128-CTR decryption. (system implementation)
+ */
+TEST(AesCipherBulkTest, AES_128_CTR_system_benchmark)
+{
+	benchmarkImpl(AesCipherFactory::AES_IMPL_SYSTEM, IAesCipher::CM_CTR);
+}
+
+/**
+ * Benchmark AES-128-CTR decryption. (AES-NI)
+ */
+TEST(AesCipherBulkTest, AES_128_CTR_aesni_benchmark)
+{
+	benchmarkImpl(AesCipherFactory::AES_IMPL_AESNI, IAesCipher::CM_CTR);
+}
 } }
 
 /**
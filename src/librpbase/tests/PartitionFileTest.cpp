@@ -0,0 +1,356 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * PartitionFileTest.cpp: PartitionFile read-ahead test.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// PartitionFile
+#include "../disc/PartitionFile.hpp"
+#include "../disc/DiscReader.hpp"
+#include "../file/RpMemFile.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+// Size of the underlying disc image.
+static const unsigned int DISC_SIZE = 512*1024;
+
+// Read-ahead window sizes. (See PartitionFile.cpp.)
+static const unsigned int READAHEAD_MIN = 4096;
+static const unsigned int READAHEAD_MAX = 64*1024;
+
+class PartitionFileTest : public ::testing::Test
+{
+	protected:
+		PartitionFileTest()
+			: m_memFile(nullptr)
+			, m_discReader(nullptr)
+		{ }
+
+		void SetUp(void) override final;
+		void TearDown(void) override final;
+
+	protected:
+		/**
+		 * Read from a PartitionFile and compare against the disc image.
+		 * @param file PartitionFile.
+		 * @param offset PartitionFile starting offset.
+		 * @param size Amount of data to read.
+		 * @return Number of bytes read.
+		 */
+		size_t readAndCheck(PartitionFile *file, int64_t offset, size_t size);
+
+		/**
+		 * Get the read-ahead statistics.
+		 * @param file PartitionFile.
+		 * @return Read-ahead statistics.
+		 */
+		static PartitionFile::ReadAheadStats stats(const PartitionFile *file)
+		{
+			PartitionFile::ReadAheadStats st;
+			file->getReadAheadStats(&st);
+			return st;
+		}
+
+	protected:
+		vector<uint8_t> m_data;
+		RpMemFile *m_memFile;
+		DiscReader *m_discReader;
+};
+
+void PartitionFileTest::SetUp(void)
+{
+	m_data.resize(DISC_SIZE);
+	for (unsigned int i = 0; i < DISC_SIZE; i++) {
+		m_data[i] = (uint8_t)((i * 7) ^ (i >> 9));
+	}
+	m_memFile = new RpMemFile(m_data.data(), m_data.size());
+	m_discReader = new DiscReader(m_memFile);
+	ASSERT_TRUE(m_discReader->isOpen());
+}
+
+void PartitionFileTest::TearDown(void)
+{
+	delete m_discReader;
+	m_discReader = nullptr;
+	delete m_memFile;
+	m_memFile = nullptr;
+}
+
+/**
+ * Read from a PartitionFile and compare against the disc image.
+ * @param file PartitionFile.
+ * @param offset PartitionFile starting offset.
+ * @param size Amount of data to read.
+ * @return Number of bytes read.
+ */
+size_t PartitionFileTest::readAndCheck(PartitionFile *file, int64_t offset, size_t size)
+{
+	const int64_t pos = file->tell();
+	// Guard bytes past the requested size must not be touched.
+	vector<uint8_t> buf(size + 16, 0xCC);
+	const size_t ret = file->read(buf.data(), size);
+	EXPECT_EQ(pos + (int64_t)ret, file->tell());
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[(size_t)(offset + pos)], ret))
+		<< "pos == " << pos << ", size == " << size;
+	for (size_t i = ret; i < buf.size(); i++) {
+		if (buf[i] != 0xCC) {
+			ADD_FAILURE() << "read() wrote past the end of the data: pos == " << pos
+				<< ", size == " << size << ", ret == " << ret;
+			break;
+		}
+	}
+	return ret;
+}
+
+/**
+ * Small sequential reads. The window should double for
+ * each buffer fill until it reaches READAHEAD_MAX.
+ */
+TEST_F(PartitionFileTest, sequentialWindowGrowth)
+{
+	PartitionFile file(m_discReader, 0, DISC_SIZE);
+
+	// Fills: 4 KB, 8 KB, 16 KB, 32 KB, 64 KB, 64 KB
+	static const unsigned int total = (4+8+16+32+64+64) * 1024;
+	for (unsigned int pos = 0; pos < total; pos += 512) {
+		ASSERT_EQ(512U, readAndCheck(&file, 0, 512));
+	}
+
+	const PartitionFile::ReadAheadStats st = stats(&file);
+	EXPECT_EQ(total / 512, st.reads);
+	EXPECT_EQ(6U, st.fills);
+	EXPECT_EQ(total / 512 - 6, st.bufferHits);
+	EXPECT_EQ(0U, st.directReads);
+	EXPECT_EQ((uint64_t)total, st.bytesFilled);
+	EXPECT_EQ(READAHEAD_MAX, st.window);
+}
+
+/**
+ * Partial buffer hits: part of the request is in the buffer.
+ */
+TEST_F(PartitionFileTest, partialHit)
+{
+	PartitionFile file(m_discReader, 0, DISC_SIZE);
+
+	// Fill [0, 4096).
+	ASSERT_EQ(4000U, readAndCheck(&file, 0, 4000));
+	PartitionFile::ReadAheadStats st = stats(&file);
+	EXPECT_EQ(1U, st.fills);
+	EXPECT_EQ(4096U, st.bytesFilled);
+	EXPECT_EQ(READAHEAD_MIN, st.window);
+
+	// 96 bytes from the buffer; the rest is a new, larger fill.
+	ASSERT_EQ(200U, readAndCheck(&file, 0, 200));
+	st = stats(&file);
+	EXPECT_EQ(2U, st.reads);
+	EXPECT_EQ(0U, st.bufferHits);
+	EXPECT_EQ(2U, st.fills);
+	EXPECT_EQ(0U, st.directReads);
+	EXPECT_EQ(4096U + 8192U, st.bytesFilled);
+	EXPECT_EQ(READAHEAD_MIN * 2, st.window);
+
+	// Rest of the buffer, plus more than the window:
+	// the remainder is read directly.
+	const int64_t pos = file.tell();
+	const size_t avail = (size_t)(4096 + 8192 - pos);
+	ASSERT_EQ(avail + 20000, readAndCheck(&file, 0, avail + 20000));
+	st = stats(&file);
+	EXPECT_EQ(3U, st.reads);
+	EXPECT_EQ(0U, st.bufferHits);
+	EXPECT_EQ(2U, st.fills);
+	EXPECT_EQ(1U, st.directReads);
+	EXPECT_EQ(4096U + 8192U, st.bytesFilled);
+}
+
+/**
+ * A fill that would exceed READAHEAD_MAX is capped,
+ * and the remainder is read directly.
+ */
+TEST_F(PartitionFileTest, readAheadMaxCap)
+{
+	PartitionFile file(m_discReader, 0, DISC_SIZE);
+
+	// Grow the window to READAHEAD_MAX and consume the whole buffer.
+	// Fills: 4 KB, 8 KB, 16 KB, 32 KB, 64 KB
+	static const unsigned int grow = (4+8+16+32+64) * 1024;
+	for (unsigned int pos = 0; pos < grow; pos += 1024) {
+		ASSERT_EQ(1024U, readAndCheck(&file, 0, 1024));
+	}
+	PartitionFile::ReadAheadStats st = stats(&file);
+	EXPECT_EQ(5U, st.fills);
+	EXPECT_EQ(READAHEAD_MAX, st.window);
+
+	// Large read: bypasses the buffer, and leaves
+	// the file position 100 bytes past an aligned boundary.
+	ASSERT_EQ(READAHEAD_MAX + 100U, readAndCheck(&file, 0, READAHEAD_MAX + 100));
+	st = stats(&file);
+	EXPECT_EQ(5U, st.fills);
+	EXPECT_EQ(1U, st.directReads);
+
+	// Sequential read just under the window. The aligned fill would
+	// need 100 + 65500 bytes, so it's capped at READAHEAD_MAX, and
+	// the last 64 bytes are read directly.
+	ASSERT_EQ(65500U, readAndCheck(&file, 0, 65500));
+	st = stats(&file);
+	EXPECT_EQ(6U, st.fills);
+	EXPECT_EQ(2U, st.directReads);
+	EXPECT_EQ((uint64_t)grow + READAHEAD_MAX, st.bytesFilled);
+	EXPECT_EQ(READAHEAD_MAX, st.window);
+}
+
+/**
+ * Fills are clamped to the end of the file, not the disc image.
+ */
+TEST_F(PartitionFileTest, eofClamp)
+{
+	static const int64_t offset = 8192;
+	static const int64_t size = 10000;
+	PartitionFile file(m_discReader, offset, size);
+
+	// 100 bytes are left, from an aligned fill at 8192.
+	ASSERT_EQ(0, file.seek(9900));
+	ASSERT_EQ(100U, readAndCheck(&file, offset, 512));
+	PartitionFile::ReadAheadStats st = stats(&file);
+	EXPECT_EQ(1U, st.reads);
+	EXPECT_EQ(1U, st.fills);
+	EXPECT_EQ(0U, st.directReads);
+	EXPECT_EQ((uint64_t)(size - 8192), st.bytesFilled);
+
+	// Reads at EOF don't return anything, and aren't counted.
+	ASSERT_EQ(0U, readAndCheck(&file, offset, 512));
+	st = stats(&file);
+	EXPECT_EQ(1U, st.reads);
+	EXPECT_EQ(1U, st.fills);
+
+	// Re-reading the end of the file is a buffer hit.
+	ASSERT_EQ(0, file.seek(9000));
+	ASSERT_EQ(1000U, readAndCheck(&file, offset, 4000));
+	st = stats(&file);
+	EXPECT_EQ(2U, st.reads);
+	EXPECT_EQ(1U, st.bufferHits);
+	EXPECT_EQ(1U, st.fills);
+}
+
+/**
+ * Seeking resets the read-ahead window.
+ */
+TEST_F(PartitionFileTest, windowReset)
+{
+	PartitionFile file(m_discReader, 0, DISC_SIZE);
+
+	// Fills: 4 KB, 8 KB, 16 KB
+	for (unsigned int pos = 0; pos < (4+8+16) * 1024; pos += 2048) {
+		ASSERT_EQ(2048U, readAndCheck(&file, 0, 2048));
+	}
+	PartitionFile::ReadAheadStats st = stats(&file);
+	EXPECT_EQ(3U, st.fills);
+	EXPECT_EQ(READAHEAD_MIN * 4, st.window);
+
+	// Jump forward. The window is reset, so only 4 KB is filled.
+	ASSERT_EQ(0, file.seek(300000));
+	ASSERT_EQ(100U, readAndCheck(&file, 0, 100));
+	st = stats(&file);
+	EXPECT_EQ(4U, st.fills);
+	EXPECT_EQ((uint64_t)(4+8+16+4) * 1024, st.bytesFilled);
+	EXPECT_EQ(READAHEAD_MIN, st.window);
+	const unsigned int bufferHits = st.bufferHits;
+
+	// Jumping backwards within the buffer is a hit,
+	// but it still resets the window.
+	ASSERT_EQ(0, file.seek(300010));
+	ASSERT_EQ(10U, readAndCheck(&file, 0, 10));
+	st = stats(&file);
+	EXPECT_EQ(bufferHits + 1, st.bufferHits);
+	EXPECT_EQ(4U, st.fills);
+	EXPECT_EQ(READAHEAD_MIN, st.window);
+
+	// resetReadAheadStats() clears the counters.
+	file.resetReadAheadStats();
+	st = stats(&file);
+	EXPECT_EQ(0U, st.reads);
+	EXPECT_EQ(0U, st.fills);
+	EXPECT_EQ(0U, st.bufferHits);
+	EXPECT_EQ(0ULL, st.bytesFilled);
+}
+
+/**
+ * Random seeks and reads from an unaligned partition offset.
+ * The data must always match the disc image, and the
+ * statistics must be self-consistent.
+ */
+TEST_F(PartitionFileTest, randomSeekRead)
+{
+	static const int64_t offset = 1000;
+	static const int64_t size = DISC_SIZE - 3000;
+	PartitionFile file(m_discReader, offset, size);
+
+	// Simple LCG, so the sequence is reproducible.
+	uint32_t seed = 0x12345678;
+	unsigned int expectedReads = 0;
+	for (unsigned int i = 0; i < 5000; i++) {
+		seed = seed * 1103515245 + 12345;
+		const unsigned int r = seed >> 8;
+
+		if ((r & 3) == 0) {
+			// Random seek. (may be past EOF)
+			const int64_t pos = (int64_t)(r % (unsigned int)(size + 1024));
+			ASSERT_EQ(0, file.seek(pos));
+		}
+
+		// Mostly small reads, with some large ones.
+		size_t sz = ((r >> 4) & 7) == 0 ? (r % 100000) : (r % 3000);
+		if (file.tell() < size && sz > 0) {
+			expectedReads++;
+		}
+		readAndCheck(&file, offset, sz);
+
+		const PartitionFile::ReadAheadStats st = stats(&file);
+		ASSERT_EQ(expectedReads, st.reads);
+		ASSERT_LE(st.bufferHits + st.directReads, st.reads);
+		ASSERT_LE(st.bytesFilled, (uint64_t)st.fills * READAHEAD_MAX);
+		ASSERT_GE(st.window, READAHEAD_MIN);
+		ASSERT_LE(st.window, READAHEAD_MAX);
+		ASSERT_EQ(0U, st.window & (st.window - 1)) << "window must be a power of two";
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: PartitionFile tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
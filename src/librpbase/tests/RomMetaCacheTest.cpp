@@ -0,0 +1,368 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RomMetaCacheTest.cpp: RomMetaCache serialization test.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// RomMetaCache
+#include "../RomMetaCache.hpp"
+#include "../RomData.hpp"
+#include "../RomData_p.hpp"
+#include "../RomFields.hpp"
+#include "../file/RpFile.hpp"
+#include "../file/FileSystem.hpp"
+using namespace LibRpBase::FileSystem;
+
+// C includes.
+#ifndef _WIN32
+#include <dirent.h>
+#include <unistd.h>
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * RomData subclass with a fixed set of fields
+ * covering every serialized field type.
+ */
+class TestRomData : public RomData
+{
+	public:
+		TestRomData();
+
+	private:
+		typedef RomData super;
+		RP_DISABLE_COPY(TestRomData)
+
+	public:
+		int isRomSupported(const DetectInfo *info) const override final
+		{
+			RP_UNUSED(info);
+			return -1;
+		}
+
+		const char *systemName(unsigned int type) const override final
+		{
+			static const char *const sysNames[4] = {
+				"Test System Long", "Test System", "TS", nullptr
+			};
+			return sysNames[type & SYSNAME_TYPE_MASK];
+		}
+
+		const char *const *supportedFileExtensions(void) const override final
+		{
+			return nullptr;
+		}
+
+	protected:
+		int loadFieldData(void) override final;
+};
+
+TestRomData::TestRomData()
+	: super(new RomDataPrivate(this, nullptr))
+{
+	RomDataPrivate *const d = d_ptr;
+	d->className = "TestRomData";
+	d->fileType = FTYPE_DISC_IMAGE;
+	d->isValid = true;
+}
+
+int TestRomData::loadFieldData(void)
+{
+	RomDataPrivate *const d = d_ptr;
+	RomFields *const fields = d->fields;
+
+	fields->reserveTabs(2);
+	fields->setTabName(0, "Main");
+	fields->setTabName(1, "Extra");
+
+	fields->setTabIndex(0);
+	fields->addField_string("Title", "Test Title");
+	fields->addField_string("Game ID", "RTEST1", RomFields::STRF_MONOSPACE);
+	fields->addField_string("Empty", "");
+
+	static const char *const flag_names[] = {"Flag A", "Flag B", "Flag C"};
+	fields->addField_bitfield("Flags",
+		RomFields::strArrayToVector(flag_names, 3), 2, 0x5);
+
+	fields->setTabIndex(1);
+	static const char *const headers[] = {"#", "Name"};
+	vector<vector<string> > *const list_data = new vector<vector<string> >(2);
+	(*list_data)[0].push_back("0");
+	(*list_data)[0].push_back("First");
+	(*list_data)[1].push_back("1");
+	(*list_data)[1].push_back("Second");
+	fields->addField_listData("List", RomFields::strArrayToVector(headers, 2),
+		list_data, 4, RomFields::RFT_LISTDATA_CHECKBOXES, 0x2);
+
+	fields->addField_dateTime("Date", 1234567890,
+		RomFields::RFT_DATETIME_HAS_DATE | RomFields::RFT_DATETIME_IS_UTC);
+
+	RomFields::age_ratings_t age_ratings;
+	age_ratings.fill(0);
+	age_ratings[RomFields::AGE_USA] = RomFields::AGEBF_ACTIVE | 13;
+	age_ratings[RomFields::AGE_EUROPE] = RomFields::AGEBF_ACTIVE | RomFields::AGEBF_ONLINE_PLAY | 12;
+	fields->addField_ageRatings("Age Ratings", age_ratings);
+
+	return fields->count();
+}
+
+class RomMetaCacheTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) override final;
+		void TearDown(void) override final;
+
+		/**
+		 * Write a test ROM file.
+		 * @param size File size.
+		 */
+		void writeRom(size_t size);
+
+		/**
+		 * Count leftover temporary files in the metadata cache directory.
+		 * @return Number of temporary files.
+		 */
+		int countTempFiles(void) const;
+
+		string m_romFilename;
+};
+
+void RomMetaCacheTest::SetUp(void)
+{
+	// NOTE: The cache directory is set up by gtest_main().
+	const string &cache_dir = getCacheDirectory();
+	ASSERT_FALSE(cache_dir.empty());
+	m_romFilename = cache_dir + DIR_SEP_CHR + "RomMetaCacheTest.bin";
+	ASSERT_EQ(0, rmkdir(m_romFilename));
+	writeRom(1024);
+	RomMetaCache::remove(m_romFilename);
+}
+
+void RomMetaCacheTest::TearDown(void)
+{
+	RomMetaCache::remove(m_romFilename);
+	delete_file(m_romFilename);
+}
+
+/**
+ * Write a test ROM file.
+ * @param size File size.
+ */
+void RomMetaCacheTest::writeRom(size_t size)
+{
+	unique_ptr<IRpFile> file(new RpFile(m_romFilename, RpFile::FM_CREATE_WRITE));
+	ASSERT_TRUE(file->isOpen());
+	vector<uint8_t> buf(size, 0x5A);
+	ASSERT_EQ(size, file->write(buf.data(), buf.size()));
+}
+
+/**
+ * Count leftover temporary files in the metadata cache directory.
+ * @return Number of temporary files.
+ */
+int RomMetaCacheTest::countTempFiles(void) const
+{
+	int count = 0;
+#ifndef _WIN32
+	const string dir = getCacheDirectory() + DIR_SEP_CHR + "metadata";
+	DIR *pDir = opendir(dir.c_str());
+	if (!pDir)
+		return 0;
+	struct dirent *dirent;
+	while ((dirent = readdir(pDir)) != nullptr) {
+		const size_t len = strlen(dirent->d_name);
+		if (len >= 4 && !strcmp(&dirent->d_name[len-4], ".tmp")) {
+			count++;
+		}
+	}
+	closedir(pDir);
+#endif /* !_WIN32 */
+	return count;
+}
+
+/**
+ * Store a RomData object and look it up again.
+ * All fields must survive the round trip.
+ */
+TEST_F(RomMetaCacheTest, roundTrip)
+{
+	TestRomData *const romData = new TestRomData();
+	ASSERT_EQ(0, RomMetaCache::store(m_romFilename, romData));
+	EXPECT_EQ(0, countTempFiles());
+
+	RomData *const cached = RomMetaCache::lookup(m_romFilename);
+	ASSERT_TRUE(cached != nullptr);
+	EXPECT_TRUE(cached->isValid());
+	EXPECT_STREQ(romData->className(), cached->className());
+	EXPECT_EQ(romData->fileType(), cached->fileType());
+	for (unsigned int i = 0; i < 8; i++) {
+		if ((i & RomData::SYSNAME_TYPE_MASK) > RomData::SYSNAME_TYPE_ABBREVIATION)
+			continue;
+		EXPECT_STREQ(romData->systemName(i), cached->systemName(i)) << "type == " << i;
+	}
+
+	const RomFields *const expected = romData->fields();
+	const RomFields *const actual = cached->fields();
+	ASSERT_TRUE(expected != nullptr);
+	ASSERT_TRUE(actual != nullptr);
+
+	ASSERT_EQ(expected->tabCount(), actual->tabCount());
+	for (int i = 0; i < expected->tabCount(); i++) {
+		EXPECT_STREQ(expected->tabName(i), actual->tabName(i));
+	}
+
+	ASSERT_EQ(expected->count(), actual->count());
+	for (int i = 0; i < expected->count(); i++) {
+		const RomFields::Field *const ef = expected->field(i);
+		const RomFields::Field *const af = actual->field(i);
+		ASSERT_TRUE(ef != nullptr);
+		ASSERT_TRUE(af != nullptr);
+		EXPECT_EQ(ef->name, af->name);
+		EXPECT_EQ(ef->type, af->type) << "field: " << ef->name;
+		EXPECT_EQ(ef->tabIdx, af->tabIdx) << "field: " << ef->name;
+		EXPECT_TRUE(af->isValid) << "field: " << ef->name;
+
+		switch (ef->type) {
+			case RomFields::RFT_STRING:
+				EXPECT_EQ(ef->desc.flags, af->desc.flags);
+				ASSERT_EQ(ef->data.str != nullptr, af->data.str != nullptr);
+				if (ef->data.str) {
+					EXPECT_EQ(*ef->data.str, *af->data.str);
+				}
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				EXPECT_EQ(ef->desc.bitfield.elemsPerRow, af->desc.bitfield.elemsPerRow);
+				ASSERT_TRUE(af->desc.bitfield.names != nullptr);
+				EXPECT_EQ(*ef->desc.bitfield.names, *af->desc.bitfield.names);
+				EXPECT_EQ(ef->data.bitfield, af->data.bitfield);
+				break;
+
+			case RomFields::RFT_LISTDATA:
+				EXPECT_EQ(ef->desc.list_data.flags, af->desc.list_data.flags);
+				EXPECT_EQ(ef->desc.list_data.rows_visible, af->desc.list_data.rows_visible);
+				ASSERT_TRUE(af->desc.list_data.names != nullptr);
+				EXPECT_EQ(*ef->desc.list_data.names, *af->desc.list_data.names);
+				EXPECT_EQ(ef->data.list_checkboxes, af->data.list_checkboxes);
+				ASSERT_TRUE(af->data.list_data != nullptr);
+				EXPECT_EQ(*ef->data.list_data, *af->data.list_data);
+				break;
+
+			case RomFields::RFT_DATETIME:
+				EXPECT_EQ(ef->desc.flags, af->desc.flags);
+				EXPECT_EQ(ef->data.date_time, af->data.date_time);
+				break;
+
+			case RomFields::RFT_AGE_RATINGS:
+				ASSERT_TRUE(af->data.age_ratings != nullptr);
+				EXPECT_EQ(*ef->data.age_ratings, *af->data.age_ratings);
+				break;
+
+			default:
+				ADD_FAILURE() << "Unexpected field type: " << (int)ef->type;
+				break;
+		}
+	}
+
+	cached->unref();
+	romData->unref();
+}
+
+/**
+ * Modifying the ROM must invalidate the cache entry.
+ */
+TEST_F(RomMetaCacheTest, invalidatedByModification)
+{
+	TestRomData *const romData = new TestRomData();
+	ASSERT_EQ(0, RomMetaCache::store(m_romFilename, romData));
+	romData->unref();
+
+	// Change the file size.
+	writeRom(2048);
+	EXPECT_TRUE(RomMetaCache::lookup(m_romFilename) == nullptr);
+}
+
+/**
+ * Storing an entry again must replace the existing entry.
+ */
+TEST_F(RomMetaCacheTest, replaceEntry)
+{
+	TestRomData *const romData = new TestRomData();
+	ASSERT_EQ(0, RomMetaCache::store(m_romFilename, romData));
+	ASSERT_EQ(0, RomMetaCache::store(m_romFilename, romData));
+	romData->unref();
+	EXPECT_EQ(0, countTempFiles());
+
+	RomData *const cached = RomMetaCache::lookup(m_romFilename);
+	ASSERT_TRUE(cached != nullptr);
+	EXPECT_STREQ("TestRomData", cached->className());
+	cached->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: RomMetaCache tests.\n\n");
+	fflush(nullptr);
+
+#ifndef _WIN32
+	// Use a temporary cache directory so the user's
+	// metadata cache isn't touched.
+	char tmpdir[] = "/tmp/RomMetaCacheTest.XXXXXX";
+	if (!mkdtemp(tmpdir)) {
+		fprintf(stderr, "*** ERROR: mkdtemp() failed.\n");
+		return EXIT_FAILURE;
+	}
+	setenv("XDG_CACHE_HOME", tmpdir, 1);
+#endif /* !_WIN32 */
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	int ret = RUN_ALL_TESTS();
+
+#ifndef _WIN32
+	// Remove the temporary cache directory.
+	// NOTE: The test fixture removes all files it creates.
+	const string cache_dir = string(tmpdir) + "/rom-properties";
+	rmdir((cache_dir + "/metadata").c_str());
+	rmdir(cache_dir.c_str());
+	rmdir(tmpdir);
+#endif /* !_WIN32 */
+	return ret;
+}
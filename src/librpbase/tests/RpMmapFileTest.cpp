@@ -0,0 +1,297 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpMmapFileTest.cpp: RpMmapFile test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// RpMmapFile
+#include "../file/RpMmapFile.hpp"
+#include "../file/RpFile.hpp"
+#include "../file/FileSystem.hpp"
+using namespace LibRpBase::FileSystem;
+
+// C includes.
+#ifndef _WIN32
+#include <unistd.h>
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+// Test file size. (Not a multiple of the page size.)
+static const size_t FILE_SIZE = 10000;
+
+class RpMmapFileTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) override final;
+		void TearDown(void) override final;
+
+	protected:
+		/**
+		 * Write a file in the temporary directory.
+		 * @param name Filename, relative to the temporary directory.
+		 * @param data File data.
+		 * @param size Size of the file data.
+		 * @return Full filename.
+		 */
+		string writeFile(const char *name, const uint8_t *data, size_t size);
+
+	protected:
+		string m_dir;			// Temporary directory, with a trailing separator.
+		vector<uint8_t> m_data;		// Test file data.
+		vector<string> m_files;		// Files to delete in TearDown().
+		unique_ptr<RpMmapFile> m_file;	// Test file.
+};
+
+void RpMmapFileTest::SetUp(void)
+{
+	// NOTE: The cache directory is set up by gtest_main().
+	const string &cache_dir = getCacheDirectory();
+	ASSERT_FALSE(cache_dir.empty());
+	m_dir = cache_dir + DIR_SEP_CHR + "RpMmapFileTest" + DIR_SEP_CHR;
+	ASSERT_EQ(0, rmkdir(m_dir));
+
+	m_data.resize(FILE_SIZE);
+	for (size_t i = 0; i < m_data.size(); i++) {
+		m_data[i] = (uint8_t)((i * 7) ^ (i >> 8));
+	}
+
+	const string filename = writeFile("test.bin", m_data.data(), m_data.size());
+	m_file.reset(new RpMmapFile(filename));
+	ASSERT_TRUE(m_file->isOpen());
+}
+
+void RpMmapFileTest::TearDown(void)
+{
+	m_file.reset();
+	for (auto iter = m_files.cbegin(); iter != m_files.cend(); ++iter) {
+		delete_file(*iter);
+	}
+#ifndef _WIN32
+	rmdir(m_dir.c_str());
+#endif /* !_WIN32 */
+}
+
+/**
+ * Write a file in the temporary directory.
+ * @param name Filename, relative to the temporary directory.
+ * @param data File data.
+ * @param size Size of the file data.
+ * @return Full filename.
+ */
+string RpMmapFileTest::writeFile(const char *name, const uint8_t *data, size_t size)
+{
+	const string filename = m_dir + name;
+	m_files.push_back(filename);
+	RpFile file(filename, RpFile::FM_CREATE_WRITE);
+	EXPECT_TRUE(file.isOpen()) << filename;
+	if (size > 0) {
+		EXPECT_EQ(size, file.write(data, size)) << filename;
+	}
+	return filename;
+}
+
+/**
+ * read() and seek(), including at and past EOF.
+ */
+TEST_F(RpMmapFileTest, readAndSeek)
+{
+	EXPECT_EQ((int64_t)FILE_SIZE, m_file->size());
+	EXPECT_EQ(0, m_file->tell());
+
+	// Read the entire file.
+	vector<uint8_t> buf(FILE_SIZE + 100);
+	ASSERT_EQ(FILE_SIZE, m_file->read(buf.data(), FILE_SIZE));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), FILE_SIZE));
+	EXPECT_EQ((int64_t)FILE_SIZE, m_file->tell());
+
+	// Read at EOF.
+	EXPECT_EQ(0U, m_file->read(buf.data(), 1));
+
+	// Short read near EOF.
+	ASSERT_EQ(0, m_file->seek(FILE_SIZE - 10));
+	ASSERT_EQ(10U, m_file->read(buf.data(), 100));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[FILE_SIZE - 10], 10));
+	EXPECT_EQ((int64_t)FILE_SIZE, m_file->tell());
+
+	// Seeking past EOF clamps to EOF.
+	ASSERT_EQ(0, m_file->seek(FILE_SIZE + 1000));
+	EXPECT_EQ((int64_t)FILE_SIZE, m_file->tell());
+	EXPECT_EQ(0U, m_file->read(buf.data(), 1));
+
+	// Read from the middle of the file.
+	ASSERT_EQ(0, m_file->seek(4321));
+	ASSERT_EQ(100U, m_file->read(buf.data(), 100));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[4321], 100));
+	EXPECT_EQ(4421, m_file->tell());
+
+	// RpMmapFile is read-only.
+	EXPECT_EQ(0U, m_file->write(buf.data(), 1));
+	EXPECT_EQ(-1, m_file->truncate(0));
+	EXPECT_EQ((int64_t)FILE_SIZE, m_file->size());
+}
+
+/**
+ * pread(), including at and past EOF.
+ */
+TEST_F(RpMmapFileTest, pread)
+{
+	ASSERT_EQ(0, m_file->seek(123));
+
+	uint8_t buf[256];
+	ASSERT_EQ(sizeof(buf), m_file->pread(5000, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[5000], sizeof(buf)));
+
+	// Short read near EOF.
+	ASSERT_EQ(16U, m_file->pread(FILE_SIZE - 16, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[FILE_SIZE - 16], 16));
+
+	// At and past EOF.
+	EXPECT_EQ(0U, m_file->pread(FILE_SIZE, buf, sizeof(buf)));
+	EXPECT_EQ(0U, m_file->pread(FILE_SIZE + 1000, buf, sizeof(buf)));
+	EXPECT_EQ(0U, m_file->pread(-1, buf, sizeof(buf)));
+
+	// The file position isn't changed.
+	EXPECT_EQ(123, m_file->tell());
+}
+
+/**
+ * map() bounds checking.
+ */
+TEST_F(RpMmapFileTest, map)
+{
+	const uint8_t *const base = static_cast<const uint8_t*>(m_file->map(0, FILE_SIZE));
+	ASSERT_TRUE(base != nullptr);
+	EXPECT_EQ(0, memcmp(base, m_data.data(), FILE_SIZE));
+
+	// Regions within the file point into the same mapping.
+	EXPECT_EQ(base + 1000, m_file->map(1000, 500));
+	EXPECT_EQ(base + FILE_SIZE - 1, m_file->map(FILE_SIZE - 1, 1));
+
+	// Out of range.
+	EXPECT_TRUE(m_file->map(0, FILE_SIZE + 1) == nullptr);
+	EXPECT_TRUE(m_file->map(FILE_SIZE - 1, 2) == nullptr);
+	EXPECT_TRUE(m_file->map(FILE_SIZE + 1, 0) == nullptr);
+	EXPECT_TRUE(m_file->map(-1, 1) == nullptr);
+
+	// Closed files can't be mapped.
+	m_file->close();
+	EXPECT_FALSE(m_file->isOpen());
+	EXPECT_TRUE(m_file->map(0, 1) == nullptr);
+}
+
+/**
+ * dup()'d files share the mapping, but not the file position.
+ */
+TEST_F(RpMmapFileTest, dup)
+{
+	ASSERT_EQ(0, m_file->seek(1000));
+	unique_ptr<IRpFile> dup(m_file->dup());
+	ASSERT_TRUE(dup != nullptr);
+	ASSERT_TRUE(dup->isOpen());
+	EXPECT_EQ(0, dup->tell());
+
+	uint8_t buf[64];
+	ASSERT_EQ(sizeof(buf), dup->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, m_data.data(), sizeof(buf)));
+	EXPECT_EQ((int64_t)sizeof(buf), dup->tell());
+	EXPECT_EQ(1000, m_file->tell());
+
+	ASSERT_EQ(sizeof(buf), m_file->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[1000], sizeof(buf)));
+	EXPECT_EQ((int64_t)sizeof(buf), dup->tell());
+
+	// The mapping is shared.
+	EXPECT_EQ(m_file->map(0, FILE_SIZE), dup->map(0, FILE_SIZE));
+
+	// The dup()'d file remains valid after the original is closed.
+	m_file.reset();
+	ASSERT_EQ(sizeof(buf), dup->pread(FILE_SIZE - sizeof(buf), buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[FILE_SIZE - sizeof(buf)], sizeof(buf)));
+}
+
+/**
+ * Empty and missing files can't be opened.
+ */
+TEST_F(RpMmapFileTest, openErrors)
+{
+	const string emptyFile = writeFile("empty.bin", nullptr, 0);
+	RpMmapFile empty(emptyFile);
+	EXPECT_FALSE(empty.isOpen());
+	EXPECT_NE(0, empty.lastError());
+	EXPECT_EQ(-1, empty.size());
+	EXPECT_TRUE(empty.map(0, 0) == nullptr);
+
+	RpMmapFile missing(m_dir + "missing.bin");
+	EXPECT_FALSE(missing.isOpen());
+	EXPECT_EQ(ENOENT, missing.lastError());
+
+	uint8_t buf[16];
+	EXPECT_EQ(0U, missing.read(buf, sizeof(buf)));
+	EXPECT_EQ(0U, missing.pread(0, buf, sizeof(buf)));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: RpMmapFile tests.\n\n");
+	fflush(nullptr);
+
+#ifndef _WIN32
+	// Use a temporary cache directory for the test files.
+	char tmpdir[] = "/tmp/RpMmapFileTest.XXXXXX";
+	if (!mkdtemp(tmpdir)) {
+		fprintf(stderr, "*** ERROR: mkdtemp() failed.\n");
+		return EXIT_FAILURE;
+	}
+	setenv("XDG_CACHE_HOME", tmpdir, 1);
+#endif /* !_WIN32 */
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	int ret = RUN_ALL_TESTS();
+
+#ifndef _WIN32
+	// Remove the temporary cache directory.
+	// NOTE: The test fixture removes all files it creates.
+	rmdir((string(tmpdir) + "/rom-properties").c_str());
+	rmdir(tmpdir);
+#endif /* !_WIN32 */
+	return ret;
+}
@@ -0,0 +1,259 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * Sha1Test.cpp: SHA-1 test.                                               *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Sha1
+#include "../crypto/Sha1.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class Sha1Test : public ::testing::TestWithParam<Sha1::Implementation>
+{
+	protected:
+		void SetUp(void) override final;
+
+		/**
+		 * Convert a digest to a hexadecimal string.
+		 * @param digest Digest. (Sha1::DIGEST_SIZE bytes)
+		 * @return Hexadecimal string.
+		 */
+		static string toHex(const uint8_t *digest);
+
+		/**
+		 * Hash data using the current implementation.
+		 * @param data Data.
+		 * @param len Length of data.
+		 * @return Hexadecimal digest.
+		 */
+		string hash(const void *data, size_t len) const;
+};
+
+/**
+ * Formatting function for Sha1::Implementation.
+ */
+inline ::std::ostream& operator<<(::std::ostream& os, Sha1::Implementation impl)
+{
+	switch (impl) {
+		case Sha1::IMPL_CPP:	return os << "CPP";
+		case Sha1::IMPL_SHANI:	return os << "SHANI";
+		default:		return os << "DEFAULT";
+	}
+}
+
+void Sha1Test::SetUp(void)
+{
+	if (!Sha1::isImplSupported(GetParam())) {
+		fprintf(stderr, "*** SHA-1 implementation is not supported on this system; skipping.\n");
+	}
+}
+
+/**
+ * Convert a digest to a hexadecimal string.
+ * @param digest Digest. (Sha1::DIGEST_SIZE bytes)
+ * @return Hexadecimal string.
+ */
+string Sha1Test::toHex(const uint8_t *digest)
+{
+	char buf[Sha1::DIGEST_SIZE*2 + 1];
+	for (unsigned int i = 0; i < Sha1::DIGEST_SIZE; i++) {
+		snprintf(&buf[i*2], 3, "%02x", digest[i]);
+	}
+	return string(buf, Sha1::DIGEST_SIZE*2);
+}
+
+/**
+ * Hash data using the current implementation.
+ * @param data Data.
+ * @param len Length of data.
+ * @return Hexadecimal digest.
+ */
+string Sha1Test::hash(const void *data, size_t len) const
+{
+	Sha1 sha1(GetParam());
+	sha1.update(data, len);
+	uint8_t digest[Sha1::DIGEST_SIZE];
+	sha1.final(digest);
+	return toHex(digest);
+}
+
+/**
+ * FIPS 180 test vector: empty message.
+ */
+TEST_P(Sha1Test, emptyMessage)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	EXPECT_EQ("da39a3ee5e6b4b0d3255bfef95601890afd80709", hash("", 0));
+}
+
+/**
+ * FIPS 180 test vector: "abc"
+ */
+TEST_P(Sha1Test, abc)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	EXPECT_EQ("a9993e364706816aba3e25717850c26c9cd0d89d", hash("abc", 3));
+}
+
+/**
+ * FIPS 180 test vector: 448-bit message.
+ * The padding doesn't fit in the first block.
+ */
+TEST_P(Sha1Test, message448)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	static const char msg[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	EXPECT_EQ("84983e441c3bd26ebaae4aa1f95129e5e54670f1", hash(msg, sizeof(msg)-1));
+}
+
+/**
+ * FIPS 180 test vector: 896-bit message.
+ */
+TEST_P(Sha1Test, message896)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	static const char msg[] =
+		"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+		"hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+	EXPECT_EQ("a49b2446a02c645bf419f995b67091253a04a259", hash(msg, sizeof(msg)-1));
+}
+
+/**
+ * FIPS 180 test vector: one million 'a's, hashed in one call.
+ */
+TEST_P(Sha1Test, millionA)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	const vector<uint8_t> buf(1000000, 'a');
+	EXPECT_EQ("34aa973cd4c4daa4f61eeb2bdbad27316534016f", hash(buf.data(), buf.size()));
+}
+
+/**
+ * FIPS 180 test vector: one million 'a's, hashed in
+ * odd-sized chunks from an unaligned buffer.
+ * This exercises the partial block buffer.
+ */
+TEST_P(Sha1Test, millionA_chunked)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	vector<uint8_t> buf(1000000 + 1, 'a');
+	const uint8_t *p = &buf[1];
+	size_t remain = 1000000;
+
+	static const size_t chunk_sizes[] = {1, 7, 63, 64, 65, 127, 200, 4097};
+	Sha1 sha1(GetParam());
+	for (unsigned int i = 0; remain > 0; i++) {
+		size_t sz = chunk_sizes[i % (sizeof(chunk_sizes)/sizeof(chunk_sizes[0]))];
+		if (sz > remain) {
+			sz = remain;
+		}
+		sha1.update(p, sz);
+		p += sz;
+		remain -= sz;
+	}
+
+	uint8_t digest[Sha1::DIGEST_SIZE];
+	sha1.final(digest);
+	EXPECT_EQ("34aa973cd4c4daa4f61eeb2bdbad27316534016f", toHex(digest));
+}
+
+/**
+ * Compare against the C++ implementation for every length
+ * around the block boundaries, at every alignment.
+ */
+TEST_P(Sha1Test, matchesCpp)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+
+	uint8_t buf[Sha1::BLOCK_SIZE*4 + 16];
+	for (unsigned int i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 131 + 7);
+	}
+
+	for (unsigned int align = 0; align < 16; align++) {
+		for (size_t len = 0; len <= Sha1::BLOCK_SIZE*4; len++) {
+			Sha1 ref(Sha1::IMPL_CPP);
+			ref.update(&buf[align], len);
+			uint8_t digest[Sha1::DIGEST_SIZE];
+			ref.final(digest);
+			EXPECT_EQ(toHex(digest), hash(&buf[align], len))
+				<< "align == " << align << ", len == " << len;
+		}
+	}
+}
+
+/**
+ * The hash state must be reset by final().
+ */
+TEST_P(Sha1Test, reuse)
+{
+	if (!Sha1::isImplSupported(GetParam()))
+		return;
+	Sha1 sha1(GetParam());
+	uint8_t digest[Sha1::DIGEST_SIZE];
+
+	sha1.update("abc", 3);
+	sha1.final(digest);
+	EXPECT_EQ("a9993e364706816aba3e25717850c26c9cd0d89d", toHex(digest));
+
+	sha1.final(digest);
+	EXPECT_EQ("da39a3ee5e6b4b0d3255bfef95601890afd80709", toHex(digest));
+}
+
+INSTANTIATE_TEST_CASE_P(Sha1Test, Sha1Test,
+	::testing::Values(
+		Sha1::IMPL_CPP,
+		Sha1::IMPL_SHANI
+	));
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: Sha1 tests.\n\n");
+	fprintf(stderr, "Default SHA-1 implementation: %s\n\n", LibRpBase::Sha1::implName());
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,378 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * SplitDiscReaderTest.cpp: SplitDiscReader test.                          *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// SplitDiscReader
+#include "../disc/SplitDiscReader.hpp"
+#include "../file/RpFile.hpp"
+#include "../file/FileSystem.hpp"
+using namespace LibRpBase::FileSystem;
+
+// C includes.
+#ifndef _WIN32
+#include <unistd.h>
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * SplitDiscReader with access to the part table.
+ */
+class TestSplitDiscReader : public SplitDiscReader
+{
+	public:
+		explicit TestSplitDiscReader(IRpFile *file)
+			: SplitDiscReader(file) { }
+
+	public:
+		using SplitDiscReader::findPart;
+
+		/**
+		 * Get the starting position of a part.
+		 * @param part Part index. (partCount() returns the total size.)
+		 * @return Starting position.
+		 */
+		int64_t partStart(unsigned int part) const
+		{
+			return m_partStart[part];
+		}
+};
+
+class SplitDiscReaderTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) override final;
+		void TearDown(void) override final;
+
+	protected:
+		/**
+		 * Write the disc image as a set of part files.
+		 * @param names Part filenames, relative to the temporary directory.
+		 * @param sizes Part sizes.
+		 * @param count Number of parts.
+		 */
+		void writeParts(const char *const *names, const unsigned int *sizes, unsigned int count);
+
+		/**
+		 * Open a part file with SplitDiscReader.
+		 * @param name Filename, relative to the temporary directory.
+		 * @return SplitDiscReader, or nullptr on error.
+		 */
+		TestSplitDiscReader *openReader(const char *name);
+
+	protected:
+		string m_dir;			// Temporary directory, with a trailing separator.
+		vector<uint8_t> m_data;		// Disc image data.
+		vector<string> m_files;		// Files to delete in TearDown().
+};
+
+void SplitDiscReaderTest::SetUp(void)
+{
+	// NOTE: The cache directory is set up by gtest_main().
+	const string &cache_dir = getCacheDirectory();
+	ASSERT_FALSE(cache_dir.empty());
+	m_dir = cache_dir + DIR_SEP_CHR + "SplitDiscReaderTest" + DIR_SEP_CHR;
+	ASSERT_EQ(0, rmkdir(m_dir));
+
+	m_data.resize(64*1024);
+	for (size_t i = 0; i < m_data.size(); i++) {
+		m_data[i] = (uint8_t)((i * 13) ^ (i >> 8));
+	}
+}
+
+void SplitDiscReaderTest::TearDown(void)
+{
+	for (auto iter = m_files.cbegin(); iter != m_files.cend(); ++iter) {
+		delete_file(*iter);
+	}
+#ifndef _WIN32
+	rmdir(m_dir.c_str());
+#endif /* !_WIN32 */
+}
+
+/**
+ * Write the disc image as a set of part files.
+ * @param names Part filenames, relative to the temporary directory.
+ * @param sizes Part sizes.
+ * @param count Number of parts.
+ */
+void SplitDiscReaderTest::writeParts(const char *const *names, const unsigned int *sizes, unsigned int count)
+{
+	size_t pos = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		const string filename = m_dir + names[i];
+		m_files.push_back(filename);
+		unique_ptr<IRpFile> file(new RpFile(filename, RpFile::FM_CREATE_WRITE));
+		ASSERT_TRUE(file->isOpen()) << filename;
+		ASSERT_LE(pos + sizes[i], m_data.size());
+		ASSERT_EQ(sizes[i], file->write(&m_data[pos], sizes[i]));
+		pos += sizes[i];
+	}
+}
+
+/**
+ * Open a part file with SplitDiscReader.
+ * @param name Filename, relative to the temporary directory.
+ * @return SplitDiscReader, or nullptr on error.
+ */
+TestSplitDiscReader *SplitDiscReaderTest::openReader(const char *name)
+{
+	unique_ptr<IRpFile> file(new RpFile(m_dir + name, RpFile::FM_OPEN_READ));
+	if (!file->isOpen())
+		return nullptr;
+	// NOTE: SplitDiscReader dup()s the file.
+	return new TestSplitDiscReader(file.get());
+}
+
+/**
+ * Split filename detection.
+ */
+TEST_F(SplitDiscReaderTest, isSplitFilename)
+{
+	EXPECT_TRUE(SplitDiscReader::isSplitFilename("game.part0.iso"));
+	EXPECT_TRUE(SplitDiscReader::isSplitFilename("GAME.PART0.ISO"));
+	EXPECT_TRUE(SplitDiscReader::isSplitFilename("game.wbfs"));
+	EXPECT_TRUE(SplitDiscReader::isSplitFilename("GAME.WBFS"));
+	EXPECT_TRUE(SplitDiscReader::isSplitFilename(string("dir.part0") + DIR_SEP_CHR + "game.part0.iso"));
+
+	EXPECT_FALSE(SplitDiscReader::isSplitFilename("game.iso"));
+	EXPECT_FALSE(SplitDiscReader::isSplitFilename("game.part1.iso"));
+	EXPECT_FALSE(SplitDiscReader::isSplitFilename("game.wbf1"));
+	EXPECT_FALSE(SplitDiscReader::isSplitFilename(".part0"));
+	EXPECT_FALSE(SplitDiscReader::isSplitFilename(string("dir.part0") + DIR_SEP_CHR + "game"));
+}
+
+/**
+ * "*.part0.iso" opens "*.part1.iso", etc., and stops at the first missing part.
+ */
+TEST_F(SplitDiscReaderTest, partNames)
+{
+	static const char *const names[] = {"game.part0.iso", "game.part1.iso", "game.part2.iso", "game.part4.iso"};
+	static const unsigned int sizes[] = {10000, 7000, 3, 5000};
+	ASSERT_NO_FATAL_FAILURE(writeParts(names, sizes, 4));
+
+	unique_ptr<TestSplitDiscReader> reader(openReader(names[0]));
+	ASSERT_TRUE(reader != nullptr);
+	ASSERT_TRUE(reader->isOpen());
+	EXPECT_EQ(3U, reader->partCount());
+	EXPECT_EQ(10000 + 7000 + 3, reader->size());
+
+	// A later part on its own isn't split.
+	reader.reset(openReader(names[1]));
+	ASSERT_TRUE(reader != nullptr);
+	EXPECT_EQ(1U, reader->partCount());
+	EXPECT_EQ(7000, reader->size());
+}
+
+/**
+ * "*.wbfs" opens "*.wbf1", etc.
+ */
+TEST_F(SplitDiscReaderTest, wbfsNames)
+{
+	// NOTE: "game.wbfs1" isn't a valid part name.
+	static const char *const names[] = {"game.wbfs", "game.wbf1", "game.wbf2", "game.wbfs1"};
+	static const unsigned int sizes[] = {8192, 8192, 100, 4096};
+	ASSERT_NO_FATAL_FAILURE(writeParts(names, sizes, 4));
+
+	unique_ptr<TestSplitDiscReader> reader(openReader(names[0]));
+	ASSERT_TRUE(reader != nullptr);
+	EXPECT_EQ(3U, reader->partCount());
+	EXPECT_EQ(8192 + 8192 + 100, reader->size());
+}
+
+/**
+ * Non-split filenames only use one part.
+ */
+TEST_F(SplitDiscReaderTest, singlePart)
+{
+	static const char *const names[] = {"game.iso", "game.part1.iso", "game.wbf1"};
+	static const unsigned int sizes[] = {4000, 4000, 4000};
+	ASSERT_NO_FATAL_FAILURE(writeParts(names, sizes, 3));
+
+	unique_ptr<TestSplitDiscReader> reader(openReader(names[0]));
+	ASSERT_TRUE(reader != nullptr);
+	EXPECT_EQ(1U, reader->partCount());
+	EXPECT_EQ(4000, reader->size());
+
+	// readv() is forwarded directly.
+	uint8_t buf[2][100];
+	IRpFile::ReadRequest reqs[2] = {
+		{100, buf[0], 100, 0},
+		{3950, buf[1], 100, 0},	// 50 bytes past EOF
+	};
+	EXPECT_EQ(1U, reader->readv(reqs, 2));
+	EXPECT_EQ(100U, reqs[0].ret);
+	EXPECT_EQ(50U, reqs[1].ret);
+	EXPECT_EQ(0, memcmp(buf[0], &m_data[100], 100));
+	EXPECT_EQ(0, memcmp(buf[1], &m_data[3950], 50));
+}
+
+/**
+ * findPart() at every part boundary.
+ */
+TEST_F(SplitDiscReaderTest, findPart)
+{
+	static const char *const names[] = {"game.part0.iso", "game.part1.iso", "game.part2.iso", "game.part3.iso"};
+	static const unsigned int sizes[] = {10000, 1, 7000, 4096};
+	ASSERT_NO_FATAL_FAILURE(writeParts(names, sizes, 4));
+
+	unique_ptr<TestSplitDiscReader> reader(openReader(names[0]));
+	ASSERT_TRUE(reader != nullptr);
+	ASSERT_EQ(4U, reader->partCount());
+
+	for (unsigned int part = 0; part < reader->partCount(); part++) {
+		const int64_t start = reader->partStart(part);
+		const int64_t end = reader->partStart(part + 1);
+		EXPECT_EQ(part, reader->findPart(start)) << "part == " << part;
+		EXPECT_EQ(part, reader->findPart(end - 1)) << "part == " << part;
+		if (start > 0) {
+			EXPECT_EQ(part - 1, reader->findPart(start - 1)) << "part == " << part;
+		}
+	}
+	EXPECT_EQ(reader->size(), reader->partStart(reader->partCount()));
+}
+
+/**
+ * pread() and read() across part boundaries.
+ */
+TEST_F(SplitDiscReaderTest, preadAcrossParts)
+{
+	static const char *const names[] = {"game.part0.iso", "game.part1.iso", "game.part2.iso"};
+	static const unsigned int sizes[] = {10000, 3, 7000};
+	ASSERT_NO_FATAL_FAILURE(writeParts(names, sizes, 3));
+
+	unique_ptr<TestSplitDiscReader> reader(openReader(names[0]));
+	ASSERT_TRUE(reader != nullptr);
+	ASSERT_EQ(3U, reader->partCount());
+	const int64_t discSize = reader->size();
+	ASSERT_EQ(17003, discSize);
+
+	vector<uint8_t> buf((size_t)discSize + 100);
+
+	// Crosses one boundary.
+	EXPECT_EQ(200U, reader->pread(9900, buf.data(), 200));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[9900], 200));
+
+	// Spans the whole middle part.
+	EXPECT_EQ(20U, reader->pread(9990, buf.data(), 20));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[9990], 20));
+
+	// Entire disc image, and past the end.
+	EXPECT_EQ((size_t)discSize, reader->pread(0, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), (size_t)discSize));
+	EXPECT_EQ(0U, reader->pread(discSize, buf.data(), 1));
+	EXPECT_EQ(0U, reader->pread(-1, buf.data(), 1));
+
+	// Sequential read() across the boundaries.
+	ASSERT_EQ(0, reader->seek(9998));
+	EXPECT_EQ(4U, reader->read(buf.data(), 4));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[9998], 4));
+	EXPECT_EQ(10002, reader->tell());
+	EXPECT_EQ(4U, reader->read(buf.data(), 4));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[10002], 4));
+	EXPECT_EQ(10006, reader->tell());
+}
+
+/**
+ * readv() with requests in single parts, across parts,
+ * and out of range.
+ */
+TEST_F(SplitDiscReaderTest, readv)
+{
+	static const char *const names[] = {"game.part0.iso", "game.part1.iso", "game.part2.iso"};
+	static const unsigned int sizes[] = {10000, 3, 7000};
+	ASSERT_NO_FATAL_FAILURE(writeParts(names, sizes, 3));
+
+	unique_ptr<TestSplitDiscReader> reader(openReader(names[0]));
+	ASSERT_TRUE(reader != nullptr);
+	ASSERT_EQ(3U, reader->partCount());
+
+	uint8_t buf[8][300];
+	memset(buf, 0xCC, sizeof(buf));
+	IRpFile::ReadRequest reqs[8] = {
+		{12000,  buf[0], 300, 0},	// Part 2
+		{100,    buf[1], 300, 0},	// Part 0
+		{9800,   buf[2], 300, 0},	// Parts 0, 1, 2
+		{10000,  buf[3], 3,   0},	// All of part 1
+		{5000,   buf[4], 200, 0},	// Part 0
+		{16900,  buf[5], 300, 0},	// Part 2, past EOF
+		{17003,  buf[6], 10,  0},	// At EOF
+		{17003,  buf[7], 0,   0},	// At EOF, zero size
+	};
+	EXPECT_EQ(6U, reader->readv(reqs, 8));
+
+	static const size_t expected_ret[8] = {300, 300, 300, 3, 200, 103, 0, 0};
+	for (unsigned int i = 0; i < 8; i++) {
+		EXPECT_EQ(expected_ret[i], reqs[i].ret) << "request " << i;
+		EXPECT_EQ(0, memcmp(buf[i], &m_data[(size_t)reqs[i].pos], reqs[i].ret)) << "request " << i;
+		if (reqs[i].ret < sizeof(buf[i])) {
+			EXPECT_EQ(0xCC, buf[i][reqs[i].ret]) << "request " << i;
+		}
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: SplitDiscReader tests.\n\n");
+	fflush(nullptr);
+
+#ifndef _WIN32
+	// Use a temporary cache directory for the part files.
+	char tmpdir[] = "/tmp/SplitDiscReaderTest.XXXXXX";
+	if (!mkdtemp(tmpdir)) {
+		fprintf(stderr, "*** ERROR: mkdtemp() failed.\n");
+		return EXIT_FAILURE;
+	}
+	setenv("XDG_CACHE_HOME", tmpdir, 1);
+#endif /* !_WIN32 */
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	int ret = RUN_ALL_TESTS();
+
+#ifndef _WIN32
+	// Remove the temporary cache directory.
+	// NOTE: The test fixture removes all files it creates.
+	rmdir((string(tmpdir) + "/rom-properties").c_str());
+	rmdir(tmpdir);
+#endif /* !_WIN32 */
+	return ret;
+}
@@ -43,6 +43,7 @@
    /* FIXME: Not working... (clang-3.9.0 complains that it's not declared.) */
 #  define ATOMIC_INC_FETCH(ptr)			__c11_atomic_add_fetch(ptr, 1, __ATOMIC_SEQ_CST)
 #  define ATOMIC_DEC_FETCH(ptr)			__c11_atomic_dec_fetch(ptr, 1, __ATOMIC_SEQ_CST)
+#  define ATOMIC_ADD_FETCH(ptr, val)		__c11_atomic_add_fetch(ptr, val, __ATOMIC_SEQ_CST)
 #  define ATOMIC_OR_FETCH(ptr, val)		__c11_atomic_or_fetch(ptr, val, __ATOMIC_SEQ_CST)
    /* NOTE: C11 version of cmpxchg requires pointers, so we'll use the Itanium-style version. */
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg);
@@ -51,6 +52,7 @@
    /* Use Itanium-style atomics. */
 #  define ATOMIC_INC_FETCH(ptr)			__sync_add_and_fetch(ptr, 1)
 #  define ATOMIC_DEC_FETCH(ptr)			__sync_sub_and_fetch(ptr, 1)
+#  define ATOMIC_ADD_FETCH(ptr, val)		__sync_add_and_fetch(ptr, val)
 #  define ATOMIC_OR_FETCH(ptr, val)		__sync_or_and_fetch(ptr, val)
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg);
 #  define ATOMIC_EXCHANGE(ptr, val)		__sync_lock_test_and_set(ptr, val);
@@ -60,6 +62,7 @@
    /* gcc-4.7: Use prefixed C11-style atomics. */
 #  define ATOMIC_INC_FETCH(ptr)			__atomic_add_fetch(ptr, 1, __ATOMIC_SEQ_CST)
 #  define ATOMIC_DEC_FETCH(ptr)			__atomic_sub_fetch(ptr, 1, __ATOMIC_SEQ_CST)
+#  define ATOMIC_ADD_FETCH(ptr, val)		__atomic_add_fetch(ptr, val, __ATOMIC_SEQ_CST)
 #  define ATOMIC_OR_FETCH(ptr, val)		__atomic_or_fetch(ptr, val, __ATOMIC_SEQ_CST)
    /* NOTE: C11 version of cmpxchg requires pointers, so we'll use the Itanium-style version. */
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg)
@@ -68,6 +71,7 @@
    /* gcc-4.6 and earlier: Use Itanium-style atomics. */
 #  define ATOMIC_INC_FETCH(ptr)			__sync_add_and_fetch(ptr, 1)
 #  define ATOMIC_DEC_FETCH(ptr)			__sync_sub_and_fetch(ptr, 1)
+#  define ATOMIC_ADD_FETCH(ptr, val)		__sync_add_and_fetch(ptr, val)
 #  define ATOMIC_OR_FETCH(ptr, val)		__sync_or_and_fetch(ptr, val)
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg)
 #  define ATOMIC_EXCHANGE(ptr, val)		__sync_lock_test_and_set(ptr, val)
@@ -83,6 +87,10 @@ static FORCEINLINE int ATOMIC_DEC_FETCH(volatile int *ptr)
 {
 	return _InterlockedDecrement(REINTERPRET_CAST(volatile long*)(ptr));
 }
+static FORCEINLINE int ATOMIC_ADD_FETCH(volatile int *ptr, int val)
+{
+	return _InterlockedExchangeAdd(REINTERPRET_CAST(volatile long*)(ptr), val) + val;
+}
 static FORCEINLINE int ATOMIC_OR_FETCH(volatile int *ptr, int val)
 {
 	return _InterlockedOr(REINTERPRET_CAST(volatile long*)(ptr), val);
@@ -38,8 +38,9 @@ class Semaphore
 		/**
 		 * Create a semaphore.
 		 * @param count Number of times the semaphore can be obtained before blocking.
+		 * @param maxCount Maximum count. (If -1, same as count.)
 		 */
-		explicit Semaphore(int count);
+		explicit Semaphore(int count, int maxCount = -1);
 
 		/**
 		 * Delete the semaphore.
@@ -30,10 +30,14 @@ namespace LibRpBase {
 /**
  * Create a semaphore.
  * @param count Number of times the semaphore can be obtained before blocking.
+ * @param maxCount Maximum count. (If -1, same as count.)
  */
-Semaphore::Semaphore(int count)
+Semaphore::Semaphore(int count, int maxCount)
 	: m_isInit(false)
 {
+	// NOTE: POSIX semaphores don't have a maximum count.
+	RP_UNUSED(maxCount);
+
 	int ret = sem_init(&m_sem, 0, count);
 	assert(ret == 0);
 	if (ret == 0) {
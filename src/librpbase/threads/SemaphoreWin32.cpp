@@ -30,10 +30,14 @@ namespace LibRpBase {
 /**
  * Create a semaphore.
  * @param count Number of times the semaphore can be obtained before blocking.
+ * @param maxCount Maximum count. (If -1, same as count.)
  */
-Semaphore::Semaphore(int count)
+Semaphore::Semaphore(int count, int maxCount)
 {
-	m_sem = CreateSemaphore(nullptr, count, count, nullptr);
+	if (maxCount < 0) {
+		maxCount = count;
+	}
+	m_sem = CreateSemaphore(nullptr, count, maxCount, nullptr);
 	assert(m_sem != nullptr);
 	if (!m_sem) {
 		// FIXME: Do something if an error occurred here...
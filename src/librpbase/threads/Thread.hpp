@@ -0,0 +1,99 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Thread.hpp: System-specific thread implementation.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_THREAD_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_THREAD_HPP__
+
+#include "common.h"
+
+#ifdef _WIN32
+#include "libwin32common/RpWin32_sdk.h"
+#else /* !_WIN32 */
+#include <pthread.h>
+#endif
+
+namespace LibRpBase {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param param User parameter.
+		 */
+		typedef void (*ThreadFunc)(void *param);
+
+		/**
+		 * Create and start a thread.
+		 * Check isRunning() to determine if the thread was started.
+		 * @param func Thread function.
+		 * @param param User parameter.
+		 */
+		explicit Thread(ThreadFunc func, void *param);
+
+		/**
+		 * Delete the thread.
+		 * If the thread is still running, this
+		 * will block until it finishes.
+		 */
+		~Thread();
+
+	private:
+		RP_DISABLE_COPY(Thread)
+
+	public:
+		/**
+		 * Is the thread running?
+		 * @return True if the thread was started and hasn't been joined yet.
+		 */
+		inline bool isRunning(void) const
+		{
+			return m_isRunning;
+		}
+
+		/**
+		 * Wait for the thread to finish.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int join(void);
+
+		/**
+		 * Get the number of logical processors in the system.
+		 * @return Number of logical processors. (Always at least 1.)
+		 */
+		static unsigned int processorCount(void);
+
+	private:
+		ThreadFunc m_func;
+		void *m_param;
+#ifdef _WIN32
+		HANDLE m_thread;
+		static DWORD WINAPI threadProc(LPVOID lpParameter);
+#else
+		pthread_t m_thread;
+		static void *threadProc(void *arg);
+#endif
+		bool m_isRunning;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_THREAD_HPP__ */
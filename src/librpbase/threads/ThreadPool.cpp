@@ -0,0 +1,163 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ThreadPool.cpp: Simple worker thread pool.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "ThreadPool.hpp"
+#include "Thread.hpp"
+#include "Atomics.h"
+
+// C includes. (C++ namespace)
+#include <cassert>
+
+// Maximum number of threads.
+// This is mostly to keep the semaphore counts sane.
+#define THREADPOOL_MAX_THREADS 64
+
+namespace LibRpBase {
+
+/**
+ * Create a thread pool.
+ *
+ * The calling thread also processes work items in run(),
+ * so the pool starts (threads - 1) worker threads.
+ *
+ * @param threads Number of threads to use. (If 0, use the number of logical processors.)
+ */
+ThreadPool::ThreadPool(unsigned int threads)
+	: m_startSem(0, THREADPOOL_MAX_THREADS)
+	, m_doneSem(0, THREADPOOL_MAX_THREADS)
+	, m_func(nullptr)
+	, m_param(nullptr)
+	, m_count(0)
+	, m_next(0)
+	, m_quit(false)
+{
+	if (threads == 0) {
+		threads = Thread::processorCount();
+	}
+	if (threads > THREADPOOL_MAX_THREADS) {
+		threads = THREADPOOL_MAX_THREADS;
+	}
+
+	m_threads.reserve(threads - 1);
+	for (unsigned int i = 1; i < threads; i++) {
+		Thread *const thread = new Thread(workerProc, this);
+		if (!thread->isRunning()) {
+			// Unable to start the thread.
+			// Use whatever threads we have.
+			delete thread;
+			break;
+		}
+		m_threads.push_back(thread);
+	}
+}
+
+/**
+ * Delete the thread pool.
+ * This will stop and join all worker threads.
+ * WARNING: run() must not be active!
+ */
+ThreadPool::~ThreadPool()
+{
+	m_quit = true;
+	for (size_t i = 0; i < m_threads.size(); i++) {
+		m_startSem.release();
+	}
+	for (auto iter = m_threads.begin(); iter != m_threads.end(); ++iter) {
+		delete *iter;
+	}
+}
+
+/**
+ * Worker thread entry point.
+ * @param param ThreadPool.
+ */
+void ThreadPool::workerProc(void *param)
+{
+	ThreadPool *const pool = static_cast<ThreadPool*>(param);
+	while (true) {
+		pool->m_startSem.obtain();
+		if (pool->m_quit)
+			break;
+		pool->processItems();
+		pool->m_doneSem.release();
+	}
+}
+
+/**
+ * Process work items until none are left.
+ */
+void ThreadPool::processItems(void)
+{
+	while (true) {
+		const unsigned int idx = (unsigned int)(ATOMIC_INC_FETCH(&m_next) - 1);
+		if (idx >= m_count)
+			break;
+		m_func(m_param, idx);
+	}
+}
+
+/**
+ * Run a function for each work item index in [0, count).
+ *
+ * Work items are handed out to the worker threads and the
+ * calling thread in order, one at a time, so the number of
+ * items in flight is bounded by the number of threads.
+ *
+ * This function blocks until all work items have been processed.
+ * Only one run() may be active at a time; concurrent calls are
+ * serialized.
+ *
+ * @param count Number of work items.
+ * @param func Work item function.
+ * @param param User parameter.
+ */
+void ThreadPool::run(unsigned int count, WorkFunc func, void *param)
+{
+	assert(func != nullptr);
+	if (!func || count == 0)
+		return;
+
+	MutexLocker runLock(m_runMutex);
+	m_func = func;
+	m_param = param;
+	m_count = count;
+	m_next = 0;
+
+	// Don't wake up more workers than we have items for.
+	// The calling thread handles one of them.
+	size_t workers = m_threads.size();
+	if (workers > count - 1) {
+		workers = count - 1;
+	}
+
+	for (size_t i = 0; i < workers; i++) {
+		m_startSem.release();
+	}
+	processItems();
+	for (size_t i = 0; i < workers; i++) {
+		m_doneSem.obtain();
+	}
+
+	m_func = nullptr;
+	m_param = nullptr;
+}
+
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ThreadPool.hpp: Simple worker thread pool.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_THREADPOOL_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_THREADPOOL_HPP__
+
+#include "common.h"
+#include "Mutex.hpp"
+#include "Semaphore.hpp"
+
+// C++ includes.
+#include <vector>
+
+namespace LibRpBase {
+
+class Thread;
+
+class ThreadPool
+{
+	public:
+		/**
+		 * Create a thread pool.
+		 *
+		 * The calling thread also processes work items in run(),
+		 * so the pool starts (threads - 1) worker threads.
+		 *
+		 * @param threads Number of threads to use. (If 0, use the number of logical processors.)
+		 */
+		explicit ThreadPool(unsigned int threads = 0);
+
+		/**
+		 * Delete the thread pool.
+		 * This will stop and join all worker threads.
+		 * WARNING: run() must not be active!
+		 */
+		~ThreadPool();
+
+	private:
+		RP_DISABLE_COPY(ThreadPool)
+
+	public:
+		/**
+		 * Work item function.
+		 * @param param User parameter.
+		 * @param idx Work item index.
+		 */
+		typedef void (*WorkFunc)(void *param, unsigned int idx);
+
+		/**
+		 * Run a function for each work item index in [0, count).
+		 *
+		 * Work items are handed out to the worker threads and the
+		 * calling thread in order, one at a time, so the number of
+		 * items in flight is bounded by the number of threads.
+		 *
+		 * This function blocks until all work items have been processed.
+		 * Only one run() may be active at a time; concurrent calls are
+		 * serialized.
+		 *
+		 * @param count Number of work items.
+		 * @param func Work item function.
+		 * @param param User parameter.
+		 */
+		void run(unsigned int count, WorkFunc func, void *param);
+
+		/**
+		 * Get the total number of threads used by run(),
+		 * including the calling thread.
+		 * @return Number of threads.
+		 */
+		inline unsigned int threadCount(void) const
+		{
+			return (unsigned int)m_threads.size() + 1;
+		}
+
+	private:
+		/**
+		 * Worker thread entry point.
+		 * @param param ThreadPool.
+		 */
+		static void workerProc(void *param);
+
+		/**
+		 * Process work items until none are left.
+		 */
+		void processItems(void);
+
+	private:
+		std::vector<Thread*> m_threads;
+
+		// Serializes run() calls.
+		Mutex m_runMutex;
+
+		// Worker threads obtain m_startSem to start a job,
+		// and release m_doneSem once they run out of items.
+		Semaphore m_startSem;
+		Semaphore m_doneSem;
+
+		// Current job.
+		WorkFunc m_func;
+		void *m_param;
+		unsigned int m_count;
+		volatile int m_next;
+		volatile bool m_quit;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_THREADPOOL_HPP__ */
@@ -0,0 +1,103 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ThreadPosix.cpp: POSIX thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "Thread.hpp"
+
+// C includes.
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpBase {
+
+/**
+ * Create and start a thread.
+ * Check isRunning() to determine if the thread was started.
+ * @param func Thread function.
+ * @param param User parameter.
+ */
+Thread::Thread(ThreadFunc func, void *param)
+	: m_func(func)
+	, m_param(param)
+	, m_isRunning(false)
+{
+	assert(func != nullptr);
+	if (!func)
+		return;
+
+	int ret = pthread_create(&m_thread, nullptr, threadProc, this);
+	assert(ret == 0);
+	if (ret == 0) {
+		m_isRunning = true;
+	} else {
+		// FIXME: Do something if an error occurred here...
+	}
+}
+
+/**
+ * Delete the thread.
+ * If the thread is still running, this
+ * will block until it finishes.
+ */
+Thread::~Thread()
+{
+	join();
+}
+
+/**
+ * Thread entry point.
+ * @param arg Thread object.
+ * @return nullptr
+ */
+void *Thread::threadProc(void *arg)
+{
+	Thread *const thread = static_cast<Thread*>(arg);
+	thread->m_func(thread->m_param);
+	return nullptr;
+}
+
+/**
+ * Wait for the thread to finish.
+ * @return 0 on success; non-zero on error.
+ */
+int Thread::join(void)
+{
+	if (!m_isRunning)
+		return -EBADF;
+
+	int ret = pthread_join(m_thread, nullptr);
+	m_isRunning = false;
+	return ret;
+}
+
+/**
+ * Get the number of logical processors in the system.
+ * @return Number of logical processors. (Always at least 1.)
+ */
+unsigned int Thread::processorCount(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0 ? (unsigned int)count : 1);
+}
+
+}
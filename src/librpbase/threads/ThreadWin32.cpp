@@ -0,0 +1,108 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ThreadWin32.cpp: Win32 thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "Thread.hpp"
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpBase {
+
+/**
+ * Create and start a thread.
+ * Check isRunning() to determine if the thread was started.
+ * @param func Thread function.
+ * @param param User parameter.
+ */
+Thread::Thread(ThreadFunc func, void *param)
+	: m_func(func)
+	, m_param(param)
+	, m_thread(nullptr)
+	, m_isRunning(false)
+{
+	assert(func != nullptr);
+	if (!func)
+		return;
+
+	m_thread = CreateThread(nullptr, 0, threadProc, this, 0, nullptr);
+	assert(m_thread != nullptr);
+	if (m_thread) {
+		m_isRunning = true;
+	} else {
+		// FIXME: Do something if an error occurred here...
+	}
+}
+
+/**
+ * Delete the thread.
+ * If the thread is still running, this
+ * will block until it finishes.
+ */
+Thread::~Thread()
+{
+	join();
+}
+
+/**
+ * Thread entry point.
+ * @param lpParameter Thread object.
+ * @return 0
+ */
+DWORD WINAPI Thread::threadProc(LPVOID lpParameter)
+{
+	Thread *const thread = static_cast<Thread*>(lpParameter);
+	thread->m_func(thread->m_param);
+	return 0;
+}
+
+/**
+ * Wait for the thread to finish.
+ * @return 0 on success; non-zero on error.
+ */
+int Thread::join(void)
+{
+	if (!m_isRunning)
+		return -EBADF;
+
+	DWORD dwWaitResult = WaitForSingleObject(m_thread, INFINITE);
+	CloseHandle(m_thread);
+	m_thread = nullptr;
+	m_isRunning = false;
+	if (dwWaitResult == WAIT_OBJECT_0)
+		return 0;
+
+	// TODO: What error to return?
+	return -1;
+}
+
+/**
+ * Get the number of logical processors in the system.
+ * @return Number of logical processors. (Always at least 1.)
+ */
+unsigned int Thread::processorCount(void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (si.dwNumberOfProcessors > 0 ? (unsigned int)si.dwNumberOfProcessors : 1);
+}
+
+}
@@ -25,6 +25,7 @@
 // librpbase
 #include "librpbase/byteswap.h"
 #include "librpbase/RomData.hpp"
+#include "librpbase/RomMetaCache.hpp"
 #include "librpbase/SystemRegion.hpp"
 #include "libi18n/i18n.h"
 using namespace LibRpBase;
@@ -40,8 +41,10 @@ using namespace LibRomData;
 
 #include "bmp.hpp"
 #include "properties.hpp"
+#include "verifysectors.hpp"
 #ifdef ENABLE_DECRYPTION
 # include "verifykeys.hpp"
+# include "verifyhashes.hpp"
 #endif /* ENABLE_DECRYPTION */
 
 // C includes.
@@ -145,35 +148,66 @@ static void ExtractImages(RomData *romData, std::vector<ExtractParam>& extract)
 * Shows info about file
 * @param filename ROM filename
 * @param json Is program running in json mode?
+* @param useCache Use the metadata cache?
+* @param verifyHashes Verify disc image hashes?
+* @param verifySectors Verify CD-ROM sector EDC/ECC?
 * @param extract Vector of image extraction parameters
 */
-static void DoFile(const char *filename, bool json, std::vector<ExtractParam>& extract){
+static void DoFile(const char *filename, bool json, bool useCache, bool verifyHashes, bool verifySectors, std::vector<ExtractParam>& extract){
 	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
-	IRpFile *file = new RpFile(filename, RpFile::FM_OPEN_READ);
-	if (file->isOpen()) {
-		RomData *romData = RomDataFactory::create(file);
-		if (romData && romData->isValid()) {
-			if (json) {
-				cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
-				cout << JSONROMOutput(romData) << endl;
-			} else {
-				cout << ROMOutput(romData) << endl;
-			}
 
-			ExtractImages(romData, extract);
+	// Check the metadata cache first.
+	// NOTE: Cached RomData objects don't have any images,
+	// so the cache can't be used for image extraction.
+	RomData *romData = nullptr;
+	if (useCache && extract.empty() && !verifyHashes && !verifySectors) {
+		romData = RomMetaCache::lookup(filename);
+	}
+
+	if (!romData) {
+		IRpFile *file = new RpFile(filename, RpFile::FM_OPEN_READ);
+		if (!file->isOpen()) {
+			cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
+			if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+			delete file;
+			return;
+		}
+
+		// NOTE: RomData dup()s the file.
+		romData = RomDataFactory::create(file);
+		delete file;
+		if (romData && useCache) {
+			RomMetaCache::store(filename, romData);
+		}
+	}
+
+	if (romData && romData->isValid()) {
+		if (json) {
+			cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
+			cout << JSONROMOutput(romData) << endl;
 		} else {
-			cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
-			if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+			cout << ROMOutput(romData) << endl;
 		}
 
-		if (romData) {
-			romData->unref();
+		ExtractImages(romData, extract);
+#ifdef ENABLE_DECRYPTION
+		if (verifyHashes) {
+			VerifyHashes(romData);
+		}
+#else /* !ENABLE_DECRYPTION */
+		RP_UNUSED(verifyHashes);
+#endif /* ENABLE_DECRYPTION */
+		if (verifySectors) {
+			VerifySectors(romData);
 		}
 	} else {
-		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
-		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
+		if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+	}
+
+	if (romData) {
+		romData->unref();
 	}
-	delete file;
 }
 
 /**
@@ -223,13 +257,16 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-j] [[-x[b]N outfile]... filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-j] [-m] [-V] [-E] [[-x[b]N outfile]... filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
+		cerr << "  -V:   " << C_("rpcli", "Verify disc image hashes. (Wii only)") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-j] [[-x[b]N outfile]... filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-j] [-m] [-E] [[-x[b]N outfile]... filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
+		cerr << "  -m:   " << C_("rpcli", "Use the metadata cache. (Cached files don't list images.)") << endl;
+		cerr << "  -E:   " << C_("rpcli", "Verify CD-ROM sector EDC/ECC. (Dreamcast and Saturn only)") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -xbN: " << C_("rpcli", "Extract image N to outfile in BMP format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
@@ -244,11 +281,22 @@ int RP_C_API main(int argc, char *argv[])
 	assert(RomData::IMG_INT_MIN == 0);
 	// DoFile parameters
 	bool json = false;
+	bool useCache = false;
+	bool verifyHashes = false;
+	bool verifySectors = false;
 	std::vector<ExtractParam> extract;
 
 	for (int i = 1; i < argc; i++) { // figure out the json mode in advance
 		if (argv[i][0] == '-' && argv[i][1] == 'j') {
 			json = true;
+		} else if (argv[i][0] == '-' && argv[i][1] == 'm') {
+			useCache = true;
+		} else if (argv[i][0] == '-' && argv[i][1] == 'E') {
+			verifySectors = true;
+#ifdef ENABLE_DECRYPTION
+		} else if (argv[i][0] == '-' && argv[i][1] == 'V') {
+			verifyHashes = true;
+#endif /* ENABLE_DECRYPTION */
 		}
 	}
 	if (json) cout << "[\n";
@@ -294,6 +342,11 @@ int RP_C_API main(int argc, char *argv[])
 				break;
 			}
 			case 'j': // do nothing
+			case 'm': // do nothing
+			case 'E': // do nothing
+#ifdef ENABLE_DECRYPTION
+			case 'V': // do nothing
+#endif /* ENABLE_DECRYPTION */
 				break;
 			default:
 				cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown switch '%c'"), argv[i][1]) << endl;
@@ -303,7 +356,7 @@ int RP_C_API main(int argc, char *argv[])
 		else{
 			if (first) first = false;
 			else if (json) cout << "," << endl;
-			DoFile(argv[i], json, extract);
+			DoFile(argv[i], json, useCache, verifyHashes, verifySectors, extract);
 			extract.clear();
 		}
 	}
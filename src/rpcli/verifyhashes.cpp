@@ -0,0 +1,130 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * verifyhashes.cpp: Verify disc image hashes.                            *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ * Copyright (c) 2016-2017 by Egor.                                        *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.rpcli.h"
+
+#ifndef ENABLE_DECRYPTION
+#error This file should only be compiled if decryption is enabled.
+#endif
+
+#include "verifyhashes.hpp"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+
+// libromdata
+#include "libromdata/Console/GameCube.hpp"
+#include "libromdata/disc/WiiPartition.hpp"
+using namespace LibRomData;
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cstring>
+
+// C++ includes.
+#include <iostream>
+#include <vector>
+using std::cerr;
+using std::endl;
+using std::vector;
+
+/**
+ * Verify the hashes in a disc image and print a bad sector report.
+ * Currently, only Wii disc images are supported.
+ * @param romData RomData object.
+ * @return 0 if all hashes are valid; non-zero on error.
+ */
+int VerifyHashes(RomData *romData)
+{
+	assert(romData != nullptr);
+	if (!romData || !romData->isValid() || strcmp(romData->className(), "GameCube") != 0) {
+		cerr << "-- " << C_("rpcli", "Hash verification is not supported for this file.") << endl;
+		return 1;
+	}
+
+	cerr << "*** " << C_("rpcli", "Verifying Wii partition hashes...") << endl;
+	GameCube *const gcn = static_cast<GameCube*>(romData);
+	vector<GameCube::WiiPartitionHashReport> reports;
+	int ret = gcn->verifyWiiPartitionHashes(reports);
+	if (ret != 0) {
+		cerr << rp_sprintf(C_("rpcli", "ERROR: %s"), strerror(-ret)) << endl;
+		return 1;
+	}
+
+	int err = 0;
+	for (auto iter = reports.cbegin(); iter != reports.cend(); ++iter) {
+		static const char *const partTypes[] = {
+			NOP_C_("rpcli|WiiPartitionType", "Game"),
+			NOP_C_("rpcli|WiiPartitionType", "Update"),
+			NOP_C_("rpcli|WiiPartitionType", "Channel"),
+		};
+		const char *const partType = (iter->type < ARRAY_SIZE(partTypes)
+			? dpgettext_expr(RP_I18N_DOMAIN, "rpcli|WiiPartitionType", partTypes[iter->type])
+			: C_("rpcli|WiiPartitionType", "Unknown"));
+		// tr: %1$u == volume group, %2$u == partition number, %3$s == partition type, %4$08llX == address
+		cerr << rp_sprintf_p(C_("rpcli", "Partition %1$u.%2$u (%3$s) at 0x%4$08llX:"),
+			iter->vg, iter->pt, partType, (unsigned long long)iter->start) << endl;
+		if (iter->error != 0) {
+			cerr << "  " << rp_sprintf(C_("rpcli", "ERROR: %s"), strerror(-iter->error)) << endl;
+			err = 1;
+			continue;
+		}
+
+		const WiiPartition::HashReport &report = iter->report;
+		cerr << "  " << (report.h3TableOK
+			? C_("rpcli", "H3 table: OK")
+			: C_("rpcli", "H3 table: does not match the TMD")) << endl;
+		cerr << "  " << rp_sprintf_p(C_("rpcli", "%1$u sectors checked, %2$u bad sectors."),
+			report.sectorCount, (unsigned int)report.badSectors.size()) << endl;
+		if (!report.h3TableOK || !report.badSectors.empty()) {
+			err = 1;
+		}
+
+		for (auto bad = report.badSectors.cbegin(); bad != report.badSectors.cend(); ++bad) {
+			// tr: %1$08X == sector number, %2$u == sector group
+			cerr << "  " << rp_sprintf_p(C_("rpcli", "Sector 0x%1$08X (group %2$u):"),
+				bad->sector, bad->sector / 64);
+			if (bad->errors & WiiPartition::HASHERR_READ) {
+				cerr << ' ' << C_("rpcli", "read error");
+			}
+			if (bad->errors & WiiPartition::HASHERR_H0) {
+				cerr << rp_sprintf(" H0 [0x%08X]", bad->h0_mask);
+			}
+			if (bad->errors & WiiPartition::HASHERR_H1) {
+				cerr << " H1";
+			}
+			if (bad->errors & WiiPartition::HASHERR_H2) {
+				cerr << " H2";
+			}
+			if (bad->errors & WiiPartition::HASHERR_H3) {
+				cerr << " H3";
+			}
+			cerr << endl;
+		}
+	}
+
+	return err;
+}
@@ -0,0 +1,37 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * verifyhashes.hpp: Verify disc image hashes.                             *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_VERIFYHASHES_HPP__
+#define __ROMPROPERTIES_RPCLI_VERIFYHASHES_HPP__
+
+namespace LibRpBase {
+	class RomData;
+}
+
+/**
+ * Verify the hashes in a disc image and print a bad sector report.
+ * Currently, only Wii disc images are supported.
+ * @param romData RomData object.
+ * @return 0 if all hashes are valid; non-zero on error.
+ */
+int VerifyHashes(LibRpBase::RomData *romData);
+
+#endif /* __ROMPROPERTIES_RPCLI_VERIFYHASHES_HPP__ */
@@ -0,0 +1,104 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * verifysectors.cpp: Verify CD-ROM sector EDC/ECC.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2017 by David Korth.                                 *
+ * Copyright (c) 2016-2017 by Egor.                                        *
+ *                                                                         *
+ * This program is free software; you can redistribute it and/or modify it *
+ * under the terms of the GNU General Public License as published by the   *
+ * Free Software Foundation; either version 2 of the License, or (at your  *
+ * option) any later version.                                              *
+ *                                                                         *
+ * This program is distributed in the hope that it will be useful, but     *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           *
+ * GNU General Public License for more details.                            *
+ *                                                                         *
+ * You should have received a copy of the GNU General Public License along *
+ * with this program; if not, write to the Free Software Foundation, Inc., *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.           *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "verifysectors.hpp"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+
+// libromdata
+#include "libromdata/Console/Dreamcast.hpp"
+#include "libromdata/Console/SegaSaturn.hpp"
+#include "libromdata/utils/CdromEdcEcc.hpp"
+using namespace LibRomData;
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <iostream>
+using std::cerr;
+using std::endl;
+
+/**
+ * Verify the EDC and ECC of a CD-ROM disc image and print a bad sector report.
+ * Currently, only Dreamcast and Sega Saturn disc images are supported.
+ * @param romData RomData object.
+ * @return 0 if all sectors are valid; non-zero on error.
+ */
+int VerifySectors(RomData *romData)
+{
+	assert(romData != nullptr);
+	const char *const className = (romData && romData->isValid() ? romData->className() : "");
+	const bool isDreamcast = !strcmp(className, "Dreamcast");
+	if (!isDreamcast && strcmp(className, "SegaSaturn") != 0) {
+		cerr << "-- " << C_("rpcli", "Sector verification is not supported for this file.") << endl;
+		return 1;
+	}
+
+	cerr << "*** " << C_("rpcli", "Verifying CD-ROM sectors...") << endl;
+	CdromEdcEcc::SectorReport report;
+	int ret = (isDreamcast
+		? static_cast<Dreamcast*>(romData)->verifyCdromSectors(report)
+		: static_cast<SegaSaturn*>(romData)->verifyCdromSectors(report));
+	if (ret == -ENOTSUP) {
+		cerr << "-- " << C_("rpcli", "This disc image has 2048-byte sectors, which don't have EDC or ECC.") << endl;
+		return 1;
+	} else if (ret != 0) {
+		cerr << rp_sprintf(C_("rpcli", "ERROR: %s"), strerror(-ret)) << endl;
+		return 1;
+	}
+
+	cerr << rp_sprintf_p(C_("rpcli", "%1$u sectors checked, %2$u bad sectors."),
+		report.sectorCount, (unsigned int)report.badSectors.size()) << endl;
+	for (auto bad = report.badSectors.cbegin(); bad != report.badSectors.cend(); ++bad) {
+		// tr: %u == LBA
+		cerr << "  " << rp_sprintf(C_("rpcli", "LBA %u:"), bad->lba);
+		if (bad->errors & CdromEdcEcc::SECTERR_READ) {
+			cerr << ' ' << C_("rpcli", "read error");
+		}
+		if (bad->errors & CdromEdcEcc::SECTERR_SYNC) {
+			cerr << ' ' << C_("rpcli", "invalid sync");
+		}
+		if (bad->errors & CdromEdcEcc::SECTERR_MODE) {
+			cerr << ' ' << C_("rpcli", "invalid mode");
+		}
+		if (bad->errors & CdromEdcEcc::SECTERR_EDC) {
+			cerr << " EDC";
+		}
+		if (bad->errors & CdromEdcEcc::SECTERR_ECC_P) {
+			cerr << " ECC-P";
+		}
+		if (bad->errors & CdromEdcEcc::SECTERR_ECC_Q) {
+			cerr << " ECC-Q";
+		}
+		cerr << endl;
+	}
+
+	return (report.badSectors.empty() ? 0 : 1);
+}